@@ -0,0 +1,253 @@
+#version 330 core
+#extension GL_ARB_shader_storage_buffer_object : enable
+
+struct Material {
+   vec3 ambientColor;
+   float ambientStrength;
+   vec3 diffuseColor;
+   vec3 specularColor;
+   float shininess;
+};
+
+struct LightSource {
+   vec3 position;
+   float focalStrength;
+   vec3 ambientColor;
+   float specularIntensity;
+   vec3 diffuseColor;
+   // distance the light fades out at, 0 to reach everywhere
+   float range;
+   vec3 specularColor;
+};
+
+// any number of lights in a storage buffer, or when the driver
+// has no storage buffers, the first few as uniforms
+#if defined(GL_ARB_shader_storage_buffer_object)
+#define LIGHT_CLUSTERS
+layout (std430) readonly buffer LightBuffer {
+   int lightCount;
+   LightSource lights[];
+};
+
+// the lights reaching each cluster of the view frustum, with
+// the clusters numbered across, then down, then in depth
+layout (std430) readonly buffer LightClusterBuffer {
+   // clusters across, down and deep, and the count of lights with no range
+   uvec4 clusterGrid;
+   // near and far depth, and the scale and bias from log depth to slice
+   vec4 clusterDepth;
+   // size of a cluster on screen in pixels
+   vec4 clusterTile;
+   // offset and count of each cluster, the lights with no range, then the cluster lights
+   uint clusterLights[];
+};
+#else
+#define MAX_UNIFORM_LIGHTS 4
+uniform int lightCount = 0;
+uniform LightSource lights[MAX_UNIFORM_LIGHTS];
+#endif
+
+// values of each draw of a multi-draw-indirect call, as in
+// the vertex shader, which decides whether they are used
+#if defined(GL_ARB_shader_storage_buffer_object)
+#define INDIRECT_DRAWS
+struct DrawData {
+   mat4 model;
+   mat4 normalMatrix;
+   vec4 color;
+   vec4 textureRect;
+   vec4 ambientColor;
+   vec4 diffuseColor;
+   vec4 specularColor;
+   vec2 UVscale;
+   int textureLayer;
+   int bUseTexture;
+};
+
+layout (std430) readonly buffer DrawDataBuffer {
+   DrawData draws[];
+};
+#endif
+
+// camera values of the frame, shared by every program
+layout (std140) uniform FrameData {
+   mat4 view;
+   mat4 projection;
+   mat4 viewProjection;
+   vec4 viewPosition;
+};
+
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+// object color and texture layer, from the uniforms or the instance
+in vec4 fragmentObjectColor;
+flat in int fragmentTextureLayer;
+// draw values to use in place of the uniforms, or -1
+flat in int fragmentDrawIndex;
+
+out vec4 outFragmentColor;
+
+uniform bool bUseTexture = false;
+uniform bool bUseLighting = false;
+uniform sampler2D objectTexture;
+uniform vec2 UVscale = vec2(1.0f, 1.0f);
+uniform Material material;
+
+// packed textures - a layer of a texture array, optionally
+// an atlas rectangle (offset.xy, size.zw) within that layer
+uniform bool bUseTextureArray = false;
+uniform sampler2DArray objectTextureArray;
+uniform vec4 textureRect = vec4(0.0f, 0.0f, 1.0f, 1.0f);
+// loop over the lights of the cluster rather than every light
+uniform bool bUseLightClusters = false;
+
+// function prototypes
+vec3 CalcLightSource(LightSource light, Material objectMaterial, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection);
+vec4 SampleObjectTexture(vec2 objectUVscale, vec4 objectTextureRect);
+#ifdef LIGHT_CLUSTERS
+uint FindLightCluster();
+#endif
+
+void main()
+{
+   Material objectMaterial = material;
+   bool bObjectUseTexture = bUseTexture;
+   vec2 objectUVscale = UVscale;
+   vec4 objectTextureRect = textureRect;
+#ifdef INDIRECT_DRAWS
+   if (fragmentDrawIndex >= 0)
+   {
+      objectMaterial.ambientColor = draws[fragmentDrawIndex].ambientColor.rgb;
+      objectMaterial.ambientStrength = draws[fragmentDrawIndex].ambientColor.w;
+      objectMaterial.diffuseColor = draws[fragmentDrawIndex].diffuseColor.rgb;
+      objectMaterial.specularColor = draws[fragmentDrawIndex].specularColor.rgb;
+      objectMaterial.shininess = draws[fragmentDrawIndex].specularColor.w;
+      bObjectUseTexture = (draws[fragmentDrawIndex].bUseTexture != 0);
+      objectUVscale = draws[fragmentDrawIndex].UVscale;
+      objectTextureRect = draws[fragmentDrawIndex].textureRect;
+   }
+#endif
+
+   if (bUseLighting == true)
+   {
+      // properties
+      vec3 lightNormal = normalize(fragmentVertexNormal);
+      vec3 viewDirection = normalize(viewPosition.xyz - fragmentPosition);
+      vec3 phongResult = vec3(0.0f);
+
+#ifdef LIGHT_CLUSTERS
+      if (bUseLightClusters == true)
+      {
+         uint firstGlobalLight = 2u * clusterGrid.x * clusterGrid.y * clusterGrid.z;
+         for (uint i = 0u; i < clusterGrid.w; i++)
+         {
+            phongResult += CalcLightSource(lights[clusterLights[firstGlobalLight + i]], objectMaterial, lightNormal, fragmentPosition, viewDirection);
+         }
+
+         uint cluster = FindLightCluster();
+         uint firstLight = clusterLights[2u * cluster];
+         uint clusterLightCount = clusterLights[2u * cluster + 1u];
+         for (uint i = 0u; i < clusterLightCount; i++)
+         {
+            phongResult += CalcLightSource(lights[clusterLights[firstLight + i]], objectMaterial, lightNormal, fragmentPosition, viewDirection);
+         }
+      }
+      else
+#endif
+      {
+         for (int i = 0; i < lightCount; i++)
+         {
+            phongResult += CalcLightSource(lights[i], objectMaterial, lightNormal, fragmentPosition, viewDirection);
+         }
+      }
+
+      if (bObjectUseTexture == true)
+      {
+         vec4 textureColor = SampleObjectTexture(objectUVscale, objectTextureRect);
+         outFragmentColor = vec4(phongResult * textureColor.xyz, 1.0f);
+      }
+      else
+      {
+         outFragmentColor = vec4(phongResult * fragmentObjectColor.xyz, fragmentObjectColor.w);
+      }
+   }
+   else
+   {
+      if (bObjectUseTexture == true)
+      {
+         outFragmentColor = SampleObjectTexture(objectUVscale, objectTextureRect);
+      }
+      else
+      {
+         outFragmentColor = fragmentObjectColor;
+      }
+   }
+}
+
+// samples the object texture, which is either a plain 2D
+// texture or an entry in a packed texture array
+vec4 SampleObjectTexture(vec2 objectUVscale, vec4 objectTextureRect)
+{
+   vec2 textureCoordinate = fragmentTextureCoordinate * objectUVscale;
+
+   if (bUseTextureArray == false)
+   {
+      return texture(objectTexture, textureCoordinate);
+   }
+
+   // wrap within the atlas rectangle, using the derivatives of
+   // the unwrapped coordinate so the seams keep the right mip
+   vec2 atlasCoordinate = objectTextureRect.xy + fract(textureCoordinate) * objectTextureRect.zw;
+   return textureGrad(objectTextureArray,
+      vec3(atlasCoordinate, float(fragmentTextureLayer)),
+      dFdx(textureCoordinate) * objectTextureRect.zw,
+      dFdy(textureCoordinate) * objectTextureRect.zw);
+}
+
+// calculates the color contributed by one light source
+vec3 CalcLightSource(LightSource light, Material objectMaterial, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection)
+{
+   vec3 ambient;
+   vec3 diffuse;
+   vec3 specular;
+
+   // ambient lighting
+   ambient = light.ambientColor * objectMaterial.ambientColor * objectMaterial.ambientStrength;
+
+   // diffuse lighting
+   vec3 lightDirection = normalize(light.position - vertexPosition);
+   float impact = max(dot(lightNormal, lightDirection), 0.0f);
+   diffuse = impact * light.diffuseColor * objectMaterial.diffuseColor;
+
+   // specular lighting
+   vec3 reflectDirection = reflect(-lightDirection, lightNormal);
+   float specularComponent = pow(max(dot(viewDirection, reflectDirection), 0.0f), light.focalStrength);
+   specular = light.specularIntensity * specularComponent * light.specularColor * objectMaterial.specularColor;
+
+   // a light with a range fades out to nothing at it, so the
+   // clusters it was not binned into miss none of its light
+   float attenuation = 1.0f;
+   if (light.range > 0.0f)
+   {
+      float distanceRatio = length(light.position - vertexPosition) / light.range;
+      attenuation = clamp(1.0f - pow(distanceRatio, 4.0f), 0.0f, 1.0f);
+      attenuation *= attenuation;
+   }
+
+   return (ambient + diffuse + specular) * attenuation;
+}
+
+#ifdef LIGHT_CLUSTERS
+// finds the cluster the fragment falls in, from its place on
+// the screen and the log of its depth
+uint FindLightCluster()
+{
+   float viewDepth = -(view * vec4(fragmentPosition, 1.0f)).z;
+   ivec2 tile = clamp(ivec2(gl_FragCoord.xy / clusterTile.xy), ivec2(0), ivec2(clusterGrid.xy) - 1);
+   int slice = int(floor(log(max(viewDepth, clusterDepth.x)) * clusterDepth.z + clusterDepth.w));
+   slice = clamp(slice, 0, int(clusterGrid.z) - 1);
+
+   return uint(tile.x) + clusterGrid.x * (uint(tile.y) + clusterGrid.y * uint(slice));
+}
+#endif
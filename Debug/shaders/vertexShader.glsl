@@ -0,0 +1,97 @@
+#version 330 core
+#extension GL_ARB_shader_storage_buffer_object : enable
+#extension GL_ARB_shader_draw_parameters : enable
+
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+
+// per instance values of an instanced draw, used in place of
+// the matching uniforms when bUseInstancing is set
+layout (location = 3) in mat4 inInstanceModel;
+layout (location = 7) in mat3 inInstanceNormalMatrix;
+layout (location = 10) in vec4 inInstanceColor;
+layout (location = 11) in float inInstanceTextureLayer;
+
+// values of each draw of a multi-draw-indirect call, found
+// with gl_DrawID when the driver has the extensions for it
+#if defined(GL_ARB_shader_storage_buffer_object) && defined(GL_ARB_shader_draw_parameters)
+#define INDIRECT_DRAWS
+struct DrawData {
+   mat4 model;
+   mat4 normalMatrix;
+   vec4 color;
+   vec4 textureRect;
+   vec4 ambientColor;
+   vec4 diffuseColor;
+   vec4 specularColor;
+   vec2 UVscale;
+   int textureLayer;
+   int bUseTexture;
+};
+
+layout (std430) readonly buffer DrawDataBuffer {
+   DrawData draws[];
+};
+#endif
+
+// camera values of the frame, shared by every program
+layout (std140) uniform FrameData {
+   mat4 view;
+   mat4 projection;
+   mat4 viewProjection;
+   vec4 viewPosition;
+};
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+out vec4 fragmentObjectColor;
+flat out int fragmentTextureLayer;
+// draw values the fragment shader reads, -1 for the uniforms
+flat out int fragmentDrawIndex;
+
+uniform mat4 model;
+// inverse transpose of the model matrix, worked out once per object
+uniform mat4 normalMatrix;
+uniform vec4 objectColor = vec4(1.0f);
+// layer of the packed texture array holding the object texture
+uniform int textureLayer = 0;
+uniform bool bUseInstancing = false;
+uniform bool bUseIndirectDraws = false;
+// draw values of the first draw of the indirect call
+uniform int firstDrawData = 0;
+
+void main()
+{
+   mat4 objectModel = model;
+   mat3 objectNormalMatrix = mat3(normalMatrix);
+   fragmentObjectColor = objectColor;
+   fragmentTextureLayer = textureLayer;
+   fragmentDrawIndex = -1;
+   if (bUseInstancing == true)
+   {
+      objectModel = inInstanceModel;
+      objectNormalMatrix = inInstanceNormalMatrix;
+      fragmentObjectColor = inInstanceColor;
+      fragmentTextureLayer = int(inInstanceTextureLayer);
+   }
+#ifdef INDIRECT_DRAWS
+   if (bUseIndirectDraws == true)
+   {
+      fragmentDrawIndex = firstDrawData + gl_DrawIDARB;
+      objectModel = draws[fragmentDrawIndex].model;
+      objectNormalMatrix = mat3(draws[fragmentDrawIndex].normalMatrix);
+      fragmentObjectColor = draws[fragmentDrawIndex].color;
+      fragmentTextureLayer = draws[fragmentDrawIndex].textureLayer;
+   }
+#endif
+
+   // transform the vertex into clip space
+   gl_Position = viewProjection * objectModel * vec4(inVertexPosition, 1.0f);
+
+   // lighting is calculated in world space
+   fragmentPosition = vec3(objectModel * vec4(inVertexPosition, 1.0f));
+   fragmentVertexNormal = objectNormalMatrix * inVertexNormal;
+   fragmentTextureCoordinate = inTextureCoordinate;
+}
@@ -0,0 +1,346 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetpack.cpp
+// ============
+// map a single file pack of textures, meshes and shaders
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AssetPack.h"
+#include "TextureCompressor.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+/***********************************************************
+ *  AssetPack()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+AssetPack::AssetPack()
+{
+	m_pEntries = NULL;
+	m_entryCount = 0;
+}
+
+/***********************************************************
+ *  ~AssetPack()
+ *
+ *  The destructor for the class.  Any pointers handed out
+ *  into the pack become invalid.
+ ***********************************************************/
+AssetPack::~AssetPack()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping the passed in pack and
+ *  checking its header and index.  Every entry must lie
+ *  within the file, so the assets can be handed out without
+ *  further checks.
+ ***********************************************************/
+bool AssetPack::Open(const std::string& filename)
+{
+	Close();
+
+	if (m_mappedFile.Open(filename) == false)
+	{
+		return(false);
+	}
+
+	const unsigned char* pData = m_mappedFile.GetData();
+	size_t dataSize = m_mappedFile.GetSize();
+	PACK_HEADER header;
+
+	bool bValid = (dataSize >= sizeof(header));
+	if (bValid == true)
+	{
+		memcpy(&header, pData, sizeof(header));
+		bValid = ((memcmp(header.magic, "APAK", 4) == 0) && (header.version == PACK_VERSION) &&
+			(header.indexOffset <= dataSize) &&
+			(header.entryCount <= (dataSize - header.indexOffset) / sizeof(PACK_ENTRY)) &&
+			(header.indexOffset % 8 == 0));
+	}
+
+	if (bValid == true)
+	{
+		m_pEntries = (const PACK_ENTRY*)(pData + header.indexOffset);
+		m_entryCount = (int)header.entryCount;
+		for (int i = 0; (i < m_entryCount) && (bValid == true); i++)
+		{
+			const PACK_ENTRY& entry = m_pEntries[i];
+			bValid = ((entry.offset <= dataSize) && (entry.size <= dataSize - entry.offset) &&
+				(memchr(entry.name, 0, MAX_NAME_LENGTH) != NULL));
+			if (bValid == true)
+			{
+				m_entryIndices[GetEntryKey(entry.type, entry.name)] = i;
+			}
+		}
+	}
+
+	if (bValid == false)
+	{
+		std::cout << "Could not use asset pack:" << filename << std::endl;
+		Close();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the pack.
+ ***********************************************************/
+void AssetPack::Close()
+{
+	m_entryIndices.clear();
+	m_pEntries = NULL;
+	m_entryCount = 0;
+	m_mappedFile.Close();
+}
+
+/***********************************************************
+ *  IsOpen()
+ *
+ *  This method is used for checking whether a pack is
+ *  mapped.
+ ***********************************************************/
+bool AssetPack::IsOpen() const
+{
+	return(NULL != m_pEntries);
+}
+
+/***********************************************************
+ *  FindEntry()
+ *
+ *  This method is used for finding the index entry of an
+ *  asset by its type and name.
+ ***********************************************************/
+const AssetPack::PACK_ENTRY* AssetPack::FindEntry(ASSET_TYPE type, const std::string& name) const
+{
+	std::unordered_map<std::string, int>::const_iterator found = m_entryIndices.find(GetEntryKey(type, name));
+
+	if (found == m_entryIndices.end())
+	{
+		return(NULL);
+	}
+
+	return(&m_pEntries[found->second]);
+}
+
+/***********************************************************
+ *  GetTexture()
+ *
+ *  This method is used for getting the mip chain of a packed
+ *  texture.  The levels point into the pack, which must stay
+ *  open until they are uploaded.  FreeImage() can be called
+ *  on the image, as the image owns nothing.
+ ***********************************************************/
+bool AssetPack::GetTexture(const std::string& name, TextureDecodePool::DECODED_IMAGE& image) const
+{
+	const PACK_ENTRY* pEntry = FindEntry(ASSET_TEXTURE, name);
+	if (NULL == pEntry)
+	{
+		return(false);
+	}
+
+	int width = pEntry->params[0];
+	int height = pEntry->params[1];
+	int colorChannels = pEntry->params[2];
+	int blockFormat = pEntry->params[3];
+	int levelCount = pEntry->params[4];
+	if ((width <= 0) || (height <= 0) || (levelCount <= 0) || (levelCount > 32))
+	{
+		return(false);
+	}
+
+	const unsigned char* pLevel = m_mappedFile.GetData() + pEntry->offset;
+	size_t remaining = (size_t)pEntry->size;
+	std::vector<TextureDecodePool::MIP_LEVEL> mipLevels;
+	int levelWidth = width;
+	int levelHeight = height;
+	for (int level = 0; level < levelCount; level++)
+	{
+		TextureDecodePool::MIP_LEVEL mipLevel;
+		mipLevel.width = levelWidth;
+		mipLevel.height = levelHeight;
+		mipLevel.size = (blockFormat != 0) ?
+			TextureCompressor::GetCompressedSize((TextureCompressor::BLOCK_FORMAT)blockFormat, levelWidth, levelHeight) :
+			(size_t)levelWidth * levelHeight * colorChannels;
+		mipLevel.pixels = pLevel;
+		if (mipLevel.size > remaining)
+		{
+			return(false);
+		}
+		mipLevels.push_back(mipLevel);
+
+		pLevel += mipLevel.size;
+		remaining -= mipLevel.size;
+		levelWidth = (levelWidth > 1) ? levelWidth / 2 : 1;
+		levelHeight = (levelHeight > 1) ? levelHeight / 2 : 1;
+	}
+
+	TextureDecodePool::ResetImage(image);
+	image.filename = name;
+	image.width = width;
+	image.height = height;
+	image.colorChannels = colorChannels;
+	image.mipLevels = mipLevels;
+	image.blockFormat = blockFormat;
+	image.compressionPSNR = pEntry->params[5] / 100.0f;
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetMesh()
+ *
+ *  This method is used for getting the interleaved vertex
+ *  data and the triangle indices of a packed mesh.
+ ***********************************************************/
+bool AssetPack::GetMesh(const std::string& name, MESH_DATA& mesh) const
+{
+	const PACK_ENTRY* pEntry = FindEntry(ASSET_MESH, name);
+	if (NULL == pEntry)
+	{
+		return(false);
+	}
+
+	mesh.vertexCount = pEntry->params[0];
+	mesh.indexCount = pEntry->params[1];
+	mesh.floatsPerVertex = pEntry->params[2];
+
+	size_t vertexBytes = (size_t)mesh.vertexCount * mesh.floatsPerVertex * sizeof(float);
+	size_t indexBytes = (size_t)mesh.indexCount * sizeof(uint32_t);
+	if ((mesh.vertexCount <= 0) || (mesh.indexCount < 0) || (mesh.floatsPerVertex <= 0) ||
+		(vertexBytes + indexBytes != pEntry->size))
+	{
+		return(false);
+	}
+
+	// payloads are aligned in the pack, so the floats are read in place
+	const unsigned char* pData = m_mappedFile.GetData() + pEntry->offset;
+	mesh.vertices = (const float*)pData;
+	mesh.indices = (const uint32_t*)(pData + vertexBytes);
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetShaderSource()
+ *
+ *  This method is used for getting the source text of a
+ *  packed shader.  The text is not zero terminated, so its
+ *  length must be passed along to glShaderSource().
+ ***********************************************************/
+bool AssetPack::GetShaderSource(const std::string& name, const char*& source, int& length) const
+{
+	const PACK_ENTRY* pEntry = FindEntry(ASSET_SHADER, name);
+	if (NULL == pEntry)
+	{
+		return(false);
+	}
+
+	source = (const char*)(m_mappedFile.GetData() + pEntry->offset);
+	length = (int)pEntry->size;
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetEntryCount()
+ *
+ *  This method is used for getting the number of assets in
+ *  the pack.
+ ***********************************************************/
+int AssetPack::GetEntryCount() const
+{
+	return(m_entryCount);
+}
+
+/***********************************************************
+ *  GetSize()
+ *
+ *  This method is used for getting the size of the mapped
+ *  pack in bytes.
+ ***********************************************************/
+size_t AssetPack::GetSize() const
+{
+	return(m_mappedFile.GetSize());
+}
+
+/***********************************************************
+ *  FindPackFile()
+ *
+ *  This method is used for finding the passed in pack.  The
+ *  folder of the executable is looked in first, so the pack
+ *  is found whatever the working folder is, and then the
+ *  working folder.  An empty string is returned when there
+ *  is no pack.
+ ***********************************************************/
+std::string AssetPack::FindPackFile(const std::string& packName)
+{
+	std::string executablePath;
+#ifdef _WIN32
+	char modulePath[MAX_PATH];
+	DWORD length = GetModuleFileNameA(NULL, modulePath, MAX_PATH);
+	if ((length > 0) && (length < MAX_PATH))
+	{
+		executablePath.assign(modulePath, length);
+	}
+#else
+	char modulePath[4096];
+	ssize_t length = readlink("/proc/self/exe", modulePath, sizeof(modulePath) - 1);
+	if (length > 0)
+	{
+		executablePath.assign(modulePath, (size_t)length);
+	}
+#endif
+
+	std::string::size_type separator = executablePath.find_last_of("/\\");
+	if (separator != std::string::npos)
+	{
+		std::string packPath = executablePath.substr(0, separator + 1) + packName;
+		if (std::ifstream(packPath.c_str(), std::ios::binary).is_open() == true)
+		{
+			return(packPath);
+		}
+	}
+
+	if (std::ifstream(packName.c_str(), std::ios::binary).is_open() == true)
+	{
+		return(packName);
+	}
+
+	return(std::string());
+}
+
+/***********************************************************
+ *  GetEntryKey()
+ *
+ *  This method is used for getting the lookup key of an
+ *  asset, so assets of different types can share a name.
+ ***********************************************************/
+std::string AssetPack::GetEntryKey(uint32_t type, const std::string& name)
+{
+	return(std::to_string(type) + ":" + name);
+}
@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetpack.h
+// ============
+// map a single file pack of textures, meshes and shaders
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MappedFile.h"
+#include "TextureDecodePool.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+/***********************************************************
+ *  AssetPack
+ *
+ *  This class maps an asset pack written by AssetPackBuilder
+ *  once, and hands out its assets as pointers into the
+ *  mapping, so nothing is copied or decoded before it is
+ *  handed to OpenGL.  A pack holds the mip chains of decoded
+ *  or block compressed textures, the vertex and index data
+ *  of the baked scene meshes, and shader sources.
+ ***********************************************************/
+class AssetPack
+{
+public:
+	// constructor
+	AssetPack();
+	// destructor
+	~AssetPack();
+
+	enum ASSET_TYPE
+	{
+		ASSET_TEXTURE = 1,
+		ASSET_MESH = 2,
+		ASSET_SHADER = 3
+	};
+
+	// format version written in the pack header
+	static const uint32_t PACK_VERSION = 1;
+	// longest asset name, including the terminating zero
+	static const int MAX_NAME_LENGTH = 64;
+
+	// header at the start of the pack
+	struct PACK_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t reserved;
+		// offset of the index, written after every payload
+		uint64_t indexOffset;
+	};
+
+	// index entry of one asset
+	struct PACK_ENTRY
+	{
+		char name[MAX_NAME_LENGTH];
+		uint32_t type;
+		// textures: width, height, channels, block format, levels, PSNR in 1/100 dB
+		// meshes: vertex count, index count, floats per vertex
+		int32_t params[6];
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	struct MESH_DATA
+	{
+		const float* vertices;
+		int vertexCount;
+		int floatsPerVertex;
+		const uint32_t* indices;
+		int indexCount;
+	};
+
+	// map the pack and read its index
+	bool Open(const std::string& filename);
+	// unmap the pack
+	void Close();
+	bool IsOpen() const;
+
+	// find an asset by type and name, NULL when it is not packed
+	const PACK_ENTRY* FindEntry(ASSET_TYPE type, const std::string& name) const;
+	// get the mip chain of a texture, pointing into the pack
+	bool GetTexture(const std::string& name, TextureDecodePool::DECODED_IMAGE& image) const;
+	// get the vertex and index data of a mesh, pointing into the pack
+	bool GetMesh(const std::string& name, MESH_DATA& mesh) const;
+	// get the source text of a shader, pointing into the pack
+	bool GetShaderSource(const std::string& name, const char*& source, int& length) const;
+
+	// number of assets in the pack
+	int GetEntryCount() const;
+	// size of the mapped pack in bytes
+	size_t GetSize() const;
+
+	// find a pack next to the executable, or else in the working folder
+	static std::string FindPackFile(const std::string& packName);
+
+private:
+	MappedFile m_mappedFile;
+	const PACK_ENTRY* m_pEntries;
+	int m_entryCount;
+	// index into m_pEntries of each asset, keyed by type and name
+	std::unordered_map<std::string, int> m_entryIndices;
+
+	// key used to look up an asset
+	static std::string GetEntryKey(uint32_t type, const std::string& name);
+
+	// packs own a file mapping, so they are not copied
+	AssetPack(const AssetPack&);
+	AssetPack& operator=(const AssetPack&);
+};
@@ -0,0 +1,295 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetpackbuilder.cpp
+// ============
+// write textures, meshes and shaders into a single file pack
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AssetPackBuilder.h"
+
+#include <cstdio>
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	// payloads start on 16 byte boundaries so vertex data can be read in place
+	const uint64_t g_PayloadAlignment = 16;
+}
+
+/***********************************************************
+ *  AssetPackBuilder()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+AssetPackBuilder::AssetPackBuilder()
+{
+	m_offset = 0;
+}
+
+/***********************************************************
+ *  ~AssetPackBuilder()
+ *
+ *  The destructor for the class.  A pack that was begun but
+ *  never finished is removed.
+ ***********************************************************/
+AssetPackBuilder::~AssetPackBuilder()
+{
+	if (m_file.is_open() == true)
+	{
+		m_file.close();
+		std::remove(m_tempFilename.c_str());
+	}
+}
+
+/***********************************************************
+ *  Begin()
+ *
+ *  This method is used for starting a new pack.  The header
+ *  is written now and rewritten by Finish() once the index
+ *  offset is known.
+ ***********************************************************/
+bool AssetPackBuilder::Begin(const std::string& packFilename)
+{
+	if (m_file.is_open() == true)
+	{
+		return(false);
+	}
+
+	m_packFilename = packFilename;
+	m_tempFilename = packFilename + ".tmp";
+	m_entries.clear();
+	m_offset = 0;
+
+	m_file.open(m_tempFilename.c_str(), std::ios::binary | std::ios::trunc);
+	if (!m_file)
+	{
+		return(false);
+	}
+
+	AssetPack::PACK_HEADER header;
+	memset(&header, 0, sizeof(header));
+	WriteData(&header, sizeof(header));
+
+	return(true);
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for adding every level of the mip
+ *  chain of a decoded or block compressed image.  Images
+ *  without a mip chain, as from a plain stbi_load(), are
+ *  turned down, since the pack is meant to skip the mipmap
+ *  generation as well as the decode.
+ ***********************************************************/
+bool AssetPackBuilder::AddTexture(const std::string& name, const TextureDecodePool::DECODED_IMAGE& image)
+{
+	if ((image.mipLevels.empty() == true) || (BeginEntry(AssetPack::ASSET_TEXTURE, name) == false))
+	{
+		return(false);
+	}
+
+	AssetPack::PACK_ENTRY& entry = m_entries.back();
+	entry.params[0] = image.width;
+	entry.params[1] = image.height;
+	entry.params[2] = image.colorChannels;
+	entry.params[3] = image.blockFormat;
+	entry.params[4] = (int32_t)image.mipLevels.size();
+	entry.params[5] = (int32_t)(image.compressionPSNR * 100.0f);
+
+	for (size_t level = 0; level < image.mipLevels.size(); level++)
+	{
+		WriteData(image.mipLevels[level].pixels, image.mipLevels[level].size);
+	}
+
+	return(m_file.good());
+}
+
+/***********************************************************
+ *  AddMesh()
+ *
+ *  This method is used for adding the interleaved vertex
+ *  data of a mesh followed by its triangle indices.
+ ***********************************************************/
+bool AssetPackBuilder::AddMesh(const std::string& name, const std::vector<float>& vertices,
+	int floatsPerVertex, const std::vector<uint32_t>& indices)
+{
+	if ((floatsPerVertex <= 0) || (vertices.empty() == true) ||
+		(vertices.size() % floatsPerVertex != 0) || (BeginEntry(AssetPack::ASSET_MESH, name) == false))
+	{
+		return(false);
+	}
+
+	AssetPack::PACK_ENTRY& entry = m_entries.back();
+	entry.params[0] = (int32_t)(vertices.size() / floatsPerVertex);
+	entry.params[1] = (int32_t)indices.size();
+	entry.params[2] = floatsPerVertex;
+
+	WriteData(&vertices[0], vertices.size() * sizeof(float));
+	if (indices.empty() == false)
+	{
+		WriteData(&indices[0], indices.size() * sizeof(uint32_t));
+	}
+
+	return(m_file.good());
+}
+
+/***********************************************************
+ *  AddShader()
+ *
+ *  This method is used for adding the source text of a
+ *  shader, as read from its file.
+ ***********************************************************/
+bool AssetPackBuilder::AddShader(const std::string& name, const unsigned char* source, size_t length)
+{
+	if ((NULL == source) || (length == 0) || (BeginEntry(AssetPack::ASSET_SHADER, name) == false))
+	{
+		return(false);
+	}
+
+	WriteData(source, length);
+
+	return(m_file.good());
+}
+
+/***********************************************************
+ *  Finish()
+ *
+ *  This method is used for writing the index after the last
+ *  payload, filling in the header, and moving the finished
+ *  pack into place.
+ ***********************************************************/
+bool AssetPackBuilder::Finish()
+{
+	if (m_file.is_open() == false)
+	{
+		return(false);
+	}
+
+	WritePadding(8);
+	uint64_t indexOffset = m_offset;
+	if (m_entries.empty() == false)
+	{
+		m_file.write((const char*)&m_entries[0], (std::streamsize)(m_entries.size() * sizeof(AssetPack::PACK_ENTRY)));
+		m_offset += m_entries.size() * sizeof(AssetPack::PACK_ENTRY);
+	}
+
+	AssetPack::PACK_HEADER header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "APAK", 4);
+	header.version = AssetPack::PACK_VERSION;
+	header.entryCount = (uint32_t)m_entries.size();
+	header.indexOffset = indexOffset;
+	m_file.seekp(0, std::ios::beg);
+	m_file.write((const char*)&header, sizeof(header));
+
+	m_file.close();
+	if (!m_file)
+	{
+		std::remove(m_tempFilename.c_str());
+		return(false);
+	}
+
+	// rename does not replace an existing file on Windows
+	std::remove(m_packFilename.c_str());
+	if (std::rename(m_tempFilename.c_str(), m_packFilename.c_str()) != 0)
+	{
+		std::remove(m_tempFilename.c_str());
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetEntryCount()
+ *
+ *  This method is used for getting the number of assets
+ *  added to the pack so far.
+ ***********************************************************/
+int AssetPackBuilder::GetEntryCount() const
+{
+	return((int)m_entries.size());
+}
+
+/***********************************************************
+ *  GetWrittenBytes()
+ *
+ *  This method is used for getting the number of bytes
+ *  written to the pack so far.
+ ***********************************************************/
+uint64_t AssetPackBuilder::GetWrittenBytes() const
+{
+	return(m_offset);
+}
+
+/***********************************************************
+ *  BeginEntry()
+ *
+ *  This method is used for padding the file to the payload
+ *  alignment and adding an index entry for the next payload.
+ *  Names must be unique within a type and fit the index.
+ ***********************************************************/
+bool AssetPackBuilder::BeginEntry(AssetPack::ASSET_TYPE type, const std::string& name)
+{
+	if ((m_file.is_open() == false) || (name.empty() == true) ||
+		(name.size() >= (size_t)AssetPack::MAX_NAME_LENGTH))
+	{
+		return(false);
+	}
+
+	for (size_t i = 0; i < m_entries.size(); i++)
+	{
+		if ((m_entries[i].type == (uint32_t)type) && (name.compare(m_entries[i].name) == 0))
+		{
+			return(false);
+		}
+	}
+
+	WritePadding(g_PayloadAlignment);
+
+	AssetPack::PACK_ENTRY entry;
+	memset(&entry, 0, sizeof(entry));
+	memcpy(entry.name, name.c_str(), name.size());
+	entry.type = (uint32_t)type;
+	entry.offset = m_offset;
+	entry.size = 0;
+	m_entries.push_back(entry);
+
+	return(true);
+}
+
+/***********************************************************
+ *  WriteData()
+ *
+ *  This method is used for appending bytes to the file and
+ *  to the payload of the last index entry.
+ ***********************************************************/
+void AssetPackBuilder::WriteData(const void* pData, size_t size)
+{
+	m_file.write((const char*)pData, (std::streamsize)size);
+	m_offset += size;
+
+	if (m_entries.empty() == false)
+	{
+		m_entries.back().size = m_offset - m_entries.back().offset;
+	}
+}
+
+/***********************************************************
+ *  WritePadding()
+ *
+ *  This method is used for writing zeros up to the next
+ *  multiple of the passed in alignment.
+ ***********************************************************/
+void AssetPackBuilder::WritePadding(uint64_t alignment)
+{
+	const char padding[16] = { 0 };
+	uint64_t paddingSize = (alignment - (m_offset % alignment)) % alignment;
+
+	m_file.write(padding, (std::streamsize)paddingSize);
+	m_offset += paddingSize;
+}
@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetpackbuilder.h
+// ============
+// write textures, meshes and shaders into a single file pack
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AssetPack.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  AssetPackBuilder
+ *
+ *  This class writes the asset pack read by AssetPack.  The
+ *  payloads are written one after another as the assets are
+ *  added, each aligned so it can be used in place once the
+ *  pack is mapped, and the index goes at the end.  The pack
+ *  is written to a temporary file and only replaces an
+ *  existing pack once it is complete.
+ ***********************************************************/
+class AssetPackBuilder
+{
+public:
+	// constructor
+	AssetPackBuilder();
+	// destructor - an unfinished pack is thrown away
+	~AssetPackBuilder();
+
+	// start writing a new pack
+	bool Begin(const std::string& packFilename);
+	// add the whole mip chain of a texture
+	bool AddTexture(const std::string& name, const TextureDecodePool::DECODED_IMAGE& image);
+	// add interleaved vertex data and triangle indices
+	bool AddMesh(const std::string& name, const std::vector<float>& vertices,
+		int floatsPerVertex, const std::vector<uint32_t>& indices);
+	// add the source text of a shader
+	bool AddShader(const std::string& name, const unsigned char* source, size_t length);
+	// write the index and replace any existing pack
+	bool Finish();
+
+	// number of assets added so far
+	int GetEntryCount() const;
+	// bytes written so far
+	uint64_t GetWrittenBytes() const;
+
+private:
+	std::ofstream m_file;
+	std::string m_packFilename;
+	std::string m_tempFilename;
+	std::vector<AssetPack::PACK_ENTRY> m_entries;
+	// offset of the next byte written
+	uint64_t m_offset;
+
+	// pad to the payload alignment and add an index entry
+	bool BeginEntry(AssetPack::ASSET_TYPE type, const std::string& name);
+	// append bytes to the payload of the last entry
+	void WriteData(const void* pData, size_t size);
+	// pad the file to a multiple of the alignment
+	void WritePadding(uint64_t alignment);
+
+	// builders own an open file, so they are not copied
+	AssetPackBuilder(const AssetPackBuilder&);
+	AssetPackBuilder& operator=(const AssetPackBuilder&);
+};
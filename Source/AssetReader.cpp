@@ -0,0 +1,626 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetreader.cpp
+// ============
+// read batches of asset files asynchronously
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AssetReader.h"
+
+#include <cstring>
+#include <fstream>
+
+#ifdef ASSET_READER_IO_URING
+#include <cerrno>
+#include <cstdint>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// declaration of global variables
+namespace
+{
+	// the rings are set up with raw system calls, so no library is needed
+	int IoUringSetup(unsigned entryCount, struct io_uring_params* pParams)
+	{
+		return((int)syscall(__NR_io_uring_setup, entryCount, pParams));
+	}
+
+	int IoUringEnter(int ringFileDescriptor, unsigned submitCount, unsigned minComplete, unsigned flags)
+	{
+		return((int)syscall(__NR_io_uring_enter, ringFileDescriptor, submitCount, minComplete, flags, NULL, 0));
+	}
+}
+#endif
+
+/***********************************************************
+ *  AssetReader()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+AssetReader::AssetReader()
+{
+	m_bSubmitted = false;
+	m_bReaping = false;
+#ifdef ASSET_READER_IO_URING
+	m_ringFileDescriptor = -1;
+	m_pSubmissionRing = NULL;
+	m_submissionRingSize = 0;
+	m_pCompletionRing = NULL;
+	m_completionRingSize = 0;
+	m_pSubmissionEntries = NULL;
+	m_submissionEntriesSize = 0;
+	m_pSubmissionHead = NULL;
+	m_pSubmissionTail = NULL;
+	m_pSubmissionMask = NULL;
+	m_pSubmissionArray = NULL;
+	m_pCompletionHead = NULL;
+	m_pCompletionTail = NULL;
+	m_pCompletionMask = NULL;
+	m_pCompletionEntries = NULL;
+	m_submissionEntryCount = 0;
+	m_completionEntryCount = 0;
+	m_nextSubmit = 0;
+	m_inFlight = 0;
+#endif
+}
+
+/***********************************************************
+ *  ~AssetReader()
+ *
+ *  The destructor for the class.  Reads still in flight are
+ *  waited for, since the kernel writes into their buffers,
+ *  and the buffers of files that were never taken are freed.
+ ***********************************************************/
+AssetReader::~AssetReader()
+{
+#ifdef ASSET_READER_IO_URING
+	// no more of the batch is started
+	m_nextSubmit = m_requests.size();
+	while ((m_inFlight > 0) && (ReapCompletions(true) == true))
+	{
+	}
+	CloseRing();
+#endif
+
+	for (size_t i = 0; i < m_requests.size(); i++)
+	{
+		if (m_requests[i].state != READ_TAKEN)
+		{
+			delete[] m_requests[i].data;
+		}
+#ifdef ASSET_READER_IO_URING
+		if (m_requests[i].fileDescriptor >= 0)
+		{
+			close(m_requests[i].fileDescriptor);
+		}
+#endif
+	}
+}
+
+/***********************************************************
+ *  QueueRead()
+ *
+ *  This method is used for adding a file to the batch read
+ *  by Submit().  Files queued more than once are read once.
+ ***********************************************************/
+void AssetReader::QueueRead(const std::string& filename)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if ((m_bSubmitted == true) || (m_requestIndices.count(filename) != 0))
+	{
+		return;
+	}
+
+	READ_REQUEST request;
+	request.filename = filename;
+	request.data = NULL;
+	request.size = 0;
+	request.fileDescriptor = -1;
+	request.state = READ_QUEUED;
+
+	m_requestIndices[filename] = (int)m_requests.size();
+	m_requests.push_back(request);
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for starting the reads of every
+ *  queued file.  With io_uring the files are opened and
+ *  their reads submitted together with one system call, as
+ *  far as the rings have room, and the rest follow as reads
+ *  complete.  Without it nothing is read until the files are
+ *  taken.
+ ***********************************************************/
+void AssetReader::Submit()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if ((m_bSubmitted == true) || (m_requests.empty() == true))
+	{
+		return;
+	}
+	m_bSubmitted = true;
+
+#ifdef ASSET_READER_IO_URING
+	if (OpenRing((unsigned)m_requests.size()) == true)
+	{
+		m_readVectors.resize(m_requests.size());
+		if (SubmitPending() == false)
+		{
+			CloseRing();
+		}
+	}
+#endif
+}
+
+/***********************************************************
+ *  TakeFile()
+ *
+ *  This method is used for blocking until the passed in
+ *  queued file has been read, and taking its bytes, which
+ *  are freed with FreeBuffer().  Each file can only be taken
+ *  once.  Files that were not read asynchronously, or whose
+ *  read failed, are read here with blocking reads.  While
+ *  one caller waits in the kernel for reads to finish, the
+ *  lock is free for the others to take files that already
+ *  arrived, and they wait for it to collect the rest.
+ ***********************************************************/
+bool AssetReader::TakeFile(const std::string& filename, ASSET_BUFFER& buffer)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	buffer.filename = filename;
+	buffer.data = NULL;
+	buffer.size = 0;
+
+	std::unordered_map<std::string, int>::const_iterator found = m_requestIndices.find(filename);
+	if (found == m_requestIndices.end())
+	{
+		return(false);
+	}
+
+	READ_REQUEST& request = m_requests[found->second];
+
+#ifdef ASSET_READER_IO_URING
+	// finished reads are collected by one waiting thread at a time
+	while (request.state == READ_PENDING)
+	{
+		if (m_bReaping == true)
+		{
+			m_readsCollected.wait(lock);
+			continue;
+		}
+
+		// only the reaping thread touches the rings, so it can
+		// wait in the kernel without holding the lock
+		m_bReaping = true;
+		lock.unlock();
+		bool bWaited = WaitForCompletion();
+		lock.lock();
+		bool bReaped = ((bWaited == true) && (ReapCompletions(false) == true));
+		m_bReaping = false;
+		m_readsCollected.notify_all();
+
+		if (bReaped == false)
+		{
+			return(false);
+		}
+	}
+#endif
+
+	if (request.state == READ_TAKEN)
+	{
+		return(false);
+	}
+
+	if (request.state == READ_DONE)
+	{
+		buffer.data = request.data;
+		buffer.size = request.size;
+		request.data = NULL;
+		request.state = READ_TAKEN;
+		return(true);
+	}
+
+	// the blocking read does not need the lock
+	request.state = READ_TAKEN;
+	lock.unlock();
+
+	return(ReadFile(filename, buffer));
+}
+
+/***********************************************************
+ *  FreeBuffer()
+ *
+ *  This method is used for freeing the bytes of a file that
+ *  was taken from the reader.
+ ***********************************************************/
+void AssetReader::FreeBuffer(ASSET_BUFFER& buffer)
+{
+	delete[] buffer.data;
+	buffer.data = NULL;
+	buffer.size = 0;
+}
+
+/***********************************************************
+ *  ReadFile()
+ *
+ *  This method is used for reading the whole of the passed
+ *  in file into a new buffer with blocking reads.  Empty
+ *  files are treated as errors.
+ ***********************************************************/
+bool AssetReader::ReadFile(const std::string& filename, ASSET_BUFFER& buffer)
+{
+	buffer.filename = filename;
+	buffer.data = NULL;
+	buffer.size = 0;
+
+	std::ifstream file(filename.c_str(), std::ios::binary | std::ios::ate);
+	if (file.is_open() == false)
+	{
+		return(false);
+	}
+
+	std::streamoff fileSize = file.tellg();
+	if (fileSize <= 0)
+	{
+		return(false);
+	}
+	file.seekg(0, std::ios::beg);
+
+	buffer.data = new unsigned char[(size_t)fileSize];
+	buffer.size = (size_t)fileSize;
+	bool bRead = (file.read((char*)buffer.data, fileSize).good() == true);
+
+	if (bRead == false)
+	{
+		FreeBuffer(buffer);
+	}
+
+	return(bRead);
+}
+
+/***********************************************************
+ *  IsAsynchronous()
+ *
+ *  This method is used for checking whether the queued
+ *  files are being read through io_uring.
+ ***********************************************************/
+bool AssetReader::IsAsynchronous() const
+{
+#ifdef ASSET_READER_IO_URING
+	return(m_ringFileDescriptor >= 0);
+#else
+	return(false);
+#endif
+}
+
+/***********************************************************
+ *  GetQueuedCount()
+ *
+ *  This method is used for getting the number of files that
+ *  were queued for reading.
+ ***********************************************************/
+int AssetReader::GetQueuedCount() const
+{
+	return((int)m_requests.size());
+}
+
+#ifdef ASSET_READER_IO_URING
+/***********************************************************
+ *  OpenRing()
+ *
+ *  This method is used for creating an io_uring instance
+ *  and mapping its rings.  It fails on kernels before 5.1,
+ *  and where io_uring is turned off or filtered out, such
+ *  as in many containers, so the reads fall back to
+ *  blocking reads.
+ ***********************************************************/
+bool AssetReader::OpenRing(unsigned entryCount)
+{
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+#ifdef IORING_SETUP_CLAMP
+	params.flags = IORING_SETUP_CLAMP;
+#endif
+
+	m_ringFileDescriptor = IoUringSetup(entryCount, &params);
+	if (m_ringFileDescriptor < 0)
+	{
+		m_ringFileDescriptor = -1;
+		return(false);
+	}
+
+	m_submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	m_completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	m_submissionEntriesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+
+	bool bSingleMap = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+	bSingleMap = ((params.features & IORING_FEAT_SINGLE_MMAP) != 0);
+#endif
+	if (bSingleMap == true)
+	{
+		// both rings live in one mapping on newer kernels
+		if (m_completionRingSize > m_submissionRingSize)
+		{
+			m_submissionRingSize = m_completionRingSize;
+		}
+		m_completionRingSize = m_submissionRingSize;
+	}
+
+	m_pSubmissionRing = mmap(NULL, m_submissionRingSize, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, m_ringFileDescriptor, IORING_OFF_SQ_RING);
+	if (m_pSubmissionRing == MAP_FAILED)
+	{
+		m_pSubmissionRing = NULL;
+		CloseRing();
+		return(false);
+	}
+
+	if (bSingleMap == true)
+	{
+		m_pCompletionRing = m_pSubmissionRing;
+	}
+	else
+	{
+		m_pCompletionRing = mmap(NULL, m_completionRingSize, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, m_ringFileDescriptor, IORING_OFF_CQ_RING);
+		if (m_pCompletionRing == MAP_FAILED)
+		{
+			m_pCompletionRing = NULL;
+			CloseRing();
+			return(false);
+		}
+	}
+
+	m_pSubmissionEntries = mmap(NULL, m_submissionEntriesSize, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, m_ringFileDescriptor, IORING_OFF_SQES);
+	if (m_pSubmissionEntries == MAP_FAILED)
+	{
+		m_pSubmissionEntries = NULL;
+		CloseRing();
+		return(false);
+	}
+
+	unsigned char* pSubmissionRing = (unsigned char*)m_pSubmissionRing;
+	unsigned char* pCompletionRing = (unsigned char*)m_pCompletionRing;
+	m_pSubmissionHead = (unsigned*)(pSubmissionRing + params.sq_off.head);
+	m_pSubmissionTail = (unsigned*)(pSubmissionRing + params.sq_off.tail);
+	m_pSubmissionMask = (unsigned*)(pSubmissionRing + params.sq_off.ring_mask);
+	m_pSubmissionArray = (unsigned*)(pSubmissionRing + params.sq_off.array);
+	m_pCompletionHead = (unsigned*)(pCompletionRing + params.cq_off.head);
+	m_pCompletionTail = (unsigned*)(pCompletionRing + params.cq_off.tail);
+	m_pCompletionMask = (unsigned*)(pCompletionRing + params.cq_off.ring_mask);
+	m_pCompletionEntries = pCompletionRing + params.cq_off.cqes;
+	m_submissionEntryCount = params.sq_entries;
+	m_completionEntryCount = params.cq_entries;
+
+	return(true);
+}
+
+/***********************************************************
+ *  CloseRing()
+ *
+ *  This method is used for unmapping the rings and closing
+ *  the io_uring instance.  Requests that were never
+ *  submitted go back to being read with blocking reads.
+ ***********************************************************/
+void AssetReader::CloseRing()
+{
+	if (NULL != m_pSubmissionEntries)
+	{
+		munmap(m_pSubmissionEntries, m_submissionEntriesSize);
+		m_pSubmissionEntries = NULL;
+	}
+	if ((NULL != m_pCompletionRing) && (m_pCompletionRing != m_pSubmissionRing))
+	{
+		munmap(m_pCompletionRing, m_completionRingSize);
+	}
+	m_pCompletionRing = NULL;
+	if (NULL != m_pSubmissionRing)
+	{
+		munmap(m_pSubmissionRing, m_submissionRingSize);
+		m_pSubmissionRing = NULL;
+	}
+	if (m_ringFileDescriptor >= 0)
+	{
+		close(m_ringFileDescriptor);
+		m_ringFileDescriptor = -1;
+	}
+}
+
+/***********************************************************
+ *  SubmitPending()
+ *
+ *  This method is used for opening the next queued files,
+ *  allocating buffers of their sizes, and submitting their
+ *  reads.  The reads in flight are kept within the size of
+ *  the completion ring so no completion is ever dropped.
+ *  Files that cannot be opened are left to the blocking
+ *  reads.  It returns false when the kernel refused the
+ *  whole batch.  Entries it only turned away for now stay
+ *  in the ring and are submitted again while waiting.
+ ***********************************************************/
+bool AssetReader::SubmitPending()
+{
+	struct io_uring_sqe* pEntries = (struct io_uring_sqe*)m_pSubmissionEntries;
+	unsigned tail = *m_pSubmissionTail;
+	unsigned mask = *m_pSubmissionMask;
+
+	while ((m_nextSubmit < m_requests.size()) && (m_inFlight < m_completionEntryCount) &&
+		(tail - __atomic_load_n(m_pSubmissionHead, __ATOMIC_ACQUIRE) < m_submissionEntryCount))
+	{
+		READ_REQUEST& request = m_requests[m_nextSubmit];
+		size_t index = m_nextSubmit;
+		m_nextSubmit++;
+
+		if (request.state != READ_QUEUED)
+		{
+			continue;
+		}
+
+		int fileDescriptor = open(request.filename.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fileDescriptor < 0)
+		{
+			continue;
+		}
+		struct stat fileStat;
+		if ((fstat(fileDescriptor, &fileStat) != 0) || (fileStat.st_size <= 0))
+		{
+			close(fileDescriptor);
+			continue;
+		}
+
+		request.fileDescriptor = fileDescriptor;
+		request.size = (size_t)fileStat.st_size;
+		request.data = new unsigned char[request.size];
+		request.state = READ_PENDING;
+		m_readVectors[index].iov_base = request.data;
+		m_readVectors[index].iov_len = request.size;
+
+		unsigned slot = tail & mask;
+		struct io_uring_sqe* pEntry = &pEntries[slot];
+		memset(pEntry, 0, sizeof(*pEntry));
+		pEntry->opcode = IORING_OP_READV;
+		pEntry->fd = fileDescriptor;
+		pEntry->addr = (unsigned long long)(uintptr_t)&m_readVectors[index];
+		pEntry->len = 1;
+		pEntry->off = 0;
+		pEntry->user_data = (unsigned long long)index;
+		m_pSubmissionArray[slot] = slot;
+		tail++;
+		m_inFlight++;
+	}
+
+	// the entries must be visible before the kernel sees the new tail
+	__atomic_store_n(m_pSubmissionTail, tail, __ATOMIC_RELEASE);
+
+	unsigned submitCount = tail - __atomic_load_n(m_pSubmissionHead, __ATOMIC_ACQUIRE);
+	if (submitCount == 0)
+	{
+		return(true);
+	}
+
+	int result = IoUringEnter(m_ringFileDescriptor, submitCount, 0, 0);
+	if ((result < 0) && (errno != EINTR) && (errno != EAGAIN) && (errno != EBUSY))
+	{
+		// nothing was taken by the kernel, so the entries are withdrawn
+		// and the reads go back to blocking reads
+		if (m_inFlight == submitCount)
+		{
+			__atomic_store_n(m_pSubmissionTail, tail - submitCount, __ATOMIC_RELEASE);
+			for (size_t i = 0; i < m_requests.size(); i++)
+			{
+				if (m_requests[i].state == READ_PENDING)
+				{
+					close(m_requests[i].fileDescriptor);
+					m_requests[i].fileDescriptor = -1;
+					delete[] m_requests[i].data;
+					m_requests[i].data = NULL;
+					m_requests[i].state = READ_QUEUED;
+				}
+			}
+			m_inFlight = 0;
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  WaitForCompletion()
+ *
+ *  This method is used for waiting in the kernel until at
+ *  least one read has finished, unless one has already.
+ *  Entries the kernel turned away earlier are submitted
+ *  again with the wait.  It only reads the ring indices,
+ *  so it is called without the lock by the one thread that
+ *  collects the reads.
+ ***********************************************************/
+bool AssetReader::WaitForCompletion()
+{
+	if (*m_pCompletionHead != __atomic_load_n(m_pCompletionTail, __ATOMIC_ACQUIRE))
+	{
+		return(true);
+	}
+
+	unsigned submitCount = *m_pSubmissionTail - __atomic_load_n(m_pSubmissionHead, __ATOMIC_ACQUIRE);
+	int result = IoUringEnter(m_ringFileDescriptor, submitCount, 1, IORING_ENTER_GETEVENTS);
+	if ((result < 0) && (errno != EINTR))
+	{
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  ReapCompletions()
+ *
+ *  This method is used for collecting the finished reads
+ *  from the completion ring, waiting in the kernel for at
+ *  least one when bWait is set and none are ready.  Short
+ *  reads are finished with blocking reads, and failed reads
+ *  go back to being read with blocking reads when taken.
+ *  Freed ring space is used to submit more of the batch,
+ *  and entries the kernel turned away earlier are submitted
+ *  again while waiting.
+ ***********************************************************/
+bool AssetReader::ReapCompletions(bool bWait)
+{
+	if ((bWait == true) && (WaitForCompletion() == false))
+	{
+		return(false);
+	}
+
+	struct io_uring_cqe* pEntries = (struct io_uring_cqe*)m_pCompletionEntries;
+	unsigned head = *m_pCompletionHead;
+	unsigned tail = __atomic_load_n(m_pCompletionTail, __ATOMIC_ACQUIRE);
+	while (head != tail)
+	{
+		struct io_uring_cqe* pEntry = &pEntries[head & *m_pCompletionMask];
+		READ_REQUEST& request = m_requests[(size_t)pEntry->user_data];
+		int result = pEntry->res;
+		head++;
+		m_inFlight--;
+
+		size_t readSize = (result > 0) ? (size_t)result : 0;
+		while ((result > 0) && (readSize < request.size))
+		{
+			result = (int)pread(request.fileDescriptor, request.data + readSize,
+				request.size - readSize, (off_t)readSize);
+			readSize += (result > 0) ? (size_t)result : 0;
+		}
+
+		close(request.fileDescriptor);
+		request.fileDescriptor = -1;
+		if (readSize == request.size)
+		{
+			request.state = READ_DONE;
+		}
+		else
+		{
+			delete[] request.data;
+			request.data = NULL;
+			request.size = 0;
+			request.state = READ_QUEUED;
+		}
+	}
+	__atomic_store_n(m_pCompletionHead, head, __ATOMIC_RELEASE);
+
+	// files the kernel turns away are read when taken
+	SubmitPending();
+
+	return(true);
+}
+#endif
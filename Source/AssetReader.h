@@ -0,0 +1,144 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetreader.h
+// ============
+// read batches of asset files asynchronously
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// io_uring is only available on Linux
+#if defined(__linux__)
+#define ASSET_READER_IO_URING
+#include <sys/uio.h>
+#endif
+
+/***********************************************************
+ *  AssetReader
+ *
+ *  This class reads whole asset files into memory.  Every
+ *  queued file is submitted to the kernel in one batch
+ *  through io_uring on Linux, so the reads overlap each
+ *  other and the decoding of the files that already
+ *  arrived.  Where io_uring is not available, each file is
+ *  read with blocking reads by the thread that takes it.
+ *  Files may be taken from any thread.  One taking thread
+ *  at a time waits in the kernel, without the lock, while
+ *  the others wait for it to hand out what finished, so a
+ *  file that has arrived is taken at once.
+ ***********************************************************/
+class AssetReader
+{
+public:
+	// constructor
+	AssetReader();
+	// destructor
+	~AssetReader();
+
+	struct ASSET_BUFFER
+	{
+		std::string filename;
+		unsigned char* data;
+		size_t size;
+	};
+
+	// add a file to the batch, before Submit() is called
+	void QueueRead(const std::string& filename);
+	// start reading every queued file
+	void Submit();
+	// block until a queued file has been read and take its bytes
+	bool TakeFile(const std::string& filename, ASSET_BUFFER& buffer);
+	// free the bytes of a taken file
+	static void FreeBuffer(ASSET_BUFFER& buffer);
+	// read a whole file with blocking reads
+	static bool ReadFile(const std::string& filename, ASSET_BUFFER& buffer);
+
+	// true when the batch is read through io_uring
+	bool IsAsynchronous() const;
+	// number of files queued for reading
+	int GetQueuedCount() const;
+
+private:
+	enum READ_STATE
+	{
+		// not started, read with blocking reads when taken
+		READ_QUEUED = 0,
+		// submitted to the kernel
+		READ_PENDING,
+		// read into the buffer of the request
+		READ_DONE,
+		// handed to a caller of TakeFile()
+		READ_TAKEN
+	};
+
+	struct READ_REQUEST
+	{
+		std::string filename;
+		unsigned char* data;
+		size_t size;
+		int fileDescriptor;
+		READ_STATE state;
+	};
+
+	std::vector<READ_REQUEST> m_requests;
+	// index into m_requests of each queued file
+	std::unordered_map<std::string, int> m_requestIndices;
+	bool m_bSubmitted;
+	// guards the requests and the completion queue
+	std::mutex m_mutex;
+	// true while a taking thread waits in the kernel for finished reads
+	bool m_bReaping;
+	// signaled when the waiting thread has collected finished reads
+	std::condition_variable m_readsCollected;
+
+#ifdef ASSET_READER_IO_URING
+	int m_ringFileDescriptor;
+	// mapped submission and completion rings and the submission entries
+	void* m_pSubmissionRing;
+	size_t m_submissionRingSize;
+	void* m_pCompletionRing;
+	size_t m_completionRingSize;
+	void* m_pSubmissionEntries;
+	size_t m_submissionEntriesSize;
+	// ring indices shared with the kernel
+	unsigned* m_pSubmissionHead;
+	unsigned* m_pSubmissionTail;
+	unsigned* m_pSubmissionMask;
+	unsigned* m_pSubmissionArray;
+	unsigned* m_pCompletionHead;
+	unsigned* m_pCompletionTail;
+	unsigned* m_pCompletionMask;
+	void* m_pCompletionEntries;
+	unsigned m_submissionEntryCount;
+	unsigned m_completionEntryCount;
+	// read vectors of the requests, kept alive while in flight
+	std::vector<struct iovec> m_readVectors;
+	// next request to submit and number of reads in flight
+	size_t m_nextSubmit;
+	unsigned m_inFlight;
+
+	// create and map the rings, false when io_uring is not available
+	bool OpenRing(unsigned entryCount);
+	// unmap and close the rings
+	void CloseRing();
+	// open and submit as many queued files as the rings hold
+	bool SubmitPending();
+	// wait in the kernel until a read finishes, unless one already has
+	bool WaitForCompletion();
+	// collect finished reads, waiting for one when bWait is set
+	bool ReapCompletions(bool bWait);
+#endif
+
+	// asset readers own operating system handles, so they are not copied
+	AssetReader(const AssetReader&);
+	AssetReader& operator=(const AssetReader&);
+};
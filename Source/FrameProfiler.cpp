@@ -0,0 +1,179 @@
+///////////////////////////////////////////////////////////////////////////////
+// frameprofiler.cpp
+// ============
+// measure CPU frame time and GPU render time over a run of frames
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameProfiler.h"
+
+/***********************************************************
+ *  FrameProfiler()
+ *
+ *  The constructor for the class.  The ring of timer queries
+ *  is created here.
+ ***********************************************************/
+FrameProfiler::FrameProfiler(int queryCount)
+{
+	if (queryCount < 1)
+	{
+		queryCount = 1;
+	}
+
+	m_queryIDs.assign(queryCount, 0);
+	m_queryPending.assign(queryCount, false);
+	glGenQueries(queryCount, &m_queryIDs[0]);
+
+	m_nextQuery = 0;
+	Reset();
+}
+
+/***********************************************************
+ *  ~FrameProfiler()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameProfiler::~FrameProfiler()
+{
+	glDeleteQueries((GLsizei)m_queryIDs.size(), &m_queryIDs[0]);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting the timer query of a
+ *  frame and measuring the CPU time since the last frame.
+ *  When every query of the ring is still in flight, the
+ *  oldest one is waited on.
+ ***********************************************************/
+void FrameProfiler::BeginFrame()
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (m_bHaveLastFrame == true)
+	{
+		std::chrono::duration<double, std::milli> frameTime = now - m_lastFrameStart;
+		m_cpuMilliseconds += frameTime.count();
+		m_cpuFrameCount++;
+	}
+	m_lastFrameStart = now;
+	m_bHaveLastFrame = true;
+
+	CollectQueries(false);
+	if (m_queryPending[m_nextQuery] == true)
+	{
+		CollectQueries(true);
+	}
+
+	glBeginQuery(GL_TIME_ELAPSED, m_queryIDs[m_nextQuery]);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for ending the timer query of a
+ *  frame.
+ ***********************************************************/
+void FrameProfiler::EndFrame()
+{
+	glEndQuery(GL_TIME_ELAPSED);
+
+	m_queryPending[m_nextQuery] = true;
+	m_nextQuery = (m_nextQuery + 1) % (int)m_queryIDs.size();
+	m_frameCount++;
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method is used for forgetting every measured frame.
+ *  Results of queries still in flight are dropped.
+ ***********************************************************/
+void FrameProfiler::Reset()
+{
+	for (size_t i = 0; i < m_queryPending.size(); i++)
+	{
+		if (m_queryPending[i] == true)
+		{
+			GLuint64 elapsed = 0;
+			glGetQueryObjectui64v(m_queryIDs[i], GL_QUERY_RESULT, &elapsed);
+			m_queryPending[i] = false;
+		}
+	}
+
+	m_frameCount = 0;
+	m_cpuMilliseconds = 0.0;
+	m_cpuFrameCount = 0;
+	m_gpuMilliseconds = 0.0;
+	m_gpuFrameCount = 0;
+	m_bHaveLastFrame = false;
+}
+
+/***********************************************************
+ *  GetFrameCount()
+ *
+ *  This method is used for getting the number of frames
+ *  measured since the last reset.
+ ***********************************************************/
+int FrameProfiler::GetFrameCount() const
+{
+	return(m_frameCount);
+}
+
+/***********************************************************
+ *  GetAverageCPUMilliseconds()
+ *
+ *  This method is used for getting the average CPU time from
+ *  the start of one frame to the start of the next.
+ ***********************************************************/
+double FrameProfiler::GetAverageCPUMilliseconds() const
+{
+	return((m_cpuFrameCount > 0) ? m_cpuMilliseconds / m_cpuFrameCount : 0.0);
+}
+
+/***********************************************************
+ *  GetAverageGPUMilliseconds()
+ *
+ *  This method is used for getting the average GPU time of
+ *  the frames whose timer queries have been read back.
+ ***********************************************************/
+double FrameProfiler::GetAverageGPUMilliseconds() const
+{
+	return((m_gpuFrameCount > 0) ? m_gpuMilliseconds / m_gpuFrameCount : 0.0);
+}
+
+/***********************************************************
+ *  CollectQueries()
+ *
+ *  This method is used for reading back the timer queries of
+ *  the ring that have finished, oldest first.  With bWait
+ *  set the oldest pending query is waited on.
+ ***********************************************************/
+void FrameProfiler::CollectQueries(bool bWait)
+{
+	int queryCount = (int)m_queryIDs.size();
+
+	for (int i = 0; i < queryCount; i++)
+	{
+		int query = (m_nextQuery + i) % queryCount;
+		if (m_queryPending[query] == false)
+		{
+			continue;
+		}
+
+		GLint available = 0;
+		glGetQueryObjectiv(m_queryIDs[query], GL_QUERY_RESULT_AVAILABLE, &available);
+		if ((available == 0) && (bWait == false))
+		{
+			break;
+		}
+
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(m_queryIDs[query], GL_QUERY_RESULT, &elapsed);
+		m_gpuMilliseconds += (double)elapsed / 1000000.0;
+		m_gpuFrameCount++;
+		m_queryPending[query] = false;
+		bWait = false;
+	}
+}
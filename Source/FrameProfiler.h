@@ -0,0 +1,64 @@
+///////////////////////////////////////////////////////////////////////////////
+// frameprofiler.h
+// ============
+// measure CPU frame time and GPU render time over a run of frames
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <vector>
+
+/***********************************************************
+ *  FrameProfiler
+ *
+ *  This class averages the CPU time between frames and the
+ *  GPU time spent on the commands of each frame.  The GPU
+ *  time comes from GL_TIME_ELAPSED queries kept in a small
+ *  ring, and each query is only read back once its result
+ *  is available, so measuring never stalls the pipeline.
+ ***********************************************************/
+class FrameProfiler
+{
+public:
+	// constructor - must be called with an OpenGL context
+	FrameProfiler(int queryCount = 4);
+	// destructor
+	~FrameProfiler();
+
+	// start timing the commands of a frame
+	void BeginFrame();
+	// stop timing the commands of a frame
+	void EndFrame();
+	// forget every measured frame
+	void Reset();
+
+	// number of frames measured since the last reset
+	int GetFrameCount() const;
+	// average CPU time from one frame to the next
+	double GetAverageCPUMilliseconds() const;
+	// average GPU time of the frames whose queries were read back
+	double GetAverageGPUMilliseconds() const;
+
+private:
+	// ring of timer queries, one per frame in flight
+	std::vector<GLuint> m_queryIDs;
+	// true while a query of the ring waits for its result
+	std::vector<bool> m_queryPending;
+	int m_nextQuery;
+	int m_frameCount;
+	double m_cpuMilliseconds;
+	int m_cpuFrameCount;
+	double m_gpuMilliseconds;
+	int m_gpuFrameCount;
+	bool m_bHaveLastFrame;
+	std::chrono::steady_clock::time_point m_lastFrameStart;
+
+	// add the results of the finished queries to the totals
+	void CollectQueries(bool bWait);
+};
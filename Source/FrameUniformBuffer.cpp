@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////////
+// frameuniformbuffer.cpp
+// ============
+// share the camera values of a frame across shader programs
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameUniformBuffer.h"
+#include "GLResourceTracker.h"
+
+// declaration of global variables
+namespace
+{
+	// name of the frame values block in the shaders
+	const char* g_FrameDataBlockName = "FrameData";
+}
+
+/***********************************************************
+ *  FrameUniformBuffer()
+ *
+ *  The constructor for the class.  The buffer is created
+ *  and left bound at its binding point, where every program
+ *  reads it.
+ ***********************************************************/
+FrameUniformBuffer::FrameUniformBuffer(GLResourceTracker* pResourceTracker)
+{
+	m_pResourceTracker = pResourceTracker;
+	m_frameData.view = glm::mat4(1.0f);
+	m_frameData.projection = glm::mat4(1.0f);
+	m_frameData.viewProjection = glm::mat4(1.0f);
+	m_frameData.viewPosition = glm::vec4(0.0f);
+
+	glGenBuffers(1, &m_bufferID);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_bufferID);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FRAME_DATA), &m_frameData, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, m_bufferID);
+
+	m_pResourceTracker->Track(GLResourceTracker::RESOURCE_BUFFER, m_bufferID, sizeof(FRAME_DATA), "frame");
+}
+
+/***********************************************************
+ *  ~FrameUniformBuffer()
+ *
+ *  The destructor for the class.
+ ***********************************************************/
+FrameUniformBuffer::~FrameUniformBuffer()
+{
+	m_pResourceTracker->Delete(GLResourceTracker::RESOURCE_BUFFER, m_bufferID);
+	m_bufferID = 0;
+}
+
+/***********************************************************
+ *  BindProgram()
+ *
+ *  This method is used for pointing the frame values block
+ *  of a linked program at the binding the buffer is bound
+ *  to.  It only has to be called once after the program is
+ *  linked, and a program without the block reads nothing.
+ ***********************************************************/
+bool FrameUniformBuffer::BindProgram(GLuint programID)
+{
+	GLuint blockIndex = glGetUniformBlockIndex(programID, g_FrameDataBlockName);
+	if (blockIndex == GL_INVALID_INDEX)
+	{
+		return(false);
+	}
+
+	glUniformBlockBinding(programID, blockIndex, FRAME_DATA_BINDING);
+	return(true);
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for writing the camera values of the
+ *  frame into the buffer with one copy, which every program
+ *  bound to it reads from then on.
+ ***********************************************************/
+void FrameUniformBuffer::Update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPosition)
+{
+	m_frameData.view = view;
+	m_frameData.projection = projection;
+	m_frameData.viewProjection = projection * view;
+	m_frameData.viewPosition = glm::vec4(viewPosition, 1.0f);
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_bufferID);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FRAME_DATA), &m_frameData);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/***********************************************************
+ *  GetFrameData()
+ *
+ *  This method is used for getting the camera values the
+ *  last Update() wrote.
+ ***********************************************************/
+const FrameUniformBuffer::FRAME_DATA& FrameUniformBuffer::GetFrameData() const
+{
+	return(m_frameData);
+}
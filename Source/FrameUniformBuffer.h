@@ -0,0 +1,66 @@
+///////////////////////////////////////////////////////////////////////////////
+// frameuniformbuffer.h
+// ============
+// share the camera values of a frame across shader programs
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+class GLResourceTracker;
+
+/***********************************************************
+ *  FrameUniformBuffer
+ *
+ *  This class holds the camera values of a frame in one
+ *  uniform buffer bound at a fixed binding point.  A linked
+ *  program has its FrameData block pointed at the binding
+ *  once, and from then on reads the values of every frame
+ *  without any of its own uniforms being set, so any number
+ *  of programs share one buffer write per frame.
+ ***********************************************************/
+class FrameUniformBuffer
+{
+public:
+	// constructor - must be called with an OpenGL context
+	FrameUniformBuffer(GLResourceTracker* pResourceTracker);
+	// destructor
+	~FrameUniformBuffer();
+
+	// uniform buffer binding point of the frame values
+	static const GLuint FRAME_DATA_BINDING = 0;
+
+	// values of one frame, laid out as FrameData in the shaders (std140)
+	struct FRAME_DATA
+	{
+		glm::mat4 view;
+		glm::mat4 projection;
+		// projection times view, worked out once per frame
+		glm::mat4 viewProjection;
+		// camera position, w unused
+		glm::vec4 viewPosition;
+	};
+
+	// point the frame values block of a linked program at its binding
+	static bool BindProgram(GLuint programID);
+
+	// write the camera values of the frame with one buffer write
+	void Update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPosition);
+	// values written by the last Update()
+	const FRAME_DATA& GetFrameData() const;
+
+private:
+	// records the buffer
+	GLResourceTracker* m_pResourceTracker;
+	GLuint m_bufferID;
+	FRAME_DATA m_frameData;
+
+	// buffers are OpenGL objects, so they are not copied
+	FrameUniformBuffer(const FrameUniformBuffer&);
+	FrameUniformBuffer& operator=(const FrameUniformBuffer&);
+};
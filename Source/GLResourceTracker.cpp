@@ -0,0 +1,380 @@
+///////////////////////////////////////////////////////////////////////////////
+// glresourcetracker.cpp
+// ============
+// track the lifetime and memory size of OpenGL resources
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GLResourceTracker.h"
+
+#include <iostream>
+#include <map>
+
+/***********************************************************
+ *  GLResourceTracker()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GLResourceTracker::GLResourceTracker()
+{
+	m_peakBytes = 0;
+	m_liveBytes = 0;
+}
+
+/***********************************************************
+ *  ~GLResourceTracker()
+ *
+ *  The destructor for the class.  Anything still tracked has
+ *  leaked from its owner, so it is reported and deleted.
+ ***********************************************************/
+GLResourceTracker::~GLResourceTracker()
+{
+	DeleteAll();
+}
+
+/***********************************************************
+ *  Track()
+ *
+ *  This method is used for recording a newly created
+ *  resource.  Tracking a resource that is already tracked
+ *  only updates its size.
+ ***********************************************************/
+void GLResourceTracker::Track(RESOURCE_TYPE type, GLuint id, size_t byteSize, const std::string& subsystem)
+{
+	if (id == 0)
+	{
+		return;
+	}
+
+	uint64_t key = MakeKey(type, id);
+	std::unordered_map<uint64_t, RESOURCE_RECORD>::iterator found = m_resources.find(key);
+	if (found != m_resources.end())
+	{
+		Resize(type, id, byteSize);
+		return;
+	}
+
+	RESOURCE_RECORD record;
+	record.type = type;
+	record.id = id;
+	record.byteSize = byteSize;
+	record.subsystem = subsystem;
+	m_resources[key] = record;
+
+	m_liveBytes += byteSize;
+	if (m_liveBytes > m_peakBytes)
+	{
+		m_peakBytes = m_liveBytes;
+	}
+}
+
+/***********************************************************
+ *  Resize()
+ *
+ *  This method is used for changing the recorded size of a
+ *  tracked resource, such as a texture whose levels were
+ *  allocated after it was created.
+ ***********************************************************/
+void GLResourceTracker::Resize(RESOURCE_TYPE type, GLuint id, size_t byteSize)
+{
+	std::unordered_map<uint64_t, RESOURCE_RECORD>::iterator found = m_resources.find(MakeKey(type, id));
+	if (found == m_resources.end())
+	{
+		return;
+	}
+
+	m_liveBytes = m_liveBytes - found->second.byteSize + byteSize;
+	found->second.byteSize = byteSize;
+	if (m_liveBytes > m_peakBytes)
+	{
+		m_peakBytes = m_liveBytes;
+	}
+}
+
+/***********************************************************
+ *  Untrack()
+ *
+ *  This method is used for forgetting a resource that is
+ *  deleted by its owner outside of the tracker.
+ ***********************************************************/
+void GLResourceTracker::Untrack(RESOURCE_TYPE type, GLuint id)
+{
+	std::unordered_map<uint64_t, RESOURCE_RECORD>::iterator found = m_resources.find(MakeKey(type, id));
+	if (found == m_resources.end())
+	{
+		return;
+	}
+
+	m_liveBytes -= found->second.byteSize;
+	m_resources.erase(found);
+}
+
+/***********************************************************
+ *  Delete()
+ *
+ *  This method is used for deleting an OpenGL resource and
+ *  removing it from the live totals.  Resources that were
+ *  never tracked are still deleted.
+ ***********************************************************/
+void GLResourceTracker::Delete(RESOURCE_TYPE type, GLuint id)
+{
+	if (id == 0)
+	{
+		return;
+	}
+
+	DeleteObject(type, id);
+	Untrack(type, id);
+}
+
+/***********************************************************
+ *  DeleteAll()
+ *
+ *  This method is used for deleting every resource that is
+ *  still tracked.  Each one is reported, since its owner
+ *  should already have deleted it.
+ ***********************************************************/
+void GLResourceTracker::DeleteAll()
+{
+	std::unordered_map<uint64_t, RESOURCE_RECORD>::const_iterator resource;
+	for (resource = m_resources.begin(); resource != m_resources.end(); ++resource)
+	{
+		std::cout << "WARNING: Freeing leaked " << GetTypeName(resource->second.type) << " "
+			<< resource->second.id << " (" << resource->second.byteSize << " bytes) from "
+			<< resource->second.subsystem << std::endl;
+		DeleteObject(resource->second.type, resource->second.id);
+	}
+
+	m_resources.clear();
+	m_liveBytes = 0;
+}
+
+/***********************************************************
+ *  IsTracked()
+ *
+ *  This method is used for checking whether a resource is
+ *  being tracked.
+ ***********************************************************/
+bool GLResourceTracker::IsTracked(RESOURCE_TYPE type, GLuint id) const
+{
+	return(m_resources.find(MakeKey(type, id)) != m_resources.end());
+}
+
+/***********************************************************
+ *  GetLiveBytes()
+ *
+ *  This method is used for getting the total bytes of the
+ *  live resources of a subsystem, or of every subsystem
+ *  when no subsystem is passed in.
+ ***********************************************************/
+size_t GLResourceTracker::GetLiveBytes(const std::string& subsystem) const
+{
+	if (subsystem.empty() == true)
+	{
+		return(m_liveBytes);
+	}
+
+	size_t liveBytes = 0;
+	std::unordered_map<uint64_t, RESOURCE_RECORD>::const_iterator resource;
+	for (resource = m_resources.begin(); resource != m_resources.end(); ++resource)
+	{
+		if (resource->second.subsystem == subsystem)
+		{
+			liveBytes += resource->second.byteSize;
+		}
+	}
+
+	return(liveBytes);
+}
+
+/***********************************************************
+ *  Report()
+ *
+ *  This method is used for printing the live resource counts
+ *  and sizes of each subsystem, along with the overall live
+ *  and peak totals.
+ ***********************************************************/
+void GLResourceTracker::Report(const char* heading) const
+{
+	struct SUBSYSTEM_TOTAL
+	{
+		int counts[RESOURCE_TYPE_COUNT];
+		size_t byteSize;
+	};
+
+	// sorted by name so reports line up from run to run
+	std::map<std::string, SUBSYSTEM_TOTAL> totals;
+	std::unordered_map<uint64_t, RESOURCE_RECORD>::const_iterator resource;
+	for (resource = m_resources.begin(); resource != m_resources.end(); ++resource)
+	{
+		if (totals.find(resource->second.subsystem) == totals.end())
+		{
+			SUBSYSTEM_TOTAL empty = {};
+			totals[resource->second.subsystem] = empty;
+		}
+		SUBSYSTEM_TOTAL& total = totals[resource->second.subsystem];
+		total.counts[resource->second.type]++;
+		total.byteSize += resource->second.byteSize;
+	}
+
+	std::cout << "INFO: GPU memory " << heading << ": " << m_liveBytes / 1024 << " KB live, "
+		<< m_peakBytes / 1024 << " KB peak" << std::endl;
+
+	std::map<std::string, SUBSYSTEM_TOTAL>::const_iterator total;
+	for (total = totals.begin(); total != totals.end(); ++total)
+	{
+		std::cout << "INFO:   " << total->first << ": " << total->second.byteSize / 1024 << " KB in";
+		for (int type = 0; type < RESOURCE_TYPE_COUNT; type++)
+		{
+			if (total->second.counts[type] > 0)
+			{
+				std::cout << " " << total->second.counts[type] << " " << GetTypeName((RESOURCE_TYPE)type) << "s";
+			}
+		}
+		std::cout << std::endl;
+	}
+}
+
+/***********************************************************
+ *  MeasureTexture()
+ *
+ *  This method is used for adding up the bytes of every
+ *  allocated level of a texture, as reported by the driver.
+ *  The texture is bound to the active unit for the queries
+ *  and the previous binding is put back afterwards.
+ ***********************************************************/
+size_t GLResourceTracker::MeasureTexture(GLenum target, GLuint textureID)
+{
+	GLenum bindingQuery = (target == GL_TEXTURE_2D_ARRAY) ? GL_TEXTURE_BINDING_2D_ARRAY : GL_TEXTURE_BINDING_2D;
+	GLint previousTexture = 0;
+	size_t byteSize = 0;
+
+	glGetIntegerv(bindingQuery, &previousTexture);
+	glBindTexture(target, textureID);
+
+	for (GLint level = 0; level < 32; level++)
+	{
+		GLint width = 0;
+		GLint height = 0;
+		GLint depth = 0;
+		GLint compressed = 0;
+		glGetTexLevelParameteriv(target, level, GL_TEXTURE_WIDTH, &width);
+		glGetTexLevelParameteriv(target, level, GL_TEXTURE_HEIGHT, &height);
+		glGetTexLevelParameteriv(target, level, GL_TEXTURE_DEPTH, &depth);
+		if ((width == 0) || (height == 0))
+		{
+			break;
+		}
+
+		glGetTexLevelParameteriv(target, level, GL_TEXTURE_COMPRESSED, &compressed);
+		if (compressed != 0)
+		{
+			GLint compressedSize = 0;
+			glGetTexLevelParameteriv(target, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &compressedSize);
+			byteSize += (size_t)compressedSize;
+		}
+		else
+		{
+			GLint internalFormat = 0;
+			glGetTexLevelParameteriv(target, level, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+
+			// drivers store RGB8 texels padded out to 4 bytes
+			size_t texelSize = 4;
+			if ((internalFormat == GL_R8) || (internalFormat == GL_RED))
+			{
+				texelSize = 1;
+			}
+			else if ((internalFormat == GL_RG8) || (internalFormat == GL_RG))
+			{
+				texelSize = 2;
+			}
+			byteSize += (size_t)width * height * ((depth > 0) ? depth : 1) * texelSize;
+		}
+	}
+
+	glBindTexture(target, (GLuint)previousTexture);
+
+	return(byteSize);
+}
+
+/***********************************************************
+ *  MeasureBuffer()
+ *
+ *  This method is used for getting the size of a buffer as
+ *  reported by the driver.
+ ***********************************************************/
+size_t GLResourceTracker::MeasureBuffer(GLuint bufferID)
+{
+	GLint previousBuffer = 0;
+	GLint64 bufferSize = 0;
+
+	glGetIntegerv(GL_COPY_READ_BUFFER_BINDING, &previousBuffer);
+	glBindBuffer(GL_COPY_READ_BUFFER, bufferID);
+	glGetBufferParameteri64v(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &bufferSize);
+	glBindBuffer(GL_COPY_READ_BUFFER, (GLuint)previousBuffer);
+
+	return((size_t)bufferSize);
+}
+
+/***********************************************************
+ *  GetTypeName()
+ *
+ *  This method is used for getting the name of a resource
+ *  type for reporting.
+ ***********************************************************/
+const char* GLResourceTracker::GetTypeName(RESOURCE_TYPE type)
+{
+	switch (type)
+	{
+	case RESOURCE_TEXTURE:
+		return("texture");
+	case RESOURCE_BUFFER:
+		return("buffer");
+	case RESOURCE_PROGRAM:
+		return("program");
+	case RESOURCE_SAMPLER:
+		return("sampler");
+	default:
+		return("resource");
+	}
+}
+
+/***********************************************************
+ *  MakeKey()
+ *
+ *  This method is used for combining the type and name of a
+ *  resource into its key, since each type has its own names.
+ ***********************************************************/
+uint64_t GLResourceTracker::MakeKey(RESOURCE_TYPE type, GLuint id)
+{
+	return(((uint64_t)type << 32) | (uint64_t)id);
+}
+
+/***********************************************************
+ *  DeleteObject()
+ *
+ *  This method is used for deleting the OpenGL object of the
+ *  passed in type.
+ ***********************************************************/
+void GLResourceTracker::DeleteObject(RESOURCE_TYPE type, GLuint id)
+{
+	switch (type)
+	{
+	case RESOURCE_TEXTURE:
+		glDeleteTextures(1, &id);
+		break;
+	case RESOURCE_BUFFER:
+		glDeleteBuffers(1, &id);
+		break;
+	case RESOURCE_PROGRAM:
+		glDeleteProgram(id);
+		break;
+	case RESOURCE_SAMPLER:
+		glDeleteSamplers(1, &id);
+		break;
+	default:
+		break;
+	}
+}
@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+// glresourcetracker.h
+// ============
+// track the lifetime and memory size of OpenGL resources
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+/***********************************************************
+ *  GLResourceTracker
+ *
+ *  This class records every tracked OpenGL texture, buffer,
+ *  program and sampler together with its size in bytes and
+ *  the subsystem that created it.  Resources are deleted
+ *  through the tracker so the live totals stay correct, and
+ *  anything still alive at shutdown is reported and freed.
+ *  It must only be used on the thread that owns the OpenGL
+ *  context.
+ ***********************************************************/
+class GLResourceTracker
+{
+public:
+	// constructor
+	GLResourceTracker();
+	// destructor - frees any resources still being tracked
+	~GLResourceTracker();
+
+	enum RESOURCE_TYPE
+	{
+		RESOURCE_TEXTURE = 0,
+		RESOURCE_BUFFER,
+		RESOURCE_PROGRAM,
+		RESOURCE_SAMPLER,
+		RESOURCE_TYPE_COUNT
+	};
+
+	// start tracking a created resource
+	void Track(RESOURCE_TYPE type, GLuint id, size_t byteSize, const std::string& subsystem);
+	// change the recorded size of a tracked resource
+	void Resize(RESOURCE_TYPE type, GLuint id, size_t byteSize);
+	// stop tracking a resource owned and deleted elsewhere
+	void Untrack(RESOURCE_TYPE type, GLuint id);
+	// delete a resource and stop tracking it
+	void Delete(RESOURCE_TYPE type, GLuint id);
+	// delete every tracked resource, reporting each as a leak
+	void DeleteAll();
+
+	// true when the resource is being tracked
+	bool IsTracked(RESOURCE_TYPE type, GLuint id) const;
+	// bytes of the live resources of a subsystem, or of all of them
+	size_t GetLiveBytes(const std::string& subsystem = "") const;
+	// print the live counts and bytes per subsystem
+	void Report(const char* heading) const;
+
+	// measure the bytes of every allocated level of a texture
+	static size_t MeasureTexture(GLenum target, GLuint textureID);
+	// measure the bytes of a buffer
+	static size_t MeasureBuffer(GLuint bufferID);
+	// get the name of a resource type for reporting
+	static const char* GetTypeName(RESOURCE_TYPE type);
+
+private:
+	struct RESOURCE_RECORD
+	{
+		RESOURCE_TYPE type;
+		GLuint id;
+		size_t byteSize;
+		std::string subsystem;
+	};
+
+	// live resources keyed by type and name
+	std::unordered_map<uint64_t, RESOURCE_RECORD> m_resources;
+	// largest total of live bytes seen
+	size_t m_peakBytes;
+	size_t m_liveBytes;
+
+	static uint64_t MakeKey(RESOURCE_TYPE type, GLuint id);
+	// release the OpenGL object behind a resource
+	static void DeleteObject(RESOURCE_TYPE type, GLuint id);
+};
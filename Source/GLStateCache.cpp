@@ -0,0 +1,143 @@
+///////////////////////////////////////////////////////////////////////////////
+// glstatecache.cpp
+// ============
+// drop OpenGL state changes that would not change anything
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GLStateCache.h"
+
+/***********************************************************
+ *  GLStateCache()
+ *
+ *  The constructor for the class.  Nothing is known about
+ *  the state yet, so the first call of each kind is passed
+ *  to the driver.
+ ***********************************************************/
+GLStateCache::GLStateCache()
+{
+	m_clearColor = glm::vec4(0.0f);
+	m_bClearColorValid = false;
+	m_issuedCount = 0;
+	m_elidedCount = 0;
+}
+
+/***********************************************************
+ *  ~GLStateCache()
+ *
+ *  The destructor for the class.
+ ***********************************************************/
+GLStateCache::~GLStateCache()
+{
+}
+
+/***********************************************************
+ *  SetCapability()
+ *
+ *  This method is used for switching a capability on or
+ *  off with glEnable() or glDisable(), unless the cache
+ *  shows it is already in that state.
+ ***********************************************************/
+void GLStateCache::SetCapability(GLenum capability, bool bEnabled)
+{
+	size_t index = 0;
+	while ((index < m_capabilities.size()) && (m_capabilities[index].capability != capability))
+	{
+		index++;
+	}
+
+	if (index == m_capabilities.size())
+	{
+		CAPABILITY_STATE capabilityState;
+		capabilityState.capability = capability;
+		capabilityState.bEnabled = !bEnabled;
+		m_capabilities.push_back(capabilityState);
+	}
+	else if (m_capabilities[index].bEnabled == bEnabled)
+	{
+		m_elidedCount++;
+		return;
+	}
+
+	if (bEnabled == true)
+	{
+		glEnable(capability);
+	}
+	else
+	{
+		glDisable(capability);
+	}
+	m_capabilities[index].bEnabled = bEnabled;
+	m_issuedCount++;
+}
+
+/***********************************************************
+ *  SetClearColor()
+ *
+ *  This method is used for setting the color the color
+ *  buffer is cleared to, unless the cache shows it is
+ *  already that color.
+ ***********************************************************/
+void GLStateCache::SetClearColor(const glm::vec4& color)
+{
+	if ((m_bClearColorValid == true) && (m_clearColor == color))
+	{
+		m_elidedCount++;
+		return;
+	}
+
+	glClearColor(color.r, color.g, color.b, color.a);
+	m_clearColor = color;
+	m_bClearColorValid = true;
+	m_issuedCount++;
+}
+
+/***********************************************************
+ *  Invalidate()
+ *
+ *  This method is used for forgetting the copied state, so
+ *  the next call of each kind reaches the driver.
+ ***********************************************************/
+void GLStateCache::Invalidate()
+{
+	m_capabilities.clear();
+	m_bClearColorValid = false;
+}
+
+/***********************************************************
+ *  GetIssuedCount()
+ *
+ *  This method is used for getting the number of state
+ *  changes passed to the driver since the counts were
+ *  reset.
+ ***********************************************************/
+int GLStateCache::GetIssuedCount() const
+{
+	return(m_issuedCount);
+}
+
+/***********************************************************
+ *  GetElidedCount()
+ *
+ *  This method is used for getting the number of state
+ *  changes dropped since the counts were reset, because
+ *  the state was already set.
+ ***********************************************************/
+int GLStateCache::GetElidedCount() const
+{
+	return(m_elidedCount);
+}
+
+/***********************************************************
+ *  ResetCounts()
+ *
+ *  This method is used for starting the issued and elided
+ *  counts again, such as once per frame.
+ ***********************************************************/
+void GLStateCache::ResetCounts()
+{
+	m_issuedCount = 0;
+	m_elidedCount = 0;
+}
@@ -0,0 +1,64 @@
+///////////////////////////////////////////////////////////////////////////////
+// glstatecache.h
+// ============
+// drop OpenGL state changes that would not change anything
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  GLStateCache
+ *
+ *  This class keeps a copy of the fixed function state set
+ *  through it - the capabilities switched on and off and
+ *  the clear color - so a call that would set the state the
+ *  context already has never reaches the driver.  State
+ *  set without going through the cache must be followed by
+ *  a call to Invalidate().
+ ***********************************************************/
+class GLStateCache
+{
+public:
+	// constructor
+	GLStateCache();
+	// destructor
+	~GLStateCache();
+
+	// switch a capability such as GL_DEPTH_TEST on or off, unless it is already
+	void SetCapability(GLenum capability, bool bEnabled);
+	// set the color the color buffer is cleared to, unless it is already
+	void SetClearColor(const glm::vec4& color);
+
+	// forget the copied state after it was set some other way
+	void Invalidate();
+	// calls passed to the driver and dropped as unchanged since ResetCounts()
+	int GetIssuedCount() const;
+	int GetElidedCount() const;
+	void ResetCounts();
+
+private:
+	struct CAPABILITY_STATE
+	{
+		GLenum capability;
+		bool bEnabled;
+	};
+
+	// capabilities set so far, only a few so searched in order
+	std::vector<CAPABILITY_STATE> m_capabilities;
+	glm::vec4 m_clearColor;
+	bool m_bClearColorValid;
+	int m_issuedCount;
+	int m_elidedCount;
+
+	// the copied state matches one context, so it is not copied
+	GLStateCache(const GLStateCache&);
+	GLStateCache& operator=(const GLStateCache&);
+};
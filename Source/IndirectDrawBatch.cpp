@@ -0,0 +1,227 @@
+///////////////////////////////////////////////////////////////////////////////
+// indirectdrawbatch.cpp
+// ============
+// submit the draws of a frame with multi-draw-indirect calls
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "IndirectDrawBatch.h"
+#include "GLResourceTracker.h"
+
+// declaration of global variables
+namespace
+{
+	// draws the command and draw value buffers have room for at first
+	const int g_InitialDrawCount = 256;
+	// name of the draw values block in the shaders
+	const char* g_DrawDataBlockName = "DrawDataBuffer";
+}
+
+/***********************************************************
+ *  IndirectDrawBatch()
+ *
+ *  The constructor for the class.  The command and draw
+ *  value buffers are created with room for a few hundred
+ *  draws, and grow as needed.
+ ***********************************************************/
+IndirectDrawBatch::IndirectDrawBatch(const SceneMeshes* pSceneMeshes, GLResourceTracker* pResourceTracker)
+{
+	m_pSceneMeshes = pSceneMeshes;
+	m_pResourceTracker = pResourceTracker;
+
+	m_commandBufferBytes = g_InitialDrawCount * sizeof(DRAW_COMMAND);
+	glGenBuffers(1, &m_commandBufferID);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBufferID);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, (GLsizeiptr)m_commandBufferBytes, NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	m_drawDataBufferBytes = g_InitialDrawCount * sizeof(DRAW_DATA);
+	glGenBuffers(1, &m_drawDataBufferID);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawDataBufferID);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)m_drawDataBufferBytes, NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	m_pResourceTracker->Track(GLResourceTracker::RESOURCE_BUFFER, m_commandBufferID, m_commandBufferBytes, "draws");
+	m_pResourceTracker->Track(GLResourceTracker::RESOURCE_BUFFER, m_drawDataBufferID, m_drawDataBufferBytes, "draws");
+}
+
+/***********************************************************
+ *  ~IndirectDrawBatch()
+ *
+ *  The destructor for the class.  The command and draw
+ *  value buffers are freed, while the shape buffers belong
+ *  to SceneMeshes.
+ ***********************************************************/
+IndirectDrawBatch::~IndirectDrawBatch()
+{
+	m_pResourceTracker->Delete(GLResourceTracker::RESOURCE_BUFFER, m_commandBufferID);
+	m_pResourceTracker->Delete(GLResourceTracker::RESOURCE_BUFFER, m_drawDataBufferID);
+	m_commandBufferID = 0;
+	m_drawDataBufferID = 0;
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  This method is used for checking that the driver has
+ *  what the indirect draws need - multi-draw-indirect,
+ *  shader storage buffers and gl_DrawID in the shaders.
+ ***********************************************************/
+bool IndirectDrawBatch::IsSupported()
+{
+	return((GLEW_ARB_multi_draw_indirect == GL_TRUE) &&
+		(GLEW_ARB_shader_storage_buffer_object == GL_TRUE) &&
+		(GLEW_ARB_shader_draw_parameters == GL_TRUE));
+}
+
+/***********************************************************
+ *  BindProgram()
+ *
+ *  This method is used for pointing the draw values block
+ *  of a linked program at the binding the draw values are
+ *  bound to.  The shaders only declare the block when the
+ *  driver compiled them with the extensions it needs, so a
+ *  program without it cannot make indirect draws.
+ ***********************************************************/
+bool IndirectDrawBatch::BindProgram(GLuint programID)
+{
+	GLuint blockIndex = glGetProgramResourceIndex(programID, GL_SHADER_STORAGE_BLOCK, g_DrawDataBlockName);
+	if (blockIndex == GL_INVALID_INDEX)
+	{
+		return(false);
+	}
+
+	glShaderStorageBlockBinding(programID, blockIndex, DRAW_DATA_BINDING);
+	return(true);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing the draws of the last
+ *  frame.  The arrays keep their capacity, so a frame with
+ *  the same number of draws allocates nothing.
+ ***********************************************************/
+void IndirectDrawBatch::Clear()
+{
+	m_commands.clear();
+	m_drawData.clear();
+}
+
+/***********************************************************
+ *  AddDraw()
+ *
+ *  This method is used for adding a draw of a shape with
+ *  its values.  The index returned is where the values sit
+ *  in the draw values buffer.
+ ***********************************************************/
+int IndirectDrawBatch::AddDraw(SceneMeshes::MESH_SHAPE shape, const DRAW_DATA& drawData)
+{
+	if (m_pSceneMeshes->IsLoaded(shape) == false)
+	{
+		return(-1);
+	}
+
+	const SceneMeshes::SHAPE_RANGE& range = m_pSceneMeshes->GetShapeRange(shape);
+	DRAW_COMMAND command;
+	command.indexCount = range.indexCount;
+	command.instanceCount = 1;
+	command.firstIndex = range.firstIndex;
+	command.baseVertex = range.baseVertex;
+	command.baseInstance = 0;
+	m_commands.push_back(command);
+	m_drawData.push_back(drawData);
+
+	return((int)m_drawData.size() - 1);
+}
+
+/***********************************************************
+ *  UploadDraws()
+ *
+ *  This method is used for writing the commands and values
+ *  of every added draw to their buffers with one copy each,
+ *  and binding the values for the shaders.
+ ***********************************************************/
+void IndirectDrawBatch::UploadDraws()
+{
+	if (m_commands.empty() == true)
+	{
+		return;
+	}
+
+	RefillBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBufferID, m_commandBufferBytes,
+		&m_commands[0], m_commands.size() * sizeof(DRAW_COMMAND));
+	RefillBuffer(GL_SHADER_STORAGE_BUFFER, m_drawDataBufferID, m_drawDataBufferBytes,
+		&m_drawData[0], m_drawData.size() * sizeof(DRAW_DATA));
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_DATA_BINDING, m_drawDataBufferID);
+}
+
+/***********************************************************
+ *  Draw()
+ *
+ *  This method is used for drawing a run of the uploaded
+ *  draws with one glMultiDrawElementsIndirect call, reading
+ *  the vertices from the shared buffers of the shapes.  The
+ *  shaders number the draws of the call from 0 with
+ *  gl_DrawID, so they must be told the first one.
+ ***********************************************************/
+void IndirectDrawBatch::Draw(int firstDraw, int drawCount) const
+{
+	if ((firstDraw < 0) || (drawCount <= 0) || (firstDraw + drawCount > (int)m_commands.size()))
+	{
+		return;
+	}
+
+	m_pSceneMeshes->BindShapes();
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBufferID);
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+		(const void*)((size_t)firstDraw * sizeof(DRAW_COMMAND)), drawCount, 0);
+}
+
+/***********************************************************
+ *  EndDraws()
+ *
+ *  This method is used for unbinding the shapes and the
+ *  command buffer after the draws.
+ ***********************************************************/
+void IndirectDrawBatch::EndDraws()
+{
+	SceneMeshes::UnbindShapes();
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+/***********************************************************
+ *  GetCount()
+ *
+ *  This method is used for getting the number of draws
+ *  added this frame.
+ ***********************************************************/
+int IndirectDrawBatch::GetCount() const
+{
+	return((int)m_commands.size());
+}
+
+/***********************************************************
+ *  RefillBuffer()
+ *
+ *  This method is used for copying data into a buffer that
+ *  is rewritten every frame.  The buffer is given fresh
+ *  storage first so the copy does not wait on draws still
+ *  reading the last frame, and grows to fit the data.
+ ***********************************************************/
+void IndirectDrawBatch::RefillBuffer(GLenum target, GLuint bufferID, size_t& bufferBytes,
+	const void* data, size_t dataBytes)
+{
+	if (dataBytes > bufferBytes)
+	{
+		bufferBytes = dataBytes;
+		m_pResourceTracker->Resize(GLResourceTracker::RESOURCE_BUFFER, bufferID, bufferBytes);
+	}
+
+	glBindBuffer(target, bufferID);
+	glBufferData(target, (GLsizeiptr)bufferBytes, NULL, GL_STREAM_DRAW);
+	glBufferSubData(target, 0, (GLsizeiptr)dataBytes, data);
+	glBindBuffer(target, 0);
+}
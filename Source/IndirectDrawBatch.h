@@ -0,0 +1,111 @@
+///////////////////////////////////////////////////////////////////////////////
+// indirectdrawbatch.h
+// ============
+// submit the draws of a frame with multi-draw-indirect calls
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneMeshes.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+class GLResourceTracker;
+
+/***********************************************************
+ *  IndirectDrawBatch
+ *
+ *  This class draws the shapes of SceneMeshes straight from
+ *  its shared vertex and index buffers, so any mix of
+ *  shapes is drawn without rebinding vertex state.  Each
+ *  frame the draws are written into an indirect
+ *  command buffer, and the values of each draw into a shader
+ *  storage buffer that the shaders index with gl_DrawID, so
+ *  a run of draws goes out as one glMultiDrawElementsIndirect
+ *  call with no uniforms set between them.
+ ***********************************************************/
+class IndirectDrawBatch
+{
+public:
+	// constructor - the meshes must outlive the batch
+	IndirectDrawBatch(const SceneMeshes* pSceneMeshes, GLResourceTracker* pResourceTracker);
+	// destructor
+	~IndirectDrawBatch();
+
+	// shader storage binding point of the draw values
+	static const GLuint DRAW_DATA_BINDING = 0;
+
+	// values of one draw, laid out as DrawData in the shaders (std430)
+	struct DRAW_DATA
+	{
+		glm::mat4 modelMatrix;
+		// only the upper 3x3 part is read
+		glm::mat4 normalMatrix;
+		glm::vec4 color;
+		// atlas rectangle of a packed texture, offset and size
+		glm::vec4 textureRect;
+		// material colors, with the ambient strength and the shininess in w
+		glm::vec4 ambientColor;
+		glm::vec4 diffuseColor;
+		glm::vec4 specularColor;
+		glm::vec2 UVscale;
+		int32_t textureLayer;
+		// nonzero to sample the texture rather than use the color
+		int32_t bUseTexture;
+	};
+
+	// true when the driver has multi-draw-indirect, storage buffers and gl_DrawID
+	static bool IsSupported();
+	// point the draw values block of a linked program at its binding
+	static bool BindProgram(GLuint programID);
+
+	// remove the draws of the last frame
+	void Clear();
+	// add a draw of a loaded shape and get back its index, or -1
+	int AddDraw(SceneMeshes::MESH_SHAPE shape, const DRAW_DATA& drawData);
+	// write the commands and values of every added draw to the GPU
+	void UploadDraws();
+	// draw a run of the uploaded draws with one call
+	void Draw(int firstDraw, int drawCount) const;
+	// unbind the shapes after the draws
+	static void EndDraws();
+
+	int GetCount() const;
+
+private:
+	// layout of a glMultiDrawElementsIndirect command
+	struct DRAW_COMMAND
+	{
+		GLuint indexCount;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+
+	// shapes drawn from their shared buffers
+	const SceneMeshes* m_pSceneMeshes;
+	// records the command and draw value buffers
+	GLResourceTracker* m_pResourceTracker;
+	GLuint m_commandBufferID;
+	GLuint m_drawDataBufferID;
+	size_t m_commandBufferBytes;
+	size_t m_drawDataBufferBytes;
+	// the draws of the frame
+	std::vector<DRAW_COMMAND> m_commands;
+	std::vector<DRAW_DATA> m_drawData;
+
+	// copy data into a buffer rewritten every frame, growing it to fit
+	void RefillBuffer(GLenum target, GLuint bufferID, size_t& bufferBytes, const void* data, size_t dataBytes);
+
+	// batches own OpenGL objects, so they are not copied
+	IndirectDrawBatch(const IndirectDrawBatch&);
+	IndirectDrawBatch& operator=(const IndirectDrawBatch&);
+};
@@ -0,0 +1,368 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightbuffer.cpp
+// ============
+// keep any number of scene lights in a shader storage buffer
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LightBuffer.h"
+#include "GLResourceTracker.h"
+
+#include <algorithm>
+
+// declaration of global variables
+namespace
+{
+	// lights the buffer has room for at first
+	const int g_InitialLightCount = 64;
+	// name of the lights block in the shaders
+	const char* g_LightBlockName = "LightBuffer";
+}
+
+/***********************************************************
+ *  LightBuffer()
+ *
+ *  The constructor for the class.  The buffer is created
+ *  with room for a few dozen lights, grows as needed, and
+ *  is left bound at its binding point.
+ ***********************************************************/
+LightBuffer::LightBuffer(GLResourceTracker* pResourceTracker)
+{
+	m_pResourceTracker = pResourceTracker;
+	m_bufferID = 0;
+	m_capacity = 0;
+	m_bCountChanged = true;
+	m_uploadedCount = 0;
+
+	if (IsSupported() == true)
+	{
+		glGenBuffers(1, &m_bufferID);
+		m_pResourceTracker->Track(GLResourceTracker::RESOURCE_BUFFER, m_bufferID, 0, "lights");
+		ReserveLights(g_InitialLightCount);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHT_DATA_BINDING, m_bufferID);
+	}
+}
+
+/***********************************************************
+ *  ~LightBuffer()
+ *
+ *  The destructor for the class.
+ ***********************************************************/
+LightBuffer::~LightBuffer()
+{
+	if (m_bufferID != 0)
+	{
+		m_pResourceTracker->Delete(GLResourceTracker::RESOURCE_BUFFER, m_bufferID);
+		m_bufferID = 0;
+	}
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  This method is used for checking that the driver has
+ *  shader storage buffers for the lights.
+ ***********************************************************/
+bool LightBuffer::IsSupported()
+{
+	return(GLEW_ARB_shader_storage_buffer_object == GL_TRUE);
+}
+
+/***********************************************************
+ *  BindProgram()
+ *
+ *  This method is used for pointing the lights block of a
+ *  linked program at the binding the lights are bound to.
+ *  The shaders only declare the block when the driver
+ *  compiled them with storage buffers, and otherwise hold
+ *  a few lights as uniforms.
+ ***********************************************************/
+bool LightBuffer::BindProgram(GLuint programID)
+{
+	if (IsSupported() == false)
+	{
+		return(false);
+	}
+
+	GLuint blockIndex = glGetProgramResourceIndex(programID, GL_SHADER_STORAGE_BLOCK, g_LightBlockName);
+	if (blockIndex == GL_INVALID_INDEX)
+	{
+		return(false);
+	}
+
+	glShaderStorageBlockBinding(programID, blockIndex, LIGHT_DATA_BINDING);
+	return(true);
+}
+
+/***********************************************************
+ *  AddLight()
+ *
+ *  This method is used for adding a light at the end of
+ *  the packed lights.  The ID of a removed light is used
+ *  again before a new one is made.
+ ***********************************************************/
+int LightBuffer::AddLight(const LIGHT_DATA& light)
+{
+	int lightID = (int)m_lightIndices.size();
+	if (m_freeIDs.empty() == false)
+	{
+		lightID = m_freeIDs.back();
+		m_freeIDs.pop_back();
+	}
+	else
+	{
+		m_lightIndices.push_back(-1);
+	}
+
+	int index = (int)m_lights.size();
+	m_lights.push_back(light);
+	m_lightIDs.push_back(lightID);
+	m_bChanged.push_back(false);
+	m_lightIndices[lightID] = index;
+
+	MarkChanged(index);
+	m_bCountChanged = true;
+
+	return(lightID);
+}
+
+/***********************************************************
+ *  UpdateLight()
+ *
+ *  This method is used for changing the values of a light,
+ *  which is written again on the next upload.
+ ***********************************************************/
+bool LightBuffer::UpdateLight(int lightID, const LIGHT_DATA& light)
+{
+	if ((lightID < 0) || (lightID >= (int)m_lightIndices.size()) || (m_lightIndices[lightID] < 0))
+	{
+		return(false);
+	}
+
+	int index = m_lightIndices[lightID];
+	m_lights[index] = light;
+	MarkChanged(index);
+
+	return(true);
+}
+
+/***********************************************************
+ *  RemoveLight()
+ *
+ *  This method is used for removing a light.  The last
+ *  light moves into its place, so only that one place is
+ *  written again along with the count.
+ ***********************************************************/
+bool LightBuffer::RemoveLight(int lightID)
+{
+	if ((lightID < 0) || (lightID >= (int)m_lightIndices.size()) || (m_lightIndices[lightID] < 0))
+	{
+		return(false);
+	}
+
+	int index = m_lightIndices[lightID];
+	int lastIndex = (int)m_lights.size() - 1;
+	if (index != lastIndex)
+	{
+		m_lights[index] = m_lights[lastIndex];
+		m_lightIDs[index] = m_lightIDs[lastIndex];
+		m_lightIndices[m_lightIDs[index]] = index;
+		MarkChanged(index);
+	}
+
+	// the last place is past the count now, so it is never written
+	if (m_bChanged[lastIndex] == true)
+	{
+		m_changedLights.erase(std::find(m_changedLights.begin(), m_changedLights.end(), lastIndex));
+	}
+	m_lights.pop_back();
+	m_lightIDs.pop_back();
+	m_bChanged.pop_back();
+	m_lightIndices[lightID] = -1;
+	m_freeIDs.push_back(lightID);
+	m_bCountChanged = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing every light, which
+ *  only writes the count on the next upload.
+ ***********************************************************/
+void LightBuffer::Clear()
+{
+	m_lights.clear();
+	m_lightIDs.clear();
+	m_lightIndices.clear();
+	m_freeIDs.clear();
+	m_changedLights.clear();
+	m_bChanged.clear();
+	m_bCountChanged = true;
+}
+
+/***********************************************************
+ *  GetLightCount()
+ *
+ *  This method is used for getting the number of lights.
+ ***********************************************************/
+int LightBuffer::GetLightCount() const
+{
+	return((int)m_lights.size());
+}
+
+/***********************************************************
+ *  GetLight()
+ *
+ *  This method is used for getting a light by its place in
+ *  the packed lights, as the shaders see them.
+ ***********************************************************/
+const LightBuffer::LIGHT_DATA& LightBuffer::GetLight(int index) const
+{
+	return(m_lights[index]);
+}
+
+/***********************************************************
+ *  HasChanges()
+ *
+ *  This method is used for checking whether anything has
+ *  to be written on the next upload.
+ ***********************************************************/
+bool LightBuffer::HasChanges() const
+{
+	return((m_bCountChanged == true) || (m_changedLights.empty() == false));
+}
+
+/***********************************************************
+ *  Upload()
+ *
+ *  This method is used for writing the changed lights to
+ *  the buffer, with one copy for each run of neighboring
+ *  changed lights, and the count when it changed.  Without
+ *  a storage buffer the changes are only forgotten.
+ ***********************************************************/
+void LightBuffer::Upload()
+{
+	if (HasChanges() == false)
+	{
+		return;
+	}
+
+	m_uploadedCount = 0;
+	if (m_bufferID != 0)
+	{
+		ReserveLights((int)m_lights.size());
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_bufferID);
+		if (m_bCountChanged == true)
+		{
+			LIGHT_HEADER header;
+			header.lightCount = (int32_t)m_lights.size();
+			header.padding[0] = 0;
+			header.padding[1] = 0;
+			header.padding[2] = 0;
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(header), &header);
+		}
+
+		std::sort(m_changedLights.begin(), m_changedLights.end());
+		size_t first = 0;
+		while (first < m_changedLights.size())
+		{
+			size_t end = first + 1;
+			while ((end < m_changedLights.size()) && (m_changedLights[end] == m_changedLights[end - 1] + 1))
+			{
+				end++;
+			}
+
+			int firstLight = m_changedLights[first];
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+				(GLintptr)(sizeof(LIGHT_HEADER) + (size_t)firstLight * sizeof(LIGHT_DATA)),
+				(GLsizeiptr)((end - first) * sizeof(LIGHT_DATA)), &m_lights[firstLight]);
+			first = end;
+		}
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		m_uploadedCount = (int)m_changedLights.size();
+	}
+
+	for (size_t i = 0; i < m_changedLights.size(); i++)
+	{
+		m_bChanged[m_changedLights[i]] = false;
+	}
+	m_changedLights.clear();
+	m_bCountChanged = false;
+}
+
+/***********************************************************
+ *  GetUploadedCount()
+ *
+ *  This method is used for getting the number of lights
+ *  the last upload with any changes wrote.
+ ***********************************************************/
+int LightBuffer::GetUploadedCount() const
+{
+	return(m_uploadedCount);
+}
+
+/***********************************************************
+ *  HasStorageBuffer()
+ *
+ *  This method is used for checking whether the lights
+ *  reach the shaders through the storage buffer.
+ ***********************************************************/
+bool LightBuffer::HasStorageBuffer() const
+{
+	return(m_bufferID != 0);
+}
+
+/***********************************************************
+ *  MarkChanged()
+ *
+ *  This method is used for listing a place to be written
+ *  on the next upload.
+ ***********************************************************/
+void LightBuffer::MarkChanged(int index)
+{
+	if (m_bChanged[index] == false)
+	{
+		m_bChanged[index] = true;
+		m_changedLights.push_back(index);
+	}
+}
+
+/***********************************************************
+ *  ReserveLights()
+ *
+ *  This method is used for giving the buffer room for a
+ *  number of lights.  The buffer doubles in size when it
+ *  grows, and new storage starts empty, so every light and
+ *  the count are written again.
+ ***********************************************************/
+void LightBuffer::ReserveLights(int lightCount)
+{
+	if (lightCount <= m_capacity)
+	{
+		return;
+	}
+
+	int capacity = (m_capacity > 0) ? m_capacity : g_InitialLightCount;
+	while (capacity < lightCount)
+	{
+		capacity *= 2;
+	}
+	m_capacity = capacity;
+
+	size_t bufferBytes = sizeof(LIGHT_HEADER) + (size_t)m_capacity * sizeof(LIGHT_DATA);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_bufferID);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)bufferBytes, NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	m_pResourceTracker->Resize(GLResourceTracker::RESOURCE_BUFFER, m_bufferID, bufferBytes);
+
+	for (int i = 0; i < (int)m_lights.size(); i++)
+	{
+		MarkChanged(i);
+	}
+	m_bCountChanged = true;
+}
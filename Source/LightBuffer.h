@@ -0,0 +1,122 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightbuffer.h
+// ============
+// keep any number of scene lights in a shader storage buffer
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class GLResourceTracker;
+
+/***********************************************************
+ *  LightBuffer
+ *
+ *  This class holds the lights of the scene packed one
+ *  after another, with the light count in front of them, in
+ *  a shader storage buffer the fragment shader loops over.
+ *  Lights are added, updated and removed through IDs that
+ *  stay the same while other lights come and go, and only
+ *  the lights that changed since the last upload are
+ *  written to the buffer.  Removing a light moves the last
+ *  one into its place, so the lights stay packed.  When the
+ *  driver has no storage buffers the lights are only kept
+ *  on the CPU, for the caller to set some other way.
+ ***********************************************************/
+class LightBuffer
+{
+public:
+	// constructor - must be called with an OpenGL context
+	LightBuffer(GLResourceTracker* pResourceTracker);
+	// destructor
+	~LightBuffer();
+
+	// shader storage binding point of the lights
+	static const GLuint LIGHT_DATA_BINDING = 1;
+
+	// one light, laid out as LightSource in the shaders (std430)
+	struct LIGHT_DATA
+	{
+		glm::vec3 position;
+		float focalStrength;
+		glm::vec3 ambientColor;
+		float specularIntensity;
+		glm::vec3 diffuseColor;
+		// distance the light fades out at, 0 for a light that reaches everywhere
+		float range;
+		glm::vec3 specularColor;
+		float padding;
+	};
+
+	// true when the driver has shader storage buffers
+	static bool IsSupported();
+	// point the lights block of a linked program at its binding
+	static bool BindProgram(GLuint programID);
+
+	// add a light and get back its ID
+	int AddLight(const LIGHT_DATA& light);
+	// change the values of a light, false for an unknown ID
+	bool UpdateLight(int lightID, const LIGHT_DATA& light);
+	// remove a light, false for an unknown ID
+	bool RemoveLight(int lightID);
+	// remove every light
+	void Clear();
+
+	int GetLightCount() const;
+	// light by its place in the buffer, from 0 to GetLightCount() - 1
+	const LIGHT_DATA& GetLight(int index) const;
+
+	// true when a light or the count changed since the last Upload()
+	bool HasChanges() const;
+	// write the changed lights and the count to the buffer
+	void Upload();
+	// lights written by the last Upload() that had changes
+	int GetUploadedCount() const;
+	// false when the lights are only kept on the CPU
+	bool HasStorageBuffer() const;
+
+private:
+	// light count in front of the lights, padded to the light alignment
+	struct LIGHT_HEADER
+	{
+		int32_t lightCount;
+		int32_t padding[3];
+	};
+
+	// records the light buffer
+	GLResourceTracker* m_pResourceTracker;
+	// 0 when the driver has no storage buffers
+	GLuint m_bufferID;
+	// lights the buffer has room for
+	int m_capacity;
+	// the lights, packed
+	std::vector<LIGHT_DATA> m_lights;
+	// ID of the light at each place, and the place of each ID or -1
+	std::vector<int> m_lightIDs;
+	std::vector<int> m_lightIndices;
+	// IDs of removed lights, used again before new ones
+	std::vector<int> m_freeIDs;
+	// places written since the last upload, each listed once
+	std::vector<int> m_changedLights;
+	std::vector<bool> m_bChanged;
+	bool m_bCountChanged;
+	int m_uploadedCount;
+
+	// list a place as changed unless it already is
+	void MarkChanged(int index);
+	// give the buffer room for the lights, marking them all changed if it moves
+	void ReserveLights(int lightCount);
+
+	// buffers are OpenGL objects, so they are not copied
+	LightBuffer(const LightBuffer&);
+	LightBuffer& operator=(const LightBuffer&);
+};
@@ -0,0 +1,639 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightclusters.cpp
+// ============
+// bin the scene lights into a grid of clusters over the view frustum
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LightClusters.h"
+#include "GLResourceTracker.h"
+#include "LightBuffer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__AVX__)
+#define LIGHT_CLUSTERS_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define LIGHT_CLUSTERS_SSE2
+#include <emmintrin.h>
+#endif
+
+// declaration of global variables and the light testing helpers
+namespace
+{
+	// name of the cluster block in the shaders
+	const char* g_ClusterBlockName = "LightClusterBuffer";
+	// position of the spheres padding out the last lanes, which reach nothing
+	const float g_FarAway = 1.0e18f;
+
+	// the sphere test is written once against these wrappers,
+	// which hold eight lights with AVX, four with SSE2 and one
+	// without either
+#if defined(LIGHT_CLUSTERS_AVX)
+	typedef __m256 FLOATS;
+	const int g_Lanes = 8;
+
+	inline FLOATS Load(const float* values) { return(_mm256_loadu_ps(values)); }
+	inline FLOATS Splat(float value) { return(_mm256_set1_ps(value)); }
+	inline FLOATS Add(FLOATS a, FLOATS b) { return(_mm256_add_ps(a, b)); }
+	inline FLOATS Sub(FLOATS a, FLOATS b) { return(_mm256_sub_ps(a, b)); }
+	inline FLOATS Mul(FLOATS a, FLOATS b) { return(_mm256_mul_ps(a, b)); }
+	inline FLOATS Max(FLOATS a, FLOATS b) { return(_mm256_max_ps(a, b)); }
+	inline int LessEqualMask(FLOATS a, FLOATS b) { return(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LE_OQ))); }
+#elif defined(LIGHT_CLUSTERS_SSE2)
+	typedef __m128 FLOATS;
+	const int g_Lanes = 4;
+
+	inline FLOATS Load(const float* values) { return(_mm_loadu_ps(values)); }
+	inline FLOATS Splat(float value) { return(_mm_set1_ps(value)); }
+	inline FLOATS Add(FLOATS a, FLOATS b) { return(_mm_add_ps(a, b)); }
+	inline FLOATS Sub(FLOATS a, FLOATS b) { return(_mm_sub_ps(a, b)); }
+	inline FLOATS Mul(FLOATS a, FLOATS b) { return(_mm_mul_ps(a, b)); }
+	inline FLOATS Max(FLOATS a, FLOATS b) { return(_mm_max_ps(a, b)); }
+	inline int LessEqualMask(FLOATS a, FLOATS b) { return(_mm_movemask_ps(_mm_cmple_ps(a, b))); }
+#else
+	typedef float FLOATS;
+	const int g_Lanes = 1;
+
+	inline FLOATS Load(const float* values) { return(*values); }
+	inline FLOATS Splat(float value) { return(value); }
+	inline FLOATS Add(FLOATS a, FLOATS b) { return(a + b); }
+	inline FLOATS Sub(FLOATS a, FLOATS b) { return(a - b); }
+	inline FLOATS Mul(FLOATS a, FLOATS b) { return(a * b); }
+	inline FLOATS Max(FLOATS a, FLOATS b) { return((a > b) ? a : b); }
+	inline int LessEqualMask(FLOATS a, FLOATS b) { return((a <= b) ? 1 : 0); }
+#endif
+
+	/***********************************************************
+	 *  Unproject()
+	 *
+	 *  Move a point from normalized device coordinates back
+	 *  into view space.
+	 ***********************************************************/
+	inline glm::vec3 Unproject(const glm::mat4& inverseProjection, float x, float y, float z)
+	{
+		glm::vec4 point = inverseProjection * glm::vec4(x, y, z, 1.0f);
+		return(glm::vec3(point) / point.w);
+	}
+}
+
+/***********************************************************
+ *  LightClusters()
+ *
+ *  The constructor for the class.  The cluster buffer is
+ *  created and left bound at its binding point, and the
+ *  worker threads are started and wait for a view to bin.
+ ***********************************************************/
+LightClusters::LightClusters(GLResourceTracker* pResourceTracker, unsigned int threadCount)
+{
+	m_pResourceTracker = pResourceTracker;
+	m_bufferID = 0;
+	m_bufferBytes = 0;
+	m_view = glm::mat4(1.0f);
+	m_projection = glm::mat4(1.0f);
+	m_viewportSize = glm::ivec2(0, 0);
+	m_bBinned = false;
+	m_clusterLightCount = 0;
+	m_binMilliseconds = 0.0;
+	m_nextSlice = 0;
+	m_generation = 0;
+	m_busyWorkers = 0;
+	m_bStopping = false;
+
+	m_boundsMinX.resize(CLUSTER_COUNT);
+	m_boundsMinY.resize(CLUSTER_COUNT);
+	m_boundsMinZ.resize(CLUSTER_COUNT);
+	m_boundsMaxX.resize(CLUSTER_COUNT);
+	m_boundsMaxY.resize(CLUSTER_COUNT);
+	m_boundsMaxZ.resize(CLUSTER_COUNT);
+	m_sliceNear.resize(CLUSTER_COUNT_Z);
+	m_sliceFar.resize(CLUSTER_COUNT_Z);
+	m_slices.resize(CLUSTER_COUNT_Z);
+	m_clusterCounts.resize(CLUSTER_COUNT);
+
+	if (IsSupported() == true)
+	{
+		m_bufferBytes = sizeof(CLUSTER_HEADER) + 2 * CLUSTER_COUNT * sizeof(uint32_t);
+		glGenBuffers(1, &m_bufferID);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_bufferID);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)m_bufferBytes, NULL, GL_STREAM_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTER_DATA_BINDING, m_bufferID);
+		m_pResourceTracker->Track(GLResourceTracker::RESOURCE_BUFFER, m_bufferID, m_bufferBytes, "lights");
+	}
+
+	if (threadCount == 0)
+	{
+		// the calling thread bins slices too
+		threadCount = std::thread::hardware_concurrency();
+		if (threadCount > 1)
+			threadCount--;
+		if (threadCount == 0)
+			threadCount = 1;
+	}
+	threadCount = std::min(threadCount, (unsigned int)CLUSTER_COUNT_Z - 1);
+
+	for (unsigned int i = 0; i < threadCount; i++)
+	{
+		m_workers.push_back(std::thread(&LightClusters::WorkerLoop, this));
+	}
+}
+
+/***********************************************************
+ *  ~LightClusters()
+ *
+ *  The destructor for the class.  The worker threads are
+ *  stopped before the buffer is freed.
+ ***********************************************************/
+LightClusters::~LightClusters()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopping = true;
+	}
+	m_workAvailable.notify_all();
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+
+	if (m_bufferID != 0)
+	{
+		m_pResourceTracker->Delete(GLResourceTracker::RESOURCE_BUFFER, m_bufferID);
+		m_bufferID = 0;
+	}
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  This method is used for checking that the driver has
+ *  shader storage buffers for the cluster lists.
+ ***********************************************************/
+bool LightClusters::IsSupported()
+{
+	return(GLEW_ARB_shader_storage_buffer_object == GL_TRUE);
+}
+
+/***********************************************************
+ *  BindProgram()
+ *
+ *  This method is used for pointing the cluster block of a
+ *  linked program at the binding the cluster lists are
+ *  bound to.
+ ***********************************************************/
+bool LightClusters::BindProgram(GLuint programID)
+{
+	if (IsSupported() == false)
+	{
+		return(false);
+	}
+
+	GLuint blockIndex = glGetProgramResourceIndex(programID, GL_SHADER_STORAGE_BLOCK, g_ClusterBlockName);
+	if (blockIndex == GL_INVALID_INDEX)
+	{
+		return(false);
+	}
+
+	glShaderStorageBlockBinding(programID, blockIndex, CLUSTER_DATA_BINDING);
+	return(true);
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for binning the lights for a view
+ *  and writing the cluster lists.  Nothing is done when
+ *  neither the view nor the lights changed since the last
+ *  lists were written, and the cluster boxes are only
+ *  worked out again when the projection or the viewport
+ *  changed.  The calling thread bins slices along with the
+ *  workers and returns once every slice is done.
+ ***********************************************************/
+bool LightClusters::Update(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	glm::ivec2 viewportSize,
+	const LightBuffer& lights,
+	bool bLightsChanged)
+{
+	if (m_bufferID == 0)
+	{
+		return(false);
+	}
+
+	bool bProjectionChanged = (m_bBinned == false) || (projection != m_projection) || (viewportSize != m_viewportSize);
+	if ((bProjectionChanged == false) && (bLightsChanged == false) && (view == m_view))
+	{
+		return(false);
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if (bProjectionChanged == true)
+	{
+		ComputeClusterBounds(projection, viewportSize);
+	}
+	m_view = view;
+	m_projection = projection;
+	m_viewportSize = viewportSize;
+	m_bBinned = true;
+
+	GatherLights(view, lights);
+
+	// wake the workers and bin alongside them
+	m_nextSlice = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_generation++;
+		m_busyWorkers = (unsigned int)m_workers.size();
+	}
+	m_workAvailable.notify_all();
+	BinSlices();
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (m_busyWorkers > 0)
+		{
+			m_workDone.wait(lock);
+		}
+	}
+
+	UploadClusters();
+	std::chrono::duration<double, std::milli> binTime = std::chrono::steady_clock::now() - start;
+	m_binMilliseconds = binTime.count();
+
+	return(true);
+}
+
+/***********************************************************
+ *  Invalidate()
+ *
+ *  This method is used for binning the lights again on the
+ *  next Update(), such as after updates were skipped while
+ *  the lights changed.
+ ***********************************************************/
+void LightClusters::Invalidate()
+{
+	m_bBinned = false;
+}
+
+/***********************************************************
+ *  GetClusterLightCount()
+ *
+ *  This method is used for getting the number of light
+ *  entries in the cluster lists last written, not counting
+ *  the lights with no range.
+ ***********************************************************/
+int LightClusters::GetClusterLightCount() const
+{
+	return(m_clusterLightCount);
+}
+
+/***********************************************************
+ *  GetBinMilliseconds()
+ *
+ *  This method is used for getting the time the last
+ *  Update() that binned the lights took, including the
+ *  upload.
+ ***********************************************************/
+double LightClusters::GetBinMilliseconds() const
+{
+	return(m_binMilliseconds);
+}
+
+/***********************************************************
+ *  GetThreadCount()
+ *
+ *  This method is used for getting the number of worker
+ *  threads binning besides the calling thread.
+ ***********************************************************/
+unsigned int LightClusters::GetThreadCount() const
+{
+	return((unsigned int)m_workers.size());
+}
+
+/***********************************************************
+ *  GetKernelName()
+ *
+ *  This method is used for getting the name of the
+ *  instruction set the lights are tested with.
+ ***********************************************************/
+const char* LightClusters::GetKernelName()
+{
+#if defined(LIGHT_CLUSTERS_AVX)
+	return("AVX");
+#elif defined(LIGHT_CLUSTERS_SSE2)
+	return("SSE2");
+#else
+	return("scalar");
+#endif
+}
+
+/***********************************************************
+ *  ComputeClusterBounds()
+ *
+ *  This method is used for working out the view space box
+ *  around every cluster.  The depth range of the view is
+ *  split into slices that grow by the same ratio each, so
+ *  the clusters stay about as deep as they are wide.  The
+ *  corners of each screen tile are taken back through the
+ *  projection to the near and far planes, and the edges
+ *  between them are cut at the depths of each slice, which
+ *  works for perspective and orthographic projections
+ *  alike.  The values the shaders need to find the cluster
+ *  of a fragment are kept for the header.
+ ***********************************************************/
+void LightClusters::ComputeClusterBounds(const glm::mat4& projection, glm::ivec2 viewportSize)
+{
+	glm::mat4 inverseProjection = glm::inverse(projection);
+	float nearDepth = -Unproject(inverseProjection, 0.0f, 0.0f, -1.0f).z;
+	float farDepth = -Unproject(inverseProjection, 0.0f, 0.0f, 1.0f).z;
+	nearDepth = std::max(nearDepth, 0.001f);
+	farDepth = std::max(farDepth, nearDepth * 2.0f);
+
+	float depthRatio = farDepth / nearDepth;
+	for (int slice = 0; slice < CLUSTER_COUNT_Z; slice++)
+	{
+		m_sliceNear[slice] = nearDepth * powf(depthRatio, (float)slice / CLUSTER_COUNT_Z);
+		m_sliceFar[slice] = nearDepth * powf(depthRatio, (float)(slice + 1) / CLUSTER_COUNT_Z);
+	}
+
+	for (int y = 0; y < CLUSTER_COUNT_Y; y++)
+	{
+		for (int x = 0; x < CLUSTER_COUNT_X; x++)
+		{
+			// the tile corners on the near and far planes
+			glm::vec3 nearCorners[4];
+			glm::vec3 farCorners[4];
+			for (int corner = 0; corner < 4; corner++)
+			{
+				float ndcX = -1.0f + 2.0f * (float)(x + (corner & 1)) / CLUSTER_COUNT_X;
+				float ndcY = -1.0f + 2.0f * (float)(y + (corner >> 1)) / CLUSTER_COUNT_Y;
+				nearCorners[corner] = Unproject(inverseProjection, ndcX, ndcY, -1.0f);
+				farCorners[corner] = Unproject(inverseProjection, ndcX, ndcY, 1.0f);
+			}
+
+			for (int slice = 0; slice < CLUSTER_COUNT_Z; slice++)
+			{
+				glm::vec3 boundsMin(g_FarAway);
+				glm::vec3 boundsMax(-g_FarAway);
+				for (int corner = 0; corner < 4; corner++)
+				{
+					glm::vec3 edge = farCorners[corner] - nearCorners[corner];
+					float nearT = (-m_sliceNear[slice] - nearCorners[corner].z) / edge.z;
+					float farT = (-m_sliceFar[slice] - nearCorners[corner].z) / edge.z;
+					glm::vec3 nearPoint = nearCorners[corner] + edge * nearT;
+					glm::vec3 farPoint = nearCorners[corner] + edge * farT;
+					boundsMin = glm::min(boundsMin, glm::min(nearPoint, farPoint));
+					boundsMax = glm::max(boundsMax, glm::max(nearPoint, farPoint));
+				}
+
+				int cluster = x + CLUSTER_COUNT_X * (y + CLUSTER_COUNT_Y * slice);
+				m_boundsMinX[cluster] = boundsMin.x;
+				m_boundsMinY[cluster] = boundsMin.y;
+				m_boundsMinZ[cluster] = boundsMin.z;
+				m_boundsMaxX[cluster] = boundsMax.x;
+				m_boundsMaxY[cluster] = boundsMax.y;
+				m_boundsMaxZ[cluster] = boundsMax.z;
+			}
+		}
+	}
+
+	// the shaders find the slice from the log of the depth
+	float logRatio = logf(depthRatio);
+	m_header.clusterGrid[0] = CLUSTER_COUNT_X;
+	m_header.clusterGrid[1] = CLUSTER_COUNT_Y;
+	m_header.clusterGrid[2] = CLUSTER_COUNT_Z;
+	m_header.clusterGrid[3] = 0;
+	m_header.clusterDepth[0] = nearDepth;
+	m_header.clusterDepth[1] = farDepth;
+	m_header.clusterDepth[2] = CLUSTER_COUNT_Z / logRatio;
+	m_header.clusterDepth[3] = -CLUSTER_COUNT_Z * logf(nearDepth) / logRatio;
+	m_header.clusterTile[0] = (float)viewportSize.x / CLUSTER_COUNT_X;
+	m_header.clusterTile[1] = (float)viewportSize.y / CLUSTER_COUNT_Y;
+	m_header.clusterTile[2] = 0.0f;
+	m_header.clusterTile[3] = 0.0f;
+}
+
+/***********************************************************
+ *  GatherLights()
+ *
+ *  This method is used for moving the bounded lights into
+ *  view space as spheres, one array per component, and
+ *  listing the lights with no range apart.
+ ***********************************************************/
+void LightClusters::GatherLights(const glm::mat4& view, const LightBuffer& lights)
+{
+	m_lightX.clear();
+	m_lightY.clear();
+	m_lightZ.clear();
+	m_lightRadius.clear();
+	m_lightIndices.clear();
+	m_globalLights.clear();
+
+	for (int i = 0; i < lights.GetLightCount(); i++)
+	{
+		const LightBuffer::LIGHT_DATA& light = lights.GetLight(i);
+		if (light.range <= 0.0f)
+		{
+			m_globalLights.push_back((uint32_t)i);
+			continue;
+		}
+
+		glm::vec4 position = view * glm::vec4(light.position, 1.0f);
+		m_lightX.push_back(position.x);
+		m_lightY.push_back(position.y);
+		m_lightZ.push_back(position.z);
+		m_lightRadius.push_back(light.range);
+		m_lightIndices.push_back((uint32_t)i);
+	}
+}
+
+/***********************************************************
+ *  BinSlices()
+ *
+ *  This method is used for taking depth slices to bin one
+ *  at a time until every slice of the view is taken.
+ ***********************************************************/
+void LightClusters::BinSlices()
+{
+	int slice = m_nextSlice.fetch_add(1);
+	while (slice < CLUSTER_COUNT_Z)
+	{
+		BinSlice(slice);
+		slice = m_nextSlice.fetch_add(1);
+	}
+}
+
+/***********************************************************
+ *  BinSlice()
+ *
+ *  This method is used for listing the lights reaching each
+ *  cluster of one depth slice.  The lights that reach the
+ *  depth range of the slice are picked out first, and the
+ *  spheres of those are then tested against the box of
+ *  every cluster of the slice a full register of lights at
+ *  a time, taking the squared distance from each center to
+ *  the box.  A slice only writes its own lists and counts,
+ *  so the slices are binned in parallel without locking.
+ ***********************************************************/
+void LightClusters::BinSlice(int slice)
+{
+	SLICE_LIGHTS& sliceLights = m_slices[slice];
+	sliceLights.x.clear();
+	sliceLights.y.clear();
+	sliceLights.z.clear();
+	sliceLights.radius.clear();
+	sliceLights.lights.clear();
+	sliceLights.clusterLights.clear();
+
+	for (size_t i = 0; i < m_lightIndices.size(); i++)
+	{
+		float depth = -m_lightZ[i];
+		if ((depth + m_lightRadius[i] >= m_sliceNear[slice]) && (depth - m_lightRadius[i] <= m_sliceFar[slice]))
+		{
+			sliceLights.x.push_back(m_lightX[i]);
+			sliceLights.y.push_back(m_lightY[i]);
+			sliceLights.z.push_back(m_lightZ[i]);
+			sliceLights.radius.push_back(m_lightRadius[i]);
+			sliceLights.lights.push_back(m_lightIndices[i]);
+		}
+	}
+
+	// the padding spheres are too far away to reach any cluster
+	while ((sliceLights.x.size() % g_Lanes) != 0)
+	{
+		sliceLights.x.push_back(g_FarAway);
+		sliceLights.y.push_back(g_FarAway);
+		sliceLights.z.push_back(g_FarAway);
+		sliceLights.radius.push_back(0.0f);
+		sliceLights.lights.push_back(0);
+	}
+
+	const FLOATS zero = Splat(0.0f);
+	const size_t lightCount = sliceLights.x.size();
+	const int firstCluster = slice * CLUSTER_COUNT_X * CLUSTER_COUNT_Y;
+	for (int cluster = firstCluster; cluster < firstCluster + CLUSTER_COUNT_X * CLUSTER_COUNT_Y; cluster++)
+	{
+		const FLOATS minX = Splat(m_boundsMinX[cluster]);
+		const FLOATS minY = Splat(m_boundsMinY[cluster]);
+		const FLOATS minZ = Splat(m_boundsMinZ[cluster]);
+		const FLOATS maxX = Splat(m_boundsMaxX[cluster]);
+		const FLOATS maxY = Splat(m_boundsMaxY[cluster]);
+		const FLOATS maxZ = Splat(m_boundsMaxZ[cluster]);
+		size_t firstEntry = sliceLights.clusterLights.size();
+
+		for (size_t i = 0; i < lightCount; i += g_Lanes)
+		{
+			FLOATS x = Load(&sliceLights.x[i]);
+			FLOATS y = Load(&sliceLights.y[i]);
+			FLOATS z = Load(&sliceLights.z[i]);
+			FLOATS radius = Load(&sliceLights.radius[i]);
+
+			// distance along each axis from the center to the box, 0 inside it
+			FLOATS dx = Max(Max(Sub(minX, x), Sub(x, maxX)), zero);
+			FLOATS dy = Max(Max(Sub(minY, y), Sub(y, maxY)), zero);
+			FLOATS dz = Max(Max(Sub(minZ, z), Sub(z, maxZ)), zero);
+			FLOATS distanceSquared = Add(Add(Mul(dx, dx), Mul(dy, dy)), Mul(dz, dz));
+
+			int mask = LessEqualMask(distanceSquared, Mul(radius, radius));
+			for (int lane = 0; mask != 0; lane++, mask >>= 1)
+			{
+				if ((mask & 1) != 0)
+				{
+					sliceLights.clusterLights.push_back(sliceLights.lights[i + lane]);
+				}
+			}
+		}
+
+		m_clusterCounts[cluster] = (uint32_t)(sliceLights.clusterLights.size() - firstEntry);
+	}
+}
+
+/***********************************************************
+ *  UploadClusters()
+ *
+ *  This method is used for joining the lists of the slices
+ *  behind the offset and count of every cluster and the
+ *  lights with no range, and writing them to the buffer
+ *  after the header.  The buffer is given fresh storage
+ *  first so the copy does not wait on draws still reading
+ *  the last lists, and grows to fit.
+ ***********************************************************/
+void LightClusters::UploadClusters()
+{
+	m_clusterData.resize(2 * CLUSTER_COUNT);
+	m_clusterData.insert(m_clusterData.end(), m_globalLights.begin(), m_globalLights.end());
+	m_header.clusterGrid[3] = (uint32_t)m_globalLights.size();
+
+	m_clusterLightCount = 0;
+	for (int slice = 0; slice < CLUSTER_COUNT_Z; slice++)
+	{
+		const int firstCluster = slice * CLUSTER_COUNT_X * CLUSTER_COUNT_Y;
+		uint32_t offset = (uint32_t)m_clusterData.size();
+		for (int cluster = firstCluster; cluster < firstCluster + CLUSTER_COUNT_X * CLUSTER_COUNT_Y; cluster++)
+		{
+			m_clusterData[2 * cluster] = offset;
+			m_clusterData[2 * cluster + 1] = m_clusterCounts[cluster];
+			offset += m_clusterCounts[cluster];
+		}
+
+		const std::vector<uint32_t>& clusterLights = m_slices[slice].clusterLights;
+		m_clusterData.insert(m_clusterData.end(), clusterLights.begin(), clusterLights.end());
+		m_clusterLightCount += (int)clusterLights.size();
+	}
+
+	size_t dataBytes = sizeof(CLUSTER_HEADER) + m_clusterData.size() * sizeof(uint32_t);
+	if (dataBytes > m_bufferBytes)
+	{
+		m_bufferBytes = std::max(dataBytes, m_bufferBytes * 2);
+		m_pResourceTracker->Resize(GLResourceTracker::RESOURCE_BUFFER, m_bufferID, m_bufferBytes);
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_bufferID);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)m_bufferBytes, NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(CLUSTER_HEADER), &m_header);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(CLUSTER_HEADER),
+		(GLsizeiptr)(m_clusterData.size() * sizeof(uint32_t)), &m_clusterData[0]);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  This method is run by every worker thread.  It waits for
+ *  Update() to start a new generation, bins slices until
+ *  none are left, and reports back.
+ ***********************************************************/
+void LightClusters::WorkerLoop()
+{
+	unsigned int generation = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while ((m_bStopping == false) && (m_generation == generation))
+			{
+				m_workAvailable.wait(lock);
+			}
+			if (m_bStopping == true)
+			{
+				return;
+			}
+			generation = m_generation;
+		}
+
+		BinSlices();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_busyWorkers--;
+		}
+		m_workDone.notify_one();
+	}
+}
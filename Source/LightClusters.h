@@ -0,0 +1,175 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightclusters.h
+// ============
+// bin the scene lights into a grid of clusters over the view frustum
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class GLResourceTracker;
+class LightBuffer;
+
+/***********************************************************
+ *  LightClusters
+ *
+ *  This class splits the view frustum into a grid of
+ *  clusters, tiles across the screen and slices in depth
+ *  that grow with distance, and lists the lights that reach
+ *  each cluster, so the fragment shader only loops over the
+ *  lights of the cluster it falls in.  Each frame the
+ *  bounded lights are moved into view space and tested as
+ *  spheres against the box around every cluster, several
+ *  lights at once with AVX or SSE2 when the compiler
+ *  targets them.  The depth slices are shared out between
+ *  the calling thread and a pool of worker threads.  Lights
+ *  with no range reach every cluster and are listed once.
+ *  The lists are written to a shader storage buffer, after
+ *  the grid size and the values that find a cluster from a
+ *  fragment.
+ ***********************************************************/
+class LightClusters
+{
+public:
+	// constructor - must be called with an OpenGL context, zero threads picks a count from the hardware
+	LightClusters(GLResourceTracker* pResourceTracker, unsigned int threadCount = 0);
+	// destructor
+	~LightClusters();
+
+	// shader storage binding point of the cluster lists
+	static const GLuint CLUSTER_DATA_BINDING = 2;
+	// clusters across, down and deep
+	static const int CLUSTER_COUNT_X = 16;
+	static const int CLUSTER_COUNT_Y = 12;
+	static const int CLUSTER_COUNT_Z = 24;
+	static const int CLUSTER_COUNT = CLUSTER_COUNT_X * CLUSTER_COUNT_Y * CLUSTER_COUNT_Z;
+
+	// true when the driver has shader storage buffers
+	static bool IsSupported();
+	// point the cluster block of a linked program at its binding
+	static bool BindProgram(GLuint programID);
+
+	// bin the lights for a view and write the lists, false when nothing changed
+	bool Update(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		glm::ivec2 viewportSize,
+		const LightBuffer& lights,
+		bool bLightsChanged);
+	// bin again on the next Update() even when nothing changed
+	void Invalidate();
+
+	// light entries of every cluster in the last lists written
+	int GetClusterLightCount() const;
+	// time the last Update() that binned took
+	double GetBinMilliseconds() const;
+	// threads binning besides the calling thread
+	unsigned int GetThreadCount() const;
+	// name of the instruction set the lights are tested with
+	static const char* GetKernelName();
+
+private:
+	// grid size and cluster lookup values in front of the lists (std430)
+	struct CLUSTER_HEADER
+	{
+		// clusters across, down and deep, and the count of lights with no range
+		uint32_t clusterGrid[4];
+		// near and far depth, and the scale and bias from log depth to slice
+		float clusterDepth[4];
+		// size of a cluster on screen in pixels
+		float clusterTile[4];
+	};
+
+	// the lights reaching one depth slice, and the lists of its clusters
+	struct SLICE_LIGHTS
+	{
+		// view space spheres, padded to a whole number of lanes
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+		std::vector<float> radius;
+		std::vector<uint32_t> lights;
+		// light indices of the clusters of the slice, one after another
+		std::vector<uint32_t> clusterLights;
+	};
+
+	// records the cluster buffer
+	GLResourceTracker* m_pResourceTracker;
+	// 0 when the driver has no storage buffers
+	GLuint m_bufferID;
+	size_t m_bufferBytes;
+	// view the lists were last binned for
+	glm::mat4 m_view;
+	glm::mat4 m_projection;
+	glm::ivec2 m_viewportSize;
+	bool m_bBinned;
+	// view space box around each cluster, with the depth range of each slice
+	std::vector<float> m_boundsMinX;
+	std::vector<float> m_boundsMinY;
+	std::vector<float> m_boundsMinZ;
+	std::vector<float> m_boundsMaxX;
+	std::vector<float> m_boundsMaxY;
+	std::vector<float> m_boundsMaxZ;
+	std::vector<float> m_sliceNear;
+	std::vector<float> m_sliceFar;
+	CLUSTER_HEADER m_header;
+	// bounded lights as view space spheres, and the lights with no range
+	std::vector<float> m_lightX;
+	std::vector<float> m_lightY;
+	std::vector<float> m_lightZ;
+	std::vector<float> m_lightRadius;
+	std::vector<uint32_t> m_lightIndices;
+	std::vector<uint32_t> m_globalLights;
+	// binned lights by slice
+	std::vector<SLICE_LIGHTS> m_slices;
+	// light entries of each cluster
+	std::vector<uint32_t> m_clusterCounts;
+	// offset and count of each cluster, then the light indices, as uploaded
+	std::vector<uint32_t> m_clusterData;
+	int m_clusterLightCount;
+	double m_binMilliseconds;
+
+	// worker threads that bin the slices along with the calling thread
+	std::vector<std::thread> m_workers;
+	// next slice to bin
+	std::atomic<int> m_nextSlice;
+	// bumped for every Update() that bins, which wakes the workers
+	unsigned int m_generation;
+	// workers still binning the slices of this generation
+	unsigned int m_busyWorkers;
+	// set when the pool is shutting down
+	bool m_bStopping;
+	std::mutex m_mutex;
+	std::condition_variable m_workAvailable;
+	std::condition_variable m_workDone;
+
+	// work out the box around every cluster for a projection and viewport
+	void ComputeClusterBounds(const glm::mat4& projection, glm::ivec2 viewportSize);
+	// move the lights into view space
+	void GatherLights(const glm::mat4& view, const LightBuffer& lights);
+	// bin slices until none are left
+	void BinSlices();
+	// list the lights reaching each cluster of one depth slice
+	void BinSlice(int slice);
+	// join the slice lists and write them to the buffer
+	void UploadClusters();
+	// loop run by each of the worker threads
+	void WorkerLoop();
+
+	// clusters own OpenGL objects and threads, so they are not copied
+	LightClusters(const LightClusters&);
+	LightClusters& operator=(const LightClusters&);
+};
@@ -1,5 +1,8 @@
 #include <iostream>         // error handling and output
 #include <cstdlib>          // EXIT_FAILURE
+#include <cstring>          // strcmp
+#include <chrono>           // time to first frame
+#include <string>           // asset pack path
 
 #include <GL/glew.h>        // GLEW library
 #include "GLFW/glfw3.h"     // GLFW library
@@ -9,6 +12,9 @@
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "AssetPack.h"
+#include "FrameProfiler.h"
+#include "GLStateCache.h"
 #include "SceneManager.h"
 #include "ViewManager.h"
 #include "ShapeMeshes.h"
@@ -35,6 +41,7 @@ namespace
 // need to be pre-declared at the beginning of the source code.
 bool InitializeGLFW();
 bool InitializeGLEW();
+bool LoadPackedShaders(const AssetPack& assetPack);
 
 
 /***********************************************************
@@ -45,6 +52,118 @@ bool InitializeGLEW();
  ***********************************************************/
 int main(int argc, char* argv[])
 {
+	bool bPackTextures = false;
+	bool bStreamTextures = true;
+	bool bSamplerBenchmark = false;
+	bool bUseAssetPack = true;
+	bool bUseInstancing = true;
+	bool bUseIndirectDraws = false;
+	bool bUniformBenchmark = false;
+	bool bLightBenchmark = false;
+	const char* buildPackFilename = NULL;
+	const char* sceneFilename = NULL;
+	size_t textureBudgetBytes = 0;
+	TextureCompressor::BLOCK_FORMAT textureCompression = TextureCompressor::BLOCK_FORMAT_NONE;
+
+	// report the texture decode speedup of the worker pool
+	// when launched with the --texture-benchmark option
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--texture-benchmark") == 0)
+		{
+			SceneManager::BenchmarkTextureDecoding();
+		}
+		// report the speedup of composing model matrices in a batch
+		else if (strcmp(argv[i], "--transform-benchmark") == 0)
+		{
+			SceneManager::BenchmarkTransforms();
+		}
+		// report the time to load a large binary scene file
+		else if (strcmp(argv[i], "--scene-benchmark") == 0)
+		{
+			SceneManager::BenchmarkSceneLoading();
+		}
+		// draw the layout from a text or binary scene file
+		else if ((strcmp(argv[i], "--scene") == 0) && (i + 1 < argc))
+		{
+			sceneFilename = argv[++i];
+		}
+		// pack the scene textures into texture arrays
+		else if (strcmp(argv[i], "--texture-arrays") == 0)
+		{
+			bPackTextures = true;
+		}
+		// time the scene with each sampler preset in turn
+		else if (strcmp(argv[i], "--sampler-benchmark") == 0)
+		{
+			bSamplerBenchmark = true;
+		}
+		// upload every scene texture before the first frame
+		else if (strcmp(argv[i], "--no-texture-streaming") == 0)
+		{
+			bStreamTextures = false;
+		}
+		// block compress the scene textures as they are loaded
+		else if ((strcmp(argv[i], "--compress-textures") == 0) && (i + 1 < argc))
+		{
+			textureCompression = TextureCompressor::ParseFormatName(argv[++i]);
+		}
+		// keep the scene textures within a GPU memory budget in MB
+		else if ((strcmp(argv[i], "--texture-budget") == 0) && (i + 1 < argc))
+		{
+			textureBudgetBytes = (size_t)(atof(argv[++i]) * 1024.0 * 1024.0);
+		}
+		// compress every texture image ahead of time and exit
+		else if ((strcmp(argv[i], "--compress-textures-offline") == 0) && (i + 1 < argc))
+		{
+			SceneManager::CompressSceneTextures(TextureCompressor::ParseFormatName(argv[++i]));
+			return(EXIT_SUCCESS);
+		}
+		// write the textures, meshes and shaders into an asset pack and exit
+		else if ((strcmp(argv[i], "--build-asset-pack") == 0) && (i + 1 < argc))
+		{
+			buildPackFilename = argv[++i];
+		}
+		// load the scene assets from their own files
+		else if (strcmp(argv[i], "--no-asset-pack") == 0)
+		{
+			bUseAssetPack = false;
+		}
+		// draw every object on its own, without instanced draws
+		else if (strcmp(argv[i], "--no-instancing") == 0)
+		{
+			bUseInstancing = false;
+		}
+		// time setting the draw uniforms by name and by handle
+		else if (strcmp(argv[i], "--uniform-benchmark") == 0)
+		{
+			bUniformBenchmark = true;
+		}
+		// submit the scene with multi-draw-indirect calls
+		else if (strcmp(argv[i], "--multi-draw-indirect") == 0)
+		{
+			bUseIndirectDraws = true;
+		}
+		// time the frame as desk lamps are added, with and without light clusters
+		else if (strcmp(argv[i], "--light-benchmark") == 0)
+		{
+			bLightBenchmark = true;
+		}
+	}
+
+	// built after all options are read so the pack uses --compress-textures
+	if (NULL != buildPackFilename)
+	{
+		if (SceneManager::BuildAssetPack(buildPackFilename, textureCompression) == false)
+		{
+			return(EXIT_FAILURE);
+		}
+		return(EXIT_SUCCESS);
+	}
+
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	bool bFirstFrame = true;
+
 	// if GLFW fails initialization, then terminate the application
 	if (InitializeGLFW() == false)
 	{
@@ -66,47 +185,277 @@ int main(int argc, char* argv[])
 		return(EXIT_FAILURE);
 	}
 
-	// load the shader code from the external GLSL files
-	g_ShaderManager->LoadShaders(
-		"../../../Utilities/shaders/vertexShader.glsl",
-		"../../../Utilities/shaders/fragmentShader.glsl");
+	// map the asset pack when one sits next to the executable
+	AssetPack* pAssetPack = NULL;
+	std::string packFilename;
+	if (bUseAssetPack == true)
+	{
+		packFilename = AssetPack::FindPackFile("assets.pack");
+	}
+	if (packFilename.empty() == false)
+	{
+		pAssetPack = new AssetPack();
+		if (pAssetPack->Open(packFilename) == true)
+		{
+			std::cout << "INFO: Mapped asset pack " << packFilename << " with " << pAssetPack->GetEntryCount()
+				<< " assets (" << pAssetPack->GetSize() / 1024 << " KB)" << std::endl;
+		}
+		else
+		{
+			delete pAssetPack;
+			pAssetPack = NULL;
+		}
+	}
+
+	// compile the shader code from the pack, or from the external GLSL files
+	if ((NULL == pAssetPack) || (LoadPackedShaders(*pAssetPack) == false))
+	{
+		g_ShaderManager->LoadShaders(
+			"shaders/vertexShader.glsl",
+			"shaders/fragmentShader.glsl");
+	}
 	g_ShaderManager->use();
 
 	// try to create a new scene manager object and prepare the 3D scene
 	g_SceneManager = new SceneManager(g_ShaderManager);
+	g_SceneManager->SetTexturePacking(bPackTextures);
+	g_SceneManager->SetTextureCompression(textureCompression);
+	g_SceneManager->SetTextureStreaming(bStreamTextures);
+	g_SceneManager->SetTextureBudget(textureBudgetBytes);
+	g_SceneManager->SetAssetPack(pAssetPack);
+	g_SceneManager->SetInstancing(bUseInstancing);
+	g_SceneManager->SetIndirectDraws(bUseIndirectDraws);
 	g_SceneManager->PrepareScene();
+	// the frame values buffer is counted with the scene's resources
+	g_ViewManager->SetResourceTracker(g_SceneManager->GetResourceTracker());
+	if (NULL != sceneFilename)
+	{
+		g_SceneManager->LoadSceneFile(sceneFilename);
+	}
+	if (bUniformBenchmark == true)
+	{
+		g_SceneManager->BenchmarkUniformUpdates();
+	}
+
+	// the sampler and light benchmarks time frames with vsync off
+	FrameProfiler* pFrameProfiler = NULL;
+	int benchmarkPreset = -1;
+	// lights of the light benchmark, 0 when it is not running
+	int benchmarkLights = 0;
+	bool bBenchmarkClusters = true;
+	int lastTransformRecomputes = -1;
+	int lastStateChanges = -1;
+	int lastDrawCalls = -1;
+	int lastUniformWrites = -1;
+	int lastStateWrites = -1;
+	int lastLightUploads = -1;
+	// the depth test and clear color are set every frame, and
+	// only reach the driver when they change
+	GLStateCache stateCache;
+	bool bReloadKeyDown = false;
+	if ((bSamplerBenchmark == true) || (bLightBenchmark == true))
+	{
+		pFrameProfiler = new FrameProfiler();
+		glfwSwapInterval(0);
+	}
 
 	// loop will keep running until the application is closed 
 	// or until an error has occurred
 	while (!glfwWindowShouldClose(g_Window))
 	{
+		stateCache.ResetCounts();
+
 		// Enable z-depth
-		glEnable(GL_DEPTH_TEST);
+		stateCache.SetCapability(GL_DEPTH_TEST, true);
 
 		// Clear the frame and z buffers
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		stateCache.SetClearColor(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 		// convert from 3D object space to 2D view
 		g_ViewManager->PrepareSceneView();
 
+		// swap in any streamed textures that have arrived
+		g_SceneManager->UpdateTextureStreaming();
+
+		// F5 loads the scene file again, once per key press, so
+		// an edited or replaced layout shows without restarting
+		bool bReloadKeyPressed = (glfwGetKey(g_Window, GLFW_KEY_F5) == GLFW_PRESS);
+		if ((NULL != sceneFilename) && (bReloadKeyPressed == true) && (bReloadKeyDown == false))
+		{
+			g_SceneManager->LoadSceneFile(sceneFilename);
+		}
+		bReloadKeyDown = bReloadKeyPressed;
+
+		// start the benchmark once every texture has arrived
+		if ((NULL != pFrameProfiler) && (benchmarkPreset < 0) && (benchmarkLights == 0) &&
+			(g_SceneManager->IsStreamingTextures() == false))
+		{
+			if (bSamplerBenchmark == true)
+			{
+				benchmarkPreset = SamplerCache::SAMPLER_BILINEAR;
+				g_SceneManager->SetSamplerOverride(benchmarkPreset);
+			}
+			else
+			{
+				benchmarkLights = 4;
+				bBenchmarkClusters = true;
+				g_SceneManager->SetBenchmarkLights(benchmarkLights);
+				g_SceneManager->SetLightClusters(bBenchmarkClusters);
+			}
+			pFrameProfiler->Reset();
+		}
+		if ((benchmarkPreset >= 0) || (benchmarkLights > 0))
+		{
+			pFrameProfiler->BeginFrame();
+		}
+
 		// refresh the 3D scene
+		g_SceneManager->SetCameraView(g_ViewManager->GetCameraPosition(), g_ViewManager->GetFocalLengthPixels());
+		g_SceneManager->SetViewFrustum(g_ViewManager->GetFrameUniforms()->GetFrameData().view,
+			g_ViewManager->GetFrameUniforms()->GetFrameData().projection, g_ViewManager->GetViewportSize());
 		g_SceneManager->RenderScene();
 
+		// report the matrix work whenever it changes, so a still scene logs zero once
+		if (g_SceneManager->GetTransformRecomputeCount() != lastTransformRecomputes)
+		{
+			lastTransformRecomputes = g_SceneManager->GetTransformRecomputeCount();
+			std::cout << "INFO: Transform recomputes this frame: " << lastTransformRecomputes << std::endl;
+		}
+		// report the state changes of the sorted draws the same way
+		if (g_SceneManager->GetStateChangeCount() != lastStateChanges)
+		{
+			lastStateChanges = g_SceneManager->GetStateChangeCount();
+			std::cout << "INFO: State changes this frame: " << lastStateChanges << ", saved by the render queue: "
+				<< g_SceneManager->GetSavedStateChangeCount() << std::endl;
+		}
+		// and the draw calls left once repeated objects are instanced
+		if (g_SceneManager->GetDrawCallCount() != lastDrawCalls)
+		{
+			lastDrawCalls = g_SceneManager->GetDrawCallCount();
+			std::cout << "INFO: Draw calls this frame: " << lastDrawCalls << std::endl;
+		}
+		// and the uniform and state writes that changed anything
+		if (g_SceneManager->GetUniformWriteCount() != lastUniformWrites)
+		{
+			lastUniformWrites = g_SceneManager->GetUniformWriteCount();
+			std::cout << "INFO: Uniform writes this frame: " << lastUniformWrites << ", dropped as unchanged: "
+				<< g_SceneManager->GetElidedUniformWriteCount() << std::endl;
+		}
+		if (g_SceneManager->GetLightUploadCount() != lastLightUploads)
+		{
+			lastLightUploads = g_SceneManager->GetLightUploadCount();
+			std::cout << "INFO: Lights written to the light buffer: " << lastLightUploads << " of "
+				<< g_SceneManager->GetLightCount() << std::endl;
+		}
+		if (stateCache.GetIssuedCount() != lastStateWrites)
+		{
+			lastStateWrites = stateCache.GetIssuedCount();
+			std::cout << "INFO: State writes this frame: " << lastStateWrites << ", dropped as unchanged: "
+				<< stateCache.GetElidedCount() << std::endl;
+		}
+
+		// fit the textures drawn this frame within the budget
+		g_SceneManager->UpdateTextureResidency();
+
+		if (benchmarkPreset >= 0)
+		{
+			pFrameProfiler->EndFrame();
+			if (pFrameProfiler->GetFrameCount() >= 500)
+			{
+				std::cout << "INFO: Sampler " << SamplerCache::GetPresetName((SamplerCache::SAMPLER_PRESET)benchmarkPreset)
+					<< ": frame " << pFrameProfiler->GetAverageCPUMilliseconds() << " ms, scene GPU time "
+					<< pFrameProfiler->GetAverageGPUMilliseconds() << " ms" << std::endl;
+
+				// move to the next preset, or go back to the material presets
+				benchmarkPreset++;
+				if (benchmarkPreset >= SamplerCache::SAMPLER_PRESET_COUNT)
+				{
+					benchmarkPreset = -1;
+					g_SceneManager->SetSamplerOverride(-1);
+					delete pFrameProfiler;
+					pFrameProfiler = NULL;
+				}
+				else
+				{
+					g_SceneManager->SetSamplerOverride(benchmarkPreset);
+					pFrameProfiler->Reset();
+				}
+			}
+		}
+		if (benchmarkLights > 0)
+		{
+			pFrameProfiler->EndFrame();
+			if (pFrameProfiler->GetFrameCount() >= 300)
+			{
+				std::cout << "INFO: " << benchmarkLights << " lights "
+					<< ((bBenchmarkClusters == true) ? "in clusters" : "without clusters")
+					<< ": frame " << pFrameProfiler->GetAverageCPUMilliseconds() << " ms, scene GPU time "
+					<< pFrameProfiler->GetAverageGPUMilliseconds() << " ms, light binning "
+					<< g_SceneManager->GetLightBinningMilliseconds() << " ms" << std::endl;
+
+				// time each light count without clusters after with them,
+				// then double the lights up to 512 and go back to the scene lights
+				if (bBenchmarkClusters == true)
+				{
+					bBenchmarkClusters = false;
+				}
+				else
+				{
+					bBenchmarkClusters = true;
+					benchmarkLights *= 2;
+				}
+				if (benchmarkLights > 512)
+				{
+					benchmarkLights = 0;
+					g_SceneManager->SetBenchmarkLights(0);
+					g_SceneManager->SetLightClusters(true);
+					delete pFrameProfiler;
+					pFrameProfiler = NULL;
+				}
+				else
+				{
+					g_SceneManager->SetBenchmarkLights(benchmarkLights);
+					g_SceneManager->SetLightClusters(bBenchmarkClusters);
+					pFrameProfiler->Reset();
+				}
+			}
+		}
+
 
 		// Flips the the back buffer with the front buffer every frame.
 		glfwSwapBuffers(g_Window);
 
+		if (bFirstFrame == true)
+		{
+			std::chrono::duration<double, std::milli> firstFrameTime = std::chrono::steady_clock::now() - startTime;
+			std::cout << "INFO: Time to first frame: " << firstFrameTime.count() << " ms" << std::endl;
+			bFirstFrame = false;
+		}
+
 		// query the latest GLFW events
 		glfwPollEvents();
 	}
 
 	// clear the allocated manager objects from memory
+	if (NULL != pFrameProfiler)
+	{
+		delete pFrameProfiler;
+		pFrameProfiler = NULL;
+	}
 	if (NULL != g_SceneManager)
 	{
+		// the view frees its buffer before the tracker goes
+		g_ViewManager->SetResourceTracker(NULL);
 		delete g_SceneManager;
 		g_SceneManager = NULL;
 	}
+	// the scene manager reads from the pack until it is deleted
+	if (NULL != pAssetPack)
+	{
+		delete pAssetPack;
+		pAssetPack = NULL;
+	}
 	if (NULL != g_ViewManager)
 	{
 		delete g_ViewManager;
@@ -174,4 +523,77 @@ bool InitializeGLEW()
 	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
 
 	return(true);
+}
+
+/***********************************************************
+ *	LoadPackedShaders()
+ *
+ *  This function is used to compile and link the shader
+ *  program from the shader sources in the asset pack.  The
+ *  sources are passed to OpenGL straight from the mapped
+ *  pack with their lengths, so they are never copied.
+ ***********************************************************/
+bool LoadPackedShaders(const AssetPack& assetPack)
+{
+	const char* shaderFiles[] = { "shaders/vertexShader.glsl", "shaders/fragmentShader.glsl" };
+	const GLenum shaderTypes[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+	GLuint shaders[2] = { 0, 0 };
+	GLint status = GL_FALSE;
+	char infoLog[1024];
+	bool bSuccess = true;
+
+	for (int i = 0; (bSuccess == true) && (i < 2); i++)
+	{
+		const char* source = NULL;
+		int length = 0;
+		if (assetPack.GetShaderSource(shaderFiles[i], source, length) == false)
+		{
+			bSuccess = false;
+			break;
+		}
+
+		shaders[i] = glCreateShader(shaderTypes[i]);
+		glShaderSource(shaders[i], 1, &source, &length);
+		glCompileShader(shaders[i]);
+		glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &status);
+		if (status == GL_FALSE)
+		{
+			glGetShaderInfoLog(shaders[i], sizeof(infoLog), NULL, infoLog);
+			std::cout << "ERROR: Packed shader " << shaderFiles[i] << " failed to compile\n" << infoLog << std::endl;
+			bSuccess = false;
+		}
+	}
+
+	GLuint programID = 0;
+	if (bSuccess == true)
+	{
+		programID = glCreateProgram();
+		glAttachShader(programID, shaders[0]);
+		glAttachShader(programID, shaders[1]);
+		glLinkProgram(programID);
+		glGetProgramiv(programID, GL_LINK_STATUS, &status);
+		if (status == GL_FALSE)
+		{
+			glGetProgramInfoLog(programID, sizeof(infoLog), NULL, infoLog);
+			std::cout << "ERROR: Packed shader program failed to link\n" << infoLog << std::endl;
+			glDeleteProgram(programID);
+			bSuccess = false;
+		}
+	}
+
+	for (int i = 0; i < 2; i++)
+	{
+		if (shaders[i] != 0)
+		{
+			glDeleteShader(shaders[i]);
+		}
+	}
+
+	if (bSuccess == true)
+	{
+		g_ShaderManager->m_programID = programID;
+		std::cout << "INFO: Compiled shaders from the asset pack" << std::endl;
+	}
+
+	return(bSuccess);
 }
\ No newline at end of file
@@ -0,0 +1,193 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.cpp
+// ============
+// map a file read-only into memory
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/***********************************************************
+ *  MappedFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MappedFile::MappedFile()
+{
+	m_pData = NULL;
+	m_size = 0;
+#ifdef _WIN32
+	m_fileHandle = INVALID_HANDLE_VALUE;
+	m_mappingHandle = NULL;
+#else
+	m_fileDescriptor = -1;
+#endif
+}
+
+/***********************************************************
+ *  ~MappedFile()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping the whole of the passed
+ *  in file read-only into memory.  Any previously mapped
+ *  file is closed first.  Empty files cannot be mapped.
+ ***********************************************************/
+bool MappedFile::Open(const std::string& filename)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE fileHandle = CreateFileA(
+		filename.c_str(),
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		NULL,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL,
+		NULL);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return(false);
+	}
+
+	LARGE_INTEGER fileSize;
+	if ((GetFileSizeEx(fileHandle, &fileSize) == FALSE) || (fileSize.QuadPart == 0))
+	{
+		CloseHandle(fileHandle);
+		return(false);
+	}
+
+	HANDLE mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mappingHandle == NULL)
+	{
+		CloseHandle(fileHandle);
+		return(false);
+	}
+
+	void* pView = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (pView == NULL)
+	{
+		CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+		return(false);
+	}
+
+	m_fileHandle = fileHandle;
+	m_mappingHandle = mappingHandle;
+	m_pData = (const unsigned char*)pView;
+	m_size = (size_t)fileSize.QuadPart;
+#else
+	int fileDescriptor = open(filename.c_str(), O_RDONLY);
+	if (fileDescriptor < 0)
+	{
+		return(false);
+	}
+
+	struct stat fileInfo;
+	if ((fstat(fileDescriptor, &fileInfo) != 0) || (fileInfo.st_size == 0))
+	{
+		close(fileDescriptor);
+		return(false);
+	}
+
+	void* pView = mmap(NULL, (size_t)fileInfo.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	if (pView == MAP_FAILED)
+	{
+		close(fileDescriptor);
+		return(false);
+	}
+
+	m_fileDescriptor = fileDescriptor;
+	m_pData = (const unsigned char*)pView;
+	m_size = (size_t)fileInfo.st_size;
+#endif
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the file and releasing
+ *  the operating system handles.
+ ***********************************************************/
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (NULL != m_pData)
+	{
+		UnmapViewOfFile(m_pData);
+	}
+	if (NULL != m_mappingHandle)
+	{
+		CloseHandle((HANDLE)m_mappingHandle);
+		m_mappingHandle = NULL;
+	}
+	if (m_fileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle((HANDLE)m_fileHandle);
+		m_fileHandle = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (NULL != m_pData)
+	{
+		munmap((void*)m_pData, m_size);
+	}
+	if (m_fileDescriptor >= 0)
+	{
+		close(m_fileDescriptor);
+		m_fileDescriptor = -1;
+	}
+#endif
+
+	m_pData = NULL;
+	m_size = 0;
+}
+
+/***********************************************************
+ *  GetData()
+ *
+ *  This method is used for getting the start of the mapped
+ *  bytes of the file.
+ ***********************************************************/
+const unsigned char* MappedFile::GetData() const
+{
+	return(m_pData);
+}
+
+/***********************************************************
+ *  GetSize()
+ *
+ *  This method is used for getting the size in bytes of the
+ *  mapped file.
+ ***********************************************************/
+size_t MappedFile::GetSize() const
+{
+	return(m_size);
+}
@@ -0,0 +1,53 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.h
+// ============
+// map a file read-only into memory
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/***********************************************************
+ *  MappedFile
+ *
+ *  This class maps a whole file read-only into the address
+ *  space of the process, so its bytes can be used in place
+ *  without copying them into separately allocated memory.
+ ***********************************************************/
+class MappedFile
+{
+public:
+	// constructor
+	MappedFile();
+	// destructor
+	~MappedFile();
+
+	// map the passed in file into memory
+	bool Open(const std::string& filename);
+	// unmap the file from memory
+	void Close();
+
+	// start of the mapped bytes, or NULL when nothing is mapped
+	const unsigned char* GetData() const;
+	// size of the mapped file in bytes
+	size_t GetSize() const;
+
+private:
+	const unsigned char* m_pData;
+	size_t m_size;
+#ifdef _WIN32
+	void* m_fileHandle;
+	void* m_mappingHandle;
+#else
+	int m_fileDescriptor;
+#endif
+
+	// mapped files own operating system handles, so they are not copied
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+};
@@ -0,0 +1,258 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderqueue.cpp
+// ============
+// order the draws of a frame to keep OpenGL state changes down
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderQueue.h"
+
+#include <climits>
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	// where each state sits in the sort key - the pass takes
+	// the top 4 bits and the low 16 bits are left clear
+	const int g_PassShift = 60;
+	const int g_StateShifts[RenderQueue::SORT_STATE_COUNT] = { 52, 44, 28, 16 };
+	const int g_StateBits[RenderQueue::SORT_STATE_COUNT] = { 8, 8, 16, 12 };
+
+	// the sort goes through the key a byte at a time
+	const int g_RadixBits = 8;
+	const int g_RadixPasses = 64 / g_RadixBits;
+	const int g_RadixBuckets = 1 << g_RadixBits;
+}
+
+/***********************************************************
+ *  RenderQueue()
+ *
+ *  The constructor for the class.
+ ***********************************************************/
+RenderQueue::RenderQueue()
+{
+	m_addedOrderStateChanges = 0;
+	m_sortedStateChanges = 0;
+}
+
+/***********************************************************
+ *  ~RenderQueue()
+ *
+ *  The destructor for the class.
+ ***********************************************************/
+RenderQueue::~RenderQueue()
+{
+}
+
+/***********************************************************
+ *  MakeSortKey()
+ *
+ *  This method is used for packing the states of a draw
+ *  into a sort key.  Textures and materials are stored one
+ *  higher so that -1, for none, sorts first.  Values too
+ *  large for their bits are wrapped, which only makes the
+ *  grouping less tight, since the key is never used to set
+ *  the states themselves.
+ ***********************************************************/
+uint64_t RenderQueue::MakeSortKey(
+	RENDER_PASS pass,
+	int program,
+	int mesh,
+	int texture,
+	int material)
+{
+	const int values[SORT_STATE_COUNT] = { program, mesh, texture + 1, material + 1 };
+	uint64_t sortKey = ((uint64_t)pass & 0xF) << g_PassShift;
+
+	for (int state = 0; state < SORT_STATE_COUNT; state++)
+	{
+		uint64_t mask = ((uint64_t)1 << g_StateBits[state]) - 1;
+		sortKey |= ((uint64_t)values[state] & mask) << g_StateShifts[state];
+	}
+
+	return(sortKey);
+}
+
+/***********************************************************
+ *  GetKeyState()
+ *
+ *  This method is used for reading one of the states back
+ *  out of a sort key, with -1 for no texture or material.
+ ***********************************************************/
+int RenderQueue::GetKeyState(uint64_t sortKey, SORT_STATE state)
+{
+	uint64_t mask = ((uint64_t)1 << g_StateBits[state]) - 1;
+	int value = (int)((sortKey >> g_StateShifts[state]) & mask);
+
+	if ((state == STATE_TEXTURE) || (state == STATE_MATERIAL))
+	{
+		value--;
+	}
+
+	return(value);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing the packets of the last
+ *  frame.  The packet arrays keep their capacity, so a
+ *  frame with the same number of draws allocates nothing.
+ ***********************************************************/
+void RenderQueue::Clear()
+{
+	m_packets.clear();
+	m_addedOrderStateChanges = 0;
+	m_sortedStateChanges = 0;
+}
+
+/***********************************************************
+ *  AddPacket()
+ *
+ *  This method is used for adding the draw of an item with
+ *  its sort key.
+ ***********************************************************/
+void RenderQueue::AddPacket(uint64_t sortKey, int item)
+{
+	DRAW_PACKET packet;
+	packet.sortKey = sortKey;
+	packet.item = item;
+	m_packets.push_back(packet);
+}
+
+/***********************************************************
+ *  Sort()
+ *
+ *  This method is used for ordering the packets by sort key
+ *  with a least significant digit radix sort, a byte per
+ *  pass.  The counts for every byte are gathered in one
+ *  walk over the keys, and a byte that is the same in every
+ *  key is skipped, so the unused key bits and states that
+ *  never vary cost nothing.  The state changes are counted
+ *  before and after for reporting.
+ ***********************************************************/
+void RenderQueue::Sort()
+{
+	m_addedOrderStateChanges = CountStateChanges();
+
+	const size_t packetCount = m_packets.size();
+	if (packetCount > 1)
+	{
+		static_assert(g_RadixPasses * g_RadixBits == 64, "the radix passes must cover the whole key");
+		uint32_t counts[g_RadixPasses][g_RadixBuckets];
+		memset(counts, 0, sizeof(counts));
+		for (size_t i = 0; i < packetCount; i++)
+		{
+			uint64_t sortKey = m_packets[i].sortKey;
+			for (int pass = 0; pass < g_RadixPasses; pass++)
+			{
+				counts[pass][(sortKey >> (pass * g_RadixBits)) & (g_RadixBuckets - 1)]++;
+			}
+		}
+
+		m_sortBuffer.resize(packetCount);
+		for (int pass = 0; pass < g_RadixPasses; pass++)
+		{
+			uint32_t* passCounts = counts[pass];
+			int shift = pass * g_RadixBits;
+			if (passCounts[(m_packets[0].sortKey >> shift) & (g_RadixBuckets - 1)] == packetCount)
+			{
+				continue;
+			}
+
+			// turn the counts into the first position of each bucket
+			uint32_t offset = 0;
+			for (int bucket = 0; bucket < g_RadixBuckets; bucket++)
+			{
+				uint32_t count = passCounts[bucket];
+				passCounts[bucket] = offset;
+				offset += count;
+			}
+			for (size_t i = 0; i < packetCount; i++)
+			{
+				m_sortBuffer[passCounts[(m_packets[i].sortKey >> shift) & (g_RadixBuckets - 1)]++] = m_packets[i];
+			}
+			m_packets.swap(m_sortBuffer);
+		}
+	}
+
+	m_sortedStateChanges = CountStateChanges();
+}
+
+/***********************************************************
+ *  GetCount()
+ *
+ *  This method is used for getting the number of packets.
+ ***********************************************************/
+int RenderQueue::GetCount() const
+{
+	return((int)m_packets.size());
+}
+
+/***********************************************************
+ *  GetPackets()
+ *
+ *  This method is used for getting the packets, in the
+ *  order they were added until Sort() is called and in
+ *  sort key order after.
+ ***********************************************************/
+const std::vector<RenderQueue::DRAW_PACKET>& RenderQueue::GetPackets() const
+{
+	return(m_packets);
+}
+
+/***********************************************************
+ *  GetAddedOrderStateChanges()
+ *
+ *  This method is used for getting the number of state
+ *  changes the packets would need in the order they were
+ *  added, as counted by the last Sort() call.
+ ***********************************************************/
+int RenderQueue::GetAddedOrderStateChanges() const
+{
+	return(m_addedOrderStateChanges);
+}
+
+/***********************************************************
+ *  GetSortedStateChanges()
+ *
+ *  This method is used for getting the number of state
+ *  changes the packets need in sorted order, as counted by
+ *  the last Sort() call.
+ ***********************************************************/
+int RenderQueue::GetSortedStateChanges() const
+{
+	return(m_sortedStateChanges);
+}
+
+/***********************************************************
+ *  CountStateChanges()
+ *
+ *  This method is used for counting how many times a state
+ *  has to be set along the packets, with every state set
+ *  for the first packet.  A draw without a material keeps
+ *  the current one, so it sets nothing.
+ ***********************************************************/
+int RenderQueue::CountStateChanges() const
+{
+	int currentStates[SORT_STATE_COUNT] = { INT_MIN, INT_MIN, INT_MIN, INT_MIN };
+	int stateChanges = 0;
+	for (size_t i = 0; i < m_packets.size(); i++)
+	{
+		for (int state = 0; state < SORT_STATE_COUNT; state++)
+		{
+			int value = GetKeyState(m_packets[i].sortKey, (SORT_STATE)state);
+			if (((state == STATE_MATERIAL) && (value < 0)) || (value == currentStates[state]))
+			{
+				continue;
+			}
+			currentStates[state] = value;
+			stateChanges++;
+		}
+	}
+
+	return(stateChanges);
+}
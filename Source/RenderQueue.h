@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderqueue.h
+// ============
+// order the draws of a frame to keep OpenGL state changes down
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  RenderQueue
+ *
+ *  This class collects the draws of a frame as packets,
+ *  each a 64 bit sort key and the index of what is drawn,
+ *  and radix sorts them by key.  The key holds the render
+ *  pass, shader program, mesh, texture and material, from
+ *  the most significant bits down, so draws that share the
+ *  costlier states end up next to each other and the states
+ *  only have to be set when they change.  The sort is
+ *  stable, so draws with the same key keep the order they
+ *  were added in.
+ ***********************************************************/
+class RenderQueue
+{
+public:
+	// constructor
+	RenderQueue();
+	// destructor
+	~RenderQueue();
+
+	enum RENDER_PASS
+	{
+		// solid objects, drawn first
+		PASS_OPAQUE = 0,
+		PASS_COUNT
+	};
+
+	// states held in the sort key below the pass, counted for reporting
+	enum SORT_STATE
+	{
+		STATE_PROGRAM = 0,
+		STATE_MESH,
+		STATE_TEXTURE,
+		STATE_MATERIAL,
+		SORT_STATE_COUNT
+	};
+
+	// one draw of the frame
+	struct DRAW_PACKET
+	{
+		uint64_t sortKey;
+		// index of what is drawn, such as a scene entity
+		int item;
+	};
+
+	// pack the states of a draw into a sort key, -1 for no texture or material
+	static uint64_t MakeSortKey(
+		RENDER_PASS pass,
+		int program,
+		int mesh,
+		int texture,
+		int material);
+	// value of one of the states in a sort key, -1 for none
+	static int GetKeyState(uint64_t sortKey, SORT_STATE state);
+
+	// remove the packets of the last frame
+	void Clear();
+	// add the draw of an item with its sort key
+	void AddPacket(uint64_t sortKey, int item);
+	// order the packets by sort key
+	void Sort();
+
+	int GetCount() const;
+	// packets in the order added, or sorted once Sort() is called
+	const std::vector<DRAW_PACKET>& GetPackets() const;
+
+	// state changes between the packets in the order they were added
+	int GetAddedOrderStateChanges() const;
+	// state changes between the packets as sorted
+	int GetSortedStateChanges() const;
+
+private:
+	std::vector<DRAW_PACKET> m_packets;
+	// scratch packets for the radix sort passes
+	std::vector<DRAW_PACKET> m_sortBuffer;
+	int m_addedOrderStateChanges;
+	int m_sortedStateChanges;
+
+	// count the changes of every state along the packets
+	int CountStateChanges() const;
+
+	// queues hold a frame of draws, so they are not copied
+	RenderQueue(const RenderQueue&);
+	RenderQueue& operator=(const RenderQueue&);
+};
@@ -0,0 +1,208 @@
+///////////////////////////////////////////////////////////////////////////////
+// samplercache.cpp
+// ============
+// create and bind OpenGL sampler objects shared across textures
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SamplerCache.h"
+
+/***********************************************************
+ *  SamplerCache()
+ *
+ *  The constructor for the class.  The highest anisotropy
+ *  the driver supports is read here, so anisotropic presets
+ *  can be clamped to it.
+ ***********************************************************/
+SamplerCache::SamplerCache(GLResourceTracker* pResourceTracker)
+{
+	GLint maxTextureUnits = 16;
+
+	m_pResourceTracker = pResourceTracker;
+	m_maxAnisotropy = 1.0f;
+
+	if (GLEW_EXT_texture_filter_anisotropic || GLEW_ARB_texture_filter_anisotropic)
+	{
+		glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &m_maxAnisotropy);
+	}
+
+	glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &maxTextureUnits);
+	m_boundSamplers.assign(maxTextureUnits, 0);
+}
+
+/***********************************************************
+ *  ~SamplerCache()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SamplerCache::~SamplerCache()
+{
+	DestroySamplers();
+}
+
+/***********************************************************
+ *  GetSampler()
+ *
+ *  This method is used for getting the sampler object that
+ *  matches the passed in description.  A new sampler is
+ *  only created the first time a description is used.
+ ***********************************************************/
+GLuint SamplerCache::GetSampler(const SAMPLER_DESC& samplerDesc)
+{
+	float maxAnisotropy = (samplerDesc.maxAnisotropy < m_maxAnisotropy) ? samplerDesc.maxAnisotropy : m_maxAnisotropy;
+
+	for (size_t i = 0; i < m_samplers.size(); i++)
+	{
+		const SAMPLER_DESC& cached = m_samplers[i].samplerDesc;
+		if ((cached.minFilter == samplerDesc.minFilter) &&
+			(cached.magFilter == samplerDesc.magFilter) &&
+			(cached.wrapS == samplerDesc.wrapS) &&
+			(cached.wrapT == samplerDesc.wrapT) &&
+			(cached.maxAnisotropy == maxAnisotropy))
+		{
+			return(m_samplers[i].samplerID);
+		}
+	}
+
+	CACHED_SAMPLER sampler;
+	sampler.samplerDesc = samplerDesc;
+	sampler.samplerDesc.maxAnisotropy = maxAnisotropy;
+
+	glGenSamplers(1, &sampler.samplerID);
+	glSamplerParameteri(sampler.samplerID, GL_TEXTURE_MIN_FILTER, samplerDesc.minFilter);
+	glSamplerParameteri(sampler.samplerID, GL_TEXTURE_MAG_FILTER, samplerDesc.magFilter);
+	glSamplerParameteri(sampler.samplerID, GL_TEXTURE_WRAP_S, samplerDesc.wrapS);
+	glSamplerParameteri(sampler.samplerID, GL_TEXTURE_WRAP_T, samplerDesc.wrapT);
+	if (maxAnisotropy > 1.0f)
+	{
+		glSamplerParameterf(sampler.samplerID, GL_TEXTURE_MAX_ANISOTROPY_EXT, maxAnisotropy);
+	}
+
+	m_samplers.push_back(sampler);
+	m_pResourceTracker->Track(GLResourceTracker::RESOURCE_SAMPLER, sampler.samplerID, 0, "samplers");
+
+	return(sampler.samplerID);
+}
+
+/***********************************************************
+ *  GetPresetSampler()
+ *
+ *  This method is used for getting the sampler object for
+ *  one of the filtering presets.
+ ***********************************************************/
+GLuint SamplerCache::GetPresetSampler(SAMPLER_PRESET samplerPreset)
+{
+	return(GetSampler(GetPresetDesc(samplerPreset)));
+}
+
+/***********************************************************
+ *  BindSampler()
+ *
+ *  This method is used for binding a sampler to a texture
+ *  unit, skipping the call when the unit already uses it.
+ ***********************************************************/
+void SamplerCache::BindSampler(int textureUnit, GLuint samplerID)
+{
+	if ((textureUnit < 0) || (textureUnit >= (int)m_boundSamplers.size()) ||
+		(m_boundSamplers[textureUnit] == samplerID))
+	{
+		return;
+	}
+
+	glBindSampler((GLuint)textureUnit, samplerID);
+	m_boundSamplers[textureUnit] = samplerID;
+}
+
+/***********************************************************
+ *  DestroySamplers()
+ *
+ *  This method is used for unbinding and deleting every
+ *  sampler object that was created.
+ ***********************************************************/
+void SamplerCache::DestroySamplers()
+{
+	for (size_t i = 0; i < m_boundSamplers.size(); i++)
+	{
+		if (m_boundSamplers[i] != 0)
+		{
+			glBindSampler((GLuint)i, 0);
+			m_boundSamplers[i] = 0;
+		}
+	}
+
+	for (size_t i = 0; i < m_samplers.size(); i++)
+	{
+		m_pResourceTracker->Delete(GLResourceTracker::RESOURCE_SAMPLER, m_samplers[i].samplerID);
+	}
+	m_samplers.clear();
+}
+
+/***********************************************************
+ *  GetPresetDesc()
+ *
+ *  This method is used for getting the description of one
+ *  of the filtering presets.  All of them repeat the
+ *  texture coordinates, like the scene textures do.
+ ***********************************************************/
+SamplerCache::SAMPLER_DESC SamplerCache::GetPresetDesc(SAMPLER_PRESET samplerPreset)
+{
+	SAMPLER_DESC samplerDesc;
+	samplerDesc.minFilter = GL_LINEAR_MIPMAP_LINEAR;
+	samplerDesc.magFilter = GL_LINEAR;
+	samplerDesc.wrapS = GL_REPEAT;
+	samplerDesc.wrapT = GL_REPEAT;
+	samplerDesc.maxAnisotropy = 1.0f;
+
+	switch (samplerPreset)
+	{
+	case SAMPLER_BILINEAR:
+		samplerDesc.minFilter = GL_LINEAR;
+		break;
+	case SAMPLER_ANISOTROPIC_4X:
+		samplerDesc.maxAnisotropy = 4.0f;
+		break;
+	case SAMPLER_ANISOTROPIC_16X:
+		samplerDesc.maxAnisotropy = 16.0f;
+		break;
+	default:
+		break;
+	}
+
+	return(samplerDesc);
+}
+
+/***********************************************************
+ *  GetPresetName()
+ *
+ *  This method is used for getting the short name of one of
+ *  the filtering presets for reporting.
+ ***********************************************************/
+const char* SamplerCache::GetPresetName(SAMPLER_PRESET samplerPreset)
+{
+	switch (samplerPreset)
+	{
+	case SAMPLER_BILINEAR:
+		return("bilinear");
+	case SAMPLER_TRILINEAR:
+		return("trilinear");
+	case SAMPLER_ANISOTROPIC_4X:
+		return("anisotropic4x");
+	case SAMPLER_ANISOTROPIC_16X:
+		return("anisotropic16x");
+	default:
+		return("unknown");
+	}
+}
+
+/***********************************************************
+ *  GetMaxAnisotropy()
+ *
+ *  This method is used for getting the highest anisotropy
+ *  supported by the driver.
+ ***********************************************************/
+float SamplerCache::GetMaxAnisotropy() const
+{
+	return(m_maxAnisotropy);
+}
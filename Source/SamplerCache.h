@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+// samplercache.h
+// ============
+// create and bind OpenGL sampler objects shared across textures
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLResourceTracker.h"
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <vector>
+
+/***********************************************************
+ *  SamplerCache
+ *
+ *  This class keeps the filtering and wrapping state apart
+ *  from the textures in OpenGL sampler objects.  Each
+ *  distinct sampler description is created only once, and
+ *  the sampler bound to each texture unit is tracked so a
+ *  unit is only rebound when its sampler changes.
+ ***********************************************************/
+class SamplerCache
+{
+public:
+	// constructor - must be called with an OpenGL context
+	SamplerCache(GLResourceTracker* pResourceTracker);
+	// destructor
+	~SamplerCache();
+
+	enum SAMPLER_PRESET
+	{
+		// single level linear filtering, which ignores the mipmaps
+		SAMPLER_BILINEAR = 0,
+		// linear filtering between the two nearest mipmaps
+		SAMPLER_TRILINEAR,
+		// trilinear with 4x anisotropic filtering
+		SAMPLER_ANISOTROPIC_4X,
+		// trilinear with 16x anisotropic filtering
+		SAMPLER_ANISOTROPIC_16X,
+		SAMPLER_PRESET_COUNT
+	};
+
+	struct SAMPLER_DESC
+	{
+		GLint minFilter;
+		GLint magFilter;
+		GLint wrapS;
+		GLint wrapT;
+		// 1 turns anisotropic filtering off
+		float maxAnisotropy;
+	};
+
+	// get the sampler for a description, creating it if needed
+	GLuint GetSampler(const SAMPLER_DESC& samplerDesc);
+	// get the sampler for one of the presets
+	GLuint GetPresetSampler(SAMPLER_PRESET samplerPreset);
+	// bind a sampler to a texture unit unless it is already bound
+	void BindSampler(int textureUnit, GLuint samplerID);
+	// delete every created sampler
+	void DestroySamplers();
+
+	// description of a preset with repeating texture coordinates
+	static SAMPLER_DESC GetPresetDesc(SAMPLER_PRESET samplerPreset);
+	// short name of a preset, such as "trilinear"
+	static const char* GetPresetName(SAMPLER_PRESET samplerPreset);
+
+	// highest anisotropy supported, 1 when not supported at all
+	float GetMaxAnisotropy() const;
+
+private:
+	struct CACHED_SAMPLER
+	{
+		SAMPLER_DESC samplerDesc;
+		GLuint samplerID;
+	};
+
+	// records the created samplers
+	GLResourceTracker* m_pResourceTracker;
+	// created samplers, searched in order as there are only a few
+	std::vector<CACHED_SAMPLER> m_samplers;
+	// sampler bound to each texture unit, 0 for none
+	std::vector<GLuint> m_boundSamplers;
+	float m_maxAnisotropy;
+};
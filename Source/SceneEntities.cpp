@@ -0,0 +1,163 @@
+///////////////////////////////////////////////////////////////////////////////
+// sceneentities.cpp
+// ============
+// store the drawn scene objects as packed arrays of components
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneEntities.h"
+
+/***********************************************************
+ *  SceneEntities()
+ *
+ *  The constructor for the class.
+ ***********************************************************/
+SceneEntities::SceneEntities()
+{
+}
+
+/***********************************************************
+ *  ~SceneEntities()
+ *
+ *  The destructor for the class.
+ ***********************************************************/
+SceneEntities::~SceneEntities()
+{
+}
+
+/***********************************************************
+ *  AddEntity()
+ *
+ *  This method is used for adding an entity with all of its
+ *  components.  Entities are drawn in the order the render
+ *  queue sorts them into, not the order they are added, so
+ *  each needs its own material.
+ ***********************************************************/
+int SceneEntities::AddEntity(
+	int nodeID,
+	int mesh,
+	int textureHandle,
+	int materialIndex,
+	glm::vec4 color,
+	glm::vec2 UVscale)
+{
+	m_nodes.push_back(nodeID);
+	m_meshes.push_back(mesh);
+	m_textures.push_back(textureHandle);
+	m_materials.push_back(materialIndex);
+	m_colors.push_back(color);
+	m_UVscales.push_back(UVscale);
+
+	return(GetCount() - 1);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing every entity.  The
+ *  arrays keep their capacity for the next scene.
+ ***********************************************************/
+void SceneEntities::Clear()
+{
+	m_nodes.clear();
+	m_meshes.clear();
+	m_textures.clear();
+	m_materials.clear();
+	m_colors.clear();
+	m_UVscales.clear();
+}
+
+/***********************************************************
+ *  Reserve()
+ *
+ *  This method is used for making room for the passed in
+ *  number of entities, so a scene of a known size is added
+ *  without the arrays growing along the way.
+ ***********************************************************/
+void SceneEntities::Reserve(int count)
+{
+	m_nodes.reserve(count);
+	m_meshes.reserve(count);
+	m_textures.reserve(count);
+	m_materials.reserve(count);
+	m_colors.reserve(count);
+	m_UVscales.reserve(count);
+}
+
+/***********************************************************
+ *  GetCount()
+ *
+ *  This method is used for getting the number of entities.
+ ***********************************************************/
+int SceneEntities::GetCount() const
+{
+	return((int)m_nodes.size());
+}
+
+/***********************************************************
+ *  GetNodes()
+ *
+ *  This method is used for getting the scene graph node of
+ *  every entity.
+ ***********************************************************/
+const std::vector<int>& SceneEntities::GetNodes() const
+{
+	return(m_nodes);
+}
+
+/***********************************************************
+ *  GetMeshes()
+ *
+ *  This method is used for getting the mesh of every entity.
+ ***********************************************************/
+const std::vector<int>& SceneEntities::GetMeshes() const
+{
+	return(m_meshes);
+}
+
+/***********************************************************
+ *  GetTextures()
+ *
+ *  This method is used for getting the texture handle of
+ *  every entity, -1 for entities drawn with their color.
+ ***********************************************************/
+const std::vector<int>& SceneEntities::GetTextures() const
+{
+	return(m_textures);
+}
+
+/***********************************************************
+ *  GetMaterials()
+ *
+ *  This method is used for getting the material index of
+ *  every entity, which is -1 only when the scene has no
+ *  materials at all.
+ ***********************************************************/
+const std::vector<int>& SceneEntities::GetMaterials() const
+{
+	return(m_materials);
+}
+
+/***********************************************************
+ *  GetColors()
+ *
+ *  This method is used for getting the color of every
+ *  entity.
+ ***********************************************************/
+const std::vector<glm::vec4>& SceneEntities::GetColors() const
+{
+	return(m_colors);
+}
+
+/***********************************************************
+ *  GetUVScales()
+ *
+ *  This method is used for getting the texture UV scale of
+ *  every entity.
+ ***********************************************************/
+const std::vector<glm::vec2>& SceneEntities::GetUVScales() const
+{
+	return(m_UVscales);
+}
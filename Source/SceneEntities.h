@@ -0,0 +1,74 @@
+///////////////////////////////////////////////////////////////////////////////
+// sceneentities.h
+// ============
+// store the drawn scene objects as packed arrays of components
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  SceneEntities
+ *
+ *  This class stores every drawn scene object as an entity,
+ *  which is just an index into one array per component -
+ *  the scene graph node that places it, the mesh, texture,
+ *  material, color and texture UV scale.  The arrays are
+ *  contiguous and the same length, so a system that needs
+ *  only some components walks only those arrays, and ranges
+ *  of entities can be split across threads or culled
+ *  without touching the rest.
+ ***********************************************************/
+class SceneEntities
+{
+public:
+	// constructor
+	SceneEntities();
+	// destructor
+	~SceneEntities();
+
+	// add an entity and get back its index
+	int AddEntity(
+		int nodeID,
+		int mesh,
+		int textureHandle,
+		int materialIndex,
+		glm::vec4 color,
+		glm::vec2 UVscale);
+	// remove every entity
+	void Clear();
+	// make room for a number of entities without growing
+	void Reserve(int count);
+
+	int GetCount() const;
+
+	// components, indexed by entity
+	// scene graph node placing the entity
+	const std::vector<int>& GetNodes() const;
+	// SceneMeshes::MESH_SHAPE of the entity
+	const std::vector<int>& GetMeshes() const;
+	// texture handle, -1 to draw with the color
+	const std::vector<int>& GetTextures() const;
+	// index of the material, -1 only when the scene has no materials
+	const std::vector<int>& GetMaterials() const;
+	const std::vector<glm::vec4>& GetColors() const;
+	const std::vector<glm::vec2>& GetUVScales() const;
+
+private:
+	std::vector<int> m_nodes;
+	std::vector<int> m_meshes;
+	std::vector<int> m_textures;
+	std::vector<int> m_materials;
+	std::vector<glm::vec4> m_colors;
+	std::vector<glm::vec2> m_UVscales;
+
+	// entities hold the whole scene, so they are not copied
+	SceneEntities(const SceneEntities&);
+	SceneEntities& operator=(const SceneEntities&);
+};
@@ -0,0 +1,388 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.cpp
+// ============
+// map a binary scene description of objects, textures, materials and lights
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneFile.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// 4 byte values per object in each of the per object arrays
+	const uint32_t g_ObjectArrayWidths[SceneFile::OBJECT_ARRAY_COUNT] = { 1, 1, 1, 1, 3, 3, 3, 4, 2 };
+
+	// the per object arrays each start on a 16 byte boundary
+	const uint64_t g_ObjectArrayAlignment = 16;
+
+	/***********************************************************
+	 *  IsSectionInFile()
+	 *
+	 *  Check that a section of records lies within the file
+	 *  and starts on an 8 byte boundary.
+	 ***********************************************************/
+	bool IsSectionInFile(uint64_t offset, uint32_t count, size_t recordSize, size_t fileSize)
+	{
+		return((offset <= fileSize) && (offset % 8 == 0) && (count <= (fileSize - offset) / recordSize));
+	}
+}
+
+/***********************************************************
+ *  SceneFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneFile::SceneFile()
+{
+	memset(&m_header, 0, sizeof(m_header));
+	m_pTextures = NULL;
+	m_pMaterials = NULL;
+	m_pLights = NULL;
+	m_pObjectArrays = NULL;
+}
+
+/***********************************************************
+ *  ~SceneFile()
+ *
+ *  The destructor for the class.  Any pointers handed out
+ *  into the scene become invalid.
+ ***********************************************************/
+SceneFile::~SceneFile()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping the passed in scene file
+ *  and checking it.  Every section must lie within the file,
+ *  tags and filenames must be terminated, and every index an
+ *  object holds must be in range, with parents coming before
+ *  their children, so the contents can be used without
+ *  further checks.
+ ***********************************************************/
+bool SceneFile::Open(const std::string& filename)
+{
+	Close();
+
+	if (m_mappedFile.Open(filename) == false)
+	{
+		std::cout << "Could not open scene file:" << filename << std::endl;
+		return(false);
+	}
+
+	const unsigned char* pData = m_mappedFile.GetData();
+	size_t dataSize = m_mappedFile.GetSize();
+
+	bool bValid = (dataSize >= sizeof(m_header));
+	if (bValid == true)
+	{
+		memcpy(&m_header, pData, sizeof(m_header));
+		bValid = ((memcmp(m_header.magic, "SCNE", 4) == 0) && (m_header.version == SCENE_VERSION) &&
+			(IsSectionInFile(m_header.textureOffset, m_header.textureCount, sizeof(TEXTURE_RECORD), dataSize) == true) &&
+			(IsSectionInFile(m_header.materialOffset, m_header.materialCount, sizeof(MATERIAL_RECORD), dataSize) == true) &&
+			(IsSectionInFile(m_header.lightOffset, m_header.lightCount, sizeof(LIGHT_RECORD), dataSize) == true) &&
+			(m_header.objectOffset <= dataSize) && (m_header.objectOffset % g_ObjectArrayAlignment == 0) &&
+			(GetObjectArrayOffset(OBJECT_ARRAY_COUNT, m_header.objectCount) <= dataSize - m_header.objectOffset));
+	}
+
+	if (bValid == true)
+	{
+		m_pTextures = (const TEXTURE_RECORD*)(pData + m_header.textureOffset);
+		m_pMaterials = (const MATERIAL_RECORD*)(pData + m_header.materialOffset);
+		m_pLights = (const LIGHT_RECORD*)(pData + m_header.lightOffset);
+		m_pObjectArrays = pData + m_header.objectOffset;
+
+		for (uint32_t i = 0; (i < m_header.textureCount) && (bValid == true); i++)
+		{
+			bValid = ((memchr(m_pTextures[i].tag, 0, MAX_TAG_LENGTH) != NULL) &&
+				(memchr(m_pTextures[i].filename, 0, MAX_FILENAME_LENGTH) != NULL));
+		}
+		for (uint32_t i = 0; (i < m_header.materialCount) && (bValid == true); i++)
+		{
+			bValid = (memchr(m_pMaterials[i].tag, 0, MAX_TAG_LENGTH) != NULL);
+		}
+
+		const int32_t* parents = GetParents();
+		const int32_t* meshes = GetMeshes();
+		const int32_t* textures = GetTextures();
+		const int32_t* materials = GetMaterials();
+		const int32_t textureCount = (int32_t)m_header.textureCount;
+		const int32_t materialCount = (int32_t)m_header.materialCount;
+		for (int32_t i = 0; (i < (int32_t)m_header.objectCount) && (bValid == true); i++)
+		{
+			bValid = ((parents[i] >= -1) && (parents[i] < i) &&
+				(meshes[i] >= 0) && (meshes[i] < SceneMeshes::MESH_SHAPE_COUNT) &&
+				(textures[i] >= -1) && (textures[i] < textureCount) &&
+				(materials[i] >= -1) && (materials[i] < materialCount));
+		}
+	}
+
+	if (bValid == false)
+	{
+		std::cout << "Could not use scene file:" << filename << std::endl;
+		Close();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the scene file.
+ ***********************************************************/
+void SceneFile::Close()
+{
+	memset(&m_header, 0, sizeof(m_header));
+	m_pTextures = NULL;
+	m_pMaterials = NULL;
+	m_pLights = NULL;
+	m_pObjectArrays = NULL;
+	m_mappedFile.Close();
+}
+
+/***********************************************************
+ *  IsOpen()
+ *
+ *  This method is used for checking whether a scene file is
+ *  mapped.
+ ***********************************************************/
+bool SceneFile::IsOpen() const
+{
+	return(NULL != m_pObjectArrays);
+}
+
+/***********************************************************
+ *  GetTextureCount()
+ *
+ *  This method is used for getting the number of textures
+ *  the scene names.
+ ***********************************************************/
+int SceneFile::GetTextureCount() const
+{
+	return((int)m_header.textureCount);
+}
+
+/***********************************************************
+ *  GetMaterialCount()
+ *
+ *  This method is used for getting the number of materials
+ *  the scene defines.
+ ***********************************************************/
+int SceneFile::GetMaterialCount() const
+{
+	return((int)m_header.materialCount);
+}
+
+/***********************************************************
+ *  GetLightCount()
+ *
+ *  This method is used for getting the number of lights the
+ *  scene places.
+ ***********************************************************/
+int SceneFile::GetLightCount() const
+{
+	return((int)m_header.lightCount);
+}
+
+/***********************************************************
+ *  GetObjectCount()
+ *
+ *  This method is used for getting the number of objects in
+ *  the scene.
+ ***********************************************************/
+int SceneFile::GetObjectCount() const
+{
+	return((int)m_header.objectCount);
+}
+
+/***********************************************************
+ *  GetTexture()
+ *
+ *  This method is used for getting the tag and filename of
+ *  a texture.
+ ***********************************************************/
+const SceneFile::TEXTURE_RECORD& SceneFile::GetTexture(int index) const
+{
+	return(m_pTextures[index]);
+}
+
+/***********************************************************
+ *  GetMaterial()
+ *
+ *  This method is used for getting the values of a material.
+ ***********************************************************/
+const SceneFile::MATERIAL_RECORD& SceneFile::GetMaterial(int index) const
+{
+	return(m_pMaterials[index]);
+}
+
+/***********************************************************
+ *  GetLight()
+ *
+ *  This method is used for getting the values of a light.
+ ***********************************************************/
+const SceneFile::LIGHT_RECORD& SceneFile::GetLight(int index) const
+{
+	return(m_pLights[index]);
+}
+
+/***********************************************************
+ *  GetParents()
+ *
+ *  This method is used for getting the parent index of
+ *  every object.
+ ***********************************************************/
+const int32_t* SceneFile::GetParents() const
+{
+	return((const int32_t*)GetObjectArray(OBJECT_PARENTS));
+}
+
+/***********************************************************
+ *  GetMeshes()
+ *
+ *  This method is used for getting the mesh of every object.
+ ***********************************************************/
+const int32_t* SceneFile::GetMeshes() const
+{
+	return((const int32_t*)GetObjectArray(OBJECT_MESHES));
+}
+
+/***********************************************************
+ *  GetTextures()
+ *
+ *  This method is used for getting the texture index of
+ *  every object.
+ ***********************************************************/
+const int32_t* SceneFile::GetTextures() const
+{
+	return((const int32_t*)GetObjectArray(OBJECT_TEXTURES));
+}
+
+/***********************************************************
+ *  GetMaterials()
+ *
+ *  This method is used for getting the material index of
+ *  every object.
+ ***********************************************************/
+const int32_t* SceneFile::GetMaterials() const
+{
+	return((const int32_t*)GetObjectArray(OBJECT_MATERIALS));
+}
+
+/***********************************************************
+ *  GetScales()
+ *
+ *  This method is used for getting the scale of every
+ *  object, three floats each.
+ ***********************************************************/
+const float* SceneFile::GetScales() const
+{
+	return((const float*)GetObjectArray(OBJECT_SCALES));
+}
+
+/***********************************************************
+ *  GetRotations()
+ *
+ *  This method is used for getting the rotation of every
+ *  object in degrees, three floats each.
+ ***********************************************************/
+const float* SceneFile::GetRotations() const
+{
+	return((const float*)GetObjectArray(OBJECT_ROTATIONS));
+}
+
+/***********************************************************
+ *  GetPositions()
+ *
+ *  This method is used for getting the position of every
+ *  object relative to its parent, three floats each.
+ ***********************************************************/
+const float* SceneFile::GetPositions() const
+{
+	return((const float*)GetObjectArray(OBJECT_POSITIONS));
+}
+
+/***********************************************************
+ *  GetColors()
+ *
+ *  This method is used for getting the color of every
+ *  object, four floats each.
+ ***********************************************************/
+const float* SceneFile::GetColors() const
+{
+	return((const float*)GetObjectArray(OBJECT_COLORS));
+}
+
+/***********************************************************
+ *  GetUVScales()
+ *
+ *  This method is used for getting the texture UV scale of
+ *  every object, two floats each.
+ ***********************************************************/
+const float* SceneFile::GetUVScales() const
+{
+	return((const float*)GetObjectArray(OBJECT_UV_SCALES));
+}
+
+/***********************************************************
+ *  GetObjectArray()
+ *
+ *  This method is used for finding the start of one of the
+ *  per object arrays in the mapping.
+ ***********************************************************/
+const void* SceneFile::GetObjectArray(OBJECT_ARRAY objectArray) const
+{
+	if (NULL == m_pObjectArrays)
+	{
+		return(NULL);
+	}
+
+	return(m_pObjectArrays + GetObjectArrayOffset(objectArray, m_header.objectCount));
+}
+
+/***********************************************************
+ *  GetObjectArrayOffset()
+ *
+ *  This method is used for working out where one of the per
+ *  object arrays starts, counted from the start of the
+ *  first one.  Passing OBJECT_ARRAY_COUNT gives the size of
+ *  all of them together.  The reader and the writer both
+ *  lay the arrays out with this.
+ ***********************************************************/
+uint64_t SceneFile::GetObjectArrayOffset(OBJECT_ARRAY objectArray, uint32_t objectCount)
+{
+	uint64_t offset = 0;
+	for (int i = 0; (i < objectArray) && (i < OBJECT_ARRAY_COUNT); i++)
+	{
+		uint64_t arraySize = (uint64_t)objectCount * g_ObjectArrayWidths[i] * 4;
+		offset += (arraySize + g_ObjectArrayAlignment - 1) / g_ObjectArrayAlignment * g_ObjectArrayAlignment;
+	}
+
+	return(offset);
+}
+
+/***********************************************************
+ *  IsBinarySceneFile()
+ *
+ *  This method is used for checking whether the passed in
+ *  file is a binary scene file rather than the text form.
+ ***********************************************************/
+bool SceneFile::IsBinarySceneFile(const std::string& filename)
+{
+	char magic[4] = { 0, 0, 0, 0 };
+	std::ifstream file(filename.c_str(), std::ios::binary);
+	file.read(magic, sizeof(magic));
+
+	return((file.good() == true) && (memcmp(magic, "SCNE", 4) == 0));
+}
@@ -0,0 +1,162 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.h
+// ============
+// map a binary scene description of objects, textures, materials and lights
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MappedFile.h"
+#include "SceneMeshes.h"
+
+#include <cstdint>
+#include <string>
+
+/***********************************************************
+ *  SceneFile
+ *
+ *  This class maps a binary scene file written by
+ *  SceneFileBuilder and hands out its contents in place.
+ *  The objects are stored as one flat array per property,
+ *  so a scene of any size is read without allocating
+ *  anything per object.  Textures and materials are named
+ *  by tag, and objects refer to them, and to their parent
+ *  object, by index.
+ ***********************************************************/
+class SceneFile
+{
+public:
+	// constructor
+	SceneFile();
+	// destructor
+	~SceneFile();
+
+	// format version written in the scene header
+	static const uint32_t SCENE_VERSION = 2;
+	// longest tag, including the terminating zero
+	static const int MAX_TAG_LENGTH = 32;
+	// longest texture filename, including the terminating zero
+	static const int MAX_FILENAME_LENGTH = 128;
+
+	// header at the start of the scene file
+	struct SCENE_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t textureCount;
+		uint32_t materialCount;
+		uint32_t lightCount;
+		uint32_t objectCount;
+		uint32_t reserved[2];
+		uint64_t textureOffset;
+		uint64_t materialOffset;
+		uint64_t lightOffset;
+		uint64_t objectOffset;
+	};
+
+	struct TEXTURE_RECORD
+	{
+		char tag[MAX_TAG_LENGTH];
+		char filename[MAX_FILENAME_LENGTH];
+	};
+
+	struct MATERIAL_RECORD
+	{
+		char tag[MAX_TAG_LENGTH];
+		float ambientColor[3];
+		float ambientStrength;
+		float diffuseColor[3];
+		float specularColor[3];
+		float shininess;
+		// SamplerCache::SAMPLER_PRESET
+		int32_t samplerPreset;
+	};
+
+	struct LIGHT_RECORD
+	{
+		float position[3];
+		float ambientColor[3];
+		float diffuseColor[3];
+		float specularColor[3];
+		float focalStrength;
+		float specularIntensity;
+		// distance the light fades out at, 0 to reach everywhere
+		float range;
+	};
+
+	// per object arrays, stored one after another in this order
+	enum OBJECT_ARRAY
+	{
+		// index of the parent object, -1 for none, always below the object's own
+		OBJECT_PARENTS = 0,
+		// SceneMeshes::MESH_SHAPE
+		OBJECT_MESHES,
+		// index of the texture, -1 to draw with the color
+		OBJECT_TEXTURES,
+		// index of the material, -1 for the material of the object before it
+		OBJECT_MATERIALS,
+		// x, y, z
+		OBJECT_SCALES,
+		// x, y, z in degrees
+		OBJECT_ROTATIONS,
+		// x, y, z relative to the parent
+		OBJECT_POSITIONS,
+		// r, g, b, a
+		OBJECT_COLORS,
+		// u, v
+		OBJECT_UV_SCALES,
+		OBJECT_ARRAY_COUNT
+	};
+
+	// map the passed in scene file
+	bool Open(const std::string& filename);
+	// unmap the scene file
+	void Close();
+	bool IsOpen() const;
+
+	int GetTextureCount() const;
+	int GetMaterialCount() const;
+	int GetLightCount() const;
+	int GetObjectCount() const;
+
+	const TEXTURE_RECORD& GetTexture(int index) const;
+	const MATERIAL_RECORD& GetMaterial(int index) const;
+	const LIGHT_RECORD& GetLight(int index) const;
+
+	// per object arrays, indexed by object
+	const int32_t* GetParents() const;
+	const int32_t* GetMeshes() const;
+	const int32_t* GetTextures() const;
+	const int32_t* GetMaterials() const;
+	// three floats per object
+	const float* GetScales() const;
+	const float* GetRotations() const;
+	const float* GetPositions() const;
+	// four floats per object
+	const float* GetColors() const;
+	// two floats per object
+	const float* GetUVScales() const;
+
+	// offset of a per object array from the start of the object arrays
+	static uint64_t GetObjectArrayOffset(OBJECT_ARRAY objectArray, uint32_t objectCount);
+	// true when the file starts with the binary scene magic
+	static bool IsBinarySceneFile(const std::string& filename);
+
+private:
+	MappedFile m_mappedFile;
+	SCENE_HEADER m_header;
+	const TEXTURE_RECORD* m_pTextures;
+	const MATERIAL_RECORD* m_pMaterials;
+	const LIGHT_RECORD* m_pLights;
+	const unsigned char* m_pObjectArrays;
+
+	// start of a per object array in the mapping
+	const void* GetObjectArray(OBJECT_ARRAY objectArray) const;
+
+	// scene files own a file mapping, so they are not copied
+	SceneFile(const SceneFile&);
+	SceneFile& operator=(const SceneFile&);
+};
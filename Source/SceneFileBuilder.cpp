@@ -0,0 +1,655 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefilebuilder.cpp
+// ============
+// compile a text scene description into a binary scene file
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneFileBuilder.h"
+#include "SamplerCache.h"
+#include "SceneMeshes.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+// declaration of global variables
+namespace
+{
+	/***********************************************************
+	 *  ReadFloats()
+	 *
+	 *  Read a number of floats from the rest of a line.
+	 ***********************************************************/
+	bool ReadFloats(std::istringstream& line, float* values, int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			if (!(line >> values[i]))
+			{
+				return(false);
+			}
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  FindMeshShape()
+	 *
+	 *  Find a shape by the last part of its asset pack name,
+	 *  such as "box", or -1 for none.
+	 ***********************************************************/
+	int FindMeshShape(const std::string& name)
+	{
+		for (int i = 0; i < SceneMeshes::MESH_SHAPE_COUNT; i++)
+		{
+			const char* shapeName = strrchr(SceneMeshes::GetShapeName((SceneMeshes::MESH_SHAPE)i), '/');
+			if ((NULL != shapeName) && (name.compare(shapeName + 1) == 0))
+			{
+				return(i);
+			}
+		}
+
+		return(-1);
+	}
+
+	/***********************************************************
+	 *  FindSamplerPreset()
+	 *
+	 *  Find a sampler preset by its short name, or -1 for none.
+	 ***********************************************************/
+	int FindSamplerPreset(const std::string& name)
+	{
+		for (int i = 0; i < SamplerCache::SAMPLER_PRESET_COUNT; i++)
+		{
+			if (name.compare(SamplerCache::GetPresetName((SamplerCache::SAMPLER_PRESET)i)) == 0)
+			{
+				return(i);
+			}
+		}
+
+		return(-1);
+	}
+
+	/***********************************************************
+	 *  WritePadding()
+	 *
+	 *  Write zeros up to the next multiple of the alignment.
+	 ***********************************************************/
+	void WritePadding(std::ofstream& file, uint64_t& offset, uint64_t alignment)
+	{
+		const char padding[16] = { 0 };
+		uint64_t paddingSize = (alignment - (offset % alignment)) % alignment;
+
+		file.write(padding, (std::streamsize)paddingSize);
+		offset += paddingSize;
+	}
+
+	/***********************************************************
+	 *  WriteArray()
+	 *
+	 *  Write the contents of a vector of records or values.
+	 ***********************************************************/
+	template <typename T>
+	void WriteArray(std::ofstream& file, uint64_t& offset, const std::vector<T>& values)
+	{
+		if (values.empty() == false)
+		{
+			file.write((const char*)&values[0], (std::streamsize)(values.size() * sizeof(T)));
+			offset += values.size() * sizeof(T);
+		}
+	}
+}
+
+/***********************************************************
+ *  SceneFileBuilder()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneFileBuilder::SceneFileBuilder()
+{
+}
+
+/***********************************************************
+ *  ~SceneFileBuilder()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneFileBuilder::~SceneFileBuilder()
+{
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for adding a texture image file
+ *  under a tag.  Tags must be unique and both must fit the
+ *  record.
+ ***********************************************************/
+int SceneFileBuilder::AddTexture(const std::string& tag, const std::string& filename)
+{
+	if ((tag.empty() == true) || (tag.size() >= (size_t)SceneFile::MAX_TAG_LENGTH) ||
+		(filename.empty() == true) || (filename.size() >= (size_t)SceneFile::MAX_FILENAME_LENGTH) ||
+		(FindTexture(tag) >= 0))
+	{
+		return(-1);
+	}
+
+	SceneFile::TEXTURE_RECORD texture;
+	memset(&texture, 0, sizeof(texture));
+	memcpy(texture.tag, tag.c_str(), tag.size());
+	memcpy(texture.filename, filename.c_str(), filename.size());
+	m_textures.push_back(texture);
+
+	return((int)m_textures.size() - 1);
+}
+
+/***********************************************************
+ *  AddMaterial()
+ *
+ *  This method is used for adding a material under a tag.
+ *  Tags must be unique and fit the record.
+ ***********************************************************/
+int SceneFileBuilder::AddMaterial(
+	const std::string& tag,
+	glm::vec3 ambientColor,
+	float ambientStrength,
+	glm::vec3 diffuseColor,
+	glm::vec3 specularColor,
+	float shininess,
+	int samplerPreset)
+{
+	if ((tag.empty() == true) || (tag.size() >= (size_t)SceneFile::MAX_TAG_LENGTH) ||
+		(samplerPreset < 0) || (samplerPreset >= SamplerCache::SAMPLER_PRESET_COUNT) ||
+		(FindMaterial(tag) >= 0))
+	{
+		return(-1);
+	}
+
+	SceneFile::MATERIAL_RECORD material;
+	memset(&material, 0, sizeof(material));
+	memcpy(material.tag, tag.c_str(), tag.size());
+	for (int i = 0; i < 3; i++)
+	{
+		material.ambientColor[i] = ambientColor[i];
+		material.diffuseColor[i] = diffuseColor[i];
+		material.specularColor[i] = specularColor[i];
+	}
+	material.ambientStrength = ambientStrength;
+	material.shininess = shininess;
+	material.samplerPreset = samplerPreset;
+	m_materials.push_back(material);
+
+	return((int)m_materials.size() - 1);
+}
+
+/***********************************************************
+ *  AddLight()
+ *
+ *  This method is used for adding a light source.  A light
+ *  with a range fades out at it, and one with a range of 0
+ *  reaches everywhere.
+ ***********************************************************/
+int SceneFileBuilder::AddLight(
+	glm::vec3 position,
+	glm::vec3 ambientColor,
+	glm::vec3 diffuseColor,
+	glm::vec3 specularColor,
+	float focalStrength,
+	float specularIntensity,
+	float range)
+{
+	SceneFile::LIGHT_RECORD light;
+	for (int i = 0; i < 3; i++)
+	{
+		light.position[i] = position[i];
+		light.ambientColor[i] = ambientColor[i];
+		light.diffuseColor[i] = diffuseColor[i];
+		light.specularColor[i] = specularColor[i];
+	}
+	light.focalStrength = focalStrength;
+	light.specularIntensity = specularIntensity;
+	light.range = range;
+	m_lights.push_back(light);
+
+	return((int)m_lights.size() - 1);
+}
+
+/***********************************************************
+ *  AddObject()
+ *
+ *  This method is used for adding an object.  The parent
+ *  must be an object added earlier, or -1 for none, and the
+ *  texture and material must have been added already, or
+ *  be -1 to draw with the color and to use the material of
+ *  the object added before.
+ ***********************************************************/
+int SceneFileBuilder::AddObject(
+	int parent,
+	int mesh,
+	int texture,
+	int material,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ,
+	glm::vec4 color,
+	glm::vec2 UVscale)
+{
+	int objectIndex = GetObjectCount();
+	if ((parent < -1) || (parent >= objectIndex) || (mesh < 0) || (mesh >= SceneMeshes::MESH_SHAPE_COUNT) ||
+		(texture < -1) || (texture >= (int)m_textures.size()) ||
+		(material < -1) || (material >= (int)m_materials.size()))
+	{
+		return(-1);
+	}
+
+	m_objectInts[SceneFile::OBJECT_PARENTS].push_back(parent);
+	m_objectInts[SceneFile::OBJECT_MESHES].push_back(mesh);
+	m_objectInts[SceneFile::OBJECT_TEXTURES].push_back(texture);
+	m_objectInts[SceneFile::OBJECT_MATERIALS].push_back(material);
+
+	// the float arrays are counted from OBJECT_SCALES
+	std::vector<float>& scales = m_objectFloats[SceneFile::OBJECT_SCALES - SceneFile::OBJECT_SCALES];
+	std::vector<float>& rotations = m_objectFloats[SceneFile::OBJECT_ROTATIONS - SceneFile::OBJECT_SCALES];
+	std::vector<float>& positions = m_objectFloats[SceneFile::OBJECT_POSITIONS - SceneFile::OBJECT_SCALES];
+	std::vector<float>& colors = m_objectFloats[SceneFile::OBJECT_COLORS - SceneFile::OBJECT_SCALES];
+	std::vector<float>& UVscales = m_objectFloats[SceneFile::OBJECT_UV_SCALES - SceneFile::OBJECT_SCALES];
+	for (int i = 0; i < 3; i++)
+	{
+		scales.push_back(scaleXYZ[i]);
+		positions.push_back(positionXYZ[i]);
+	}
+	rotations.push_back(XrotationDegrees);
+	rotations.push_back(YrotationDegrees);
+	rotations.push_back(ZrotationDegrees);
+	for (int i = 0; i < 4; i++)
+	{
+		colors.push_back(color[i]);
+	}
+	UVscales.push_back(UVscale.x);
+	UVscales.push_back(UVscale.y);
+
+	return(objectIndex);
+}
+
+/***********************************************************
+ *  FindTexture()
+ *
+ *  This method is used for finding the index of an added
+ *  texture by tag, or -1 when none has it.
+ ***********************************************************/
+int SceneFileBuilder::FindTexture(const std::string& tag) const
+{
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		if (tag.compare(m_textures[i].tag) == 0)
+		{
+			return((int)i);
+		}
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  FindMaterial()
+ *
+ *  This method is used for finding the index of an added
+ *  material by tag, or -1 when none has it.
+ ***********************************************************/
+int SceneFileBuilder::FindMaterial(const std::string& tag) const
+{
+	for (size_t i = 0; i < m_materials.size(); i++)
+	{
+		if (tag.compare(m_materials[i].tag) == 0)
+		{
+			return((int)i);
+		}
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  CompileText()
+ *
+ *  This method is used for adding every texture, material,
+ *  light and object declared in a text scene file.  The
+ *  first mistake is reported with its line number and stops
+ *  the compile, and nothing is added in that case.
+ ***********************************************************/
+bool SceneFileBuilder::CompileText(const std::string& textFilename)
+{
+	std::ifstream file(textFilename.c_str());
+	if (!file)
+	{
+		std::cout << "Could not open scene file:" << textFilename << std::endl;
+		return(false);
+	}
+
+	// object names are only needed to find the parents
+	std::unordered_map<std::string, int> objectIndices;
+	std::string error;
+	std::string text;
+	int lineNumber = 0;
+	while ((error.empty() == true) && (std::getline(file, text)))
+	{
+		lineNumber++;
+		size_t comment = text.find('#');
+		if (comment != std::string::npos)
+		{
+			text.erase(comment);
+		}
+
+		std::istringstream line(text);
+		std::string keyword;
+		if (!(line >> keyword))
+		{
+			continue;
+		}
+
+		if (keyword == "texture")
+		{
+			std::string tag;
+			std::string filename;
+			if (!(line >> tag >> filename))
+			{
+				error = "texture needs a tag and a filename";
+			}
+			else if (AddTexture(tag, filename) < 0)
+			{
+				error = "texture " + tag + " is repeated or too long";
+			}
+		}
+		else if (keyword == "material")
+		{
+			std::string tag;
+			float ambientColor[3] = { 1.0f, 1.0f, 1.0f };
+			float ambientStrength = 0.2f;
+			float diffuseColor[3] = { 1.0f, 1.0f, 1.0f };
+			float specularColor[3] = { 1.0f, 1.0f, 1.0f };
+			float shininess = 32.0f;
+			int samplerPreset = SamplerCache::SAMPLER_TRILINEAR;
+			std::string field;
+
+			if (!(line >> tag))
+			{
+				error = "material needs a tag";
+			}
+			while ((error.empty() == true) && (line >> field))
+			{
+				std::string presetName;
+				if (((field == "ambient") && (ReadFloats(line, ambientColor, 3) == true)) ||
+					((field == "strength") && (ReadFloats(line, &ambientStrength, 1) == true)) ||
+					((field == "diffuse") && (ReadFloats(line, diffuseColor, 3) == true)) ||
+					((field == "specular") && (ReadFloats(line, specularColor, 3) == true)) ||
+					((field == "shininess") && (ReadFloats(line, &shininess, 1) == true)))
+				{
+					continue;
+				}
+				if ((field == "sampler") && (line >> presetName) && (FindSamplerPreset(presetName) >= 0))
+				{
+					samplerPreset = FindSamplerPreset(presetName);
+					continue;
+				}
+				error = "bad material field " + field;
+			}
+			if ((error.empty() == true) && (AddMaterial(tag,
+				glm::vec3(ambientColor[0], ambientColor[1], ambientColor[2]), ambientStrength,
+				glm::vec3(diffuseColor[0], diffuseColor[1], diffuseColor[2]),
+				glm::vec3(specularColor[0], specularColor[1], specularColor[2]),
+				shininess, samplerPreset) < 0))
+			{
+				error = "material " + tag + " is repeated or too long";
+			}
+		}
+		else if (keyword == "light")
+		{
+			float position[3] = { 0.0f, 0.0f, 0.0f };
+			float ambientColor[3] = { 0.0f, 0.0f, 0.0f };
+			float diffuseColor[3] = { 0.0f, 0.0f, 0.0f };
+			float specularColor[3] = { 0.0f, 0.0f, 0.0f };
+			float focalStrength = 1.0f;
+			float specularIntensity = 0.0f;
+			float range = 0.0f;
+			std::string field;
+
+			while ((error.empty() == true) && (line >> field))
+			{
+				if (((field == "position") && (ReadFloats(line, position, 3) == true)) ||
+					((field == "ambient") && (ReadFloats(line, ambientColor, 3) == true)) ||
+					((field == "diffuse") && (ReadFloats(line, diffuseColor, 3) == true)) ||
+					((field == "specular") && (ReadFloats(line, specularColor, 3) == true)) ||
+					((field == "focal") && (ReadFloats(line, &focalStrength, 1) == true)) ||
+					((field == "intensity") && (ReadFloats(line, &specularIntensity, 1) == true)) ||
+					((field == "range") && (ReadFloats(line, &range, 1) == true) && (range >= 0.0f)))
+				{
+					continue;
+				}
+				error = "bad light field " + field;
+			}
+			if (error.empty() == true)
+			{
+				AddLight(glm::vec3(position[0], position[1], position[2]),
+					glm::vec3(ambientColor[0], ambientColor[1], ambientColor[2]),
+					glm::vec3(diffuseColor[0], diffuseColor[1], diffuseColor[2]),
+					glm::vec3(specularColor[0], specularColor[1], specularColor[2]),
+					focalStrength, specularIntensity, range);
+			}
+		}
+		else if (keyword == "object")
+		{
+			std::string name;
+			int parent = -1;
+			int mesh = -1;
+			int texture = -1;
+			int material = -1;
+			float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+			float UVscale[2] = { 1.0f, 1.0f };
+			float scale[3] = { 1.0f, 1.0f, 1.0f };
+			float rotation[3] = { 0.0f, 0.0f, 0.0f };
+			float position[3] = { 0.0f, 0.0f, 0.0f };
+			std::string field;
+
+			if ((!(line >> name)) || (objectIndices.count(name) > 0))
+			{
+				error = "object needs a name of its own";
+			}
+			while ((error.empty() == true) && (line >> field))
+			{
+				std::string value;
+				if (((field == "color") && (ReadFloats(line, color, 4) == true)) ||
+					((field == "uv") && (ReadFloats(line, UVscale, 2) == true)) ||
+					((field == "scale") && (ReadFloats(line, scale, 3) == true)) ||
+					((field == "rotation") && (ReadFloats(line, rotation, 3) == true)) ||
+					((field == "position") && (ReadFloats(line, position, 3) == true)))
+				{
+					continue;
+				}
+				if (!(line >> value))
+				{
+					error = "missing value for " + field;
+				}
+				else if (field == "parent")
+				{
+					std::unordered_map<std::string, int>::const_iterator found = objectIndices.find(value);
+					parent = (found != objectIndices.end()) ? found->second : -1;
+					if (parent < 0)
+					{
+						error = "parent " + value + " is not declared above";
+					}
+				}
+				else if (field == "mesh")
+				{
+					mesh = FindMeshShape(value);
+					if (mesh < 0)
+					{
+						error = "unknown mesh " + value;
+					}
+				}
+				else if (field == "texture")
+				{
+					texture = FindTexture(value);
+					if (texture < 0)
+					{
+						error = "texture " + value + " is not declared above";
+					}
+				}
+				else if (field == "material")
+				{
+					material = FindMaterial(value);
+					if (material < 0)
+					{
+						error = "material " + value + " is not declared above";
+					}
+				}
+				else
+				{
+					error = "bad object field " + field;
+				}
+			}
+			if ((error.empty() == true) && (mesh < 0))
+			{
+				error = "object " + name + " needs a mesh";
+			}
+			if (error.empty() == true)
+			{
+				objectIndices[name] = AddObject(parent, mesh, texture, material,
+					glm::vec3(scale[0], scale[1], scale[2]), rotation[0], rotation[1], rotation[2],
+					glm::vec3(position[0], position[1], position[2]),
+					glm::vec4(color[0], color[1], color[2], color[3]), glm::vec2(UVscale[0], UVscale[1]));
+			}
+		}
+		else
+		{
+			error = "unknown declaration " + keyword;
+		}
+	}
+
+	if (error.empty() == false)
+	{
+		std::cout << "Scene file error:" << textFilename << "(" << lineNumber << "): " << error << std::endl;
+		Clear();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Write()
+ *
+ *  This method is used for writing the binary scene file.
+ *  The file is written under a temporary name and only
+ *  replaces an existing scene file once it is complete, so
+ *  a scene being loaded is never seen half written.
+ ***********************************************************/
+bool SceneFileBuilder::Write(const std::string& sceneFilename) const
+{
+	std::string tempFilename = sceneFilename + ".tmp";
+	std::ofstream file(tempFilename.c_str(), std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		return(false);
+	}
+
+	SceneFile::SCENE_HEADER header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "SCNE", 4);
+	header.version = SceneFile::SCENE_VERSION;
+	header.textureCount = (uint32_t)m_textures.size();
+	header.materialCount = (uint32_t)m_materials.size();
+	header.lightCount = (uint32_t)m_lights.size();
+	header.objectCount = (uint32_t)GetObjectCount();
+
+	uint64_t offset = 0;
+	file.write((const char*)&header, sizeof(header));
+	offset += sizeof(header);
+
+	WritePadding(file, offset, 8);
+	header.textureOffset = offset;
+	WriteArray(file, offset, m_textures);
+	WritePadding(file, offset, 8);
+	header.materialOffset = offset;
+	WriteArray(file, offset, m_materials);
+	WritePadding(file, offset, 8);
+	header.lightOffset = offset;
+	WriteArray(file, offset, m_lights);
+
+	// each per object array starts on the boundary SceneFile expects
+	WritePadding(file, offset, 16);
+	header.objectOffset = offset;
+	for (int i = 0; i < SceneFile::OBJECT_ARRAY_COUNT; i++)
+	{
+		WritePadding(file, offset, 16);
+		if (i < SceneFile::OBJECT_SCALES)
+		{
+			WriteArray(file, offset, m_objectInts[i]);
+		}
+		else
+		{
+			WriteArray(file, offset, m_objectFloats[i - SceneFile::OBJECT_SCALES]);
+		}
+	}
+	WritePadding(file, offset, 16);
+
+	file.seekp(0, std::ios::beg);
+	file.write((const char*)&header, sizeof(header));
+
+	file.close();
+	if (!file)
+	{
+		std::remove(tempFilename.c_str());
+		return(false);
+	}
+
+	// rename does not replace an existing file on Windows
+	std::remove(sceneFilename.c_str());
+	if (std::rename(tempFilename.c_str(), sceneFilename.c_str()) != 0)
+	{
+		std::remove(tempFilename.c_str());
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing everything added so
+ *  far, to start on another scene.
+ ***********************************************************/
+void SceneFileBuilder::Clear()
+{
+	m_textures.clear();
+	m_materials.clear();
+	m_lights.clear();
+	for (int i = 0; i < SceneFile::OBJECT_SCALES; i++)
+	{
+		m_objectInts[i].clear();
+	}
+	for (int i = 0; i < SceneFile::OBJECT_ARRAY_COUNT - SceneFile::OBJECT_SCALES; i++)
+	{
+		m_objectFloats[i].clear();
+	}
+}
+
+/***********************************************************
+ *  GetObjectCount()
+ *
+ *  This method is used for getting the number of objects
+ *  added so far.
+ ***********************************************************/
+int SceneFileBuilder::GetObjectCount() const
+{
+	return((int)m_objectInts[SceneFile::OBJECT_PARENTS].size());
+}
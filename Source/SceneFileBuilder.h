@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefilebuilder.h
+// ============
+// compile a text scene description into a binary scene file
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneFile.h"
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  SceneFileBuilder
+ *
+ *  This class writes the binary scene file read by
+ *  SceneFile.  The scene is either added piece by piece or
+ *  compiled from its text form, one declaration per line:
+ *
+ *    texture <tag> <filename>
+ *    material <tag> [ambient r g b] [strength s] [diffuse r g b]
+ *      [specular r g b] [shininess n] [sampler <preset>]
+ *    light [position x y z] [ambient r g b] [diffuse r g b]
+ *      [specular r g b] [focal f] [intensity i] [range r]
+ *    object <name> mesh <plane|box|cylinder|sphere>
+ *      [parent <name>] [texture <tag>] [material <tag>]
+ *      [color r g b a] [uv u v] [scale x y z]
+ *      [rotation x y z] [position x y z]
+ *
+ *  Anything after a # is a comment.  Textures, materials
+ *  and parents must be declared before they are used.
+ ***********************************************************/
+class SceneFileBuilder
+{
+public:
+	// constructor
+	SceneFileBuilder();
+	// destructor
+	~SceneFileBuilder();
+
+	// add a texture and get back its index, or -1
+	int AddTexture(const std::string& tag, const std::string& filename);
+	// add a material and get back its index, or -1
+	int AddMaterial(
+		const std::string& tag,
+		glm::vec3 ambientColor,
+		float ambientStrength,
+		glm::vec3 diffuseColor,
+		glm::vec3 specularColor,
+		float shininess,
+		int samplerPreset);
+	// add a light and get back its index
+	int AddLight(
+		glm::vec3 position,
+		glm::vec3 ambientColor,
+		glm::vec3 diffuseColor,
+		glm::vec3 specularColor,
+		float focalStrength,
+		float specularIntensity,
+		float range = 0.0f);
+	// add an object under an earlier object, or a root for -1, and get back its index
+	int AddObject(
+		int parent,
+		int mesh,
+		int texture,
+		int material,
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ,
+		glm::vec4 color,
+		glm::vec2 UVscale);
+
+	// find an added texture or material by tag
+	int FindTexture(const std::string& tag) const;
+	int FindMaterial(const std::string& tag) const;
+
+	// add everything declared in a text scene file
+	bool CompileText(const std::string& textFilename);
+	// write the binary scene file, replacing any existing one
+	bool Write(const std::string& sceneFilename) const;
+	// remove everything added so far
+	void Clear();
+
+	int GetObjectCount() const;
+
+private:
+	std::vector<SceneFile::TEXTURE_RECORD> m_textures;
+	std::vector<SceneFile::MATERIAL_RECORD> m_materials;
+	std::vector<SceneFile::LIGHT_RECORD> m_lights;
+	// per object values, laid out as in the scene file
+	std::vector<int32_t> m_objectInts[SceneFile::OBJECT_SCALES];
+	std::vector<float> m_objectFloats[SceneFile::OBJECT_ARRAY_COUNT - SceneFile::OBJECT_SCALES];
+
+	// builders hold a whole scene, so they are not copied
+	SceneFileBuilder(const SceneFileBuilder&);
+	SceneFileBuilder& operator=(const SceneFileBuilder&);
+};
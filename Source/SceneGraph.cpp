@@ -0,0 +1,400 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenegraph.cpp
+// ============
+// place scene objects relative to their parents in a flattened hierarchy
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneGraph.h"
+#include "TransformBatch.h"
+
+#include <algorithm>
+
+/***********************************************************
+ *  SceneGraph()
+ *
+ *  The constructor for the class.
+ ***********************************************************/
+SceneGraph::SceneGraph()
+{
+	m_updatedNodeCount = 0;
+}
+
+/***********************************************************
+ *  ~SceneGraph()
+ *
+ *  The destructor for the class.
+ ***********************************************************/
+SceneGraph::~SceneGraph()
+{
+}
+
+/***********************************************************
+ *  AddNode()
+ *
+ *  This method is used for adding a node under the passed
+ *  in parent, or as a root when the parent is -1.  The node
+ *  goes in right after the nodes already under its parent,
+ *  which keeps every subtree contiguous.  IDs stay the same
+ *  for the life of the graph, even though the positions of
+ *  later nodes move along when a node is added before them.
+ ***********************************************************/
+int SceneGraph::AddNode(
+	int parentID,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	int parentIndex = -1;
+	int index = GetNodeCount();
+	if ((parentID >= 0) && (parentID < (int)m_nodeIndices.size()))
+	{
+		parentIndex = m_nodeIndices[parentID];
+		index = m_subtreeEnds[parentIndex];
+	}
+
+	// the ancestors of the new node grow by one node, and
+	// everything after it moves along by one position
+	std::vector<bool> bAncestor(m_parentIndices.size(), false);
+	for (int ancestor = parentIndex; ancestor >= 0; ancestor = m_parentIndices[ancestor])
+	{
+		bAncestor[ancestor] = true;
+	}
+	for (size_t i = 0; i < m_parentIndices.size(); i++)
+	{
+		if ((bAncestor[i] == true) || (m_subtreeEnds[i] > index))
+		{
+			m_subtreeEnds[i]++;
+		}
+		if (m_parentIndices[i] >= index)
+		{
+			m_parentIndices[i]++;
+		}
+	}
+	for (size_t i = 0; i < m_nodeIndices.size(); i++)
+	{
+		if (m_nodeIndices[i] >= index)
+		{
+			m_nodeIndices[i]++;
+		}
+	}
+
+	int nodeID = (int)m_nodeIndices.size();
+	m_parentIndices.insert(m_parentIndices.begin() + index, parentIndex);
+	m_subtreeEnds.insert(m_subtreeEnds.begin() + index, index + 1);
+	m_scales.insert(m_scales.begin() + index, scaleXYZ);
+	m_rotations.insert(m_rotations.begin() + index, glm::vec3(XrotationDegrees, YrotationDegrees, ZrotationDegrees));
+	m_positions.insert(m_positions.begin() + index, positionXYZ);
+	m_frames.insert(m_frames.begin() + index, glm::mat4(1.0f));
+	m_modelMatrices.insert(m_modelMatrices.begin() + index, glm::mat4(1.0f));
+	m_normalMatrices.insert(m_normalMatrices.begin() + index, glm::mat4(1.0f));
+	m_dirty.insert(m_dirty.begin() + index, false);
+	m_nodeIDs.insert(m_nodeIDs.begin() + index, nodeID);
+	m_nodeIndices.push_back(index);
+
+	MarkDirty(nodeID);
+
+	return(nodeID);
+}
+
+/***********************************************************
+ *  SetLocalTransform()
+ *
+ *  This method is used for changing the scale, rotation and
+ *  position of a node relative to its parent.  The node is
+ *  only marked for updating when the transform differs.
+ ***********************************************************/
+void SceneGraph::SetLocalTransform(
+	int nodeID,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	if ((nodeID < 0) || (nodeID >= (int)m_nodeIndices.size()))
+	{
+		return;
+	}
+
+	int index = m_nodeIndices[nodeID];
+	glm::vec3 rotation(XrotationDegrees, YrotationDegrees, ZrotationDegrees);
+	if ((m_scales[index] != scaleXYZ) || (m_rotations[index] != rotation) || (m_positions[index] != positionXYZ))
+	{
+		m_scales[index] = scaleXYZ;
+		m_rotations[index] = rotation;
+		m_positions[index] = positionXYZ;
+		MarkDirty(nodeID);
+	}
+}
+
+/***********************************************************
+ *  SetLocalPosition()
+ *
+ *  This method is used for moving a node relative to its
+ *  parent.  The nodes under it move along with it.
+ ***********************************************************/
+void SceneGraph::SetLocalPosition(int nodeID, glm::vec3 positionXYZ)
+{
+	if ((nodeID < 0) || (nodeID >= (int)m_nodeIndices.size()))
+	{
+		return;
+	}
+
+	int index = m_nodeIndices[nodeID];
+	SetLocalTransform(nodeID, m_scales[index], m_rotations[index].x, m_rotations[index].y,
+		m_rotations[index].z, positionXYZ);
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used for replacing the whole graph with
+ *  nodes read from flat arrays, such as a mapped scene file,
+ *  with three floats per node for the scales, rotations and
+ *  positions.  Every parent must come before its children.
+ *  The depth first order is laid out in two passes, the
+ *  first summing the subtree sizes from the last node back
+ *  and the second handing each node the next free position
+ *  under its parent, so the nodes end up where AddNode()
+ *  would have put them, without moving any along.  Node IDs
+ *  are the array indices.  Nothing changes when a parent is
+ *  out of order.
+ ***********************************************************/
+bool SceneGraph::Build(
+	int nodeCount,
+	const int32_t* parentIDs,
+	const float* scales,
+	const float* rotations,
+	const float* positions)
+{
+	for (int i = 0; i < nodeCount; i++)
+	{
+		if ((parentIDs[i] < -1) || (parentIDs[i] >= i))
+		{
+			return(false);
+		}
+	}
+
+	std::vector<int> subtreeSizes(nodeCount, 1);
+	for (int i = nodeCount - 1; i > 0; i--)
+	{
+		if (parentIDs[i] >= 0)
+		{
+			subtreeSizes[parentIDs[i]] += subtreeSizes[i];
+		}
+	}
+
+	m_parentIndices.resize(nodeCount);
+	m_subtreeEnds.resize(nodeCount);
+	m_scales.resize(nodeCount);
+	m_rotations.resize(nodeCount);
+	m_positions.resize(nodeCount);
+	m_frames.resize(nodeCount);
+	m_modelMatrices.resize(nodeCount);
+	m_normalMatrices.resize(nodeCount);
+	m_dirty.assign(nodeCount, false);
+	m_nodeIDs.resize(nodeCount);
+	m_nodeIndices.resize(nodeCount);
+	m_dirtyNodes.clear();
+
+	// the next free position under each node, reusing the sizes
+	std::vector<int>& nextChildIndices = subtreeSizes;
+	int nextRootIndex = 0;
+	for (int nodeID = 0; nodeID < nodeCount; nodeID++)
+	{
+		int size = subtreeSizes[nodeID];
+		int parentIndex = -1;
+		int index = nextRootIndex;
+		if (parentIDs[nodeID] >= 0)
+		{
+			parentIndex = m_nodeIndices[parentIDs[nodeID]];
+			index = nextChildIndices[parentIDs[nodeID]];
+			nextChildIndices[parentIDs[nodeID]] += size;
+		}
+		else
+		{
+			nextRootIndex += size;
+		}
+		nextChildIndices[nodeID] = index + 1;
+
+		m_parentIndices[index] = parentIndex;
+		m_subtreeEnds[index] = index + size;
+		m_scales[index] = glm::vec3(scales[nodeID * 3], scales[nodeID * 3 + 1], scales[nodeID * 3 + 2]);
+		m_rotations[index] = glm::vec3(rotations[nodeID * 3], rotations[nodeID * 3 + 1], rotations[nodeID * 3 + 2]);
+		m_positions[index] = glm::vec3(positions[nodeID * 3], positions[nodeID * 3 + 1], positions[nodeID * 3 + 2]);
+		m_nodeIDs[index] = nodeID;
+		m_nodeIndices[nodeID] = index;
+
+		// updating the roots updates every node
+		if (parentIndex < 0)
+		{
+			MarkDirty(nodeID);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for updating the matrices of the
+ *  nodes changed since the last call, along with the nodes
+ *  under them.  The changed nodes are visited in depth first
+ *  order, and a node inside a subtree that was just updated
+ *  is skipped, so the work follows the number of nodes that
+ *  moved rather than the size of the scene.
+ ***********************************************************/
+void SceneGraph::Update()
+{
+	m_updatedNodeCount = 0;
+	if (m_dirtyNodes.empty() == true)
+	{
+		return;
+	}
+
+	std::vector<int> dirtyIndices;
+	dirtyIndices.reserve(m_dirtyNodes.size());
+	for (size_t i = 0; i < m_dirtyNodes.size(); i++)
+	{
+		int index = m_nodeIndices[m_dirtyNodes[i]];
+		dirtyIndices.push_back(index);
+		m_dirty[index] = false;
+	}
+	m_dirtyNodes.clear();
+	std::sort(dirtyIndices.begin(), dirtyIndices.end());
+
+	int updatedEnd = 0;
+	for (size_t i = 0; i < dirtyIndices.size(); i++)
+	{
+		if (dirtyIndices[i] >= updatedEnd)
+		{
+			updatedEnd = m_subtreeEnds[dirtyIndices[i]];
+			UpdateRange(dirtyIndices[i], updatedEnd);
+		}
+	}
+}
+
+/***********************************************************
+ *  UpdateRange()
+ *
+ *  This method is used for updating the matrices of the
+ *  nodes at positions [first, last).  Parents come before
+ *  their children, so each frame is built on a parent frame
+ *  that is already up to date.  The model matrix columns
+ *  are a rotation scaled on each axis, so dividing them by
+ *  their squared lengths gives the normal matrix.
+ ***********************************************************/
+void SceneGraph::UpdateRange(int first, int last)
+{
+	for (int index = first; index < last; index++)
+	{
+		glm::mat4 localFrame = TransformBatch::ComposeModelMatrix(glm::vec3(1.0f, 1.0f, 1.0f),
+			m_rotations[index].x, m_rotations[index].y, m_rotations[index].z, m_positions[index]);
+		if (m_parentIndices[index] >= 0)
+		{
+			m_frames[index] = m_frames[m_parentIndices[index]] * localFrame;
+		}
+		else
+		{
+			m_frames[index] = localFrame;
+		}
+
+		glm::mat4& modelMatrix = m_modelMatrices[index];
+		glm::mat4& normalMatrix = m_normalMatrices[index];
+		modelMatrix = m_frames[index];
+		normalMatrix = glm::mat4(1.0f);
+		for (int column = 0; column < 3; column++)
+		{
+			modelMatrix[column] = m_frames[index][column] * m_scales[index][column];
+			float scaleSquared = m_scales[index][column] * m_scales[index][column];
+			if (scaleSquared > 0.0f)
+			{
+				normalMatrix[column] = modelMatrix[column] * (1.0f / scaleSquared);
+			}
+			else
+			{
+				normalMatrix[column] = glm::vec4(0.0f);
+			}
+		}
+	}
+
+	m_updatedNodeCount += last - first;
+}
+
+/***********************************************************
+ *  MarkDirty()
+ *
+ *  This method is used for queueing a node for the next
+ *  Update() call, once however often it changes.
+ ***********************************************************/
+void SceneGraph::MarkDirty(int nodeID)
+{
+	int index = m_nodeIndices[nodeID];
+	if (m_dirty[index] == false)
+	{
+		m_dirty[index] = true;
+		m_dirtyNodes.push_back(nodeID);
+	}
+}
+
+/***********************************************************
+ *  GetModelMatrix()
+ *
+ *  This method is used for getting the model matrix of a
+ *  node as of the last Update() call.
+ ***********************************************************/
+const glm::mat4& SceneGraph::GetModelMatrix(int nodeID) const
+{
+	return(m_modelMatrices[m_nodeIndices[nodeID]]);
+}
+
+/***********************************************************
+ *  GetNormalMatrix()
+ *
+ *  This method is used for getting the matrix that carries
+ *  the normals of a node into world space.  Only its upper
+ *  3x3 part is used.
+ ***********************************************************/
+const glm::mat4& SceneGraph::GetNormalMatrix(int nodeID) const
+{
+	return(m_normalMatrices[m_nodeIndices[nodeID]]);
+}
+
+/***********************************************************
+ *  GetScale()
+ *
+ *  This method is used for getting the scale of the shape
+ *  of a node.
+ ***********************************************************/
+glm::vec3 SceneGraph::GetScale(int nodeID) const
+{
+	return(m_scales[m_nodeIndices[nodeID]]);
+}
+
+/***********************************************************
+ *  GetNodeCount()
+ *
+ *  This method is used for getting the number of nodes in
+ *  the graph.
+ ***********************************************************/
+int SceneGraph::GetNodeCount() const
+{
+	return((int)m_nodeIndices.size());
+}
+
+/***********************************************************
+ *  GetUpdatedNodeCount()
+ *
+ *  This method is used for getting the number of nodes
+ *  whose matrices were updated by the last Update() call.
+ ***********************************************************/
+int SceneGraph::GetUpdatedNodeCount() const
+{
+	return(m_updatedNodeCount);
+}
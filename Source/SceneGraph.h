@@ -0,0 +1,107 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenegraph.h
+// ============
+// place scene objects relative to their parents in a flattened hierarchy
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  SceneGraph
+ *
+ *  This class keeps the scene objects in a parent and child
+ *  hierarchy, where each node is placed by a position and
+ *  rotation relative to its parent.  The nodes are stored
+ *  depth first in flat arrays, so the nodes under any node
+ *  follow it in one contiguous run, and a node that moves
+ *  only updates that run.  The scale of a node sizes its
+ *  own shape and is not passed on to its children, so parts
+ *  keep their own proportions whatever they are attached to.
+ ***********************************************************/
+class SceneGraph
+{
+public:
+	// constructor
+	SceneGraph();
+	// destructor
+	~SceneGraph();
+
+	// add a node under a parent, or a root for -1, and get back its ID
+	int AddNode(
+		int parentID,
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+	// change the transform of a node relative to its parent
+	void SetLocalTransform(
+		int nodeID,
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+	// move a node relative to its parent, keeping its rotation and scale
+	void SetLocalPosition(int nodeID, glm::vec3 positionXYZ);
+	// replace the graph with nodes whose IDs are their array indices
+	bool Build(
+		int nodeCount,
+		const int32_t* parentIDs,
+		const float* scales,
+		const float* rotations,
+		const float* positions);
+
+	// update the matrices of the changed nodes and the nodes under them
+	void Update();
+
+	// model matrix of a node, including its own scale
+	const glm::mat4& GetModelMatrix(int nodeID) const;
+	// inverse transpose of the model matrix, for transforming normals
+	const glm::mat4& GetNormalMatrix(int nodeID) const;
+	// scale of the shape of a node
+	glm::vec3 GetScale(int nodeID) const;
+
+	int GetNodeCount() const;
+	// nodes whose matrices were updated by the last Update() call
+	int GetUpdatedNodeCount() const;
+
+private:
+	// hierarchy, indexed by position in the depth first order
+	std::vector<int> m_parentIndices;
+	// one past the position of the last node under each node
+	std::vector<int> m_subtreeEnds;
+	// transform of each node relative to its parent
+	std::vector<glm::vec3> m_scales;
+	std::vector<glm::vec3> m_rotations;
+	std::vector<glm::vec3> m_positions;
+	// world position and rotation, without scale, passed to the children
+	std::vector<glm::mat4> m_frames;
+	std::vector<glm::mat4> m_modelMatrices;
+	std::vector<glm::mat4> m_normalMatrices;
+	// set for nodes waiting in m_dirtyNodes
+	std::vector<bool> m_dirty;
+	// ID of the node at each position, and position of each ID
+	std::vector<int> m_nodeIDs;
+	std::vector<int> m_nodeIndices;
+	// IDs of the nodes changed since the last Update() call
+	std::vector<int> m_dirtyNodes;
+	int m_updatedNodeCount;
+
+	// mark a node so it and the nodes under it are updated
+	void MarkDirty(int nodeID);
+	// update the matrices of the nodes at positions [first, last)
+	void UpdateRange(int first, int last);
+
+	// graphs hold the whole scene hierarchy, so they are not copied
+	SceneGraph(const SceneGraph&);
+	SceneGraph& operator=(const SceneGraph&);
+};
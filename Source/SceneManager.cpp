@@ -8,6 +8,26 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SceneManager.h"
+#include "AssetPack.h"
+#include "AssetPackBuilder.h"
+#include "AssetReader.h"
+#include "GLResourceTracker.h"
+#include "IndirectDrawBatch.h"
+#include "LightBuffer.h"
+#include "LightClusters.h"
+#include "RenderQueue.h"
+#include "TextureArrayPacker.h"
+#include "SamplerCache.h"
+#include "SceneEntities.h"
+#include "SceneFile.h"
+#include "SceneFileBuilder.h"
+#include "SceneGraph.h"
+#include "TextureCache.h"
+#include "TextureResidency.h"
+#include "TextureStreamer.h"
+#include "TransformBatch.h"
+#include "TransformCache.h"
+#include "UniformCache.h"
 
 #ifndef STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
@@ -16,14 +36,161 @@
 
 #include <glm/gtx/transform.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
 // declaration of global variables
 namespace
 {
 	const char* g_ModelName = "model";
+	const char* g_NormalMatrixName = "normalMatrix";
 	const char* g_ColorValueName = "objectColor";
 	const char* g_TextureValueName = "objectTexture";
 	const char* g_UseTextureName = "bUseTexture";
 	const char* g_UseLightingName = "bUseLighting";
+	const char* g_LightCountName = "lightCount";
+	const char* g_UseTextureArrayName = "bUseTextureArray";
+	const char* g_TextureArrayValueName = "objectTextureArray";
+	const char* g_TextureLayerName = "textureLayer";
+	const char* g_TextureRectName = "textureRect";
+	const char* g_UseInstancingName = "bUseInstancing";
+	const char* g_UseIndirectDrawsName = "bUseIndirectDraws";
+	const char* g_FirstDrawDataName = "firstDrawData";
+	const char* g_UseLightClustersName = "bUseLightClusters";
+	const char* g_UVScaleName = "UVscale";
+
+	struct SCENE_TEXTURE
+	{
+		const char* filename;
+		const char* tag;
+	};
+
+	// every image in the textures folder - the ones drawn by
+	// RenderScene() come first, in SCENE_TEXTURE_INDEX order
+	const SCENE_TEXTURE g_SceneTextures[] =
+	{
+		{ "textures/whitedesk.jpg", "desk" },
+		{ "textures/monitor.jpg", "monitor" },
+		{ "textures/blackceramic.jpg", "cup" },
+		{ "textures/blackwood.jpg", "pencil" },
+		{ "textures/keyboard.jpg", "keyboard" },
+		{ "textures/whiteceramic.jpg", "pencilcup" },
+		{ "textures/graysmooth.jpg", "mouse" },
+		{ "textures/redcover.jpg", "book1" },
+		{ "textures/bluecover.jpg", "book2" },
+		{ "textures/browncover.jpg", "book3" },
+		{ "textures/abstract.jpg", "abstract" },
+		{ "textures/backdrop.jpg", "backdrop" },
+		{ "textures/breadcrust.jpg", "breadcrust" },
+		{ "textures/cheddar.jpg", "cheddar" },
+		{ "textures/cheese_top.jpg", "cheesetop" },
+		{ "textures/cheese_wheel.jpg", "cheesewheel" },
+		{ "textures/circular-brushed-gold-texture.jpg", "brushedgold" },
+		{ "textures/drywall.jpg", "drywall" },
+		{ "textures/gold-seamless-texture.jpg", "gold" },
+		{ "textures/knife_handle.jpg", "knifehandle" },
+		{ "textures/pavers.jpg", "pavers" },
+		{ "textures/rusticwood.jpg", "rusticwood" },
+		{ "textures/stainedglass.jpg", "stainedglass" },
+		{ "textures/stainless.jpg", "stainless" },
+		{ "textures/stainless_end.jpg", "stainlessend" },
+		{ "textures/tilesf2.jpg", "tiles" },
+		{ "textures/white.jpg", "white" },
+	};
+
+	// positions in g_SceneTextures of the textures drawn by RenderScene()
+	enum SCENE_TEXTURE_INDEX
+	{
+		DESK_TEXTURE = 0,
+		MONITOR_TEXTURE,
+		CUP_TEXTURE,
+		PENCIL_TEXTURE,
+		KEYBOARD_TEXTURE,
+		PENCILCUP_TEXTURE,
+		MOUSE_TEXTURE,
+		BOOK1_TEXTURE,
+		BOOK2_TEXTURE,
+		BOOK3_TEXTURE
+	};
+
+	const int PENCIL_COUNT = 6;
+
+	// nodes of the scene graph drawn by RenderScene(), in the
+	// order BuildSceneGraph() adds them
+	enum SCENE_NODE
+	{
+		DESK_NODE = 0,
+		MONITOR_NODE,
+		MONITOR_SCREEN_NODE,
+		KEYBOARD_NODE,
+		MOUSE_NODE,
+		PENCIL_CUP_NODE,
+		FIRST_PENCIL_NODE,
+		NOTEBOOK1_NODE = FIRST_PENCIL_NODE + PENCIL_COUNT,
+		NOTEBOOK2_NODE,
+		NOTEBOOK3_NODE,
+		MUG_NODE,
+		MUG_HANDLE_NODE,
+		SCENE_NODE_COUNT
+	};
+
+	// light sources the fragment shader holds as uniforms when
+	// the driver has no storage buffers for the light buffer
+	const int MAX_UNIFORM_LIGHTS = 4;
+
+	/***********************************************************
+	 *  FillSceneObjects()
+	 *
+	 *  Rebuild a scene graph and the scene entities from the
+	 *  per object arrays of a mapped scene file.  The graph
+	 *  node of each object has the object's index as its ID.
+	 *  Texture and material indices of the file are turned
+	 *  into texture handles and material indices through the
+	 *  passed in tables.  An object without a material takes
+	 *  the one of the object before it in the file, or the
+	 *  default material when none came before, since the
+	 *  sorted draws no longer follow the order of the file.
+	 *  The arrays are sized once up front, so nothing is
+	 *  allocated per object.
+	 ***********************************************************/
+	void FillSceneObjects(
+		const SceneFile& sceneFile,
+		const std::vector<int>& textureHandles,
+		const std::vector<int>& materialIndices,
+		int defaultMaterial,
+		SceneGraph& graph,
+		SceneEntities& entities)
+	{
+		const int objectCount = sceneFile.GetObjectCount();
+		const int32_t* meshes = sceneFile.GetMeshes();
+		const int32_t* textures = sceneFile.GetTextures();
+		const int32_t* materials = sceneFile.GetMaterials();
+		const float* colors = sceneFile.GetColors();
+		const float* UVscales = sceneFile.GetUVScales();
+
+		// the scene file has already checked the parent order
+		graph.Build(objectCount, sceneFile.GetParents(), sceneFile.GetScales(),
+			sceneFile.GetRotations(), sceneFile.GetPositions());
+
+		entities.Clear();
+		entities.Reserve(objectCount);
+		int currentMaterial = defaultMaterial;
+		for (int i = 0; i < objectCount; i++)
+		{
+			if (materials[i] >= 0)
+			{
+				currentMaterial = materialIndices[materials[i]];
+			}
+			entities.AddEntity(i, meshes[i],
+				(textures[i] >= 0) ? textureHandles[textures[i]] : -1,
+				currentMaterial,
+				glm::vec4(colors[i * 4], colors[i * 4 + 1], colors[i * 4 + 2], colors[i * 4 + 3]),
+				glm::vec2(UVscales[i * 2], UVscales[i * 2 + 1]));
+		}
+	}
 }
 
 /***********************************************************
@@ -35,19 +202,127 @@ SceneManager::SceneManager(ShaderManager *pShaderManager)
 {
 	m_pShaderManager = pShaderManager;
 	m_basicMeshes = new ShapeMeshes();
+	m_pResourceTracker = new GLResourceTracker();
+	m_pAssetPack = NULL;
+	m_pSceneMeshes = new SceneMeshes(m_pResourceTracker);
+	m_pTextureCache = new TextureCache("texcache");
+	m_bPackTextures = false;
+	m_textureCompression = TextureCompressor::BLOCK_FORMAT_NONE;
+	m_compressionSavedBytes = 0;
+	m_pTextureCompressor = NULL;
+	m_bStreamTextures = true;
+	m_pDecodePool = NULL;
+	m_pAssetReader = NULL;
+	m_pTextureStreamer = NULL;
+	m_placeholderTextureID = 0;
+	m_pTextureResidency = new TextureResidency(m_pResourceTracker, m_pTextureCache);
+	m_cameraPosition = glm::vec3(0.0f, 0.0f, 0.0f);
+	m_lastObjectPosition = glm::vec3(0.0f, 0.0f, 0.0f);
+	m_lastObjectSize = 1.0f;
+	m_pTransformCache = new TransformCache();
+	m_pSceneGraph = new SceneGraph();
+	m_pSceneEntities = new SceneEntities();
+	m_pRenderQueue = new RenderQueue();
+	m_bUseInstancing = true;
+	m_drawCallCount = 0;
+	m_bUseIndirectDraws = false;
+	m_pIndirectDraws = NULL;
+	m_pSamplerCache = new SamplerCache(m_pResourceTracker);
+	m_currentSampler = m_pSamplerCache->GetPresetSampler(SamplerCache::SAMPLER_TRILINEAR);
+	m_currentTextureUnit = -1;
+	m_samplerOverride = -1;
+	m_spareTextureUnit = 0;
+	m_spareUnitHandle = -1;
+	m_spareArrayUnit = 0;
+	m_spareArrayUnitHandle = -1;
+	m_pLightClusters = NULL;
+	m_bUseLightClusters = true;
+	m_viewMatrix = glm::mat4(1.0f);
+	m_projectionMatrix = glm::mat4(1.0f);
+	m_viewportSize = glm::ivec2(0, 0);
+	m_bHaveViewFrustum = false;
+
+	// the program belongs to the shader manager, so it is only
+	// tracked for reporting
+	GLint currentProgram = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
+	m_programID = (GLuint)currentProgram;
+	if (m_programID != 0)
+	{
+		GLint binaryLength = 0;
+		glGetProgramiv(m_programID, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+		m_pResourceTracker->Track(GLResourceTracker::RESOURCE_PROGRAM, m_programID, (size_t)binaryLength, "shaders");
+	}
+	ResolveUniforms();
 
+	m_pLightBuffer = new LightBuffer(m_pResourceTracker);
+	m_bLightBufferBound = (m_programID != 0) && (LightBuffer::BindProgram(m_programID) == true);
+	if (m_bLightBufferBound == false)
+	{
+		std::cout << "INFO: The shaders cannot read the light buffer, using the first "
+			<< MAX_UNIFORM_LIGHTS << " lights" << std::endl;
+	}
+	else if (LightClusters::BindProgram(m_programID) == true)
+	{
+		m_pLightClusters = new LightClusters(m_pResourceTracker);
+		std::cout << "INFO: Binning lights into " << LightClusters::CLUSTER_COUNT << " clusters with "
+			<< LightClusters::GetKernelName() << " on " << m_pLightClusters->GetThreadCount() + 1
+			<< " threads" << std::endl;
+	}
 }
 
 /***********************************************************
  *  ~SceneManager()
  *
- *  The destructor for the class
+ *  The destructor for the class.  Every OpenGL resource of
+ *  the scene is freed here, and the final GPU memory report
+ *  shows anything that was left behind.
  ***********************************************************/
 SceneManager::~SceneManager()
 {
 	m_pShaderManager = NULL;
 	delete m_basicMeshes;
 	m_basicMeshes = NULL;
+	delete m_pTransformCache;
+	m_pTransformCache = NULL;
+	delete m_pSceneEntities;
+	m_pSceneEntities = NULL;
+	delete m_pRenderQueue;
+	m_pRenderQueue = NULL;
+	delete m_pSceneGraph;
+	m_pSceneGraph = NULL;
+	// the decode workers use the compressor and the cache
+	delete m_pTextureStreamer;
+	m_pTextureStreamer = NULL;
+	delete m_pDecodePool;
+	m_pDecodePool = NULL;
+	delete m_pAssetReader;
+	m_pAssetReader = NULL;
+	delete m_pTextureCompressor;
+	m_pTextureCompressor = NULL;
+	// the residency manager reloads levels from the cache
+	delete m_pTextureResidency;
+	m_pTextureResidency = NULL;
+	delete m_pTextureCache;
+	m_pTextureCache = NULL;
+
+	DestroyGLTextures();
+	delete m_pIndirectDraws;
+	m_pIndirectDraws = NULL;
+	delete m_pLightClusters;
+	m_pLightClusters = NULL;
+	delete m_pLightBuffer;
+	m_pLightBuffer = NULL;
+	delete m_pSceneMeshes;
+	m_pSceneMeshes = NULL;
+	m_pAssetPack = NULL;
+	delete m_pSamplerCache;
+	m_pSamplerCache = NULL;
+	m_pResourceTracker->Untrack(GLResourceTracker::RESOURCE_PROGRAM, m_programID);
+
+	m_pResourceTracker->Report("at shutdown");
+	delete m_pResourceTracker;
+	m_pResourceTracker = NULL;
 }
 
 /***********************************************************
@@ -60,26 +335,89 @@ SceneManager::~SceneManager()
  ***********************************************************/
 bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 {
-	int width = 0;
-	int height = 0;
-	int colorChannels = 0;
-	GLuint textureID = 0;
+	TextureDecodePool::DECODED_IMAGE image;
+	bool bReturn = false;
 
 	// indicate to always flip images vertically when loaded
 	stbi_set_flip_vertically_on_load(true);
 
 	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
+	TextureDecodePool::ResetImage(image);
+	image.filename = filename;
+	image.tag = tag;
+	image.pixels = stbi_load(
 		filename,
-		&width,
-		&height,
-		&colorChannels,
+		&image.width,
+		&image.height,
+		&image.colorChannels,
 		0);
 
+	bReturn = (UploadGLTexture(image) >= 0);
+
+	// free the image data from local memory
+	TextureDecodePool::FreeImage(image);
+
+	return(bReturn);
+}
+
+/***********************************************************
+ *  UploadGLTexture()
+ *
+ *  This method is used for creating an OpenGL texture from
+ *  already decoded image data and adding it to the texture
+ *  registry.  The returned handle is used to select the
+ *  texture with SetShaderTexture(), and is -1 when the
+ *  texture could not be created.  It must be called on the
+ *  thread that owns the OpenGL context.
+ ***********************************************************/
+int SceneManager::UploadGLTexture(const TextureDecodePool::DECODED_IMAGE& image)
+{
+	GLuint textureID = UploadTextureImage(image);
+	if (textureID == 0)
+	{
+		return(-1);
+	}
+
+	// register the loaded texture and associate it with the special tag string
+	TEXTURE_INFO textureInfo;
+	textureInfo.ID = textureID;
+	textureInfo.tag = image.tag;
+	textureInfo.target = GL_TEXTURE_2D;
+	textureInfo.layer = 0;
+	textureInfo.uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+	return(RegisterTexture(textureInfo));
+}
+
+/***********************************************************
+ *  UploadTextureImage()
+ *
+ *  This method is used for creating an OpenGL texture from
+ *  already decoded image data and generating the mipmaps,
+ *  without adding it to the texture registry, so it can
+ *  also fill a handle that already exists.  When the image
+ *  came from the texture cache, every level of its mip
+ *  chain is uploaded as is instead of generating them.
+ *  Block compressed mip chains are uploaded without being
+ *  decoded.  The returned texture is 0 when it could not
+ *  be created.  It must be called on the thread that owns
+ *  the OpenGL context.
+ ***********************************************************/
+GLuint SceneManager::UploadTextureImage(const TextureDecodePool::DECODED_IMAGE& image)
+{
+	GLuint textureID = 0;
+
 	// if the image was successfully read from the image file
-	if (image)
+	if ((image.pixels) || (image.mipLevels.empty() == false))
 	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
+		std::cout << "Successfully loaded image:" << image.filename << ", width:" << image.width << ", height:" << image.height << ", channels:" << image.colorChannels << std::endl;
+
+		// only RGB and RGBA images are supported
+		if ((image.colorChannels != 3) && (image.colorChannels != 4))
+		{
+			std::cout << "Not implemented to handle image with " << image.colorChannels << " channels" << std::endl;
+			return(0);
+		}
 
 		glGenTextures(1, &textureID);
 		glBindTexture(GL_TEXTURE_2D, textureID);
@@ -87,41 +425,136 @@ bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 		// set the texture wrapping parameters
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		// set texture filtering parameters - the sampler bound with
+		// the material overrides these while drawing the scene
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
 		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
+		GLint internalFormat = GL_RGB8;
+		GLenum pixelFormat = GL_RGB;
 		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
+		if (image.colorChannels == 4)
+		{
+			internalFormat = GL_RGBA8;
+			pixelFormat = GL_RGBA;
+		}
+
+		// RGB rows of odd widths are not padded to 4 bytes
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+		if (image.blockFormat != 0)
+		{
+			TextureCompressor::BLOCK_FORMAT blockFormat = (TextureCompressor::BLOCK_FORMAT)image.blockFormat;
+
+			// upload the compressed blocks straight from the mapped file
+			for (size_t level = 0; level < image.mipLevels.size(); level++)
+			{
+				glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, TextureCompressor::GetGLFormat(blockFormat),
+					image.mipLevels[level].width, image.mipLevels[level].height, 0,
+					(GLsizei)image.mipLevels[level].size, image.mipLevels[level].pixels);
+			}
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)image.mipLevels.size() - 1);
+
+			ReportCompressedTexture(image);
+		}
+		else if (image.mipLevels.empty() == false)
+		{
+			// upload the cached mip chain straight from the mapped file
+			for (size_t level = 0; level < image.mipLevels.size(); level++)
+			{
+				glTexImage2D(GL_TEXTURE_2D, (GLint)level, internalFormat,
+					image.mipLevels[level].width, image.mipLevels[level].height, 0,
+					pixelFormat, GL_UNSIGNED_BYTE, image.mipLevels[level].pixels);
+			}
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)image.mipLevels.size() - 1);
+		}
 		else
 		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
+			glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, image.width, image.height, 0, pixelFormat, GL_UNSIGNED_BYTE, image.pixels);
+
+			// generate the texture mipmaps for mapping textures to lower resolutions
+			glGenerateMipmap(GL_TEXTURE_2D);
 		}
 
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
-		// free the image data from local memory
-		stbi_image_free(image);
 		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
 
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
+		m_pResourceTracker->Track(GLResourceTracker::RESOURCE_TEXTURE, textureID,
+			GLResourceTracker::MeasureTexture(GL_TEXTURE_2D, textureID), "textures");
 
-		return true;
+		return(textureID);
 	}
 
-	std::cout << "Could not load image:" << filename << std::endl;
+	std::cout << "Could not load image:" << image.filename << std::endl;
 
 	// Error loading the image
-	return false;
+	return(0);
+}
+
+/***********************************************************
+ *  ReportCompressedTexture()
+ *
+ *  This method is used for reporting the size and quality of
+ *  a block compressed texture, and adding the memory it
+ *  saves over RGBA8 with mipmaps to the running total.
+ ***********************************************************/
+void SceneManager::ReportCompressedTexture(const TextureDecodePool::DECODED_IMAGE& image)
+{
+	size_t compressedSize = 0;
+	size_t uncompressedSize = 0;
+
+	for (size_t level = 0; level < image.mipLevels.size(); level++)
+	{
+		compressedSize += image.mipLevels[level].size;
+		uncompressedSize += (size_t)image.mipLevels[level].width * image.mipLevels[level].height * 4;
+	}
+
+	m_compressionSavedBytes += uncompressedSize - compressedSize;
+	std::cout << "INFO: Compressed " << image.tag << " as "
+		<< TextureCompressor::GetFormatName((TextureCompressor::BLOCK_FORMAT)image.blockFormat)
+		<< ", " << compressedSize / 1024 << " KB instead of " << uncompressedSize / 1024
+		<< " KB, PSNR " << image.compressionPSNR << " dB" << std::endl;
+}
+
+/***********************************************************
+ *  ManageTextureResidency()
+ *
+ *  This method is used for handing a texture whose whole
+ *  mip chain came from the texture cache to the residency
+ *  manager, which can then drop and restore its top levels.
+ *  Textures packed into arrays are not managed.
+ ***********************************************************/
+void SceneManager::ManageTextureResidency(int textureHandle, const std::string& filename, int blockFormat)
+{
+	if ((textureHandle < 0) || (textureHandle >= (int)m_textureIDs.size()) ||
+		(m_textureIDs[textureHandle].target != GL_TEXTURE_2D))
+	{
+		return;
+	}
+
+	m_pTextureResidency->AddTexture(textureHandle, m_textureIDs[textureHandle].ID, filename, blockFormat);
+}
+
+/***********************************************************
+ *  RegisterTexture()
+ *
+ *  This method is used for adding a created texture to the
+ *  texture registry and returning its new handle.
+ ***********************************************************/
+int SceneManager::RegisterTexture(const TEXTURE_INFO& textureInfo)
+{
+	int textureHandle = (int)m_textureIDs.size();
+
+	m_textureIDs.push_back(textureInfo);
+	m_textureIDs.back().unit = -1;
+	// the first texture loaded with a tag keeps it
+	m_textureHandles.insert(std::make_pair(textureInfo.tag, textureHandle));
+
+	return(textureHandle);
 }
 
 /***********************************************************
@@ -129,249 +562,1914 @@ bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
  *
  *  This method is used for preparing the 3D scene by loading
  *  the shapes, textures in memory to support the 3D scene
- *  rendering
+ *  rendering.  The image files are decoded on a pool of
+ *  worker threads while the OpenGL uploads are done here,
+ *  in order, as each decoded image arrives.  With texture
+ *  packing on, every image is collected first and packed
+ *  into texture arrays and atlas layers instead.  With
+ *  texture compression on, the workers also block compress
+ *  each image, or map its compressed file when current.
+ *  With texture streaming on, this only starts the decode
+ *  and the textures arrive through UpdateTextureStreaming().
  ***********************************************************/
 void SceneManager::LoadSceneTextures()
 {
-	bool bReturn = false;
+	// a pack holds every scene texture ready to upload, so
+	// nothing is decoded or streamed
+	if ((m_bPackTextures == false) && (LoadPackedSceneTextures() == true))
+	{
+		return;
+	}
+
+	// the pool compresses on every worker, so each image is
+	// compressed on a single thread
+	m_compressionSavedBytes = 0;
+	if ((m_textureCompression != TextureCompressor::BLOCK_FORMAT_NONE) && (NULL == m_pTextureCompressor))
+	{
+		m_pTextureCompressor = new TextureCompressor(m_textureCompression, 1);
+	}
 
-	// loading images from textures folder
-	bReturn = CreateGLTexture(
-		"textures/whitedesk.jpg", "desk");
+	// packing needs every image up front, so it always blocks
+	if ((m_bStreamTextures == true) && (m_bPackTextures == false))
+	{
+		StartTextureStreaming();
+		return;
+	}
 
-	bReturn = CreateGLTexture(
-		"textures/monitor.jpg", "monitor");
+	const int textureCount = sizeof(g_SceneTextures) / sizeof(g_SceneTextures[0]);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	double decodeMilliseconds = 0.0;
+	double uploadMilliseconds = 0.0;
+	int tickets[textureCount];
 
-	bReturn = CreateGLTexture(
-		"textures/blackceramic.jpg", "cup");
+	// the flip setting is global to stb_image, so it is set
+	// before any of the worker threads start decoding
+	stbi_set_flip_vertically_on_load(true);
 
-	bReturn = CreateGLTexture(
-		"textures/blackwood.jpg", "pencil");
+	// the files to decode are read in one batch while the
+	// workers decode the ones that already arrived
+	AssetReader assetReader;
+	ReadSceneTextureFiles(&assetReader);
 
-	bReturn = CreateGLTexture(
-		"textures/keyboard.jpg", "keyboard");
+	// decoded images and their mip chains are kept in the
+	// texture cache so warm starts skip the decode
+	TextureDecodePool decodePool(m_pTextureCache);
+	decodePool.SetTextureCompressor(m_pTextureCompressor);
+	decodePool.SetAssetReader(&assetReader);
 
-	bReturn = CreateGLTexture(
-		"textures/whiteceramic.jpg", "pencilcup");
+	// queue every scene texture for decoding up front
+	for (int i = 0; i < textureCount; i++)
+	{
+		tickets[i] = decodePool.QueueDecode(
+			g_SceneTextures[i].filename, g_SceneTextures[i].tag);
+	}
 
-	bReturn = CreateGLTexture(
-		"textures/graysmooth.jpg", "mouse");
+	// upload the decoded images in order as they become ready,
+	// keeping the handle of each texture for RenderScene()
+	m_sceneTextureHandles.assign(textureCount, -1);
+	if (m_bPackTextures == false)
+	{
+		for (int i = 0; i < textureCount; i++)
+		{
+			TextureDecodePool::DECODED_IMAGE image;
+			decodePool.WaitForImage(tickets[i], image);
+			decodeMilliseconds += image.decodeMilliseconds;
+
+			std::chrono::steady_clock::time_point uploadStart = std::chrono::steady_clock::now();
+			m_sceneTextureHandles[i] = UploadGLTexture(image);
+			if (image.mipLevels.empty() == false)
+			{
+				ManageTextureResidency(m_sceneTextureHandles[i], image.filename, image.blockFormat);
+			}
+			std::chrono::duration<double, std::milli> uploadTime = std::chrono::steady_clock::now() - uploadStart;
+			uploadMilliseconds += uploadTime.count();
+
+			TextureDecodePool::FreeImage(image);
+		}
+	}
+	else
+	{
+		// packing needs the sizes of all the images up front
+		std::vector<TextureDecodePool::DECODED_IMAGE> images(textureCount);
+		TextureArrayPacker packer;
+		for (int i = 0; i < textureCount; i++)
+		{
+			decodePool.WaitForImage(tickets[i], images[i]);
+			decodeMilliseconds += images[i].decodeMilliseconds;
+			packer.AddImage(&images[i]);
+		}
 
-	bReturn = CreateGLTexture(
-		"textures/redcover.jpg", "book1");
+		std::chrono::steady_clock::time_point uploadStart = std::chrono::steady_clock::now();
+		std::vector<TextureArrayPacker::PACKED_TEXTURE> packedTextures;
+		packer.CreateGLTextures(packedTextures);
+		for (size_t i = 0; i < packer.GetArrayIDs().size(); i++)
+		{
+			GLuint arrayID = packer.GetArrayIDs()[i];
+			m_pResourceTracker->Track(GLResourceTracker::RESOURCE_TEXTURE, arrayID,
+				GLResourceTracker::MeasureTexture(GL_TEXTURE_2D_ARRAY, arrayID), "textures");
+		}
 
-	bReturn = CreateGLTexture(
-		"textures/bluecover.jpg", "book2");
+		for (int i = 0; i < textureCount; i++)
+		{
+			if (packedTextures[i].arrayID != 0)
+			{
+				TEXTURE_INFO textureInfo;
+				textureInfo.ID = packedTextures[i].arrayID;
+				textureInfo.tag = images[i].tag;
+				textureInfo.target = GL_TEXTURE_2D_ARRAY;
+				textureInfo.layer = packedTextures[i].layer;
+				textureInfo.uvRect = packedTextures[i].uvRect;
+				m_sceneTextureHandles[i] = RegisterTexture(textureInfo);
+			}
+			else
+			{
+				// images too big for an atlas page stay plain textures
+				m_sceneTextureHandles[i] = UploadGLTexture(images[i]);
+				if (images[i].mipLevels.empty() == false)
+				{
+					ManageTextureResidency(m_sceneTextureHandles[i], images[i].filename, images[i].blockFormat);
+				}
+			}
+			TextureDecodePool::FreeImage(images[i]);
+		}
+		std::chrono::duration<double, std::milli> uploadTime = std::chrono::steady_clock::now() - uploadStart;
+		uploadMilliseconds += uploadTime.count();
 
-	bReturn = CreateGLTexture(
-		"textures/browncover.jpg", "book3");
+		std::cout << "INFO: Packed scene textures into " << packer.GetArrayIDs().size()
+			<< " texture arrays" << std::endl;
+	}
 
+	std::chrono::duration<double, std::milli> totalTime = std::chrono::steady_clock::now() - start;
+
+	// report the startup timing for the scene textures
+	std::cout << "INFO: Loaded " << m_textureIDs.size() << " of " << textureCount
+		<< " textures with " << decodePool.GetThreadCount() << " decode threads" << std::endl;
+	std::cout << "INFO: Texture load time: " << totalTime.count() << " ms (decode "
+		<< decodeMilliseconds << " ms summed across threads, upload "
+		<< uploadMilliseconds << " ms)" << std::endl;
+	std::cout << "INFO: Texture cache hits: " << m_pTextureCache->GetHitCount()
+		<< ", misses: " << m_pTextureCache->GetMissCount() << std::endl;
+	if (m_textureCompression != TextureCompressor::BLOCK_FORMAT_NONE)
+	{
+		std::cout << "INFO: Texture compression (" << TextureCompressor::GetFormatName(m_textureCompression)
+			<< ") saved " << m_compressionSavedBytes / 1024 << " KB of texture memory" << std::endl;
+	}
+	m_pResourceTracker->Report("after loading textures");
 
 	// after the texture image data is loaded into memory, the
-	// loaded textures need to be bound to texture slots - there
-	// are a total of 16 available slots for scene textures
+	// loaded textures need to be bound to texture slots - any
+	// textures past the available units share a spare unit
 	BindGLTextures();
 }
 
 /***********************************************************
- *  BindGLTextures()
+ *  LoadPackedSceneTextures()
  *
- *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
+ *  This method is used for uploading every scene texture
+ *  straight from the mip chains in the asset pack, with no
+ *  decoding and no copying.  When the pack is missing any
+ *  of the scene textures, nothing is uploaded and false is
+ *  returned, so the image files are loaded instead.
  ***********************************************************/
-void SceneManager::BindGLTextures()
+bool SceneManager::LoadPackedSceneTextures()
+{
+	const int textureCount = sizeof(g_SceneTextures) / sizeof(g_SceneTextures[0]);
+
+	if (NULL == m_pAssetPack)
+	{
+		return(false);
+	}
+
+	std::vector<TextureDecodePool::DECODED_IMAGE> images(textureCount);
+	for (int i = 0; i < textureCount; i++)
+	{
+		if (m_pAssetPack->GetTexture(g_SceneTextures[i].filename, images[i]) == false)
+		{
+			std::cout << "INFO: Asset pack has no " << g_SceneTextures[i].filename
+				<< ", loading the texture files instead" << std::endl;
+			return(false);
+		}
+		images[i].tag = g_SceneTextures[i].tag;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	m_sceneTextureHandles.assign(textureCount, -1);
+	for (int i = 0; i < textureCount; i++)
+	{
+		m_sceneTextureHandles[i] = UploadGLTexture(images[i]);
+	}
+	std::chrono::duration<double, std::milli> uploadTime = std::chrono::steady_clock::now() - start;
+
+	std::cout << "INFO: Uploaded " << textureCount << " textures from the asset pack in "
+		<< uploadTime.count() << " ms" << std::endl;
+	m_pResourceTracker->Report("after loading textures");
+
+	BindGLTextures();
+
+	return(true);
+}
+
+/***********************************************************
+ *  ReadSceneTextureFiles()
+ *
+ *  This method is used for handing the image files of the
+ *  scene textures without a current texture cache entry to
+ *  the asset reader, which starts reading them all at once.
+ *  Warm starts read nothing, since the cache entries are
+ *  mapped instead.
+ ***********************************************************/
+void SceneManager::ReadSceneTextureFiles(AssetReader* pAssetReader)
+{
+	const int textureCount = sizeof(g_SceneTextures) / sizeof(g_SceneTextures[0]);
+
+	for (int i = 0; i < textureCount; i++)
+	{
+		if (m_pTextureCache->IsCurrent(g_SceneTextures[i].filename, m_textureCompression) == false)
+		{
+			pAssetReader->QueueRead(g_SceneTextures[i].filename);
+		}
+	}
+
+	if (pAssetReader->GetQueuedCount() > 0)
+	{
+		pAssetReader->Submit();
+		std::cout << "INFO: Reading " << pAssetReader->GetQueuedCount() << " texture files "
+			<< (pAssetReader->IsAsynchronous() ? "in one io_uring batch" : "with blocking reads") << std::endl;
+	}
+}
+
+/***********************************************************
+ *  StartTextureStreaming()
+ *
+ *  This method is used for queueing every scene texture for
+ *  decoding in the background and registering a 1x1
+ *  placeholder texture under each scene texture handle, so
+ *  the first frame is drawn without waiting on any image.
+ ***********************************************************/
+void SceneManager::StartTextureStreaming()
+{
+	const int textureCount = sizeof(g_SceneTextures) / sizeof(g_SceneTextures[0]);
+	const unsigned char placeholderPixel[4] = { 128, 128, 128, 255 };
+
+	m_streamStart = std::chrono::steady_clock::now();
+
+	// the flip setting is global to stb_image, so it is set
+	// before any of the worker threads start decoding
+	stbi_set_flip_vertically_on_load(true);
+
+	m_pAssetReader = new AssetReader();
+	ReadSceneTextureFiles(m_pAssetReader);
+
+	m_pDecodePool = new TextureDecodePool(m_pTextureCache);
+	m_pDecodePool->SetTextureCompressor(m_pTextureCompressor);
+	m_pDecodePool->SetAssetReader(m_pAssetReader);
+	m_pTextureStreamer = new TextureStreamer(m_pResourceTracker);
+
+	m_streamTickets.assign(textureCount, -1);
+	for (int i = 0; i < textureCount; i++)
+	{
+		m_streamTickets[i] = m_pDecodePool->QueueDecode(
+			g_SceneTextures[i].filename, g_SceneTextures[i].tag);
+	}
+
+	// every scene texture shares the placeholder until it arrives
+	glGenTextures(1, &m_placeholderTextureID);
+	glBindTexture(GL_TEXTURE_2D, m_placeholderTextureID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	// a single level keeps it complete under mipmapped samplers
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholderPixel);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	m_pResourceTracker->Track(GLResourceTracker::RESOURCE_TEXTURE, m_placeholderTextureID, 4, "textures");
+
+	m_sceneTextureHandles.assign(textureCount, -1);
+	for (int i = 0; i < textureCount; i++)
+	{
+		TEXTURE_INFO textureInfo;
+		textureInfo.ID = m_placeholderTextureID;
+		textureInfo.tag = g_SceneTextures[i].tag;
+		textureInfo.target = GL_TEXTURE_2D;
+		textureInfo.layer = 0;
+		textureInfo.uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+		m_sceneTextureHandles[i] = RegisterTexture(textureInfo);
+	}
+
+	std::chrono::duration<double, std::milli> startTime = std::chrono::steady_clock::now() - m_streamStart;
+	std::cout << "INFO: Streaming " << textureCount << " textures with " << m_pDecodePool->GetThreadCount()
+		<< " decode threads through " << (m_pTextureStreamer->IsPersistent() ? "persistently mapped" : "mapped")
+		<< " pixel buffers, placeholders ready in " << startTime.count() << " ms" << std::endl;
+
+	BindGLTextures();
+}
+
+/***********************************************************
+ *  UpdateTextureStreaming()
+ *
+ *  This method is used for moving the streamed textures
+ *  along, once per frame before rendering.  Decoded images
+ *  are handed to the streamer as they become ready, in any
+ *  order, and each texture whose upload is done replaces
+ *  its placeholder.  The decode pool is freed once every
+ *  texture has arrived.
+ ***********************************************************/
+void SceneManager::UpdateTextureStreaming()
+{
+	if (NULL == m_pTextureStreamer)
+	{
+		return;
+	}
+
+	bool bDecoding = false;
+	for (size_t i = 0; (NULL != m_pDecodePool) && (i < m_streamTickets.size()); i++)
+	{
+		if (m_streamTickets[i] < 0)
+		{
+			continue;
+		}
+		if (m_pDecodePool->IsImageReady(m_streamTickets[i]) == false)
+		{
+			bDecoding = true;
+			continue;
+		}
+
+		TextureDecodePool::DECODED_IMAGE image;
+		m_pDecodePool->WaitForImage(m_streamTickets[i], image);
+		m_streamTickets[i] = -1;
+
+		if (m_pTextureStreamer->QueueUpload(m_sceneTextureHandles[i], image) == true)
+		{
+			if (image.blockFormat != 0)
+			{
+				ReportCompressedTexture(image);
+			}
+		}
+		else
+		{
+			// images the streamer turns down are uploaded in one go,
+			// straight into the handle of their placeholder
+			GLuint textureID = UploadTextureImage(image);
+			if (textureID != 0)
+			{
+				m_textureIDs[m_sceneTextureHandles[i]].ID = textureID;
+				if (image.mipLevels.empty() == false)
+				{
+					ManageTextureResidency(m_sceneTextureHandles[i], image.filename, image.blockFormat);
+				}
+				BindGLTextures();
+			}
+			TextureDecodePool::FreeImage(image);
+		}
+	}
+
+	std::vector<TextureStreamer::STREAMED_TEXTURE> completed;
+	m_pTextureStreamer->Update(completed);
+
+	for (size_t i = 0; i < completed.size(); i++)
+	{
+		m_textureIDs[completed[i].handle].ID = completed[i].textureID;
+		if (completed[i].bCachedMipChain == true)
+		{
+			ManageTextureResidency(completed[i].handle, completed[i].filename, completed[i].blockFormat);
+		}
+	}
+	if (completed.empty() == false)
+	{
+		// the streamed textures take over units from the placeholder
+		BindGLTextures();
+	}
+
+	if ((bDecoding == false) && (m_pTextureStreamer->IsIdle() == true))
+	{
+		std::chrono::duration<double, std::milli> streamTime = std::chrono::steady_clock::now() - m_streamStart;
+		std::cout << "INFO: Streamed " << m_streamTickets.size() << " textures ("
+			<< m_pTextureStreamer->GetUploadedBytes() / 1024 << " KB) in " << streamTime.count() << " ms" << std::endl;
+		std::cout << "INFO: Texture cache hits: " << m_pTextureCache->GetHitCount()
+			<< ", misses: " << m_pTextureCache->GetMissCount() << std::endl;
+		if (m_textureCompression != TextureCompressor::BLOCK_FORMAT_NONE)
+		{
+			std::cout << "INFO: Texture compression (" << TextureCompressor::GetFormatName(m_textureCompression)
+				<< ") saved " << m_compressionSavedBytes / 1024 << " KB of texture memory" << std::endl;
+		}
+
+		delete m_pTextureStreamer;
+		m_pTextureStreamer = NULL;
+		delete m_pDecodePool;
+		m_pDecodePool = NULL;
+		delete m_pAssetReader;
+		m_pAssetReader = NULL;
+
+		m_pResourceTracker->Report("after streaming textures");
+	}
+}
+
+/***********************************************************
+ *  BenchmarkTextureDecoding()
+ *
+ *  This method is used for measuring the speedup of decoding
+ *  every image in the textures folder on the worker pool
+ *  compared to decoding them one at a time.  Only the decode
+ *  is timed, so no OpenGL context is needed.
+ ***********************************************************/
+void SceneManager::BenchmarkTextureDecoding()
+{
+	const int fileCount = sizeof(g_SceneTextures) / sizeof(g_SceneTextures[0]);
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+
+	stbi_set_flip_vertically_on_load(true);
+
+	// decode every image one after another on this thread
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int i = 0; i < fileCount; i++)
+	{
+		unsigned char* image = stbi_load(g_SceneTextures[i].filename, &width, &height, &colorChannels, 0);
+		if (NULL == image)
+		{
+			std::cout << "Could not load image:" << g_SceneTextures[i].filename << std::endl;
+		}
+		stbi_image_free(image);
+	}
+	std::chrono::duration<double, std::milli> serialTime = std::chrono::steady_clock::now() - start;
+
+	// decode the same images on the worker pool
+	unsigned int threadCount = 0;
+	start = std::chrono::steady_clock::now();
+	{
+		TextureDecodePool decodePool;
+		threadCount = decodePool.GetThreadCount();
+		for (int i = 0; i < fileCount; i++)
+		{
+			decodePool.QueueDecode(g_SceneTextures[i].filename, g_SceneTextures[i].tag);
+		}
+		for (int i = 0; i < fileCount; i++)
+		{
+			TextureDecodePool::DECODED_IMAGE image;
+			decodePool.WaitForImage(i, image);
+			TextureDecodePool::FreeImage(image);
+		}
+	}
+	std::chrono::duration<double, std::milli> pooledTime = std::chrono::steady_clock::now() - start;
+
+	std::cout << "INFO: Decoded " << fileCount << " images serially in " << serialTime.count() << " ms" << std::endl;
+	std::cout << "INFO: Decoded " << fileCount << " images on " << threadCount << " threads in " << pooledTime.count() << " ms" << std::endl;
+	if (pooledTime.count() > 0.0)
+	{
+		std::cout << "INFO: Texture decode speedup: " << serialTime.count() / pooledTime.count() << "x\n" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  BenchmarkTransforms()
+ *
+ *  This method is used for measuring the speedup of the
+ *  transform batch over building the model matrices the old
+ *  way, from separate scale, rotation and translation
+ *  matrices multiplied together, for 10,000 and 100,000
+ *  objects.  The largest difference between the two is
+ *  reported as well.  No OpenGL context is needed.
+ ***********************************************************/
+void SceneManager::BenchmarkTransforms()
+{
+	const int objectCounts[] = { 10000, 100000 };
+	const int repeatCount = 20;
+
+	for (int test = 0; test < 2; test++)
+	{
+		const int objectCount = objectCounts[test];
+		std::vector<glm::vec3> scales(objectCount);
+		std::vector<glm::vec3> rotations(objectCount);
+		std::vector<glm::vec3> positions(objectCount);
+		std::vector<glm::mat4> modelMatrices(objectCount);
+		TransformBatch transformBatch;
+
+		// spread the objects around like scene props, with
+		// whole degree angles as RenderScene() uses
+		for (int i = 0; i < objectCount; i++)
+		{
+			scales[i] = glm::vec3(0.5f + (i % 7) * 0.25f, 0.25f + (i % 5) * 0.5f, 1.0f + (i % 3));
+			rotations[i] = glm::vec3((float)((i * 37) % 360 - 180), (float)((i * 53) % 360), (float)((i * 91) % 720 - 360));
+			positions[i] = glm::vec3((float)(i % 100) - 50.0f, (float)((i / 100) % 100) * 0.1f, -(float)(i / 10000));
+			transformBatch.AddTransform(scales[i], rotations[i].x, rotations[i].y, rotations[i].z, positions[i]);
+		}
+
+		// five matrices and four multiplies per object
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (int repeat = 0; repeat < repeatCount; repeat++)
+		{
+			for (int i = 0; i < objectCount; i++)
+			{
+				glm::mat4 scale = glm::scale(scales[i]);
+				glm::mat4 rotationX = glm::rotate(glm::radians(rotations[i].x), glm::vec3(1.0f, 0.0f, 0.0f));
+				glm::mat4 rotationY = glm::rotate(glm::radians(rotations[i].y), glm::vec3(0.0f, 1.0f, 0.0f));
+				glm::mat4 rotationZ = glm::rotate(glm::radians(rotations[i].z), glm::vec3(0.0f, 0.0f, 1.0f));
+				glm::mat4 translation = glm::translate(positions[i]);
+				modelMatrices[i] = translation * rotationX * rotationY * rotationZ * scale;
+			}
+		}
+		std::chrono::duration<double, std::milli> matrixTime = std::chrono::steady_clock::now() - start;
+
+		// the whole batch composed straight from the transforms
+		start = std::chrono::steady_clock::now();
+		for (int repeat = 0; repeat < repeatCount; repeat++)
+		{
+			transformBatch.ComposeAll();
+		}
+		std::chrono::duration<double, std::milli> batchTime = std::chrono::steady_clock::now() - start;
+
+		float largestError = 0.0f;
+		for (int i = 0; i < objectCount; i++)
+		{
+			const glm::mat4& composed = transformBatch.GetModelMatrix(i);
+			for (int column = 0; column < 4; column++)
+			{
+				for (int row = 0; row < 4; row++)
+				{
+					largestError = std::max(largestError, std::abs(composed[column][row] - modelMatrices[i][column][row]));
+				}
+			}
+		}
+
+		std::cout << "INFO: Built " << objectCount << " model matrices from matrix products in "
+			<< matrixTime.count() / repeatCount << " ms" << std::endl;
+		std::cout << "INFO: Composed " << objectCount << " model matrices with the " << TransformBatch::GetKernelName()
+			<< " batch in " << batchTime.count() / repeatCount << " ms (largest difference " << largestError << ")" << std::endl;
+		if (batchTime.count() > 0.0)
+		{
+			std::cout << "INFO: Transform speedup: " << matrixTime.count() / batchTime.count() << "x\n" << std::endl;
+		}
+	}
+}
+
+/***********************************************************
+ *  BenchmarkUniformUpdates()
+ *
+ *  This method is used for timing the uniform updates of a
+ *  draw - the matrices, color, texture switch, UV scale and
+ *  material - set by name through the shader manager and
+ *  set through the resolved handles, over 100,000 draws.
+ *  Only the model matrices change between the draws, so
+ *  the handles drop the other writes as unchanged.  The
+ *  program must be in use, and the next frame sets its
+ *  own values again.
+ ***********************************************************/
+void SceneManager::BenchmarkUniformUpdates()
 {
-	for (int i = 0; i < m_loadedTextures; i++)
+	const int drawCount = 100000;
+	const int uniformsPerDraw = 10;
+	glm::mat4 modelMatrix(1.0f);
+	const glm::vec4 color(0.5f, 0.5f, 0.5f, 1.0f);
+	const glm::vec2 UVscale(1.0f, 1.0f);
+	const glm::vec3 white(1.0f, 1.0f, 1.0f);
+
+	if ((NULL == m_pShaderManager) || (m_uniformCache.GetProgram() == 0))
 	{
-		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
+		return;
 	}
+
+	// the driver is waited on before and after, so each time
+	// covers the calls and the work they queued
+	glFinish();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int i = 0; i < drawCount; i++)
+	{
+		modelMatrix[3].x = (float)(i % 100);
+		m_pShaderManager->setMat4Value(g_ModelName, modelMatrix);
+		m_pShaderManager->setMat4Value(g_NormalMatrixName, modelMatrix);
+		m_pShaderManager->setIntValue(g_UseTextureName, false);
+		m_pShaderManager->setVec4Value(g_ColorValueName, color);
+		m_pShaderManager->setVec2Value(g_UVScaleName, UVscale);
+		m_pShaderManager->setVec3Value("material.ambientColor", white);
+		m_pShaderManager->setFloatValue("material.ambientStrength", 0.2f);
+		m_pShaderManager->setVec3Value("material.diffuseColor", white);
+		m_pShaderManager->setVec3Value("material.specularColor", white);
+		m_pShaderManager->setFloatValue("material.shininess", 32.0f);
+	}
+	glFinish();
+	std::chrono::duration<double, std::micro> nameTime = std::chrono::steady_clock::now() - start;
+
+	// the values set by name are not in the shadow copies
+	m_uniformCache.Invalidate();
+	m_uniformCache.ResetCounts();
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < drawCount; i++)
+	{
+		modelMatrix[3].x = (float)(i % 100);
+		m_uniformCache.Set(m_uniforms.model, modelMatrix);
+		m_uniformCache.Set(m_uniforms.normalMatrix, modelMatrix);
+		m_uniformCache.Set(m_uniforms.bUseTexture, false);
+		m_uniformCache.Set(m_uniforms.objectColor, color);
+		m_uniformCache.Set(m_uniforms.UVscale, UVscale);
+		m_uniformCache.Set(m_uniforms.materialAmbientColor, white);
+		m_uniformCache.Set(m_uniforms.materialAmbientStrength, 0.2f);
+		m_uniformCache.Set(m_uniforms.materialDiffuseColor, white);
+		m_uniformCache.Set(m_uniforms.materialSpecularColor, white);
+		m_uniformCache.Set(m_uniforms.materialShininess, 32.0f);
+	}
+	glFinish();
+	std::chrono::duration<double, std::micro> handleTime = std::chrono::steady_clock::now() - start;
+
+	std::cout << "INFO: Read " << m_uniformCache.GetUniformCount() << " uniform locations of the shader program" << std::endl;
+	std::cout << "INFO: Set " << uniformsPerDraw << " uniforms by name in " << nameTime.count() / drawCount
+		<< " us per draw" << std::endl;
+	std::cout << "INFO: Set " << uniformsPerDraw << " uniforms by handle in " << handleTime.count() / drawCount
+		<< " us per draw" << std::endl;
+	std::cout << "INFO: Uniform writes issued: " << m_uniformCache.GetIssuedCount()
+		<< ", dropped as unchanged: " << m_uniformCache.GetElidedCount() << std::endl;
+	if (handleTime.count() > 0.0)
+	{
+		std::cout << "INFO: Uniform update speedup: " << nameTime.count() / handleTime.count() << "x\n" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  BenchmarkSceneLoading()
+ *
+ *  This method is used for timing the load of a large scene
+ *  from a binary scene file.  A scene of desks, each
+ *  carrying a few objects, is written out first, then the
+ *  file is mapped and its objects filled into a scene graph
+ *  and the scene entities as LoadSceneFile() does, and the
+ *  graph matrices are brought up to date.  It needs no
+ *  OpenGL context.
+ ***********************************************************/
+void SceneManager::BenchmarkSceneLoading()
+{
+	const int objectCount = 100000;
+	const int objectsPerDesk = 10;
+	const char* sceneFilename = "benchmark.sceneb";
+	SceneFileBuilder builder;
+
+	builder.AddTexture("desk", "textures/whitedesk.jpg");
+	builder.AddMaterial("shinyWhite", glm::vec3(1.0f, 1.0f, 1.0f), 0.2f, glm::vec3(1.0f, 1.0f, 1.0f),
+		glm::vec3(1.0f, 1.0f, 1.0f), 32.0f, SamplerCache::SAMPLER_TRILINEAR);
+	for (int i = 0; i < objectCount; i++)
+	{
+		int desk = i - (i % objectsPerDesk);
+		if (i == desk)
+		{
+			builder.AddObject(-1, SceneMeshes::MESH_PLANE, 0, 0, glm::vec3(20.0f, 1.0f, 10.0f), 0.0f, 0.0f, 0.0f,
+				glm::vec3((float)((i / objectsPerDesk) % 100) * 25.0f, 0.0f, -(float)(i / (objectsPerDesk * 100)) * 15.0f),
+				glm::vec4(0.8f, 0.8f, 0.8f, 1.0f), glm::vec2(1.0f, 1.0f));
+		}
+		else
+		{
+			builder.AddObject(desk, SceneMeshes::MESH_BOX, -1, -1, glm::vec3(1.0f, 0.5f + (i % 3) * 0.5f, 1.0f),
+				0.0f, (float)((i * 37) % 360), 0.0f, glm::vec3((float)(i % objectsPerDesk) * 2.0f - 9.0f, 0.1f, 0.0f),
+				glm::vec4(0.1f, 0.1f, 0.1f, 1.0f), glm::vec2(1.0f, 1.0f));
+		}
+	}
+	if (builder.Write(sceneFilename) == false)
+	{
+		std::cout << "Could not write scene file:" << sceneFilename << std::endl;
+		return;
+	}
+
+	SceneFile sceneFile;
+	SceneGraph graph;
+	SceneEntities entities;
+	std::vector<int> textureHandles(1, 0);
+	std::vector<int> materialIndices(1, 0);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if (sceneFile.Open(sceneFilename) == false)
+	{
+		std::remove(sceneFilename);
+		return;
+	}
+	std::chrono::duration<double, std::milli> openTime = std::chrono::steady_clock::now() - start;
+
+	start = std::chrono::steady_clock::now();
+	FillSceneObjects(sceneFile, textureHandles, materialIndices, 0, graph, entities);
+	std::chrono::duration<double, std::milli> fillTime = std::chrono::steady_clock::now() - start;
+
+	start = std::chrono::steady_clock::now();
+	graph.Update();
+	std::chrono::duration<double, std::milli> updateTime = std::chrono::steady_clock::now() - start;
+
+	std::cout << "INFO: Mapped and checked a scene file of " << sceneFile.GetObjectCount() << " objects in "
+		<< openTime.count() << " ms" << std::endl;
+	std::cout << "INFO: Filled " << entities.GetCount() << " entities and scene graph nodes in "
+		<< fillTime.count() << " ms" << std::endl;
+	std::cout << "INFO: Placed " << graph.GetUpdatedNodeCount() << " scene graph nodes in "
+		<< updateTime.count() << " ms\n" << std::endl;
+
+	sceneFile.Close();
+	std::remove(sceneFilename);
+}
+
+/***********************************************************
+ *  CompressSceneTextures()
+ *
+ *  This method is used for block compressing every image in
+ *  the textures folder ahead of time, so later runs with
+ *  texture compression only map the compressed files.  The
+ *  images are compressed one at a time, each across every
+ *  core, and the size and quality of each is reported.  No
+ *  OpenGL context is needed.
+ ***********************************************************/
+void SceneManager::CompressSceneTextures(TextureCompressor::BLOCK_FORMAT blockFormat)
+{
+	const int fileCount = sizeof(g_SceneTextures) / sizeof(g_SceneTextures[0]);
+	TextureCache textureCache("texcache");
+	TextureCompressor textureCompressor(blockFormat);
+	size_t compressedTotal = 0;
+	size_t uncompressedTotal = 0;
+	int compressedCount = 0;
+
+	if (blockFormat == TextureCompressor::BLOCK_FORMAT_NONE)
+	{
+		return;
+	}
+
+	stbi_set_flip_vertically_on_load(true);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int i = 0; i < fileCount; i++)
+	{
+		TextureDecodePool::DECODED_IMAGE image;
+		TextureDecodePool::ResetImage(image);
+		image.filename = g_SceneTextures[i].filename;
+		image.tag = g_SceneTextures[i].tag;
+
+		// reuse the cached mip chain when there is one
+		if (textureCache.Load(image.filename, image) == false)
+		{
+			image.pixels = stbi_load(image.filename.c_str(), &image.width, &image.height, &image.colorChannels, 0);
+		}
+
+		if (((image.colorChannels == 3) || (image.colorChannels == 4)) &&
+			(textureCache.StoreCompressed(image.filename, textureCompressor, image) == true))
+		{
+			size_t compressedSize = 0;
+			size_t uncompressedSize = 0;
+			for (size_t level = 0; level < image.mipLevels.size(); level++)
+			{
+				compressedSize += image.mipLevels[level].size;
+				uncompressedSize += (size_t)image.mipLevels[level].width * image.mipLevels[level].height * 4;
+			}
+			compressedTotal += compressedSize;
+			uncompressedTotal += uncompressedSize;
+			compressedCount++;
+
+			std::cout << "INFO: Compressed " << image.filename << " (" << image.width << "x" << image.height
+				<< ") to " << compressedSize / 1024 << " KB from " << uncompressedSize / 1024
+				<< " KB, PSNR " << image.compressionPSNR << " dB" << std::endl;
+		}
+		else
+		{
+			std::cout << "Could not compress image:" << image.filename << std::endl;
+		}
+
+		TextureDecodePool::FreeImage(image);
+	}
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::cout << "INFO: Compressed " << compressedCount << " of " << fileCount << " images as "
+		<< TextureCompressor::GetFormatName(blockFormat) << " in " << elapsed.count() << " ms, "
+		<< compressedTotal / 1024 << " KB instead of " << uncompressedTotal / 1024 << " KB\n" << std::endl;
+}
+
+/***********************************************************
+ *  BuildAssetPack()
+ *
+ *  This method is used for writing every scene texture,
+ *  basic shape mesh and shader into one asset pack.  The
+ *  textures are stored as the same mip chains the texture
+ *  cache keeps, block compressed when a block format is
+ *  passed in, and the cache is used and filled on the way.
+ *  It runs before any window is created, from the folder
+ *  holding the textures and shaders folders.
+ ***********************************************************/
+bool SceneManager::BuildAssetPack(const char* packFilename, TextureCompressor::BLOCK_FORMAT blockFormat)
+{
+	const int fileCount = sizeof(g_SceneTextures) / sizeof(g_SceneTextures[0]);
+	const char* shaderFiles[] = { "shaders/vertexShader.glsl", "shaders/fragmentShader.glsl" };
+	const int shaderCount = sizeof(shaderFiles) / sizeof(shaderFiles[0]);
+	TextureCache textureCache("texcache");
+	TextureCompressor textureCompressor(blockFormat);
+	AssetPackBuilder packBuilder;
+
+	stbi_set_flip_vertically_on_load(true);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	bool bSuccess = packBuilder.Begin(packFilename);
+	for (int i = 0; (bSuccess == true) && (i < fileCount); i++)
+	{
+		TextureDecodePool::DECODED_IMAGE image;
+		TextureDecodePool::ResetImage(image);
+		image.filename = g_SceneTextures[i].filename;
+		image.tag = g_SceneTextures[i].tag;
+
+		// a current compressed file or cache entry skips the decode
+		if ((blockFormat == TextureCompressor::BLOCK_FORMAT_NONE) ||
+			(textureCache.LoadCompressed(image.filename, blockFormat, image) == false))
+		{
+			if (textureCache.Load(image.filename, image) == false)
+			{
+				image.pixels = stbi_load(image.filename.c_str(), &image.width, &image.height, &image.colorChannels, 0);
+				if (NULL != image.pixels)
+				{
+					textureCache.Store(image.filename, image);
+				}
+			}
+			if ((blockFormat != TextureCompressor::BLOCK_FORMAT_NONE) &&
+				((image.colorChannels == 3) || (image.colorChannels == 4)))
+			{
+				textureCache.StoreCompressed(image.filename, textureCompressor, image);
+			}
+		}
+
+		bSuccess = packBuilder.AddTexture(image.filename, image);
+		if (bSuccess == false)
+		{
+			std::cout << "Could not pack image:" << image.filename << std::endl;
+		}
+
+		TextureDecodePool::FreeImage(image);
+	}
+
+	for (int i = 0; (bSuccess == true) && (i < SceneMeshes::MESH_SHAPE_COUNT); i++)
+	{
+		std::vector<float> vertices;
+		std::vector<uint32_t> indices;
+		SceneMeshes::BuildShape((SceneMeshes::MESH_SHAPE)i, vertices, indices);
+		bSuccess = packBuilder.AddMesh(SceneMeshes::GetShapeName((SceneMeshes::MESH_SHAPE)i),
+			vertices, SceneMeshes::FLOATS_PER_VERTEX, indices);
+	}
+
+	for (int i = 0; (bSuccess == true) && (i < shaderCount); i++)
+	{
+		AssetReader::ASSET_BUFFER buffer;
+		bSuccess = ((AssetReader::ReadFile(shaderFiles[i], buffer) == true) &&
+			(packBuilder.AddShader(shaderFiles[i], buffer.data, buffer.size) == true));
+		if (bSuccess == false)
+		{
+			std::cout << "Could not pack shader:" << shaderFiles[i] << std::endl;
+		}
+		AssetReader::FreeBuffer(buffer);
+	}
+
+	if (bSuccess == true)
+	{
+		bSuccess = packBuilder.Finish();
+	}
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+	if (bSuccess == true)
+	{
+		std::cout << "INFO: Built asset pack " << packFilename << " with " << packBuilder.GetEntryCount()
+			<< " assets (" << packBuilder.GetWrittenBytes() / 1024 << " KB) in " << elapsed.count() << " ms" << std::endl;
+	}
+	else
+	{
+		std::cout << "Could not build asset pack:" << packFilename << std::endl;
+	}
+
+	return(bSuccess);
+}
+
+/***********************************************************
+ *  BindGLTextures()
+ *
+ *  This method is used for binding the loaded textures to
+ *  OpenGL texture memory slots.  Each texture object gets a
+ *  unit of its own while units last - packed textures share
+ *  the unit of their array.  The last two units are kept
+ *  spare for binding any remaining plain and array textures
+ *  on demand.
+ ***********************************************************/
+void SceneManager::BindGLTextures()
+{
+	GLint maxTextureUnits = 16;
+	glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &maxTextureUnits);
+
+	m_spareTextureUnit = maxTextureUnits - 1;
+	m_spareArrayUnit = maxTextureUnits - 2;
+	m_spareUnitHandle = -1;
+	m_spareArrayUnitHandle = -1;
+
+	std::unordered_map<uint32_t, int> textureUnits;
+	int nextUnit = 0;
+	for (size_t i = 0; i < m_textureIDs.size(); i++)
+	{
+		std::unordered_map<uint32_t, int>::const_iterator found = textureUnits.find(m_textureIDs[i].ID);
+		if (found != textureUnits.end())
+		{
+			m_textureIDs[i].unit = found->second;
+		}
+		else if (nextUnit < m_spareArrayUnit)
+		{
+			// bind textures on corresponding texture units
+			glActiveTexture(GL_TEXTURE0 + nextUnit);
+			glBindTexture(m_textureIDs[i].target, m_textureIDs[i].ID);
+			textureUnits[m_textureIDs[i].ID] = nextUnit;
+			m_textureIDs[i].unit = nextUnit;
+			nextUnit++;
+		}
+		else
+		{
+			m_textureIDs[i].unit = -1;
+		}
+	}
+
+	// samplers of different types must never share a unit, so
+	// each one starts out on its own spare unit
+	m_uniformCache.Set(m_uniforms.objectTexture, m_spareTextureUnit);
+	m_uniformCache.Set(m_uniforms.objectTextureArray, m_spareArrayUnit);
+}
+
+/***********************************************************
+ *  DestroyGLTextures()
+ *
+ *  This method is used for freeing the memory in all the
+ *  used texture memory slots.  Packed textures share their
+ *  array, so each texture object is deleted only once, and
+ *  the registry is emptied.
+ ***********************************************************/
+void SceneManager::DestroyGLTextures()
+{
+	std::unordered_map<uint32_t, int> deletedIDs;
+
+	for (size_t i = 0; i < m_textureIDs.size(); i++)
+	{
+		if (deletedIDs.insert(std::make_pair(m_textureIDs[i].ID, 0)).second == true)
+		{
+			m_pResourceTracker->Delete(GLResourceTracker::RESOURCE_TEXTURE, m_textureIDs[i].ID);
+		}
+	}
+
+	// textures that replaced it leave the placeholder out of the registry
+	if ((m_placeholderTextureID != 0) && (deletedIDs.count(m_placeholderTextureID) == 0))
+	{
+		m_pResourceTracker->Delete(GLResourceTracker::RESOURCE_TEXTURE, m_placeholderTextureID);
+	}
+	m_placeholderTextureID = 0;
+
+	m_textureIDs.clear();
+	m_textureHandles.clear();
+	m_sceneTextureHandles.clear();
+	m_spareUnitHandle = -1;
+	m_spareArrayUnitHandle = -1;
+}
+
+/***********************************************************
+ *  DrawShapeMesh()
+ *
+ *  This method is used for drawing a shape with the mesh
+ *  baked into the asset pack, or with the basic shapes when
+ *  the shape was not loaded from a pack.
+ ***********************************************************/
+void SceneManager::DrawShapeMesh(SceneMeshes::MESH_SHAPE shape)
+{
+	if (m_pSceneMeshes->IsLoaded(shape) == true)
+	{
+		m_pSceneMeshes->DrawShape(shape);
+		return;
+	}
+
+	switch (shape)
+	{
+	case SceneMeshes::MESH_PLANE:
+		m_basicMeshes->DrawPlaneMesh();
+		break;
+	case SceneMeshes::MESH_BOX:
+		m_basicMeshes->DrawBoxMesh();
+		break;
+	case SceneMeshes::MESH_CYLINDER:
+		m_basicMeshes->DrawCylinderMesh();
+		break;
+	case SceneMeshes::MESH_SPHERE:
+		m_basicMeshes->DrawSphereMesh();
+		break;
+	default:
+		break;
+	}
+}
+
+/***********************************************************
+ *  FindTextureID()
+ *
+ *  This method is used for getting an ID for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureID(std::string tag)
+{
+	int textureSlot = FindTextureSlot(tag);
+
+	if (textureSlot < 0)
+	{
+		return(-1);
+	}
+
+	return(m_textureIDs[textureSlot].ID);
+}
+
+/***********************************************************
+ *  FindTextureSlot()
+ *
+ *  This method is used for getting a slot index for the previously
+ *  loaded texture bitmap associated with the passed in tag.  The
+ *  slot index is the handle of the texture in the registry, so it
+ *  should be looked up once at load time rather than every draw.
+ ***********************************************************/
+int SceneManager::FindTextureSlot(std::string tag)
+{
+	std::unordered_map<std::string, int>::const_iterator found = m_textureHandles.find(tag);
+
+	if (found == m_textureHandles.end())
+	{
+		return(-1);
+	}
+
+	return(found->second);
+}
+
+/***********************************************************
+ *  FindMaterial()
+ *
+ *  This method is used for getting a material from the previously
+ *  defined materials list that is associated with the passed in tag.
+ ***********************************************************/
+bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
+{
+	if (m_objectMaterials.size() == 0)
+	{
+		return(false);
+	}
+
+	int index = 0;
+	bool bFound = false;
+	while ((index < m_objectMaterials.size()) && (bFound == false))
+	{
+		if (m_objectMaterials[index].tag.compare(tag) == 0)
+		{
+			bFound = true;
+			material.ambientColor = m_objectMaterials[index].ambientColor;
+			material.ambientStrength = m_objectMaterials[index].ambientStrength;
+			material.diffuseColor = m_objectMaterials[index].diffuseColor;
+			material.specularColor = m_objectMaterials[index].specularColor;
+			material.shininess = m_objectMaterials[index].shininess;
+		}
+		else
+		{
+			index++;
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  FindMaterialIndex()
+ *
+ *  This method is used for getting the index of the defined
+ *  material associated with the passed in tag, or -1 when
+ *  no material has that tag.
+ ***********************************************************/
+int SceneManager::FindMaterialIndex(std::string tag)
+{
+	for (int index = 0; index < (int)m_objectMaterials.size(); index++)
+	{
+		if (m_objectMaterials[index].tag.compare(tag) == 0)
+		{
+			return(index);
+		}
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transform buffer
+ *  using the passed in transformation values.
+ ***********************************************************/
+void SceneManager::SetTransformations(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	// the matrices are only composed again when the transform
+	// differs from the one this object had last frame
+	int slot = m_pTransformCache->SetNextTransform(
+		scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+
+	// remembered to work out the mip levels the object samples
+	m_lastObjectPosition = positionXYZ;
+	m_lastObjectSize = std::max(scaleXYZ.x, std::max(scaleXYZ.y, scaleXYZ.z));
+
+	if (NULL != m_pShaderManager)
+	{
+		m_uniformCache.Set(m_uniforms.model, m_pTransformCache->GetModelMatrix(slot));
+		m_uniformCache.Set(m_uniforms.normalMatrix, m_pTransformCache->GetNormalMatrix(slot));
+	}
+}
+
+/***********************************************************
+ *  SetNodeTransformations()
+ *
+ *  This method is used for setting the model and normal
+ *  matrices of a scene graph node into the shader.  The
+ *  matrices come straight from the graph, which has already
+ *  placed the node relative to its parents.
+ ***********************************************************/
+void SceneManager::SetNodeTransformations(int nodeID)
+{
+	SetLastObjectNode(nodeID);
+
+	if (NULL != m_pShaderManager)
+	{
+		m_uniformCache.Set(m_uniforms.model, m_pSceneGraph->GetModelMatrix(nodeID));
+		m_uniformCache.Set(m_uniforms.normalMatrix, m_pSceneGraph->GetNormalMatrix(nodeID));
+	}
+}
+
+/***********************************************************
+ *  SetLastObjectNode()
+ *
+ *  This method is used for remembering the position and
+ *  largest scale of the scene graph node being drawn, to
+ *  work out the mip levels the object samples.
+ ***********************************************************/
+void SceneManager::SetLastObjectNode(int nodeID)
+{
+	const glm::mat4& modelMatrix = m_pSceneGraph->GetModelMatrix(nodeID);
+	glm::vec3 scaleXYZ = m_pSceneGraph->GetScale(nodeID);
+
+	m_lastObjectPosition = glm::vec3(modelMatrix[3].x, modelMatrix[3].y, modelMatrix[3].z);
+	m_lastObjectSize = std::max(scaleXYZ.x, std::max(scaleXYZ.y, scaleXYZ.z));
+}
+
+/***********************************************************
+ *  ResolveUniforms()
+ *
+ *  This method is used for reading the uniforms of the
+ *  shader program once and resolving the handles of the
+ *  uniforms set while drawing, so no draw looks a uniform
+ *  up by name.  Uniforms only set once, such as the lights,
+ *  are still set by name.
+ ***********************************************************/
+void SceneManager::ResolveUniforms()
+{
+	m_uniformCache.Load(m_programID);
+	m_uniformCache.Resolve(g_ModelName, m_uniforms.model);
+	m_uniformCache.Resolve(g_NormalMatrixName, m_uniforms.normalMatrix);
+	m_uniformCache.Resolve(g_ColorValueName, m_uniforms.objectColor);
+	m_uniformCache.Resolve(g_UseTextureName, m_uniforms.bUseTexture);
+	m_uniformCache.Resolve(g_TextureValueName, m_uniforms.objectTexture);
+	m_uniformCache.Resolve(g_UseTextureArrayName, m_uniforms.bUseTextureArray);
+	m_uniformCache.Resolve(g_TextureArrayValueName, m_uniforms.objectTextureArray);
+	m_uniformCache.Resolve(g_TextureLayerName, m_uniforms.textureLayer);
+	m_uniformCache.Resolve(g_TextureRectName, m_uniforms.textureRect);
+	m_uniformCache.Resolve(g_UVScaleName, m_uniforms.UVscale);
+	m_uniformCache.Resolve("material.ambientColor", m_uniforms.materialAmbientColor);
+	m_uniformCache.Resolve("material.ambientStrength", m_uniforms.materialAmbientStrength);
+	m_uniformCache.Resolve("material.diffuseColor", m_uniforms.materialDiffuseColor);
+	m_uniformCache.Resolve("material.specularColor", m_uniforms.materialSpecularColor);
+	m_uniformCache.Resolve("material.shininess", m_uniforms.materialShininess);
+	m_uniformCache.Resolve(g_UseInstancingName, m_uniforms.bUseInstancing);
+	m_uniformCache.Resolve(g_UseIndirectDrawsName, m_uniforms.bUseIndirectDraws);
+	m_uniformCache.Resolve(g_FirstDrawDataName, m_uniforms.firstDrawData);
+	m_uniformCache.Resolve(g_UseLightClustersName, m_uniforms.bUseLightClusters);
+}
+
+/***********************************************************
+ *  SetShaderColor()
+ *
+ *  This method is used for setting the passed in color
+ *  into the shader for the next draw command
+ ***********************************************************/
+void SceneManager::SetShaderColor(
+	float redColorValue,
+	float greenColorValue,
+	float blueColorValue,
+	float alphaValue)
+{
+	// variables for this method
+	glm::vec4 currentColor;
+
+	currentColor.r = redColorValue;
+	currentColor.g = greenColorValue;
+	currentColor.b = blueColorValue;
+	currentColor.a = alphaValue;
+
+	if (NULL != m_pShaderManager)
+	{
+		m_uniformCache.Set(m_uniforms.bUseTexture, false);
+		m_uniformCache.Set(m_uniforms.objectColor, currentColor);
+	}
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for setting the texture data
+ *  associated with the passed in ID into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	std::string textureTag)
+{
+	SetShaderTexture(FindTextureSlot(textureTag));
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for setting the texture data with
+ *  the passed in registry handle into the shader.  Textures
+ *  without a unit of their own are bound to a spare unit,
+ *  which is only rebound when a different texture is used.
+ *  Packed textures also select their array layer and atlas
+ *  rectangle.  The sampler of the current material is bound
+ *  to the unit that is used.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	int textureHandle)
+{
+	if (NULL != m_pShaderManager)
+	{
+		if ((textureHandle < 0) || (textureHandle >= (int)m_textureIDs.size()))
+		{
+			m_uniformCache.Set(m_uniforms.bUseTexture, false);
+			return;
+		}
+
+		const TEXTURE_INFO& textureInfo = m_textureIDs[textureHandle];
+		int textureSlot = textureInfo.unit;
+
+		m_uniformCache.Set(m_uniforms.bUseTexture, true);
+
+		if (textureInfo.target == GL_TEXTURE_2D_ARRAY)
+		{
+			if (textureSlot < 0)
+			{
+				textureSlot = m_spareArrayUnit;
+				if (m_spareArrayUnitHandle != textureHandle)
+				{
+					glActiveTexture(GL_TEXTURE0 + textureSlot);
+					glBindTexture(GL_TEXTURE_2D_ARRAY, textureInfo.ID);
+					m_spareArrayUnitHandle = textureHandle;
+				}
+			}
+			m_pSamplerCache->BindSampler(textureSlot, m_currentSampler);
+			m_currentTextureUnit = textureSlot;
+			m_uniformCache.Set(m_uniforms.bUseTextureArray, true);
+			m_uniformCache.Set(m_uniforms.objectTextureArray, textureSlot);
+			m_uniformCache.Set(m_uniforms.textureLayer, textureInfo.layer);
+			m_uniformCache.Set(m_uniforms.textureRect, textureInfo.uvRect);
+		}
+		else
+		{
+			if (textureSlot < 0)
+			{
+				textureSlot = m_spareTextureUnit;
+				if (m_spareUnitHandle != textureHandle)
+				{
+					glActiveTexture(GL_TEXTURE0 + textureSlot);
+					glBindTexture(GL_TEXTURE_2D, textureInfo.ID);
+					m_spareUnitHandle = textureHandle;
+				}
+			}
+			m_pSamplerCache->BindSampler(textureSlot, m_currentSampler);
+			m_currentTextureUnit = textureSlot;
+
+			MarkTextureUsed(textureHandle);
+
+			if (m_bPackTextures == true)
+			{
+				m_uniformCache.Set(m_uniforms.bUseTextureArray, false);
+			}
+			m_uniformCache.Set(m_uniforms.objectTexture, textureSlot);
+		}
+	}
+}
+
+/***********************************************************
+ *  SetInstancing()
+ *
+ *  This method is used for turning on or off the merging of
+ *  draws with the same mesh, texture, material and texture
+ *  UV scale into instanced draws.
+ ***********************************************************/
+void SceneManager::SetInstancing(bool bUseInstancing)
+{
+	m_bUseInstancing = bUseInstancing;
+}
+
+/***********************************************************
+ *  SetIndirectDraws()
+ *
+ *  This method is used for turning on the submission of the
+ *  scene entities with multi-draw-indirect calls, which the
+ *  driver must support.  It must be called before
+ *  PrepareScene(), which creates the indirect draw buffers.
+ ***********************************************************/
+void SceneManager::SetIndirectDraws(bool bUseIndirectDraws)
+{
+	m_bUseIndirectDraws = bUseIndirectDraws;
+}
+
+/***********************************************************
+ *  MarkTextureUsed()
+ *
+ *  This method is used for letting the residency manager
+ *  know that the object being drawn samples a texture, so
+ *  the texture keeps the mip levels the object needs.  It
+ *  is called for every object drawn with a texture, even
+ *  when the texture is already bound.
+ ***********************************************************/
+void SceneManager::MarkTextureUsed(int textureHandle)
+{
+	// the nearest surface of the object decides the levels it needs
+	float distance = glm::length(m_lastObjectPosition - m_cameraPosition) - (m_lastObjectSize * 0.5f);
+	m_pTextureResidency->MarkUsed(textureHandle, std::max(distance, 0.01f), m_lastObjectSize);
+}
+
+/***********************************************************
+ *  SetAssetPack()
+ *
+ *  This method is used for setting the asset pack the scene
+ *  textures and meshes are loaded from.  The pack must stay
+ *  open for as long as the scene.  It must be called before
+ *  PrepareScene().
+ ***********************************************************/
+void SceneManager::SetAssetPack(const AssetPack* pAssetPack)
+{
+	m_pAssetPack = pAssetPack;
+}
+
+/***********************************************************
+ *  SetTexturePacking()
+ *
+ *  This method is used for turning on the packing of the
+ *  scene textures into texture arrays and atlas layers, so
+ *  draws select a layer instead of switching samplers.  It
+ *  must be called before PrepareScene().
+ ***********************************************************/
+void SceneManager::SetTexturePacking(bool bPackTextures)
+{
+	m_bPackTextures = bPackTextures;
+}
+
+/***********************************************************
+ *  SetTextureCompression()
+ *
+ *  This method is used for turning on the block compression
+ *  of the scene textures, which cuts their texture memory to
+ *  a quarter or less.  Compressed textures are not packed
+ *  into texture arrays.  It must be called before
+ *  PrepareScene().
+ ***********************************************************/
+void SceneManager::SetTextureCompression(TextureCompressor::BLOCK_FORMAT blockFormat)
+{
+	m_textureCompression = blockFormat;
+}
+
+/***********************************************************
+ *  SetTextureStreaming()
+ *
+ *  This method is used for choosing between streaming the
+ *  scene textures in behind placeholders, which is the
+ *  default, and blocking until every texture is uploaded.
+ *  Packed textures always block.  It must be called before
+ *  PrepareScene().
+ ***********************************************************/
+void SceneManager::SetTextureStreaming(bool bStreamTextures)
+{
+	m_bStreamTextures = bStreamTextures;
+}
+
+/***********************************************************
+ *  IsStreamingTextures()
+ *
+ *  This method is used for checking whether any scene
+ *  texture is still being streamed in.
+ ***********************************************************/
+bool SceneManager::IsStreamingTextures() const
+{
+	return(NULL != m_pTextureStreamer);
+}
+
+/***********************************************************
+ *  SetTextureBudget()
+ *
+ *  This method is used for setting the GPU memory budget of
+ *  the scene textures.  Over budget, the top mip levels of
+ *  the least recently drawn textures are dropped, and they
+ *  come back once the objects using them get close enough
+ *  to need them.  A budget of 0 keeps every level.
+ ***********************************************************/
+void SceneManager::SetTextureBudget(size_t budgetBytes)
+{
+	m_pTextureResidency->SetBudgetBytes(budgetBytes);
+}
+
+/***********************************************************
+ *  SetCameraView()
+ *
+ *  This method is used for setting the camera position and
+ *  the focal length in pixels used to work out how large
+ *  each drawn object is on screen.  It is called every
+ *  frame before RenderScene().
+ ***********************************************************/
+void SceneManager::SetCameraView(glm::vec3 cameraPosition, float focalPixels)
+{
+	m_cameraPosition = cameraPosition;
+	m_pTextureResidency->SetFocalLength(focalPixels);
+}
+
+/***********************************************************
+ *  UpdateTextureResidency()
+ *
+ *  This method is used for dropping and restoring the mip
+ *  levels of the scene textures from the objects drawn by
+ *  the last RenderScene() call.  Rebuilt textures replace
+ *  the old ones in the registry.
+ ***********************************************************/
+void SceneManager::UpdateTextureResidency()
+{
+	std::vector<TextureResidency::REPLACED_TEXTURE> replaced;
+	m_pTextureResidency->Update(replaced);
+
+	for (size_t i = 0; i < replaced.size(); i++)
+	{
+		m_textureIDs[replaced[i].handle].ID = replaced[i].textureID;
+	}
+	if (replaced.empty() == false)
+	{
+		BindGLTextures();
+	}
+}
+
+/***********************************************************
+ *  SetSamplerOverride()
+ *
+ *  This method is used for filtering every texture with the
+ *  passed in sampler preset, whatever the material asks
+ *  for, so the presets can be compared on the same scene.
+ *  Passing -1 goes back to the material presets.
+ ***********************************************************/
+void SceneManager::SetSamplerOverride(int samplerPreset)
+{
+	m_samplerOverride = samplerPreset;
+
+	int currentPreset = (samplerPreset >= 0) ? samplerPreset : (int)SamplerCache::SAMPLER_TRILINEAR;
+	m_currentSampler = m_pSamplerCache->GetPresetSampler((SamplerCache::SAMPLER_PRESET)currentPreset);
+}
+
+/***********************************************************
+ *  GetTransformRecomputeCount()
+ *
+ *  This method is used for getting the number of objects
+ *  whose model matrices were composed in the last frame,
+ *  through SetTransformations() or the scene graph.  It is
+ *  zero once the scene has stopped moving.
+ ***********************************************************/
+int SceneManager::GetTransformRecomputeCount() const
+{
+	return(m_pTransformCache->GetFrameRecomputeCount() + m_pSceneGraph->GetUpdatedNodeCount());
+}
+
+/***********************************************************
+ *  GetStateChangeCount()
+ *
+ *  This method is used for getting the number of times the
+ *  program, mesh, texture or material had to change while
+ *  drawing the scene entities in the last frame.
+ ***********************************************************/
+int SceneManager::GetStateChangeCount() const
+{
+	return(m_pRenderQueue->GetSortedStateChanges());
+}
+
+/***********************************************************
+ *  GetDrawCallCount()
+ *
+ *  This method is used for getting the number of draw calls
+ *  made for the scene entities in the last frame, counting
+ *  an instanced draw once.
+ ***********************************************************/
+int SceneManager::GetDrawCallCount() const
+{
+	return(m_drawCallCount);
+}
+
+/***********************************************************
+ *  GetUniformWriteCount()
+ *
+ *  This method is used for getting the number of uniform
+ *  writes passed to the driver in the last frame.
+ ***********************************************************/
+int SceneManager::GetUniformWriteCount() const
+{
+	return(m_uniformCache.GetIssuedCount());
+}
+
+/***********************************************************
+ *  GetElidedUniformWriteCount()
+ *
+ *  This method is used for getting the number of uniform
+ *  writes dropped in the last frame because the uniform
+ *  already held the value.
+ ***********************************************************/
+int SceneManager::GetElidedUniformWriteCount() const
+{
+	return(m_uniformCache.GetElidedCount());
+}
+
+/***********************************************************
+ *  AddLight()
+ *
+ *  This method is used for adding a light source to the
+ *  scene.  The ID it returns updates or removes the light
+ *  later, whatever other lights were added or removed.  A
+ *  light with a range fades out to nothing at that distance
+ *  and only lights the clusters it reaches, while a light
+ *  without one reaches everywhere.
+ ***********************************************************/
+int SceneManager::AddLight(
+	glm::vec3 position,
+	glm::vec3 ambientColor,
+	glm::vec3 diffuseColor,
+	glm::vec3 specularColor,
+	float focalStrength,
+	float specularIntensity,
+	float range)
+{
+	LightBuffer::LIGHT_DATA light;
+	light.position = position;
+	light.ambientColor = ambientColor;
+	light.diffuseColor = diffuseColor;
+	light.specularColor = specularColor;
+	light.focalStrength = focalStrength;
+	light.specularIntensity = specularIntensity;
+	light.range = range;
+	light.padding = 0.0f;
+
+	return(m_pLightBuffer->AddLight(light));
+}
+
+/***********************************************************
+ *  UpdateLight()
+ *
+ *  This method is used for changing the values of a light
+ *  source.  Only the lights changed are written to the
+ *  shaders on the next frame.
+ ***********************************************************/
+bool SceneManager::UpdateLight(
+	int lightID,
+	glm::vec3 position,
+	glm::vec3 ambientColor,
+	glm::vec3 diffuseColor,
+	glm::vec3 specularColor,
+	float focalStrength,
+	float specularIntensity,
+	float range)
+{
+	LightBuffer::LIGHT_DATA light;
+	light.position = position;
+	light.ambientColor = ambientColor;
+	light.diffuseColor = diffuseColor;
+	light.specularColor = specularColor;
+	light.focalStrength = focalStrength;
+	light.specularIntensity = specularIntensity;
+	light.range = range;
+	light.padding = 0.0f;
+
+	return(m_pLightBuffer->UpdateLight(lightID, light));
+}
+
+/***********************************************************
+ *  RemoveLight()
+ *
+ *  This method is used for removing a light source from
+ *  the scene.
+ ***********************************************************/
+bool SceneManager::RemoveLight(int lightID)
+{
+	return(m_pLightBuffer->RemoveLight(lightID));
+}
+
+/***********************************************************
+ *  GetLightCount()
+ *
+ *  This method is used for getting the number of light
+ *  sources in the scene.
+ ***********************************************************/
+int SceneManager::GetLightCount() const
+{
+	return(m_pLightBuffer->GetLightCount());
+}
+
+/***********************************************************
+ *  GetResourceTracker()
+ *
+ *  This method is used for getting the tracker of the
+ *  OpenGL resources, so objects outside the scene, such as
+ *  the frame values of the view, show up in its memory
+ *  report and leak check.  It is deleted with the scene.
+ ***********************************************************/
+GLResourceTracker* SceneManager::GetResourceTracker() const
+{
+	return(m_pResourceTracker);
+}
+
+/***********************************************************
+ *  GetLightUploadCount()
+ *
+ *  This method is used for getting the number of lights
+ *  written to the light buffer the last frame any lights
+ *  changed.
+ ***********************************************************/
+int SceneManager::GetLightUploadCount() const
+{
+	return(m_pLightBuffer->GetUploadedCount());
+}
+
+/***********************************************************
+ *  UploadSceneLights()
+ *
+ *  This method is used for writing the lights that changed
+ *  since the last frame to the shaders.  A program that
+ *  cannot read the light buffer is given the first few
+ *  lights as uniforms instead, all of them again whenever
+ *  any changed.
+ ***********************************************************/
+void SceneManager::UploadSceneLights()
+{
+	if (m_pLightBuffer->HasChanges() == false)
+	{
+		return;
+	}
+
+	if ((m_bLightBufferBound == false) && (NULL != m_pShaderManager))
+	{
+		int lightCount = std::min(m_pLightBuffer->GetLightCount(), MAX_UNIFORM_LIGHTS);
+		m_pShaderManager->setIntValue(g_LightCountName, lightCount);
+		for (int i = 0; i < lightCount; i++)
+		{
+			const LightBuffer::LIGHT_DATA& light = m_pLightBuffer->GetLight(i);
+			std::string lightName = "lights[" + std::to_string(i) + "].";
+			m_pShaderManager->setVec3Value(lightName + "position", light.position);
+			m_pShaderManager->setVec3Value(lightName + "ambientColor", light.ambientColor);
+			m_pShaderManager->setVec3Value(lightName + "diffuseColor", light.diffuseColor);
+			m_pShaderManager->setVec3Value(lightName + "specularColor", light.specularColor);
+			m_pShaderManager->setFloatValue(lightName + "focalStrength", light.focalStrength);
+			m_pShaderManager->setFloatValue(lightName + "specularIntensity", light.specularIntensity);
+			m_pShaderManager->setFloatValue(lightName + "range", light.range);
+		}
+	}
+
+	m_pLightBuffer->Upload();
+}
+
+/***********************************************************
+ *  UpdateLightClusters()
+ *
+ *  This method is used for binning the lights into the
+ *  clusters of the view frustum set for the frame, and
+ *  telling the shaders whether to read the cluster lists
+ *  or loop over every light.
+ ***********************************************************/
+void SceneManager::UpdateLightClusters(bool bLightsChanged)
+{
+	if (NULL == m_pLightClusters)
+	{
+		return;
+	}
+
+	bool bUseLightClusters = (m_bUseLightClusters == true) && (m_bHaveViewFrustum == true);
+	m_uniformCache.Set(m_uniforms.bUseLightClusters, bUseLightClusters);
+	if (bUseLightClusters == true)
+	{
+		m_pLightClusters->Update(m_viewMatrix, m_projectionMatrix, m_viewportSize, *m_pLightBuffer, bLightsChanged);
+	}
+	else if (bLightsChanged == true)
+	{
+		// the lists are out of date once turned back on
+		m_pLightClusters->Invalidate();
+	}
+}
+
+/***********************************************************
+ *  SetViewFrustum()
+ *
+ *  This method is used for setting the view and projection
+ *  matrices and the viewport size of the frame, which the
+ *  lights are binned into clusters for.  It is called
+ *  every frame before RenderScene().
+ ***********************************************************/
+void SceneManager::SetViewFrustum(const glm::mat4& view, const glm::mat4& projection, glm::ivec2 viewportSize)
+{
+	m_viewMatrix = view;
+	m_projectionMatrix = projection;
+	m_viewportSize = viewportSize;
+	m_bHaveViewFrustum = true;
+}
+
+/***********************************************************
+ *  SetLightClusters()
+ *
+ *  This method is used for turning the binning of the
+ *  lights into clusters on or off.  With it off, or when
+ *  the driver has no storage buffers, every fragment loops
+ *  over every light.
+ ***********************************************************/
+void SceneManager::SetLightClusters(bool bUseLightClusters)
+{
+	m_bUseLightClusters = bUseLightClusters;
 }
 
 /***********************************************************
- *  DestroyGLTextures()
+ *  GetLightBinningMilliseconds()
  *
- *  This method is used for freeing the memory in all the
- *  used texture memory slots.
+ *  This method is used for getting the time the lights
+ *  last took to bin into clusters and upload.
  ***********************************************************/
-void SceneManager::DestroyGLTextures()
+double SceneManager::GetLightBinningMilliseconds() const
 {
-	for (int i = 0; i < m_loadedTextures; i++)
+	if ((NULL == m_pLightClusters) || (m_bUseLightClusters == false))
 	{
-		glGenTextures(1, &m_textureIDs[i].ID);
+		return(0.0);
 	}
+
+	return(m_pLightClusters->GetBinMilliseconds());
 }
 
 /***********************************************************
- *  FindTextureID()
+ *  SetBenchmarkLights()
  *
- *  This method is used for getting an ID for the previously
- *  loaded texture bitmap associated with the passed in tag.
+ *  This method is used for replacing the lights added by
+ *  the last call with a number of small desk lamps, spread
+ *  in a grid over the desk and each reaching a few units,
+ *  for timing the scene with more and more lights.
  ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
+void SceneManager::SetBenchmarkLights(int lightCount)
 {
-	int textureID = -1;
-	int index = 0;
-	bool bFound = false;
+	const glm::vec3 lampColors[] = {
+		glm::vec3(1.0f, 0.85f, 0.6f),
+		glm::vec3(0.6f, 0.8f, 1.0f),
+		glm::vec3(1.0f, 0.6f, 0.7f),
+		glm::vec3(0.7f, 1.0f, 0.7f) };
+	const int lampColorCount = sizeof(lampColors) / sizeof(lampColors[0]);
+
+	for (size_t i = 0; i < m_benchmarkLightIDs.size(); i++)
+	{
+		RemoveLight(m_benchmarkLightIDs[i]);
+	}
+	m_benchmarkLightIDs.clear();
 
-	while ((index < m_loadedTextures) && (bFound == false))
+	// the desk is twice as wide as it is deep
+	int columns = (int)ceilf(sqrtf(2.0f * (float)lightCount));
+	int rows = (lightCount + columns - 1) / std::max(columns, 1);
+	for (int i = 0; i < lightCount; i++)
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureID = m_textureIDs[index].ID;
-			bFound = true;
-		}
-		else
-			index++;
+		float x = -9.0f + 18.0f * ((float)(i % columns) + 0.5f) / (float)columns;
+		float z = -4.5f + 9.0f * ((float)(i / columns) + 0.5f) / (float)rows;
+		glm::vec3 color = lampColors[i % lampColorCount];
+		m_benchmarkLightIDs.push_back(AddLight(
+			glm::vec3(x, 1.5f, z),
+			glm::vec3(0.0f, 0.0f, 0.0f),
+			color * 0.6f,
+			color * 0.3f,
+			16.0f,
+			0.2f,
+			3.0f));
 	}
+}
 
-	return(textureID);
+/***********************************************************
+ *  GetSavedStateChangeCount()
+ *
+ *  This method is used for getting the number of state
+ *  changes the render queue saved in the last frame over
+ *  drawing the scene entities in the order they were added.
+ ***********************************************************/
+int SceneManager::GetSavedStateChangeCount() const
+{
+	return(m_pRenderQueue->GetAddedOrderStateChanges() - m_pRenderQueue->GetSortedStateChanges());
 }
 
 /***********************************************************
- *  FindTextureSlot()
+ *  LoadSceneFile()
  *
- *  This method is used for getting a slot index for the previously
- *  loaded texture bitmap associated with the passed in tag.
+ *  This method is used for replacing the objects of the
+ *  scene with the ones described in a scene file, and can
+ *  be called again at any time to swap layouts.  A text
+ *  scene file is compiled first into the binary form next
+ *  to it, with a "b" added to its name.  Textures already
+ *  loaded under a tag are reused and the others are loaded
+ *  from their files.  Materials replace the defined ones
+ *  with the same tag and the rest are added.  When the file
+ *  places any lights they replace the scene lights.  The
+ *  current scene is kept when the file cannot be used.
  ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
+bool SceneManager::LoadSceneFile(const std::string& filename)
 {
-	int textureSlot = -1;
-	int index = 0;
-	bool bFound = false;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 
-	while ((index < m_loadedTextures) && (bFound == false))
+	std::string sceneFilename = filename;
+	if (SceneFile::IsBinarySceneFile(filename) == false)
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
+		SceneFileBuilder builder;
+		sceneFilename = filename + "b";
+		if ((builder.CompileText(filename) == false) || (builder.Write(sceneFilename) == false))
 		{
-			textureSlot = index;
-			bFound = true;
+			std::cout << "Could not compile scene file:" << filename << std::endl;
+			return(false);
 		}
-		else
-			index++;
 	}
 
-	return(textureSlot);
-}
-
-/***********************************************************
- *  FindMaterial()
- *
- *  This method is used for getting a material from the previously
- *  defined materials list that is associated with the passed in tag.
- ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
-{
-	if (m_objectMaterials.size() == 0)
+	SceneFile sceneFile;
+	if (sceneFile.Open(sceneFilename) == false)
 	{
 		return(false);
 	}
 
-	int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
+	std::vector<int> textureHandles(sceneFile.GetTextureCount(), -1);
+	for (int i = 0; i < sceneFile.GetTextureCount(); i++)
 	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
+		const SceneFile::TEXTURE_RECORD& texture = sceneFile.GetTexture(i);
+		textureHandles[i] = FindTextureSlot(texture.tag);
+		if ((textureHandles[i] < 0) && (CreateGLTexture(texture.filename, texture.tag) == true))
 		{
-			bFound = true;
-			material.ambientColor = m_objectMaterials[index].ambientColor;
-			material.ambientStrength = m_objectMaterials[index].ambientStrength;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
+			textureHandles[i] = FindTextureSlot(texture.tag);
 		}
-		else
+		if (textureHandles[i] < 0)
 		{
-			index++;
+			std::cout << "Could not load scene texture:" << texture.filename << std::endl;
 		}
 	}
 
-	return(true);
-}
+	std::vector<int> materialIndices(sceneFile.GetMaterialCount(), -1);
+	for (int i = 0; i < sceneFile.GetMaterialCount(); i++)
+	{
+		const SceneFile::MATERIAL_RECORD& record = sceneFile.GetMaterial(i);
+		OBJECT_MATERIAL material;
+		material.tag = record.tag;
+		material.ambientColor = glm::vec3(record.ambientColor[0], record.ambientColor[1], record.ambientColor[2]);
+		material.ambientStrength = record.ambientStrength;
+		material.diffuseColor = glm::vec3(record.diffuseColor[0], record.diffuseColor[1], record.diffuseColor[2]);
+		material.specularColor = glm::vec3(record.specularColor[0], record.specularColor[1], record.specularColor[2]);
+		material.shininess = record.shininess;
+		material.samplerPreset = SamplerCache::SAMPLER_TRILINEAR;
+		if ((record.samplerPreset >= 0) && (record.samplerPreset < SamplerCache::SAMPLER_PRESET_COUNT))
+		{
+			material.samplerPreset = (SamplerCache::SAMPLER_PRESET)record.samplerPreset;
+		}
 
-/***********************************************************
- *  SetTransformations()
- *
- *  This method is used for setting the transform buffer
- *  using the passed in transformation values.
- ***********************************************************/
-void SceneManager::SetTransformations(
-	glm::vec3 scaleXYZ,
-	float XrotationDegrees,
-	float YrotationDegrees,
-	float ZrotationDegrees,
-	glm::vec3 positionXYZ)
-{
-	// variables for this method
-	glm::mat4 modelView;
-	glm::mat4 scale;
-	glm::mat4 rotationX;
-	glm::mat4 rotationY;
-	glm::mat4 rotationZ;
-	glm::mat4 translation;
-
-	// set the scale value in the transform buffer
-	scale = glm::scale(scaleXYZ);
-	// set the rotation values in the transform buffer
-	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	// set the translation value in the transform buffer
-	translation = glm::translate(positionXYZ);
-
-	modelView = translation * rotationX * rotationY * rotationZ * scale;
+		materialIndices[i] = FindMaterialIndex(material.tag);
+		if (materialIndices[i] < 0)
+		{
+			materialIndices[i] = (int)m_objectMaterials.size();
+			m_objectMaterials.push_back(material);
+		}
+		else
+		{
+			m_objectMaterials[materialIndices[i]] = material;
+		}
+	}
 
-	if (NULL != m_pShaderManager)
+	// a file that places lights replaces every light of the scene
+	if (sceneFile.GetLightCount() > 0)
 	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
+		m_pLightBuffer->Clear();
+		m_benchmarkLightIDs.clear();
 	}
-}
-
-/***********************************************************
- *  SetShaderColor()
- *
- *  This method is used for setting the passed in color
- *  into the shader for the next draw command
- ***********************************************************/
-void SceneManager::SetShaderColor(
-	float redColorValue,
-	float greenColorValue,
-	float blueColorValue,
-	float alphaValue)
-{
-	// variables for this method
-	glm::vec4 currentColor;
-
-	currentColor.r = redColorValue;
-	currentColor.g = greenColorValue;
-	currentColor.b = blueColorValue;
-	currentColor.a = alphaValue;
-
-	if (NULL != m_pShaderManager)
+	for (int i = 0; i < sceneFile.GetLightCount(); i++)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
+		const SceneFile::LIGHT_RECORD& light = sceneFile.GetLight(i);
+		AddLight(
+			glm::vec3(light.position[0], light.position[1], light.position[2]),
+			glm::vec3(light.ambientColor[0], light.ambientColor[1], light.ambientColor[2]),
+			glm::vec3(light.diffuseColor[0], light.diffuseColor[1], light.diffuseColor[2]),
+			glm::vec3(light.specularColor[0], light.specularColor[1], light.specularColor[2]),
+			light.focalStrength,
+			light.specularIntensity,
+			light.range);
 	}
-}
 
-/***********************************************************
- *  SetShaderTexture()
- *
- *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
- ***********************************************************/
-void SceneManager::SetShaderTexture(
-	std::string textureTag)
-{
-	if (NULL != m_pShaderManager)
+	// the built in layout no longer applies
+	m_sceneNodes.clear();
+	// objects before the first with a material use the first material
+	FillSceneObjects(sceneFile, textureHandles, materialIndices,
+		(m_objectMaterials.empty() == true) ? -1 : 0, *m_pSceneGraph, *m_pSceneEntities);
+
+	std::chrono::duration<double, std::milli> loadTime = std::chrono::steady_clock::now() - start;
+	std::cout << "INFO: Loaded scene " << filename << " with " << sceneFile.GetObjectCount() << " objects, "
+		<< sceneFile.GetMaterialCount() << " materials and " << sceneFile.GetLightCount() << " lights in "
+		<< loadTime.count() << " ms" << std::endl;
+	if ((m_bLightBufferBound == false) && (sceneFile.GetLightCount() > MAX_UNIFORM_LIGHTS))
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
-
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
+		std::cout << "INFO: Only the first " << MAX_UNIFORM_LIGHTS << " scene lights are used" << std::endl;
 	}
+
+	return(true);
 }
 
 /***********************************************************
@@ -384,36 +2482,50 @@ void SceneManager::SetTextureUVScale(float u, float v)
 {
 	if (NULL != m_pShaderManager)
 	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
+		m_uniformCache.Set(m_uniforms.UVscale, glm::vec2(u, v));
 	}
 }
 
 /***********************************************************
  *  SetShaderMaterial()
  *
- *  This method is used for passing the material values
- *  into the shader.
+ *  This method is used for passing the values of the
+ *  material with the passed in tag into the shader, and
+ *  selecting the sampler of the material for the current
+ *  and following textures.
  ***********************************************************/
 void SceneManager::SetShaderMaterial(
 	std::string materialTag)
 {
-	if (m_objectMaterials.size() > 0)
+	SetShaderMaterial(FindMaterialIndex(materialTag));
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for passing the values of the
+ *  material at the passed in index into the shader, and
+ *  selecting its sampler for the current and following
+ *  textures.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	int materialIndex)
+{
+	if ((materialIndex < 0) || (materialIndex >= (int)m_objectMaterials.size()))
 	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
+		return;
+	}
 
+	const OBJECT_MATERIAL& material = m_objectMaterials[materialIndex];
+	m_uniformCache.Set(m_uniforms.materialAmbientColor, material.ambientColor);
+	m_uniformCache.Set(m_uniforms.materialAmbientStrength, material.ambientStrength);
+	m_uniformCache.Set(m_uniforms.materialDiffuseColor, material.diffuseColor);
+	m_uniformCache.Set(m_uniforms.materialSpecularColor, material.specularColor);
+	m_uniformCache.Set(m_uniforms.materialShininess, material.shininess);
 
-		// find the defined material that matches the tag
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
-		{
-			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
-			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
-		}
-	}
+	int samplerPreset = (m_samplerOverride >= 0) ? m_samplerOverride : (int)material.samplerPreset;
+	m_currentSampler = m_pSamplerCache->GetPresetSampler((SamplerCache::SAMPLER_PRESET)samplerPreset);
+	m_pSamplerCache->BindSampler(m_currentTextureUnit, m_currentSampler);
 }
 
 /**************************************************************/
@@ -448,6 +2560,8 @@ void SceneManager::DefineObjectMaterials()
 	material.diffuseColor = glm::vec3(1.0f, 1.0f, 1.0f);
 	material.specularColor = glm::vec3(1.0f, 1.0f, 1.0f);
 	material.shininess = 32.0f;
+	// the desk is seen at a grazing angle, so it gets anisotropic filtering
+	material.samplerPreset = SamplerCache::SAMPLER_ANISOTROPIC_16X;
 	m_objectMaterials.push_back(material);
 
 	// Define a blueish reflective material
@@ -457,6 +2571,7 @@ void SceneManager::DefineObjectMaterials()
 	material.diffuseColor = glm::vec3(0.2f, 0.2f, 0.8f);
 	material.specularColor = glm::vec3(0.5f, 0.5f, 1.0f);
 	material.shininess = 64.0f;
+	material.samplerPreset = SamplerCache::SAMPLER_TRILINEAR;
 	m_objectMaterials.push_back(material);
 
 }
@@ -465,7 +2580,8 @@ void SceneManager::DefineObjectMaterials()
  *  SetupSceneLights()
  *
  *  This method is called to add and configure the light
- *  sources for the 3D scene.  There are up to 4 light sources.
+ *  sources for the 3D scene.  Any number of lights can be
+ *  added, and they reach the shaders on the next frame.
  ***********************************************************/
 void SceneManager::SetupSceneLights()
 {
@@ -475,32 +2591,451 @@ void SceneManager::SetupSceneLights()
 	m_pShaderManager->setBoolValue(g_UseLightingName, true);
 
 	// main light source positioned to the left of the cone
-	m_pShaderManager->setVec3Value("lightSources[0].position", -5.0f, 5.0f, 5.0f); // Positioned to the left and slightly above
-	m_pShaderManager->setVec3Value("lightSources[0].ambientColor", 0.05f, 0.05f, 0.05f); // Low ambient light
-	m_pShaderManager->setVec3Value("lightSources[0].diffuseColor", 0.8f, 0.8f, 0.8f); // Bright diffuse light
-	m_pShaderManager->setVec3Value("lightSources[0].specularColor", 1.0f, 1.0f, 1.0f); // Strong specular highlight
-	m_pShaderManager->setFloatValue("lightSources[0].focalStrength", 32.0f);
-	m_pShaderManager->setFloatValue("lightSources[0].specularIntensity", 0.5f);
+	AddLight(
+		glm::vec3(-5.0f, 5.0f, 5.0f),     // Positioned to the left and slightly above
+		glm::vec3(0.05f, 0.05f, 0.05f),   // Low ambient light
+		glm::vec3(0.8f, 0.8f, 0.8f),      // Bright diffuse light
+		glm::vec3(1.0f, 1.0f, 1.0f),      // Strong specular highlight
+		32.0f,
+		0.5f);
 
 	// Add a secondary light source to ensure the rest of the scene remains darker
-	m_pShaderManager->setVec3Value("lightSources[1].position", 0.0f, -3.0f, -5.0f); // Positioned below and to the back
-	m_pShaderManager->setVec3Value("lightSources[1].ambientColor", 0.01f, 0.01f, 0.01f); // Minimal ambient contribution
-	m_pShaderManager->setVec3Value("lightSources[1].diffuseColor", 0.2f, 0.2f, 0.2f); // Subtle diffuse light
-	m_pShaderManager->setVec3Value("lightSources[1].specularColor", 0.0f, 0.0f, 0.0f); // No specular highlight
-	m_pShaderManager->setFloatValue("lightSources[1].focalStrength", 16.0f);
-	m_pShaderManager->setFloatValue("lightSources[1].specularIntensity", 0.0f);
+	AddLight(
+		glm::vec3(0.0f, -3.0f, -5.0f),    // Positioned below and to the back
+		glm::vec3(0.01f, 0.01f, 0.01f),   // Minimal ambient contribution
+		glm::vec3(0.2f, 0.2f, 0.2f),      // Subtle diffuse light
+		glm::vec3(0.0f, 0.0f, 0.0f),      // No specular highlight
+		16.0f,
+		0.0f);
 
 	// Added an overhead light for subtle illumination of the top surfaces
-	m_pShaderManager->setVec3Value("lightSources[2].position", 0.0f, 8.0f, 0.0f); // Positioned overhead
-	m_pShaderManager->setVec3Value("lightSources[2].ambientColor", 0.03f, 0.03f, 0.03f); // Very low ambient light
-	m_pShaderManager->setVec3Value("lightSources[2].diffuseColor", 0.3f, 0.3f, 0.3f); // Moderate diffuse light
-	m_pShaderManager->setVec3Value("lightSources[2].specularColor", 0.2f, 0.2f, 0.2f); // Weak specular highlight
-	m_pShaderManager->setFloatValue("lightSources[2].focalStrength", 8.0f);
-	m_pShaderManager->setFloatValue("lightSources[2].specularIntensity", 0.1f);
+	AddLight(
+		glm::vec3(0.0f, 8.0f, 0.0f),      // Positioned overhead
+		glm::vec3(0.03f, 0.03f, 0.03f),   // Very low ambient light
+		glm::vec3(0.3f, 0.3f, 0.3f),      // Moderate diffuse light
+		glm::vec3(0.2f, 0.2f, 0.2f),      // Weak specular highlight
+		8.0f,
+		0.1f);
+
+}
+
+
+
+/***********************************************************
+ *  BuildSceneGraph()
+ *
+ *  This method is used for adding the scene objects to the
+ *  scene graph.  Each part is placed relative to what it
+ *  sits on, so moving the desk carries everything on it,
+ *  moving the pencil cup carries the pencils, and moving
+ *  the mug carries its handle.  The positions work out to
+ *  the same places the objects were drawn at before.
+ ***********************************************************/
+void SceneManager::BuildSceneGraph()
+{
+	SceneGraph& graph = *m_pSceneGraph;
+
+	m_sceneNodes.assign(SCENE_NODE_COUNT, -1);
+
+	// the desk surface carries everything else
+	m_sceneNodes[DESK_NODE] = graph.AddNode(-1,
+		glm::vec3(20.0f, 1.0f, 10.0f), 0.0f, 0.0f, 0.0f, glm::vec3(0.0f, 0.0f, 0.0f));
+	int desk = m_sceneNodes[DESK_NODE];
+
+	// the screen sits on the front of the monitor body
+	m_sceneNodes[MONITOR_NODE] = graph.AddNode(desk,
+		glm::vec3(10.5f, 9.0f, 1.0f), 0.0f, 0.0f, 0.0f, glm::vec3(0.0f, 4.5f, -2.2f));
+	m_sceneNodes[MONITOR_SCREEN_NODE] = graph.AddNode(m_sceneNodes[MONITOR_NODE],
+		glm::vec3(10.0f, 7.0f, 1.0f), 0.0f, 0.0f, 0.0f, glm::vec3(0.0f, 0.5f, 0.2f));
+
+	m_sceneNodes[KEYBOARD_NODE] = graph.AddNode(desk,
+		glm::vec3(8.0f, 0.2f, 2.5f), 0.0f, 0.0f, 0.0f, glm::vec3(0.0f, 0.1f, 0.0f));
+	m_sceneNodes[MOUSE_NODE] = graph.AddNode(desk,
+		glm::vec3(1.0f, 0.2f, 1.0f), 0.0f, 0.0f, 0.0f, glm::vec3(5.0f, 0.1f, 0.0f));
+
+	// the pencils stand in a row across the cup
+	m_sceneNodes[PENCIL_CUP_NODE] = graph.AddNode(desk,
+		glm::vec3(1.0f, 2.0f, 1.0f), 0.0f, 0.0f, 0.0f, glm::vec3(8.0f, 0.1f, 0.0f));
+	for (int i = 0; i < PENCIL_COUNT; i++)
+	{
+		m_sceneNodes[FIRST_PENCIL_NODE + i] = graph.AddNode(m_sceneNodes[PENCIL_CUP_NODE],
+			glm::vec3(0.1f, 2.0f, 0.1f), 0.0f, 0.0f, 0.0f, glm::vec3(-0.5f + 0.25f * i, 0.9f, 0.0f));
+	}
+
+	// each notebook lies on the one below it
+	m_sceneNodes[NOTEBOOK1_NODE] = graph.AddNode(desk,
+		glm::vec3(2.0f, 0.3f, 3.0f), 0.0f, 0.0f, 0.0f, glm::vec3(-8.0f, 0.15f, 0.0f));
+	m_sceneNodes[NOTEBOOK2_NODE] = graph.AddNode(m_sceneNodes[NOTEBOOK1_NODE],
+		glm::vec3(2.0f, 0.3f, 2.5f), 0.0f, 0.0f, 0.0f, glm::vec3(0.0f, 0.3f, 0.0f));
+	m_sceneNodes[NOTEBOOK3_NODE] = graph.AddNode(m_sceneNodes[NOTEBOOK2_NODE],
+		glm::vec3(2.0f, 0.3f, 2.0f), 0.0f, 0.0f, 0.0f, glm::vec3(0.0f, 0.3f, 0.0f));
+
+	m_sceneNodes[MUG_NODE] = graph.AddNode(desk,
+		glm::vec3(0.5f, 1.5f, 1.5f), 0.0f, 0.0f, 0.0f, glm::vec3(-5.0f, 0.1f, 0.0f));
+	m_sceneNodes[MUG_HANDLE_NODE] = graph.AddNode(m_sceneNodes[MUG_NODE],
+		glm::vec3(0.5f, 0.5f, 0.5f), 0.0f, 0.0f, 0.0f, glm::vec3(0.5f, 0.5f, 0.0f));
+}
+
+/***********************************************************
+ *  BuildSceneEntities()
+ *
+ *  This method is used for adding a scene entity for each
+ *  object drawn, pairing its scene graph node with its
+ *  mesh, texture, material, color and texture UV scale.
+ *  The monitor body is the only object drawn with a flat
+ *  color.  The colors of the textured objects are kept for
+ *  when their textures are turned off.  Every entity gets a
+ *  material of its own, since the sorted draws cannot rely
+ *  on the one set by the entity added before.
+ ***********************************************************/
+void SceneManager::BuildSceneEntities()
+{
+	int shinyWhite = FindMaterialIndex("shinyWhite");
+	if ((shinyWhite < 0) && (m_objectMaterials.empty() == false))
+	{
+		shinyWhite = 0;
+	}
+	const glm::vec4 white(1.0f, 1.0f, 1.0f, 1.0f);
+	const glm::vec2 UVscale(1.0f, 1.0f);
+	SceneEntities& entities = *m_pSceneEntities;
+
+	entities.Clear();
+	entities.Reserve(SCENE_NODE_COUNT);
+
+	entities.AddEntity(m_sceneNodes[DESK_NODE], SceneMeshes::MESH_PLANE,
+		m_sceneTextureHandles[DESK_TEXTURE], shinyWhite, glm::vec4(0.8f, 0.8f, 0.8f, 1.0f), UVscale);
+	entities.AddEntity(m_sceneNodes[MONITOR_SCREEN_NODE], SceneMeshes::MESH_BOX,
+		m_sceneTextureHandles[MONITOR_TEXTURE], shinyWhite, glm::vec4(0.5f, 0.5f, 0.5f, 1.0f), UVscale);
+	entities.AddEntity(m_sceneNodes[MONITOR_NODE], SceneMeshes::MESH_BOX,
+		-1, shinyWhite, glm::vec4(0.5f, 0.5f, 0.5f, 1.0f), UVscale);
+	entities.AddEntity(m_sceneNodes[KEYBOARD_NODE], SceneMeshes::MESH_BOX,
+		m_sceneTextureHandles[KEYBOARD_TEXTURE], shinyWhite, glm::vec4(0.1f, 0.1f, 0.1f, 1.0f), UVscale);
+	entities.AddEntity(m_sceneNodes[MOUSE_NODE], SceneMeshes::MESH_BOX,
+		m_sceneTextureHandles[MOUSE_TEXTURE], shinyWhite, glm::vec4(0.1f, 0.1f, 0.1f, 1.0f), UVscale);
+	entities.AddEntity(m_sceneNodes[PENCIL_CUP_NODE], SceneMeshes::MESH_CYLINDER,
+		m_sceneTextureHandles[PENCILCUP_TEXTURE], shinyWhite, glm::vec4(0.1f, 0.1f, 0.1f, 1.0f), UVscale);
+	for (int i = 0; i < PENCIL_COUNT; i++)
+	{
+		entities.AddEntity(m_sceneNodes[FIRST_PENCIL_NODE + i], SceneMeshes::MESH_CYLINDER,
+			m_sceneTextureHandles[PENCIL_TEXTURE], shinyWhite, glm::vec4(0.1f, 0.1f, 0.1f, 1.0f), UVscale);
+	}
+	entities.AddEntity(m_sceneNodes[NOTEBOOK1_NODE], SceneMeshes::MESH_BOX,
+		m_sceneTextureHandles[BOOK1_TEXTURE], shinyWhite, glm::vec4(0.5f, 1.0f, 1.0f, 1.0f), UVscale);
+	entities.AddEntity(m_sceneNodes[NOTEBOOK2_NODE], SceneMeshes::MESH_BOX,
+		m_sceneTextureHandles[BOOK2_TEXTURE], shinyWhite, glm::vec4(0.0f, 0.8f, 0.0f, 1.0f), UVscale);
+	entities.AddEntity(m_sceneNodes[NOTEBOOK3_NODE], SceneMeshes::MESH_BOX,
+		m_sceneTextureHandles[BOOK3_TEXTURE], shinyWhite, glm::vec4(0.8f, 0.0f, 0.8f, 1.0f), UVscale);
+	entities.AddEntity(m_sceneNodes[MUG_NODE], SceneMeshes::MESH_CYLINDER,
+		m_sceneTextureHandles[CUP_TEXTURE], shinyWhite, glm::vec4(0.2f, 0.2f, 0.2f, 1.0f), UVscale);
+	entities.AddEntity(m_sceneNodes[MUG_HANDLE_NODE], SceneMeshes::MESH_CYLINDER,
+		m_sceneTextureHandles[CUP_TEXTURE], shinyWhite, glm::vec4(0.2f, 0.2f, 0.2f, 1.0f), UVscale);
+}
+
+/***********************************************************
+ *  DrawSceneEntities()
+ *
+ *  This method is used for drawing every scene entity.  The
+ *  entities go through the render queue each frame, which
+ *  orders them by mesh, texture and material, and each of
+ *  those states, along with the color and texture UV scale,
+ *  is only set when it differs from the entity drawn before.
+ *  Entities without a texture are drawn with their color.
+ *  Every entity has a material unless the scene has none,
+ *  so the draw order does not change what is drawn.
+ *  With instancing on, a run of sorted entities sharing the
+ *  baked mesh, texture, material and texture UV scale is
+ *  drawn with one instanced draw, each instance carrying
+ *  its own matrices and color.  With indirect draws on, the
+ *  sorted entities go out in multi-draw-indirect calls.
+ ***********************************************************/
+void SceneManager::DrawSceneEntities()
+{
+	const int entityCount = m_pSceneEntities->GetCount();
+	const std::vector<int>& nodes = m_pSceneEntities->GetNodes();
+	const std::vector<int>& meshes = m_pSceneEntities->GetMeshes();
+	const std::vector<int>& textures = m_pSceneEntities->GetTextures();
+	const std::vector<int>& materials = m_pSceneEntities->GetMaterials();
+	const std::vector<glm::vec4>& colors = m_pSceneEntities->GetColors();
+	const std::vector<glm::vec2>& UVscales = m_pSceneEntities->GetUVScales();
+
+	// every entity is drawn with the one shader program
+	m_pRenderQueue->Clear();
+	for (int i = 0; i < entityCount; i++)
+	{
+		m_pRenderQueue->AddPacket(RenderQueue::MakeSortKey(RenderQueue::PASS_OPAQUE, 0,
+			meshes[i], textures[i], materials[i]), i);
+	}
+	m_pRenderQueue->Sort();
+
+	if (NULL != m_pIndirectDraws)
+	{
+		DrawEntitiesIndirect();
+		return;
+	}
+
+	const std::vector<RenderQueue::DRAW_PACKET>& packets = m_pRenderQueue->GetPackets();
+	int currentMaterial = -1;
+	// -1 is a valid texture, the color, so nothing is set yet at -2
+	int currentTexture = -2;
+	bool bShapesBound = false;
+	bool bColorSet = false;
+	bool bUVScaleSet = false;
+	glm::vec4 currentColor;
+	glm::vec2 currentUVscale;
+
+	m_drawCallCount = 0;
+	size_t runEnd = 0;
+	for (size_t p = 0; p < packets.size(); p = runEnd)
+	{
+		const int i = packets[p].item;
+
+		// the packets are sorted, so instancable draws sit together
+		runEnd = p + 1;
+		if ((m_bUseInstancing == true) && (m_pSceneMeshes->IsLoaded((SceneMeshes::MESH_SHAPE)meshes[i]) == true))
+		{
+			while ((runEnd < packets.size()) &&
+				(meshes[packets[runEnd].item] == meshes[i]) &&
+				(textures[packets[runEnd].item] == textures[i]) &&
+				(materials[packets[runEnd].item] == materials[i]) &&
+				(UVscales[packets[runEnd].item] == UVscales[i]))
+			{
+				runEnd++;
+			}
+		}
+
+		// placed first, so the texture sees where the object is
+		SetNodeTransformations(nodes[i]);
+		if ((materials[i] >= 0) && (materials[i] != currentMaterial))
+		{
+			SetShaderMaterial(materials[i]);
+			currentMaterial = materials[i];
+		}
+		if (textures[i] != currentTexture)
+		{
+			if (textures[i] >= 0)
+			{
+				SetShaderTexture(textures[i]);
+			}
+			currentTexture = textures[i];
+			bColorSet = false;
+		}
+		else if ((textures[i] >= 0) && (textures[i] < (int)m_textureIDs.size()) &&
+			(m_textureIDs[textures[i]].target == GL_TEXTURE_2D))
+		{
+			MarkTextureUsed(textures[i]);
+		}
+		if ((textures[i] < 0) && ((bColorSet == false) || (colors[i] != currentColor)))
+		{
+			SetShaderColor(colors[i].r, colors[i].g, colors[i].b, colors[i].a);
+			currentColor = colors[i];
+			bColorSet = true;
+		}
+		if ((bUVScaleSet == false) || (UVscales[i] != currentUVscale))
+		{
+			SetTextureUVScale(UVscales[i].x, UVscales[i].y);
+			currentUVscale = UVscales[i];
+			bUVScaleSet = true;
+		}
+
+		SceneMeshes::MESH_SHAPE shape = (SceneMeshes::MESH_SHAPE)meshes[i];
+		m_drawCallCount++;
+		if (runEnd - p > 1)
+		{
+			DrawEntityInstances(p, runEnd);
+			bShapesBound = false;
+		}
+		// the baked shapes share one vertex array, so it is bound once
+		else if (m_pSceneMeshes->IsLoaded(shape) == true)
+		{
+			if (bShapesBound == false)
+			{
+				m_pSceneMeshes->BindShapes();
+				bShapesBound = true;
+			}
+			m_pSceneMeshes->DrawBoundShape(shape);
+		}
+		else
+		{
+			DrawShapeMesh(shape);
+			bShapesBound = false;
+		}
+	}
+	if (bShapesBound == true)
+	{
+		SceneMeshes::UnbindShapes();
+	}
+}
+
+/***********************************************************
+ *  DrawEntityInstances()
+ *
+ *  This method is used for drawing a run of sorted packets
+ *  that share their mesh, texture, material and texture UV
+ *  scale with one instanced draw, from the first packet up
+ *  to but not including the end one.  The shared states must
+ *  already be set.  Every instance after the first marks
+ *  its texture used from its own position, as a separate
+ *  draw of it would have.
+ ***********************************************************/
+void SceneManager::DrawEntityInstances(size_t first, size_t end)
+{
+	const std::vector<RenderQueue::DRAW_PACKET>& packets = m_pRenderQueue->GetPackets();
+	const std::vector<int>& nodes = m_pSceneEntities->GetNodes();
+	const std::vector<int>& textures = m_pSceneEntities->GetTextures();
+	const std::vector<glm::vec4>& colors = m_pSceneEntities->GetColors();
+	const int texture = textures[packets[first].item];
+	const bool bTextured2D = (texture >= 0) && (texture < (int)m_textureIDs.size()) &&
+		(m_textureIDs[texture].target == GL_TEXTURE_2D);
+	const float textureLayer = ((texture >= 0) && (texture < (int)m_textureIDs.size())) ?
+		(float)m_textureIDs[texture].layer : 0.0f;
+
+	m_instances.resize(end - first);
+	for (size_t p = first; p < end; p++)
+	{
+		const int i = packets[p].item;
+		SceneMeshes::INSTANCE_DATA& instance = m_instances[p - first];
+		instance.modelMatrix = m_pSceneGraph->GetModelMatrix(nodes[i]);
+		instance.normalMatrix = m_pSceneGraph->GetNormalMatrix(nodes[i]);
+		instance.color = colors[i];
+		instance.textureLayer = textureLayer;
+
+		if ((p > first) && (bTextured2D == true))
+		{
+			SetLastObjectNode(nodes[i]);
+			MarkTextureUsed(texture);
+		}
+	}
 
+	if (NULL != m_pShaderManager)
+	{
+		m_uniformCache.Set(m_uniforms.bUseInstancing, true);
+	}
+	m_pSceneMeshes->DrawShapeInstanced((SceneMeshes::MESH_SHAPE)m_pSceneEntities->GetMeshes()[packets[first].item],
+		&m_instances[0], (int)m_instances.size());
+	if (NULL != m_pShaderManager)
+	{
+		m_uniformCache.Set(m_uniforms.bUseInstancing, false);
+	}
 }
 
+/***********************************************************
+ *  DrawEntitiesIndirect()
+ *
+ *  This method is used for drawing the sorted scene entities
+ *  with multi-draw-indirect calls.  The values of every draw,
+ *  its matrices, color, material and texture settings, are
+ *  written to the draw values buffer, which the shaders read
+ *  in place of the uniforms.  Only the texture binding and
+ *  its sampler cannot change within a call, so a new call is
+ *  started when a draw samples a different texture object
+ *  or sampler.  With packed textures the whole scene shares
+ *  a few texture arrays, and goes out in as many calls.
+ ***********************************************************/
+void SceneManager::DrawEntitiesIndirect()
+{
+	const std::vector<RenderQueue::DRAW_PACKET>& packets = m_pRenderQueue->GetPackets();
+	const std::vector<int>& nodes = m_pSceneEntities->GetNodes();
+	const std::vector<int>& meshes = m_pSceneEntities->GetMeshes();
+	const std::vector<int>& textures = m_pSceneEntities->GetTextures();
+	const std::vector<int>& materials = m_pSceneEntities->GetMaterials();
+	const std::vector<glm::vec4>& colors = m_pSceneEntities->GetColors();
+	const std::vector<glm::vec2>& UVscales = m_pSceneEntities->GetUVScales();
+	int currentMaterial = -1;
+
+	m_pIndirectDraws->Clear();
+	m_indirectCalls.clear();
+	for (size_t p = 0; p < packets.size(); p++)
+	{
+		const int i = packets[p].item;
+		const int texture = textures[i];
+		const bool bTextured = (texture >= 0) && (texture < (int)m_textureIDs.size());
+		IndirectDrawBatch::DRAW_DATA drawData;
+
+		// entities only lack a material when the scene has none
+		if ((materials[i] >= 0) && (materials[i] < (int)m_objectMaterials.size()))
+		{
+			currentMaterial = materials[i];
+		}
+		int samplerPreset = m_samplerOverride;
+		if ((samplerPreset < 0) && (currentMaterial >= 0))
+		{
+			samplerPreset = (int)m_objectMaterials[currentMaterial].samplerPreset;
+		}
+
+		// a textured draw joins the call when it binds the same texture
+		// object and sampler, and draws with the color join any call
+		if ((bTextured == true) && (m_indirectCalls.empty() == false) && (m_indirectCalls.back().texture >= 0) &&
+			((m_textureIDs[m_indirectCalls.back().texture].ID != m_textureIDs[texture].ID) ||
+			(m_indirectCalls.back().samplerPreset != samplerPreset)))
+		{
+			INDIRECT_CALL call = { m_pIndirectDraws->GetCount(), -1, -1, -1 };
+			m_indirectCalls.push_back(call);
+		}
+		else if (m_indirectCalls.empty() == true)
+		{
+			INDIRECT_CALL call = { m_pIndirectDraws->GetCount(), -1, -1, -1 };
+			m_indirectCalls.push_back(call);
+		}
+		if ((bTextured == true) && (m_indirectCalls.back().texture < 0))
+		{
+			m_indirectCalls.back().texture = texture;
+			m_indirectCalls.back().material = currentMaterial;
+			m_indirectCalls.back().samplerPreset = samplerPreset;
+		}
+
+		SetLastObjectNode(nodes[i]);
+		if ((bTextured == true) && (m_textureIDs[texture].target == GL_TEXTURE_2D))
+		{
+			MarkTextureUsed(texture);
+		}
+
+		drawData.modelMatrix = m_pSceneGraph->GetModelMatrix(nodes[i]);
+		drawData.normalMatrix = m_pSceneGraph->GetNormalMatrix(nodes[i]);
+		drawData.color = colors[i];
+		drawData.textureRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+		drawData.textureLayer = 0;
+		drawData.bUseTexture = (bTextured == true) ? 1 : 0;
+		if ((bTextured == true) && (m_textureIDs[texture].target == GL_TEXTURE_2D_ARRAY))
+		{
+			drawData.textureRect = m_textureIDs[texture].uvRect;
+			drawData.textureLayer = m_textureIDs[texture].layer;
+		}
+		drawData.ambientColor = glm::vec4(0.0f);
+		drawData.diffuseColor = glm::vec4(0.0f);
+		drawData.specularColor = glm::vec4(0.0f);
+		if (currentMaterial >= 0)
+		{
+			const OBJECT_MATERIAL& material = m_objectMaterials[currentMaterial];
+			drawData.ambientColor = glm::vec4(material.ambientColor, material.ambientStrength);
+			drawData.diffuseColor = glm::vec4(material.diffuseColor, 0.0f);
+			drawData.specularColor = glm::vec4(material.specularColor, material.shininess);
+		}
+		drawData.UVscale = UVscales[i];
+
+		m_pIndirectDraws->AddDraw((SceneMeshes::MESH_SHAPE)meshes[i], drawData);
+	}
+
+	// every value is written with one copy before the first call
+	m_pIndirectDraws->UploadDraws();
+	m_drawCallCount = (int)m_indirectCalls.size();
+	m_uniformCache.Set(m_uniforms.bUseIndirectDraws, true);
+	for (size_t c = 0; c < m_indirectCalls.size(); c++)
+	{
+		const INDIRECT_CALL& call = m_indirectCalls[c];
+		int endDraw = (c + 1 < m_indirectCalls.size()) ? m_indirectCalls[c + 1].firstDraw : m_pIndirectDraws->GetCount();
 
+		if (call.texture >= 0)
+		{
+			// the material selects the sampler bound with the texture
+			SetShaderMaterial(call.material);
+			SetShaderTexture(call.texture);
+		}
+		m_uniformCache.Set(m_uniforms.firstDrawData, call.firstDraw);
+		m_pIndirectDraws->Draw(call.firstDraw, endDraw - call.firstDraw);
+	}
+	IndirectDrawBatch::EndDraws();
+	m_uniformCache.Set(m_uniforms.bUseIndirectDraws, false);
+}
 
 /***********************************************************
  *  PrepareScene()
@@ -517,12 +3052,58 @@ void SceneManager::PrepareScene()
 	DefineObjectMaterials();
 	// add and define the light sources for the scene
 	SetupSceneLights();
+	// place the objects relative to what they sit on
+	BuildSceneGraph();
+	// pair each placed object with what it is drawn with
+	BuildSceneEntities();
+
+	// every shape goes into the shared buffers of the scene meshes,
+	// from the asset pack when it has them, or built the same way
+	for (int i = 0; i < SceneMeshes::MESH_SHAPE_COUNT; i++)
+	{
+		SceneMeshes::MESH_SHAPE shape = (SceneMeshes::MESH_SHAPE)i;
+		AssetPack::MESH_DATA mesh;
+		std::vector<float> vertices;
+		std::vector<uint32_t> indices;
+		bool bPackedMesh = (NULL != m_pAssetPack) &&
+			(m_pAssetPack->GetMesh(SceneMeshes::GetShapeName(shape), mesh) == true) &&
+			(mesh.floatsPerVertex == SceneMeshes::FLOATS_PER_VERTEX);
+		if (bPackedMesh == false)
+		{
+			SceneMeshes::BuildShape(shape, vertices, indices);
+			mesh.vertices = &vertices[0];
+			mesh.vertexCount = (int)(vertices.size() / SceneMeshes::FLOATS_PER_VERTEX);
+			mesh.indices = &indices[0];
+			mesh.indexCount = (int)indices.size();
+		}
+
+		m_pSceneMeshes->LoadShape(shape, mesh.vertices, mesh.vertexCount, mesh.indices, mesh.indexCount);
+	}
+
+	// the shaders only read the draw values when the driver built them with the extensions
+	if ((m_bUseIndirectDraws == true) && (IndirectDrawBatch::IsSupported() == false))
+	{
+		std::cout << "INFO: Multi-draw-indirect is not supported, drawing each object on its own" << std::endl;
+	}
+	else if ((m_bUseIndirectDraws == true) && (IndirectDrawBatch::BindProgram(m_programID) == false))
+	{
+		std::cout << "INFO: The shaders cannot read indirect draw values, drawing each object on its own" << std::endl;
+	}
+	else if (m_bUseIndirectDraws == true)
+	{
+		m_pIndirectDraws = new IndirectDrawBatch(m_pSceneMeshes, m_pResourceTracker);
+	}
 
 	// Load meshes for basic shapes (boxes, cylinders, planes, etc.)
-	m_basicMeshes->LoadPlaneMesh();    // For the desk surface
-	m_basicMeshes->LoadBoxMesh();      // For the keyboard, mouse, and stack of notebooks
-	m_basicMeshes->LoadCylinderMesh(); // For the pencil cup and mug
-	m_basicMeshes->LoadSphereMesh();   // For any rounded shapes, like parts of the mug
+	// when a shape could not be put into the shared buffers
+	if (m_pSceneMeshes->IsLoaded(SceneMeshes::MESH_PLANE) == false)
+		m_basicMeshes->LoadPlaneMesh();    // For the desk surface
+	if (m_pSceneMeshes->IsLoaded(SceneMeshes::MESH_BOX) == false)
+		m_basicMeshes->LoadBoxMesh();      // For the keyboard, mouse, and stack of notebooks
+	if (m_pSceneMeshes->IsLoaded(SceneMeshes::MESH_CYLINDER) == false)
+		m_basicMeshes->LoadCylinderMesh(); // For the pencil cup and mug
+	if (m_pSceneMeshes->IsLoaded(SceneMeshes::MESH_SPHERE) == false)
+		m_basicMeshes->LoadSphereMesh();   // For any rounded shapes, like parts of the mug
 
 }
 
@@ -539,138 +3120,18 @@ void SceneManager::PrepareScene()
  ***********************************************************/
 void SceneManager::RenderScene()
 {
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-	// Render the desk (large plane as the surface of the desk)
-	scaleXYZ = glm::vec3(20.0f, 1.0f, 10.0f); // Desk dimensions
-	positionXYZ = glm::vec3(0.0f, 0.0f, 0.0f); // Position it slightly below the center
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-
-	// SetShaderColor(0.8f, 0.8f, 0.8f, 1.0f); // Desk surface color (light gray)
-	SetShaderTexture("desk"); // Set texture color
-	SetTextureUVScale(1.0, 1.0); // Set texture scale
-
-	SetShaderMaterial("shinyWhite"); // Assign shiny white material
-
-	m_basicMeshes->DrawPlaneMesh(); // Draw desk surface
-
-	// Render the monitor (Screen for the monitor)
-	scaleXYZ = glm::vec3(10.0f, 7.0f, 1.0f); // Monitor dimensions (wide screen)
-	positionXYZ = glm::vec3(0.0f, 5.0f, -2.0f); // Position it at the center of the desk
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.5f, 0.5f, 0.5f, 1.0f); // Monitor color (gray)
-	SetShaderTexture("monitor"); // Set texture color
-	SetTextureUVScale(1.0, 1.0); // Set texture scale
-
-	m_basicMeshes->DrawBoxMesh(); // Draw monitor
-
-	// Render the monitor (Box for the monitor)
-	scaleXYZ = glm::vec3(10.5f, 9.0f, 1.0f); // Monitor dimensions (wide screen)
-	positionXYZ = glm::vec3(0.0f, 4.5f, -2.2f); // Position it at the center of the desk
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.5f, 0.5f, 0.5f, 1.0f); // Monitor color (gray)
-
-	m_basicMeshes->DrawBoxMesh(); // Draw monitor
-
-	// Render the keyboard (Box for the keyboard)
-	scaleXYZ = glm::vec3(8.0f, 0.2f, 2.5f); // Keyboard dimensions
-	positionXYZ = glm::vec3(0.0f, 0.1f, 0.0f); // Position it just in front of the monitor
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Keyboard color (dark gray/black)
-	SetShaderTexture("keyboard"); // Set texture color
-	SetTextureUVScale(1.0, 1.0); // Set texture scale
-
-	m_basicMeshes->DrawBoxMesh(); // Draw keyboard
-
-	// Render the mouse (Small box for the mouse)
-	scaleXYZ = glm::vec3(1.0f, 0.2f, 1.0f); // Mouse dimensions
-	positionXYZ = glm::vec3(5.0f, 0.1f, 0.0f); // Position it beside the keyboard
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Mouse color (dark gray/black)
-	SetShaderTexture("mouse"); // Set texture color
-	SetTextureUVScale(1.0, 1.0); // Set texture scale
-
-	m_basicMeshes->DrawBoxMesh(); // Draw mouse
-
-	// Render the pencil cup (Cylinder)
-	scaleXYZ = glm::vec3(1.0f, 2.0f, 1.0f); // Pencil cup size
-	positionXYZ = glm::vec3(8.0f, 0.1f, 0.0f); // Position to the right of the monitor
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Pencil cup color (black)
-	SetShaderTexture("pencilcup"); // Set texture color
-	SetTextureUVScale(1.0, 1.0); // Set texture scale
-
-	m_basicMeshes->DrawCylinderMesh(); // Draw pencil cup
-
-	// Render the pencils (thin cylinders)
-	scaleXYZ = glm::vec3(0.1f, 2.0f, 0.1f); // Pencil dimensions
-	positionXYZ = glm::vec3(7.5f, 1.0f, 0.0f); // Position each pencil in the cup
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Pencil color (black)
-	SetShaderTexture("pencil"); // Set texture color
-	SetTextureUVScale(1.0, 1.0); // Set texture scale
-
-	m_basicMeshes->DrawCylinderMesh(); // Draw one pencil
-	// Duplicate the cylinder to draw remaining pencils
-	for (int i = 1; i < 6; ++i)
-	{
-		positionXYZ.x += 0.25f; // Offset each pencil a bit
-		SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-		m_basicMeshes->DrawCylinderMesh(); // Draw next pencil
-	}
-
-	// Render the stack of notebooks (Boxes)
-	float notebookWidth = 2.0f;
-	scaleXYZ = glm::vec3(notebookWidth, 0.3f, 3.0f); // Notebook dimensions
-	positionXYZ = glm::vec3(-8.0f, 0.15f, 0.0f); // Position stack of notebooks to the left of the monitor
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.5f, 1.0f, 1.0f, 1.0f); // Notebook color (Cyan)
-	SetShaderTexture("book1"); // Set texture color
-	SetTextureUVScale(1.0, 1.0); // Set texture scale
-
-	m_basicMeshes->DrawBoxMesh(); // Draw first notebook (largest)
-
-	scaleXYZ = glm::vec3(notebookWidth, 0.3f, 2.5f); // Slightly smaller notebook
-	positionXYZ.y += 0.3f; // Offset to stack the next notebook on top
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.0f, 0.8f, 0.0f, 1.0f); // Notebook color (Green)
-	SetShaderTexture("book2"); // Set texture color
-	SetTextureUVScale(1.0, 1.0); // Set texture scale
-
-	m_basicMeshes->DrawBoxMesh(); // Draw second notebook
-
-	scaleXYZ = glm::vec3(notebookWidth, 0.3f, 2.0f); // Smallest notebook
-	positionXYZ.y += 0.3f; // Offset to stack the next notebook on top
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.8f, 0.0f, 0.8f, 1.0f); // Notebook color (pink)
-	SetShaderTexture("book3"); // Set texture color
-	SetTextureUVScale(1.0, 1.0); // Set texture scale
-
-	m_basicMeshes->DrawBoxMesh(); // Draw third notebook
-
-	// Render the mug (Cylinder for the body and a small cone for the handle)
-	scaleXYZ = glm::vec3(0.5f, 1.5f, 1.5f); // Mug dimensions (wider base)
-	positionXYZ = glm::vec3(-5.0f, 0.1f, 0.0f); // Position it close to the monitor
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.2f, 0.2f, 0.2f, 1.0f); // Mug color (dark gray)
-	SetShaderTexture("cup"); // Set texture color
-	SetTextureUVScale(1.0, 1.0); // Set texture scale
-
-	m_basicMeshes->DrawCylinderMesh(); // Draw mug body
-
-
-	// Draw the mug handle (small cone or cylinder)
-	scaleXYZ = glm::vec3(0.5f, 0.5f, 0.5f); // Handle dimensions
-	positionXYZ = glm::vec3(-4.5f, 0.6f, 0.0f); // Position it on the side of the mug
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	//SetShaderColor(0.2f, 0.2f, 0.2f, 1.0f); // Handle color (gray)
-	SetShaderTexture("cup"); // Set texture color
-	SetTextureUVScale(1.0, 1.0); // Set texture scale
-
-	m_basicMeshes->DrawCylinderMesh(); // Draw handle
-
+	// count the uniform writes of this frame alone
+	m_uniformCache.ResetCounts();
+	// write the lights added, changed or removed since the last frame,
+	// and bin them for the view
+	bool bLightsChanged = m_pLightBuffer->HasChanges();
+	UploadSceneLights();
+	UpdateLightClusters(bLightsChanged);
+	// objects pick up their cached matrices in draw order
+	m_pTransformCache->BeginFrame();
+	// bring the nodes that moved, and the nodes on them, up to date
+	m_pSceneGraph->Update();
+
+	// draw every entity from its packed components
+	DrawSceneEntities();
 }
@@ -10,9 +10,30 @@
 #pragma once
 
 #include "ShaderManager.h"
+#include "SamplerCache.h"
+#include "SceneMeshes.h"
 #include "ShapeMeshes.h"
+#include "TextureCompressor.h"
+#include "TextureDecodePool.h"
+#include "UniformCache.h"
 
+class AssetPack;
+class AssetReader;
+class GLResourceTracker;
+class IndirectDrawBatch;
+class LightBuffer;
+class LightClusters;
+class RenderQueue;
+class SceneEntities;
+class SceneGraph;
+class TextureCache;
+class TextureResidency;
+class TextureStreamer;
+class TransformCache;
+
+#include <chrono>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 /***********************************************************
@@ -33,6 +54,13 @@ public:
 	{
 		std::string tag;
 		uint32_t ID;
+		// GL_TEXTURE_2D, or GL_TEXTURE_2D_ARRAY for packed textures
+		uint32_t target;
+		// array layer and atlas rectangle of a packed texture
+		int layer;
+		glm::vec4 uvRect;
+		// texture unit the texture is bound to, -1 for a spare unit
+		int unit;
 	};
 
 	struct OBJECT_MATERIAL
@@ -43,6 +71,8 @@ public:
 		glm::vec3 specularColor;
 		float shininess;
 		std::string tag;
+		// texture filtering used while the material is set
+		SamplerCache::SAMPLER_PRESET samplerPreset;
 	};
 
 private:
@@ -50,24 +80,179 @@ private:
 	ShaderManager* m_pShaderManager;
 	// pointer to basic shapes object
 	ShapeMeshes* m_basicMeshes;
-	// total number of loaded textures
-	int m_loadedTextures;
-	// loaded textures info
-	TEXTURE_INFO m_textureIDs[16];
+	// optional pack of pre-decoded textures, baked meshes and shaders
+	const AssetPack* m_pAssetPack;
+	// meshes loaded from the asset pack, drawn instead of the basic shapes
+	SceneMeshes* m_pSceneMeshes;
+	// on-disk cache of decoded textures and their mipmaps
+	TextureCache* m_pTextureCache;
+	// loaded textures info, indexed by texture handle
+	std::vector<TEXTURE_INFO> m_textureIDs;
+	// texture handles by tag, used when loading the scene
+	std::unordered_map<std::string, int> m_textureHandles;
+	// handles of the scene textures, in load order
+	std::vector<int> m_sceneTextureHandles;
+	// pack scene textures into texture arrays when loading
+	bool m_bPackTextures;
+	// block compress scene textures when loading
+	TextureCompressor::BLOCK_FORMAT m_textureCompression;
+	// bytes saved by block compression over RGBA8 with mipmaps
+	size_t m_compressionSavedBytes;
+	// compressor shared by the decode workers
+	TextureCompressor* m_pTextureCompressor;
+	// stream the scene textures in after the first frames
+	bool m_bStreamTextures;
+	// decodes the streamed scene textures in the background
+	TextureDecodePool* m_pDecodePool;
+	// reads the streamed scene texture files in one batch
+	AssetReader* m_pAssetReader;
+	// uploads the streamed scene textures a band at a time
+	TextureStreamer* m_pTextureStreamer;
+	// decode ticket of each scene texture, -1 once collected
+	std::vector<int> m_streamTickets;
+	// 1x1 texture drawn until a streamed texture arrives
+	GLuint m_placeholderTextureID;
+	// when the scene textures started streaming
+	std::chrono::steady_clock::time_point m_streamStart;
+	// drops and restores mip levels to stay within the texture budget
+	TextureResidency* m_pTextureResidency;
+	// camera position used to pick the mip levels objects need
+	glm::vec3 m_cameraPosition;
+	// position and largest scale of the object being drawn
+	glm::vec3 m_lastObjectPosition;
+	float m_lastObjectSize;
+	// model and normal matrices of the drawn objects, kept between frames
+	TransformCache* m_pTransformCache;
+	// objects placed relative to their parents
+	SceneGraph* m_pSceneGraph;
+	// scene graph node IDs of the objects drawn by RenderScene()
+	std::vector<int> m_sceneNodes;
+	// drawn objects as packed component arrays
+	SceneEntities* m_pSceneEntities;
+	// orders the draws of each frame by the states they need
+	RenderQueue* m_pRenderQueue;
+	// merge runs of draws with the same states into instanced draws
+	bool m_bUseInstancing;
+	// instance values of the instanced draw being made
+	std::vector<SceneMeshes::INSTANCE_DATA> m_instances;
+	// draw calls made for the scene entities in the last frame
+	int m_drawCallCount;
+	// submit the scene entities with multi-draw-indirect calls
+	bool m_bUseIndirectDraws;
+	// shared shape buffers and per frame draws, NULL when not used
+	IndirectDrawBatch* m_pIndirectDraws;
+	// first draw of each indirect call and the texture state it binds
+	struct INDIRECT_CALL
+	{
+		int firstDraw;
+		// texture and material setting the texture unit, or -1 for none
+		int texture;
+		int material;
+		int samplerPreset;
+	};
+	std::vector<INDIRECT_CALL> m_indirectCalls;
+	// size and lifetime of the OpenGL resources of the scene
+	GLResourceTracker* m_pResourceTracker;
+	// lights of the scene, written to the shaders as they change
+	LightBuffer* m_pLightBuffer;
+	// true when the program reads the lights from the light buffer
+	bool m_bLightBufferBound;
+	// lights binned into clusters of the view frustum, NULL when not used
+	LightClusters* m_pLightClusters;
+	// bin the lights into clusters rather than loop over all of them
+	bool m_bUseLightClusters;
+	// view frustum of the frame the lights are binned for
+	glm::mat4 m_viewMatrix;
+	glm::mat4 m_projectionMatrix;
+	glm::ivec2 m_viewportSize;
+	bool m_bHaveViewFrustum;
+	// IDs of the lights added by SetBenchmarkLights()
+	std::vector<int> m_benchmarkLightIDs;
+	// shader program of the shader manager, tracked but not owned
+	GLuint m_programID;
+	// uniform locations of the program, read once
+	UniformCache m_uniformCache;
+	// handles of the uniforms set while drawing
+	struct DRAW_UNIFORMS
+	{
+		UNIFORM_HANDLE<glm::mat4> model;
+		UNIFORM_HANDLE<glm::mat4> normalMatrix;
+		UNIFORM_HANDLE<glm::vec4> objectColor;
+		UNIFORM_HANDLE<bool> bUseTexture;
+		UNIFORM_HANDLE<int> objectTexture;
+		UNIFORM_HANDLE<bool> bUseTextureArray;
+		UNIFORM_HANDLE<int> objectTextureArray;
+		UNIFORM_HANDLE<int> textureLayer;
+		UNIFORM_HANDLE<glm::vec4> textureRect;
+		UNIFORM_HANDLE<glm::vec2> UVscale;
+		UNIFORM_HANDLE<glm::vec3> materialAmbientColor;
+		UNIFORM_HANDLE<float> materialAmbientStrength;
+		UNIFORM_HANDLE<glm::vec3> materialDiffuseColor;
+		UNIFORM_HANDLE<glm::vec3> materialSpecularColor;
+		UNIFORM_HANDLE<float> materialShininess;
+		UNIFORM_HANDLE<bool> bUseInstancing;
+		UNIFORM_HANDLE<bool> bUseIndirectDraws;
+		UNIFORM_HANDLE<int> firstDrawData;
+		UNIFORM_HANDLE<bool> bUseLightClusters;
+	};
+	DRAW_UNIFORMS m_uniforms;
+	// sampler objects shared by the textures
+	SamplerCache* m_pSamplerCache;
+	// sampler of the current material
+	GLuint m_currentSampler;
+	// texture unit selected by the last SetShaderTexture() call
+	int m_currentTextureUnit;
+	// preset used instead of the material presets, -1 for none
+	int m_samplerOverride;
+	// texture unit shared by the remaining textures
+	int m_spareTextureUnit;
+	// handle of the texture bound to the spare unit
+	int m_spareUnitHandle;
+	// texture unit shared by the remaining texture arrays
+	int m_spareArrayUnit;
+	// handle of the texture bound to the spare array unit
+	int m_spareArrayUnitHandle;
 	// defined object materials
 	std::vector<OBJECT_MATERIAL> m_objectMaterials;
 
 	// load texture images and convert to OpenGL texture data
 	bool CreateGLTexture(const char* filename, std::string tag);
+	// convert already decoded image data to OpenGL texture data
+	int UploadGLTexture(const TextureDecodePool::DECODED_IMAGE& image);
+	// create the OpenGL texture of decoded image data without registering it, 0 on failure
+	GLuint UploadTextureImage(const TextureDecodePool::DECODED_IMAGE& image);
+	// report the memory saved by a block compressed texture
+	void ReportCompressedTexture(const TextureDecodePool::DECODED_IMAGE& image);
+	// hand a texture uploaded with its cached mip chain to the residency manager
+	void ManageTextureResidency(int textureHandle, const std::string& filename, int blockFormat);
+	// add a created texture to the registry and get its handle
+	int RegisterTexture(const TEXTURE_INFO& textureInfo);
+	// read the scene texture files the texture cache cannot supply
+	void ReadSceneTextureFiles(AssetReader* pAssetReader);
+	// upload the scene textures straight from the asset pack
+	bool LoadPackedSceneTextures();
+	// start decoding the scene textures and register placeholders
+	void StartTextureStreaming();
 	// bind loaded OpenGL textures to slots in memory
 	void BindGLTextures();
 	// free the loaded OpenGL textures
 	void DestroyGLTextures();
+	// add the scene objects to the scene graph
+	void BuildSceneGraph();
+	// add an entity for each drawn object with its components
+	void BuildSceneEntities();
+	// draw every entity in state order, setting only the states that change
+	void DrawSceneEntities();
+	// draw a shape from the asset pack, or else from the basic shapes
+	void DrawShapeMesh(SceneMeshes::MESH_SHAPE shape);
+	// let the residency manager know the drawn object samples a texture
+	void MarkTextureUsed(int textureHandle);
 	// find a loaded texture by tag
 	int FindTextureID(std::string tag);
 	int FindTextureSlot(std::string tag);
 	// find a defined material by tag
 	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
+	int FindMaterialIndex(std::string tag);
 
 	// set the transformation values 
 	// into the transform buffer
@@ -78,6 +263,21 @@ private:
 		float ZrotationDegrees,
 		glm::vec3 positionXYZ);
 
+	// set the matrices of a scene graph node into the shader
+	void SetNodeTransformations(int nodeID);
+	// remember where a scene graph node is for picking mip levels
+	void SetLastObjectNode(int nodeID);
+	// read the uniforms of the program and resolve the draw handles
+	void ResolveUniforms();
+	// draw a run of sorted entities that share their states as instances
+	void DrawEntityInstances(size_t first, size_t end);
+	// draw the sorted entities with multi-draw-indirect calls
+	void DrawEntitiesIndirect();
+	// write the lights that changed to the shaders
+	void UploadSceneLights();
+	// bin the lights into the clusters of the view frustum
+	void UpdateLightClusters(bool bLightsChanged);
+
 	// set the color values into the shader
 	void SetShaderColor(
 		float redColorValue,
@@ -88,6 +288,8 @@ private:
 	// set the texture data into the shader
 	void SetShaderTexture(
 		std::string textureTag);
+	void SetShaderTexture(
+		int textureHandle);
 
 	// set the UV scale for the texture mapping
 	void SetTextureUVScale(
@@ -96,6 +298,8 @@ private:
 	// set the object material into the shader
 	void SetShaderMaterial(
 		std::string materialTag);
+	void SetShaderMaterial(
+		int materialIndex);
 
 
 public:
@@ -107,6 +311,96 @@ public:
 
 	void LoadSceneTextures(); // Declare LoadSceneTextures
 
+	// load textures and meshes from an asset pack that outlives the scene
+	void SetAssetPack(const AssetPack* pAssetPack);
+	// pack scene textures into texture arrays and atlas layers
+	void SetTexturePacking(bool bPackTextures);
+	// block compress scene textures into BC1, BC3 or BC7
+	void SetTextureCompression(TextureCompressor::BLOCK_FORMAT blockFormat);
+	// stream scene textures in behind placeholders instead of blocking
+	void SetTextureStreaming(bool bStreamTextures);
+	// upload the next streamed texture bands, once per frame
+	void UpdateTextureStreaming();
+	// true until every streamed texture has arrived
+	bool IsStreamingTextures() const;
+
+	// keep the scene textures within a GPU memory budget, 0 for none
+	void SetTextureBudget(size_t budgetBytes);
+	// set the camera used to pick the mip levels objects need
+	void SetCameraView(glm::vec3 cameraPosition, float focalPixels);
+	// drop or restore mip levels for the last frame, once per frame
+	void UpdateTextureResidency();
+
+	// filter every texture with one preset, or -1 for the material presets
+	void SetSamplerOverride(int samplerPreset);
+	// draw repeated objects with instanced draws
+	void SetInstancing(bool bUseInstancing);
+	// submit the scene with multi-draw-indirect calls, before PrepareScene()
+	void SetIndirectDraws(bool bUseIndirectDraws);
+	// tracker of the OpenGL resources, for objects that share the scene's accounting
+	GLResourceTracker* GetResourceTracker() const;
+
+	// number of model matrices composed in the last frame
+	int GetTransformRecomputeCount() const;
+	// number of mesh, texture and material changes in the last frame
+	int GetStateChangeCount() const;
+	// state changes the render queue saved over drawing in authoring order
+	int GetSavedStateChangeCount() const;
+	// draw calls made for the scene entities in the last frame
+	int GetDrawCallCount() const;
+	// uniform writes passed to the driver and dropped as unchanged in the last frame
+	int GetUniformWriteCount() const;
+	int GetElidedUniformWriteCount() const;
+
+	// add a light source and get back its ID, a range of 0 reaches everywhere
+	int AddLight(
+		glm::vec3 position,
+		glm::vec3 ambientColor,
+		glm::vec3 diffuseColor,
+		glm::vec3 specularColor,
+		float focalStrength,
+		float specularIntensity,
+		float range = 0.0f);
+	// change the values of a light source, false for an unknown ID
+	bool UpdateLight(
+		int lightID,
+		glm::vec3 position,
+		glm::vec3 ambientColor,
+		glm::vec3 diffuseColor,
+		glm::vec3 specularColor,
+		float focalStrength,
+		float specularIntensity,
+		float range = 0.0f);
+	// remove a light source, false for an unknown ID
+	bool RemoveLight(int lightID);
+	int GetLightCount() const;
+	// lights written to the shaders in the last frame any changed
+	int GetLightUploadCount() const;
+	// set the view frustum the lights are binned for, once per frame
+	void SetViewFrustum(const glm::mat4& view, const glm::mat4& projection, glm::ivec2 viewportSize);
+	// bin the lights into clusters of the view frustum rather than loop over all of them
+	void SetLightClusters(bool bUseLightClusters);
+	// time the last binning of the lights took, 0 when they are not binned
+	double GetLightBinningMilliseconds() const;
+	// replace the benchmark lights with a number of desk lamps
+	void SetBenchmarkLights(int lightCount);
+
+	// replace the scene with one from a text or binary scene file
+	bool LoadSceneFile(const std::string& filename);
+	// time the uniform updates of a draw by name and by handle
+	void BenchmarkUniformUpdates();
+
+	// time decoding every texture image serially and on the pool
+	static void BenchmarkTextureDecoding();
+	// time composing model matrices with matrix products and in a batch
+	static void BenchmarkTransforms();
+	// time loading a large binary scene file into the scene graph and entities
+	static void BenchmarkSceneLoading();
+	// compress every texture image ahead of time and report the results
+	static void CompressSceneTextures(TextureCompressor::BLOCK_FORMAT blockFormat);
+	// write the scene textures, meshes and shaders into an asset pack
+	static bool BuildAssetPack(const char* packFilename, TextureCompressor::BLOCK_FORMAT blockFormat);
+
 	// pre-set light sources for 3D scene
 	void SetupSceneLights();
 	// pre-define the object materials for lighting
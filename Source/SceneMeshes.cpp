@@ -0,0 +1,563 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenemeshes.cpp
+// ============
+// bake and draw the basic shape meshes of the scene
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneMeshes.h"
+#include "GLResourceTracker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+// declaration of global variables
+namespace
+{
+	const float g_Pi = 3.14159265358979f;
+	// instances the instance buffer has room for at first
+	const int g_InitialInstanceCount = 64;
+	// vertices and indices the shared buffers have room for at first
+	const int g_InitialVertexCount = 8192;
+	const int g_InitialIndexCount = 32768;
+
+	// segments around the cylinder and the sphere
+	const int g_CylinderSectors = 36;
+	const int g_SphereSectors = 36;
+	const int g_SphereStacks = 18;
+
+	const char* g_ShapeNames[SceneMeshes::MESH_SHAPE_COUNT] =
+	{
+		"meshes/plane",
+		"meshes/box",
+		"meshes/cylinder",
+		"meshes/sphere"
+	};
+
+	// append one vertex to the interleaved vertex data
+	void AddVertex(std::vector<float>& vertices,
+		float x, float y, float z, float nx, float ny, float nz, float u, float v)
+	{
+		float vertex[SceneMeshes::FLOATS_PER_VERTEX] = { x, y, z, nx, ny, nz, u, v };
+		vertices.insert(vertices.end(), vertex, vertex + SceneMeshes::FLOATS_PER_VERTEX);
+	}
+
+	// append the two triangles of a quad with counter-clockwise corners a, b, c, d
+	void AddQuad(std::vector<uint32_t>& indices, uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+	{
+		uint32_t quad[6] = { a, b, c, a, c, d };
+		indices.insert(indices.end(), quad, quad + 6);
+	}
+}
+
+/***********************************************************
+ *  SceneMeshes()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneMeshes::SceneMeshes(GLResourceTracker* pResourceTracker)
+{
+	m_pResourceTracker = pResourceTracker;
+	m_vertexArrayID = 0;
+	m_vertexBufferID = 0;
+	m_indexBufferID = 0;
+	m_vertexCapacity = 0;
+	m_indexCapacity = 0;
+	m_vertexCount = 0;
+	m_indexCount = 0;
+	for (int i = 0; i < MESH_SHAPE_COUNT; i++)
+	{
+		m_shapes[i].firstIndex = 0;
+		m_shapes[i].indexCount = 0;
+		m_shapes[i].baseVertex = 0;
+		m_shapes[i].vertexCount = 0;
+	}
+	m_instanceBufferID = 0;
+	m_instanceBufferBytes = 0;
+}
+
+/***********************************************************
+ *  ~SceneMeshes()
+ *
+ *  The destructor for the class.  The shared vertex array
+ *  and buffers are freed.
+ ***********************************************************/
+SceneMeshes::~SceneMeshes()
+{
+	if (m_vertexArrayID != 0)
+	{
+		glDeleteVertexArrays(1, &m_vertexArrayID);
+		m_pResourceTracker->Delete(GLResourceTracker::RESOURCE_BUFFER, m_vertexBufferID);
+		m_pResourceTracker->Delete(GLResourceTracker::RESOURCE_BUFFER, m_indexBufferID);
+		m_pResourceTracker->Delete(GLResourceTracker::RESOURCE_BUFFER, m_instanceBufferID);
+	}
+	m_vertexArrayID = 0;
+	m_vertexBufferID = 0;
+	m_indexBufferID = 0;
+	m_instanceBufferID = 0;
+}
+
+/***********************************************************
+ *  BuildShape()
+ *
+ *  This method is used for building the vertices and the
+ *  triangle indices of a shape.  The plane spans -1 to 1 on
+ *  X and Z facing up, the box spans -0.5 to 0.5, and the
+ *  cylinder has a radius of 1 and rises from 0 to 1 on Y
+ *  with both ends capped.  The sphere has a radius of 1.
+ *  Triangles wind counter-clockwise seen from outside.
+ ***********************************************************/
+void SceneMeshes::BuildShape(MESH_SHAPE shape, std::vector<float>& vertices, std::vector<uint32_t>& indices)
+{
+	vertices.clear();
+	indices.clear();
+
+	if (shape == MESH_PLANE)
+	{
+		AddVertex(vertices, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f);
+		AddVertex(vertices, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f);
+		AddVertex(vertices, 1.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f);
+		AddVertex(vertices, -1.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f);
+		AddQuad(indices, 0, 1, 2, 3);
+	}
+	else if (shape == MESH_BOX)
+	{
+		// the normal, and the directions of u and v across each face
+		const float faces[6][9] =
+		{
+			{ 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f },
+			{ 0.0f, 0.0f, -1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f },
+			{ 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f },
+			{ -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f },
+			{ 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f },
+			{ 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }
+		};
+		const float corners[4][2] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+
+		for (int face = 0; face < 6; face++)
+		{
+			const float* n = faces[face];
+			const float* u = faces[face] + 3;
+			const float* v = faces[face] + 6;
+			uint32_t first = (uint32_t)(vertices.size() / FLOATS_PER_VERTEX);
+			for (int corner = 0; corner < 4; corner++)
+			{
+				float s = corners[corner][0] - 0.5f;
+				float t = corners[corner][1] - 0.5f;
+				AddVertex(vertices,
+					n[0] * 0.5f + u[0] * s + v[0] * t,
+					n[1] * 0.5f + u[1] * s + v[1] * t,
+					n[2] * 0.5f + u[2] * s + v[2] * t,
+					n[0], n[1], n[2], corners[corner][0], corners[corner][1]);
+			}
+			AddQuad(indices, first, first + 1, first + 2, first + 3);
+		}
+	}
+	else if (shape == MESH_CYLINDER)
+	{
+		// the side gets its own seam column so the texture wraps once
+		for (int sector = 0; sector <= g_CylinderSectors; sector++)
+		{
+			float u = (float)sector / g_CylinderSectors;
+			float angle = u * 2.0f * g_Pi;
+			float x = std::sin(angle);
+			float z = std::cos(angle);
+			AddVertex(vertices, x, 0.0f, z, x, 0.0f, z, u, 0.0f);
+			AddVertex(vertices, x, 1.0f, z, x, 0.0f, z, u, 1.0f);
+		}
+		for (int sector = 0; sector < g_CylinderSectors; sector++)
+		{
+			uint32_t bottom = (uint32_t)(sector * 2);
+			AddQuad(indices, bottom, bottom + 2, bottom + 3, bottom + 1);
+		}
+
+		// the caps are fans around a center vertex
+		for (int cap = 0; cap < 2; cap++)
+		{
+			float y = (float)cap;
+			float ny = (cap == 0) ? -1.0f : 1.0f;
+			uint32_t center = (uint32_t)(vertices.size() / FLOATS_PER_VERTEX);
+			AddVertex(vertices, 0.0f, y, 0.0f, 0.0f, ny, 0.0f, 0.5f, 0.5f);
+			for (int sector = 0; sector < g_CylinderSectors; sector++)
+			{
+				float angle = (float)sector / g_CylinderSectors * 2.0f * g_Pi;
+				float x = std::sin(angle);
+				float z = std::cos(angle);
+				AddVertex(vertices, x, y, z, 0.0f, ny, 0.0f, 0.5f + x * 0.5f, 0.5f - z * 0.5f);
+			}
+			for (int sector = 0; sector < g_CylinderSectors; sector++)
+			{
+				uint32_t current = center + 1 + sector;
+				uint32_t next = center + 1 + (sector + 1) % g_CylinderSectors;
+				uint32_t triangle[3] = { center, next, current };
+				if (cap == 1)
+				{
+					triangle[1] = current;
+					triangle[2] = next;
+				}
+				indices.insert(indices.end(), triangle, triangle + 3);
+			}
+		}
+	}
+	else if (shape == MESH_SPHERE)
+	{
+		for (int stack = 0; stack <= g_SphereStacks; stack++)
+		{
+			float v = (float)stack / g_SphereStacks;
+			float polar = g_Pi * (1.0f - v);
+			float ringRadius = std::sin(polar);
+			float y = std::cos(polar);
+			for (int sector = 0; sector <= g_SphereSectors; sector++)
+			{
+				float u = (float)sector / g_SphereSectors;
+				float angle = u * 2.0f * g_Pi;
+				float x = ringRadius * std::sin(angle);
+				float z = ringRadius * std::cos(angle);
+				AddVertex(vertices, x, y, z, x, y, z, u, v);
+			}
+		}
+		for (int stack = 0; stack < g_SphereStacks; stack++)
+		{
+			for (int sector = 0; sector < g_SphereSectors; sector++)
+			{
+				uint32_t lower = (uint32_t)(stack * (g_SphereSectors + 1) + sector);
+				uint32_t upper = lower + g_SphereSectors + 1;
+				AddQuad(indices, lower, lower + 1, upper + 1, upper);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  GetShapeName()
+ *
+ *  This method is used for getting the name a shape is kept
+ *  under in the asset pack.
+ ***********************************************************/
+const char* SceneMeshes::GetShapeName(MESH_SHAPE shape)
+{
+	if ((shape < 0) || (shape >= MESH_SHAPE_COUNT))
+	{
+		return("");
+	}
+
+	return(g_ShapeNames[shape]);
+}
+
+/***********************************************************
+ *  LoadShape()
+ *
+ *  This method is used for copying the vertices and the
+ *  indices of a shape into the shared buffers, straight
+ *  from where they are, such as a mapped asset pack.  The
+ *  indices are kept as they are, and the shape is drawn
+ *  with its first vertex as the base vertex.  A shape that
+ *  is loaded again reuses its range when the new data fits.
+ ***********************************************************/
+bool SceneMeshes::LoadShape(MESH_SHAPE shape, const float* vertices, int vertexCount,
+	const uint32_t* indices, int indexCount)
+{
+	if ((shape < 0) || (shape >= MESH_SHAPE_COUNT) || (NULL == vertices) || (vertexCount <= 0) ||
+		(NULL == indices) || (indexCount <= 0))
+	{
+		return(false);
+	}
+
+	SHAPE_RANGE& range = m_shapes[shape];
+	if ((range.vertexCount < (GLuint)vertexCount) || (range.indexCount < (GLuint)indexCount))
+	{
+		ReserveShapes((GLuint)vertexCount, (GLuint)indexCount);
+		range.baseVertex = (GLint)m_vertexCount;
+		range.firstIndex = m_indexCount;
+		m_vertexCount += (GLuint)vertexCount;
+		m_indexCount += (GLuint)indexCount;
+	}
+	range.vertexCount = (GLuint)vertexCount;
+	range.indexCount = (GLuint)indexCount;
+
+	const size_t vertexBytes = FLOATS_PER_VERTEX * sizeof(float);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferID);
+	glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)(range.baseVertex * vertexBytes),
+		(GLsizeiptr)(vertexCount * vertexBytes), vertices);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_indexBufferID);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)(range.firstIndex * sizeof(uint32_t)),
+		(GLsizeiptr)(indexCount * sizeof(uint32_t)), indices);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	return(true);
+}
+
+/***********************************************************
+ *  IsLoaded()
+ *
+ *  This method is used for checking whether a shape is in
+ *  the shared buffers.
+ ***********************************************************/
+bool SceneMeshes::IsLoaded(MESH_SHAPE shape) const
+{
+	return((shape >= 0) && (shape < MESH_SHAPE_COUNT) && (m_shapes[shape].indexCount > 0));
+}
+
+/***********************************************************
+ *  GetShapeRange()
+ *
+ *  This method is used for getting where a loaded shape
+ *  sits in the shared buffers, for drawing it some other
+ *  way, such as with indirect draws.
+ ***********************************************************/
+const SceneMeshes::SHAPE_RANGE& SceneMeshes::GetShapeRange(MESH_SHAPE shape) const
+{
+	return(m_shapes[shape]);
+}
+
+/***********************************************************
+ *  GetVertexArray()
+ *
+ *  This method is used for getting the vertex array that
+ *  reads the shared buffers.
+ ***********************************************************/
+GLuint SceneMeshes::GetVertexArray() const
+{
+	return(m_vertexArrayID);
+}
+
+/***********************************************************
+ *  DrawShape()
+ *
+ *  This method is used for drawing a loaded shape with the
+ *  current shader settings.
+ ***********************************************************/
+void SceneMeshes::DrawShape(MESH_SHAPE shape) const
+{
+	if (IsLoaded(shape) == false)
+	{
+		return;
+	}
+
+	glBindVertexArray(m_vertexArrayID);
+	DrawBoundShape(shape);
+	glBindVertexArray(0);
+}
+
+/***********************************************************
+ *  BindShapes()
+ *
+ *  This method is used for binding the shared vertex array,
+ *  so a run of draws of any of the shapes binds it once.
+ ***********************************************************/
+void SceneMeshes::BindShapes() const
+{
+	glBindVertexArray(m_vertexArrayID);
+}
+
+/***********************************************************
+ *  DrawBoundShape()
+ *
+ *  This method is used for drawing a loaded shape with the
+ *  current shader settings while BindShapes() has bound
+ *  the shared vertex array.
+ ***********************************************************/
+void SceneMeshes::DrawBoundShape(MESH_SHAPE shape) const
+{
+	if (IsLoaded(shape) == true)
+	{
+		const SHAPE_RANGE& range = m_shapes[shape];
+		glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)range.indexCount, GL_UNSIGNED_INT,
+			(const void*)(range.firstIndex * sizeof(uint32_t)), range.baseVertex);
+	}
+}
+
+/***********************************************************
+ *  UnbindShapes()
+ *
+ *  This method is used for unbinding the shapes at the end
+ *  of a run of draws, as DrawShape() leaves them.
+ ***********************************************************/
+void SceneMeshes::UnbindShapes()
+{
+	glBindVertexArray(0);
+}
+
+/***********************************************************
+ *  DrawShapeInstanced()
+ *
+ *  This method is used for drawing a loaded shape once for
+ *  each of the passed in instances with a single draw call.
+ *  The instance values are copied into the instance buffer,
+ *  which is given fresh storage first so the copy does not
+ *  wait on draws still reading the last values.  The buffer
+ *  grows to fit the largest draw.
+ ***********************************************************/
+void SceneMeshes::DrawShapeInstanced(MESH_SHAPE shape, const INSTANCE_DATA* instances, int instanceCount)
+{
+	if ((IsLoaded(shape) == false) || (NULL == instances) || (instanceCount <= 0))
+	{
+		return;
+	}
+
+	size_t instanceBytes = (size_t)instanceCount * sizeof(INSTANCE_DATA);
+	if (instanceBytes > m_instanceBufferBytes)
+	{
+		m_instanceBufferBytes = instanceBytes;
+		m_pResourceTracker->Resize(GLResourceTracker::RESOURCE_BUFFER, m_instanceBufferID, m_instanceBufferBytes);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBufferID);
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)m_instanceBufferBytes, NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)instanceBytes, instances);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	const SHAPE_RANGE& range = m_shapes[shape];
+	glBindVertexArray(m_vertexArrayID);
+	glDrawElementsInstancedBaseVertex(GL_TRIANGLES, (GLsizei)range.indexCount, GL_UNSIGNED_INT,
+		(const void*)(range.firstIndex * sizeof(uint32_t)), instanceCount, range.baseVertex);
+	glBindVertexArray(0);
+}
+
+/***********************************************************
+ *  ReserveShapes()
+ *
+ *  This method is used for making sure the shared buffers
+ *  have room for more vertices and indices after the ones
+ *  used.  The buffers and the vertex array are created with
+ *  the first shape, and each buffer at least doubles when
+ *  it grows, with the shapes already in it copied across on
+ *  the GPU.
+ ***********************************************************/
+void SceneMeshes::ReserveShapes(GLuint vertexCount, GLuint indexCount)
+{
+	const size_t vertexBytes = FLOATS_PER_VERTEX * sizeof(float);
+
+	if (m_vertexArrayID == 0)
+	{
+		m_vertexCapacity = std::max((GLuint)g_InitialVertexCount, vertexCount);
+		m_indexCapacity = std::max((GLuint)g_InitialIndexCount, indexCount);
+		m_instanceBufferBytes = g_InitialInstanceCount * sizeof(INSTANCE_DATA);
+
+		glGenVertexArrays(1, &m_vertexArrayID);
+		glGenBuffers(1, &m_vertexBufferID);
+		glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferID);
+		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(m_vertexCapacity * vertexBytes), NULL, GL_STATIC_DRAW);
+		glGenBuffers(1, &m_indexBufferID);
+		glBindBuffer(GL_ARRAY_BUFFER, m_indexBufferID);
+		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(m_indexCapacity * sizeof(uint32_t)), NULL, GL_STATIC_DRAW);
+		glGenBuffers(1, &m_instanceBufferID);
+		glBindBuffer(GL_ARRAY_BUFFER, m_instanceBufferID);
+		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)m_instanceBufferBytes, NULL, GL_STREAM_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		m_pResourceTracker->Track(GLResourceTracker::RESOURCE_BUFFER, m_vertexBufferID,
+			m_vertexCapacity * vertexBytes, "meshes");
+		m_pResourceTracker->Track(GLResourceTracker::RESOURCE_BUFFER, m_indexBufferID,
+			m_indexCapacity * sizeof(uint32_t), "meshes");
+		m_pResourceTracker->Track(GLResourceTracker::RESOURCE_BUFFER, m_instanceBufferID, m_instanceBufferBytes, "meshes");
+		AttachBuffers();
+		return;
+	}
+
+	bool bGrown = false;
+	if (m_vertexCount + vertexCount > m_vertexCapacity)
+	{
+		GLuint capacity = std::max(m_vertexCapacity * 2, m_vertexCount + vertexCount);
+		m_vertexBufferID = GrowBuffer(m_vertexBufferID, m_vertexCount * vertexBytes, capacity * vertexBytes);
+		m_vertexCapacity = capacity;
+		bGrown = true;
+	}
+	if (m_indexCount + indexCount > m_indexCapacity)
+	{
+		GLuint capacity = std::max(m_indexCapacity * 2, m_indexCount + indexCount);
+		m_indexBufferID = GrowBuffer(m_indexBufferID, m_indexCount * sizeof(uint32_t), capacity * sizeof(uint32_t));
+		m_indexCapacity = capacity;
+		bGrown = true;
+	}
+	if (bGrown == true)
+	{
+		AttachBuffers();
+	}
+}
+
+/***********************************************************
+ *  GrowBuffer()
+ *
+ *  This method is used for creating a larger buffer, copying
+ *  the used part of a buffer into it and freeing the old
+ *  one.  The ID of the new buffer is returned.
+ ***********************************************************/
+GLuint SceneMeshes::GrowBuffer(GLuint bufferID, size_t usedBytes, size_t newBytes)
+{
+	GLuint newBufferID = 0;
+
+	glGenBuffers(1, &newBufferID);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, newBufferID);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)newBytes, NULL, GL_STATIC_DRAW);
+	if (usedBytes > 0)
+	{
+		glBindBuffer(GL_COPY_READ_BUFFER, bufferID);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)usedBytes);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	m_pResourceTracker->Delete(GLResourceTracker::RESOURCE_BUFFER, bufferID);
+	m_pResourceTracker->Track(GLResourceTracker::RESOURCE_BUFFER, newBufferID, newBytes, "meshes");
+
+	return(newBufferID);
+}
+
+/***********************************************************
+ *  AttachBuffers()
+ *
+ *  This method is used for pointing the vertex array at the
+ *  shared vertex and index buffers and at the instance
+ *  buffer.  The instance attributes advance once per
+ *  instance rather than once per vertex, and matrices take
+ *  one attribute location per column.
+ ***********************************************************/
+void SceneMeshes::AttachBuffers()
+{
+	GLsizei stride = FLOATS_PER_VERTEX * sizeof(float);
+
+	glBindVertexArray(m_vertexArrayID);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBufferID);
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferID);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (const void*)0);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (const void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (const void*)(6 * sizeof(float)));
+
+	stride = sizeof(INSTANCE_DATA);
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBufferID);
+	for (int column = 0; column < 4; column++)
+	{
+		GLuint location = 3 + column;
+		glEnableVertexAttribArray(location);
+		glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride,
+			(const void*)(offsetof(INSTANCE_DATA, modelMatrix) + column * sizeof(glm::vec4)));
+		glVertexAttribDivisor(location, 1);
+	}
+	for (int column = 0; column < 3; column++)
+	{
+		GLuint location = 7 + column;
+		glEnableVertexAttribArray(location);
+		glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, stride,
+			(const void*)(offsetof(INSTANCE_DATA, normalMatrix) + column * sizeof(glm::vec4)));
+		glVertexAttribDivisor(location, 1);
+	}
+	glEnableVertexAttribArray(10);
+	glVertexAttribPointer(10, 4, GL_FLOAT, GL_FALSE, stride, (const void*)offsetof(INSTANCE_DATA, color));
+	glVertexAttribDivisor(10, 1);
+	glEnableVertexAttribArray(11);
+	glVertexAttribPointer(11, 1, GL_FLOAT, GL_FALSE, stride, (const void*)offsetof(INSTANCE_DATA, textureLayer));
+	glVertexAttribDivisor(11, 1);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
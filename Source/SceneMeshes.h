@@ -0,0 +1,133 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenemeshes.h
+// ============
+// bake and draw the basic shape meshes of the scene
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+class GLResourceTracker;
+
+/***********************************************************
+ *  SceneMeshes
+ *
+ *  This class builds the plane, box, cylinder and sphere
+ *  meshes with the same sizes, orientation and vertex layout
+ *  as ShapeMeshes, so they can be baked into an asset pack,
+ *  and draws them from vertex data handed over from a pack.
+ *  Every shape is suballocated from one shared vertex buffer
+ *  and one shared index buffer read by a single vertex
+ *  array, and drawn with its base vertex, so switching
+ *  shapes binds nothing.  Each vertex is a position, a
+ *  normal and a texture coordinate, at attribute locations
+ *  0, 1 and 2.  A shape
+ *  can also be drawn many times in one instanced draw, with
+ *  the values of each instance read from attribute
+ *  locations 3 to 11.
+ ***********************************************************/
+class SceneMeshes
+{
+public:
+	// constructor
+	SceneMeshes(GLResourceTracker* pResourceTracker);
+	// destructor
+	~SceneMeshes();
+
+	enum MESH_SHAPE
+	{
+		MESH_PLANE = 0,
+		MESH_BOX,
+		MESH_CYLINDER,
+		MESH_SPHERE,
+		MESH_SHAPE_COUNT
+	};
+
+	// position, normal and texture coordinate
+	static const int FLOATS_PER_VERTEX = 8;
+
+	// values of one instance of an instanced draw
+	struct INSTANCE_DATA
+	{
+		// attribute locations 3 to 6
+		glm::mat4 modelMatrix;
+		// attribute locations 7 to 9, only the upper 3x3 part is read
+		glm::mat4 normalMatrix;
+		// attribute location 10
+		glm::vec4 color;
+		// attribute location 11, layer of a packed texture array
+		float textureLayer;
+		float padding[3];
+	};
+
+	// where a shape sits in the shared buffers
+	struct SHAPE_RANGE
+	{
+		// first index in the index buffer
+		GLuint firstIndex;
+		GLuint indexCount;
+		// added to every index of the shape
+		GLint baseVertex;
+		GLuint vertexCount;
+	};
+
+	// build the interleaved vertices and triangle indices of a shape
+	static void BuildShape(MESH_SHAPE shape, std::vector<float>& vertices, std::vector<uint32_t>& indices);
+	// name of a shape in the asset pack, such as "meshes/box"
+	static const char* GetShapeName(MESH_SHAPE shape);
+
+	// copy the vertex data of a shape into the shared buffers
+	bool LoadShape(MESH_SHAPE shape, const float* vertices, int vertexCount,
+		const uint32_t* indices, int indexCount);
+	// true once the shape is in the shared buffers
+	bool IsLoaded(MESH_SHAPE shape) const;
+	// where a loaded shape sits in the shared buffers
+	const SHAPE_RANGE& GetShapeRange(MESH_SHAPE shape) const;
+	// vertex array reading the shared buffers, 0 before the first shape
+	GLuint GetVertexArray() const;
+	// draw a loaded shape
+	void DrawShape(MESH_SHAPE shape) const;
+	// bind the shared vertex array for a run of DrawBoundShape() calls
+	void BindShapes() const;
+	// draw a loaded shape while the shapes are bound
+	void DrawBoundShape(MESH_SHAPE shape) const;
+	// unbind the shapes after a run of draws
+	static void UnbindShapes();
+	// draw a loaded shape once for each of the passed in instances
+	void DrawShapeInstanced(MESH_SHAPE shape, const INSTANCE_DATA* instances, int instanceCount);
+
+private:
+	// records the shared and instance buffers
+	GLResourceTracker* m_pResourceTracker;
+	GLuint m_vertexArrayID;
+	GLuint m_vertexBufferID;
+	GLuint m_indexBufferID;
+	// vertices and indices the shared buffers have room for, and have used
+	GLuint m_vertexCapacity;
+	GLuint m_indexCapacity;
+	GLuint m_vertexCount;
+	GLuint m_indexCount;
+	SHAPE_RANGE m_shapes[MESH_SHAPE_COUNT];
+	// per instance values, shared by every shape
+	GLuint m_instanceBufferID;
+	size_t m_instanceBufferBytes;
+
+	// make room in the shared buffers for more vertices and indices
+	void ReserveShapes(GLuint vertexCount, GLuint indexCount);
+	// copy a buffer into a new one of a larger size
+	GLuint GrowBuffer(GLuint bufferID, size_t usedBytes, size_t newBytes);
+	// point the vertex array at the shared and instance buffers
+	void AttachBuffers();
+
+	// meshes own OpenGL objects, so they are not copied
+	SceneMeshes(const SceneMeshes&);
+	SceneMeshes& operator=(const SceneMeshes&);
+};
@@ -0,0 +1,346 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturearraypacker.cpp
+// ============
+// pack scene textures into texture arrays and atlas layers
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureArrayPacker.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+// declaration of global variables
+namespace
+{
+	// sorts atlas images tallest first for shelf packing
+	struct TALLER_IMAGE
+	{
+		const std::vector<const TextureDecodePool::DECODED_IMAGE*>* pImages;
+
+		bool operator()(int left, int right) const
+		{
+			return((*pImages)[left]->height > (*pImages)[right]->height);
+		}
+	};
+
+	// number of mip levels down to 1x1
+	int FullMipCount(int width, int height)
+	{
+		int levels = 1;
+		int size = (width > height) ? width : height;
+		while (size > 1)
+		{
+			size /= 2;
+			levels++;
+		}
+		return(levels);
+	}
+}
+
+/***********************************************************
+ *  TextureArrayPacker()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureArrayPacker::TextureArrayPacker(int atlasPageSize, int atlasGutter)
+{
+	m_atlasPageSize = atlasPageSize;
+	m_atlasGutter = atlasGutter;
+}
+
+/***********************************************************
+ *  ~TextureArrayPacker()
+ *
+ *  The destructor for the class.  The created array
+ *  textures are owned by the caller and are not freed here.
+ ***********************************************************/
+TextureArrayPacker::~TextureArrayPacker()
+{
+}
+
+/***********************************************************
+ *  AddImage()
+ *
+ *  This method is used for adding a decoded image to be
+ *  packed.  The image is not copied, so it must stay valid
+ *  until CreateGLTextures() returns.
+ ***********************************************************/
+void TextureArrayPacker::AddImage(const TextureDecodePool::DECODED_IMAGE* pImage)
+{
+	m_images.push_back(pImage);
+}
+
+/***********************************************************
+ *  CreateGLTextures()
+ *
+ *  This method is used for packing the added images and
+ *  creating the array textures on the OpenGL context thread.
+ *  The packed textures are returned in the order the images
+ *  were added, with an array ID of 0 for images that were
+ *  not packed.
+ ***********************************************************/
+void TextureArrayPacker::CreateGLTextures(std::vector<PACKED_TEXTURE>& packedTextures)
+{
+	PACKED_TEXTURE unpacked;
+	unpacked.arrayID = 0;
+	unpacked.layer = 0;
+	unpacked.uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+	packedTextures.assign(m_images.size(), unpacked);
+	m_arrayIDs.clear();
+
+	GLint maxTextureSize = 0;
+	GLint maxArrayLayers = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxArrayLayers);
+	if (m_atlasPageSize > maxTextureSize)
+	{
+		m_atlasPageSize = maxTextureSize;
+	}
+
+	// group the usable images by their size - block compressed
+	// images stay plain textures so they keep their compression
+	std::map<std::pair<int, int>, std::vector<int> > sizeGroups;
+	for (size_t i = 0; i < m_images.size(); i++)
+	{
+		const TextureDecodePool::DECODED_IMAGE* pImage = m_images[i];
+		if ((GetBasePixels(pImage) != NULL) && (pImage->blockFormat == 0) &&
+			((pImage->colorChannels == 3) || (pImage->colorChannels == 4)))
+		{
+			sizeGroups[std::make_pair(pImage->width, pImage->height)].push_back((int)i);
+		}
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	// shared sizes get an array with one whole layer per image
+	std::vector<int> atlasImages;
+	std::map<std::pair<int, int>, std::vector<int> >::const_iterator group;
+	for (group = sizeGroups.begin(); group != sizeGroups.end(); ++group)
+	{
+		int width = group->first.first;
+		int height = group->first.second;
+		const std::vector<int>& imageIndices = group->second;
+
+		if ((imageIndices.size() < 2) || (width > maxTextureSize) || (height > maxTextureSize) ||
+			((int)imageIndices.size() > maxArrayLayers))
+		{
+			atlasImages.insert(atlasImages.end(), imageIndices.begin(), imageIndices.end());
+			continue;
+		}
+
+		GLuint arrayID = CreateArrayTexture(width, height, (int)imageIndices.size(), FullMipCount(width, height) - 1);
+		for (size_t layer = 0; layer < imageIndices.size(); layer++)
+		{
+			const TextureDecodePool::DECODED_IMAGE* pImage = m_images[imageIndices[layer]];
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, (GLint)layer, width, height, 1,
+				(pImage->colorChannels == 4) ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, GetBasePixels(pImage));
+
+			packedTextures[imageIndices[layer]].arrayID = arrayID;
+			packedTextures[imageIndices[layer]].layer = (int)layer;
+		}
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+		m_arrayIDs.push_back(arrayID);
+	}
+
+	// the odd sized images are shelf packed into atlas pages
+	std::vector<ATLAS_PLACEMENT> placements;
+	int pageCount = PlaceAtlasImages(atlasImages, placements);
+	if ((pageCount > 0) && (pageCount <= maxArrayLayers))
+	{
+		// stop the mip chain before the gutters blur into each other
+		int maxLevel = 0;
+		for (int gutter = m_atlasGutter; gutter > 1; gutter /= 2)
+		{
+			maxLevel++;
+		}
+
+		GLuint arrayID = CreateArrayTexture(m_atlasPageSize, m_atlasPageSize, pageCount, maxLevel);
+		std::vector<unsigned char> page;
+		for (int pageIndex = 0; pageIndex < pageCount; pageIndex++)
+		{
+			page.assign((size_t)m_atlasPageSize * m_atlasPageSize * 4, 0);
+			for (size_t i = 0; i < placements.size(); i++)
+			{
+				if (placements[i].page != pageIndex)
+					continue;
+
+				const TextureDecodePool::DECODED_IMAGE* pImage = m_images[placements[i].imageIndex];
+				CopyToAtlasPage(pImage, placements[i].x, placements[i].y, page);
+
+				PACKED_TEXTURE& packed = packedTextures[placements[i].imageIndex];
+				packed.arrayID = arrayID;
+				packed.layer = pageIndex;
+				packed.uvRect = glm::vec4(
+					(float)placements[i].x / m_atlasPageSize,
+					(float)placements[i].y / m_atlasPageSize,
+					(float)pImage->width / m_atlasPageSize,
+					(float)pImage->height / m_atlasPageSize);
+			}
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, pageIndex, m_atlasPageSize, m_atlasPageSize, 1,
+				GL_RGBA, GL_UNSIGNED_BYTE, &page[0]);
+		}
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+		m_arrayIDs.push_back(arrayID);
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+/***********************************************************
+ *  GetArrayIDs()
+ *
+ *  This method is used for getting the array textures that
+ *  were created by the last packing.
+ ***********************************************************/
+const std::vector<GLuint>& TextureArrayPacker::GetArrayIDs() const
+{
+	return(m_arrayIDs);
+}
+
+/***********************************************************
+ *  PlaceAtlasImages()
+ *
+ *  This method is used for shelf packing the passed in
+ *  images into square atlas pages, tallest image first.
+ *  Each image is surrounded by a gutter on every side.
+ *  Images that do not fit on an empty page are skipped.
+ *  The number of pages used is returned.
+ ***********************************************************/
+int TextureArrayPacker::PlaceAtlasImages(const std::vector<int>& imageIndices,
+	std::vector<ATLAS_PLACEMENT>& placements) const
+{
+	std::vector<int> sorted = imageIndices;
+	TALLER_IMAGE taller;
+	taller.pImages = &m_images;
+	std::stable_sort(sorted.begin(), sorted.end(), taller);
+
+	int pageCount = 0;
+	int shelfX = 0;
+	int shelfY = 0;
+	int shelfHeight = 0;
+
+	for (size_t i = 0; i < sorted.size(); i++)
+	{
+		const TextureDecodePool::DECODED_IMAGE* pImage = m_images[sorted[i]];
+		int paddedWidth = pImage->width + m_atlasGutter * 2;
+		int paddedHeight = pImage->height + m_atlasGutter * 2;
+
+		if ((paddedWidth > m_atlasPageSize) || (paddedHeight > m_atlasPageSize))
+			continue;
+
+		// start a new shelf when the image does not fit across
+		if ((pageCount > 0) && (shelfX + paddedWidth > m_atlasPageSize))
+		{
+			shelfY += shelfHeight;
+			shelfX = 0;
+			shelfHeight = 0;
+		}
+		// start a new page when the shelf does not fit down
+		if ((pageCount == 0) || (shelfY + paddedHeight > m_atlasPageSize))
+		{
+			pageCount++;
+			shelfX = 0;
+			shelfY = 0;
+			shelfHeight = 0;
+		}
+
+		ATLAS_PLACEMENT placement;
+		placement.imageIndex = sorted[i];
+		placement.page = pageCount - 1;
+		placement.x = shelfX + m_atlasGutter;
+		placement.y = shelfY + m_atlasGutter;
+		placements.push_back(placement);
+
+		shelfX += paddedWidth;
+		if (paddedHeight > shelfHeight)
+		{
+			shelfHeight = paddedHeight;
+		}
+	}
+
+	return(pageCount);
+}
+
+/***********************************************************
+ *  CopyToAtlasPage()
+ *
+ *  This method is used for copying an image into an RGBA
+ *  atlas page at the passed in position.  The gutter around
+ *  the image is filled with its wrapped edge texels, so
+ *  filtering across the edge of a repeating texture blends
+ *  with the opposite edge as it would with GL_REPEAT.
+ ***********************************************************/
+void TextureArrayPacker::CopyToAtlasPage(const TextureDecodePool::DECODED_IMAGE* pImage,
+	int x, int y, std::vector<unsigned char>& page) const
+{
+	const unsigned char* pixels = GetBasePixels(pImage);
+	int channels = pImage->colorChannels;
+
+	for (int row = -m_atlasGutter; row < pImage->height + m_atlasGutter; row++)
+	{
+		int sourceRow = (row + pImage->height) % pImage->height;
+		if (sourceRow < 0)
+			sourceRow += pImage->height;
+
+		for (int column = -m_atlasGutter; column < pImage->width + m_atlasGutter; column++)
+		{
+			int sourceColumn = (column + pImage->width) % pImage->width;
+			if (sourceColumn < 0)
+				sourceColumn += pImage->width;
+
+			const unsigned char* source = pixels + ((size_t)sourceRow * pImage->width + sourceColumn) * channels;
+			unsigned char* destination = &page[((size_t)(y + row) * m_atlasPageSize + (x + column)) * 4];
+			destination[0] = source[0];
+			destination[1] = source[1];
+			destination[2] = source[2];
+			destination[3] = (channels == 4) ? source[3] : 255;
+		}
+	}
+}
+
+/***********************************************************
+ *  CreateArrayTexture()
+ *
+ *  This method is used for creating an empty RGBA8 texture
+ *  array with room for the passed in number of layers.  The
+ *  new texture is left bound to GL_TEXTURE_2D_ARRAY.
+ ***********************************************************/
+GLuint TextureArrayPacker::CreateArrayTexture(int width, int height, int layers, int maxLevel)
+{
+	GLuint arrayID = 0;
+
+	glGenTextures(1, &arrayID);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, arrayID);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+	// wrapping is done in the shader within each atlas rectangle
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, maxLevel);
+
+	return(arrayID);
+}
+
+/***********************************************************
+ *  GetBasePixels()
+ *
+ *  This method is used for getting the top level pixels of
+ *  an image, whether it was decoded or read from the cache.
+ ***********************************************************/
+const unsigned char* TextureArrayPacker::GetBasePixels(const TextureDecodePool::DECODED_IMAGE* pImage)
+{
+	if (pImage->mipLevels.empty() == false)
+	{
+		return(pImage->mipLevels[0].pixels);
+	}
+
+	return(pImage->pixels);
+}
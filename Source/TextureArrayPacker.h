@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturearraypacker.h
+// ============
+// pack scene textures into texture arrays and atlas layers
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TextureDecodePool.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  TextureArrayPacker
+ *
+ *  This class packs decoded images into GL_TEXTURE_2D_ARRAY
+ *  textures.  Images that share a size with at least one
+ *  other image get a whole layer of an array for that size,
+ *  and the remaining odd sized images are shelf packed into
+ *  the layers of an atlas array, each with a UV rectangle
+ *  for remapping its texture coordinates.  Images too big
+ *  for an atlas page are left unpacked.
+ ***********************************************************/
+class TextureArrayPacker
+{
+public:
+	// constructor
+	TextureArrayPacker(int atlasPageSize = 2048, int atlasGutter = 8);
+	// destructor
+	~TextureArrayPacker();
+
+	struct PACKED_TEXTURE
+	{
+		// array texture holding the image, 0 when not packed
+		GLuint arrayID;
+		// layer of the array holding the image
+		int layer;
+		// offset (xy) and size (zw) of the image within the layer
+		glm::vec4 uvRect;
+	};
+
+	// add a decoded image, which must stay valid until packing
+	void AddImage(const TextureDecodePool::DECODED_IMAGE* pImage);
+	// pack the added images into newly created array textures
+	void CreateGLTextures(std::vector<PACKED_TEXTURE>& packedTextures);
+
+	// array textures created by the last packing
+	const std::vector<GLuint>& GetArrayIDs() const;
+
+private:
+	struct ATLAS_PLACEMENT
+	{
+		int imageIndex;
+		int page;
+		int x;
+		int y;
+	};
+
+	// size of each square atlas layer
+	int m_atlasPageSize;
+	// border, in texels, repeated around each atlas entry
+	int m_atlasGutter;
+	// images to pack, in the order they were added
+	std::vector<const TextureDecodePool::DECODED_IMAGE*> m_images;
+	// array textures created by the last packing
+	std::vector<GLuint> m_arrayIDs;
+
+	// shelf pack the odd sized images into atlas pages
+	int PlaceAtlasImages(const std::vector<int>& imageIndices,
+		std::vector<ATLAS_PLACEMENT>& placements) const;
+	// copy an image with repeated edges into an RGBA atlas page
+	void CopyToAtlasPage(const TextureDecodePool::DECODED_IMAGE* pImage,
+		int x, int y, std::vector<unsigned char>& page) const;
+	// create an empty RGBA8 array texture
+	static GLuint CreateArrayTexture(int width, int height, int layers, int maxLevel);
+	// get the top level pixels of a decoded or cached image
+	static const unsigned char* GetBasePixels(const TextureDecodePool::DECODED_IMAGE* pImage);
+};
@@ -0,0 +1,622 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecache.cpp
+// ============
+// persistent on-disk cache of decoded texture images and mipmaps
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureCache.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+// declaration of the cache file layout
+namespace
+{
+	// "TXC1" - identifies a texture cache file
+	const uint32_t g_CacheMagic = 0x31435854;
+	// bumped whenever the layout below changes
+	const uint32_t g_CacheVersion = 2;
+	// every mip level starts on this byte boundary
+	const uint64_t g_LevelAlignment = 16;
+
+	// the file starts with this header, followed by the
+	// level table, the source path and then the pixels
+	struct CACHE_HEADER
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t sourceModifiedTime;
+		uint64_t sourceSize;
+		uint32_t width;
+		uint32_t height;
+		uint32_t colorChannels;
+		uint32_t levelCount;
+		uint32_t pathLength;
+		// TextureCompressor::BLOCK_FORMAT of the levels
+		uint32_t blockFormat;
+		// quality of the compressed top level, 0 when uncompressed
+		float psnr;
+		uint32_t reserved;
+	};
+
+	struct CACHE_LEVEL
+	{
+		uint32_t width;
+		uint32_t height;
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	// used to give concurrent writers their own temporary file
+	std::atomic<unsigned int> g_TempFileCounter(0);
+
+	uint64_t AlignOffset(uint64_t offset)
+	{
+		return((offset + g_LevelAlignment - 1) & ~(g_LevelAlignment - 1));
+	}
+
+	// expected byte size of a level in the passed in format
+	uint64_t GetLevelSize(uint32_t blockFormat, uint32_t width, uint32_t height, uint32_t colorChannels)
+	{
+		if (blockFormat != TextureCompressor::BLOCK_FORMAT_NONE)
+		{
+			return((uint64_t)TextureCompressor::GetCompressedSize(
+				(TextureCompressor::BLOCK_FORMAT)blockFormat, (int)width, (int)height));
+		}
+		return((uint64_t)width * height * colorChannels);
+	}
+}
+
+/***********************************************************
+ *  TextureCache()
+ *
+ *  The constructor for the class.  The cache folder is
+ *  created if it does not exist yet.
+ ***********************************************************/
+TextureCache::TextureCache(const std::string& cacheDirectory)
+{
+	m_cacheDirectory = cacheDirectory;
+	m_hitCount = 0;
+	m_missCount = 0;
+
+#ifdef _WIN32
+	_mkdir(m_cacheDirectory.c_str());
+#else
+	mkdir(m_cacheDirectory.c_str(), 0755);
+#endif
+}
+
+/***********************************************************
+ *  ~TextureCache()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureCache::~TextureCache()
+{
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for mapping the current cache entry
+ *  of the passed in source image.  A missing or stale entry
+ *  is counted as a miss.
+ ***********************************************************/
+bool TextureCache::Load(const std::string& filename, TextureDecodePool::DECODED_IMAGE& image)
+{
+	if (MapEntry(GetCacheFilename(filename), filename, TextureCompressor::BLOCK_FORMAT_NONE, image) == false)
+	{
+		m_missCount++;
+		return(false);
+	}
+
+	m_hitCount++;
+	return(true);
+}
+
+/***********************************************************
+ *  Reload()
+ *
+ *  This method is used for mapping the cache entry of a
+ *  source image again after it was loaded once, such as to
+ *  restore levels the residency manager dropped.  It is not
+ *  counted as a hit or a miss, so the counts only measure
+ *  how often the cache spared a decode.
+ ***********************************************************/
+bool TextureCache::Reload(const std::string& filename, TextureDecodePool::DECODED_IMAGE& image)
+{
+	return(MapEntry(GetCacheFilename(filename), filename, TextureCompressor::BLOCK_FORMAT_NONE, image));
+}
+
+/***********************************************************
+ *  Store()
+ *
+ *  This method is used for building the whole mip chain of
+ *  the passed in decoded image with a 2x2 box filter and
+ *  writing it, together with the source stamp, to the cache
+ *  file of the image.  On success the decoded pixels are
+ *  freed and the image is switched over to the mip chain in
+ *  the mapped cache file.
+ ***********************************************************/
+bool TextureCache::Store(const std::string& filename, TextureDecodePool::DECODED_IMAGE& image)
+{
+	if ((NULL == image.pixels) || (image.width <= 0) || (image.height <= 0))
+	{
+		return(false);
+	}
+
+	std::vector<std::vector<unsigned char> > levelPixels;
+	BuildMipChain(image.pixels, image.width, image.height, image.colorChannels, levelPixels);
+
+	std::vector<TextureDecodePool::MIP_LEVEL> mipLevels;
+	int levelWidth = image.width;
+	int levelHeight = image.height;
+	for (size_t i = 0; i <= levelPixels.size(); i++)
+	{
+		TextureDecodePool::MIP_LEVEL mipLevel;
+		mipLevel.width = levelWidth;
+		mipLevel.height = levelHeight;
+		mipLevel.size = (size_t)levelWidth * levelHeight * image.colorChannels;
+		mipLevel.pixels = (i == 0) ? image.pixels : &levelPixels[i - 1][0];
+		mipLevels.push_back(mipLevel);
+
+		levelWidth = (levelWidth > 1) ? levelWidth / 2 : 1;
+		levelHeight = (levelHeight > 1) ? levelHeight / 2 : 1;
+	}
+
+	std::string cacheFilename = GetCacheFilename(filename);
+	if (WriteEntry(cacheFilename, filename, image.width, image.height, image.colorChannels,
+		TextureCompressor::BLOCK_FORMAT_NONE, 0.0f, mipLevels) == false)
+	{
+		return(false);
+	}
+
+	// upload from the written entry so the mip chain is reused
+	TextureDecodePool::DECODED_IMAGE cached = image;
+	cached.pixels = NULL;
+	cached.pMappedFile = NULL;
+	if (MapEntry(cacheFilename, filename, TextureCompressor::BLOCK_FORMAT_NONE, cached) == true)
+	{
+		TextureDecodePool::FreeImage(image);
+		image = cached;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  LoadCompressed()
+ *
+ *  This method is used for mapping the compressed file kept
+ *  next to a source image, such as "textures/desk.jpg.bc7",
+ *  when it is current and in the requested block format.
+ ***********************************************************/
+bool TextureCache::LoadCompressed(const std::string& filename,
+	TextureCompressor::BLOCK_FORMAT blockFormat, TextureDecodePool::DECODED_IMAGE& image)
+{
+	return(MapEntry(GetCompressedFilename(filename, blockFormat), filename, blockFormat, image));
+}
+
+/***********************************************************
+ *  StoreCompressed()
+ *
+ *  This method is used for compressing every level of the
+ *  mip chain of a decoded image and writing the blocks to
+ *  the compressed file next to the source image.  An image
+ *  without a mip chain gets one built first.  The quality of
+ *  the top level is measured and kept in the file.  On
+ *  success the image is switched over to the compressed
+ *  levels in the mapped file.
+ ***********************************************************/
+bool TextureCache::StoreCompressed(const std::string& filename,
+	const TextureCompressor& compressor, TextureDecodePool::DECODED_IMAGE& image)
+{
+	if (((NULL == image.pixels) && (image.mipLevels.empty() == true)) ||
+		(image.blockFormat != TextureCompressor::BLOCK_FORMAT_NONE))
+	{
+		return(false);
+	}
+
+	// use the cached mip chain, or build one from the decoded pixels
+	std::vector<std::vector<unsigned char> > levelPixels;
+	std::vector<TextureDecodePool::MIP_LEVEL> sourceLevels = image.mipLevels;
+	if (sourceLevels.empty() == true)
+	{
+		BuildMipChain(image.pixels, image.width, image.height, image.colorChannels, levelPixels);
+
+		int levelWidth = image.width;
+		int levelHeight = image.height;
+		for (size_t i = 0; i <= levelPixels.size(); i++)
+		{
+			TextureDecodePool::MIP_LEVEL mipLevel;
+			mipLevel.width = levelWidth;
+			mipLevel.height = levelHeight;
+			mipLevel.size = (size_t)levelWidth * levelHeight * image.colorChannels;
+			mipLevel.pixels = (i == 0) ? image.pixels : &levelPixels[i - 1][0];
+			sourceLevels.push_back(mipLevel);
+
+			levelWidth = (levelWidth > 1) ? levelWidth / 2 : 1;
+			levelHeight = (levelHeight > 1) ? levelHeight / 2 : 1;
+		}
+	}
+
+	// compress every level of the chain
+	TextureCompressor::BLOCK_FORMAT blockFormat = compressor.GetBlockFormat();
+	std::vector<std::vector<unsigned char> > levelBlocks(sourceLevels.size());
+	std::vector<TextureDecodePool::MIP_LEVEL> compressedLevels = sourceLevels;
+	for (size_t i = 0; i < sourceLevels.size(); i++)
+	{
+		compressor.CompressLevel(sourceLevels[i].pixels, sourceLevels[i].width,
+			sourceLevels[i].height, image.colorChannels, levelBlocks[i]);
+		compressedLevels[i].size = levelBlocks[i].size();
+		compressedLevels[i].pixels = &levelBlocks[i][0];
+	}
+
+	float psnr = (float)TextureCompressor::ComputePSNR(blockFormat, sourceLevels[0].pixels,
+		image.width, image.height, image.colorChannels, &levelBlocks[0][0]);
+
+	std::string compressedFilename = GetCompressedFilename(filename, blockFormat);
+	if (WriteEntry(compressedFilename, filename, image.width, image.height, image.colorChannels,
+		blockFormat, psnr, compressedLevels) == false)
+	{
+		return(false);
+	}
+
+	TextureDecodePool::DECODED_IMAGE compressed = image;
+	compressed.pixels = NULL;
+	compressed.pMappedFile = NULL;
+	if (MapEntry(compressedFilename, filename, blockFormat, compressed) == false)
+	{
+		return(false);
+	}
+
+	TextureDecodePool::FreeImage(image);
+	image = compressed;
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetHitCount()
+ *
+ *  This method is used for getting how many images were
+ *  loaded from the cache.
+ ***********************************************************/
+int TextureCache::GetHitCount() const
+{
+	return(m_hitCount);
+}
+
+/***********************************************************
+ *  GetMissCount()
+ *
+ *  This method is used for getting how many images were not
+ *  found in the cache or had a stale cache entry.
+ ***********************************************************/
+int TextureCache::GetMissCount() const
+{
+	return(m_missCount);
+}
+
+/***********************************************************
+ *  IsCurrent()
+ *
+ *  This method is used for checking whether the passed in
+ *  source image has a current entry, so loading it will not
+ *  read or decode the source image.  With a block format, a
+ *  current raw entry is enough, since it is compressed from
+ *  the cached mip chain.  The hit and miss counters are not
+ *  touched.
+ ***********************************************************/
+bool TextureCache::IsCurrent(const std::string& filename, TextureCompressor::BLOCK_FORMAT blockFormat)
+{
+	TextureDecodePool::DECODED_IMAGE image;
+	TextureDecodePool::ResetImage(image);
+
+	bool bCurrent = ((blockFormat != TextureCompressor::BLOCK_FORMAT_NONE) &&
+		(MapEntry(GetCompressedFilename(filename, blockFormat), filename, blockFormat, image) == true));
+	if (bCurrent == false)
+	{
+		bCurrent = MapEntry(GetCacheFilename(filename), filename, TextureCompressor::BLOCK_FORMAT_NONE, image);
+	}
+	TextureDecodePool::FreeImage(image);
+
+	return(bCurrent);
+}
+
+/***********************************************************
+ *  BuildMipChain()
+ *
+ *  This method is used for generating every mip level below
+ *  the passed in pixels with a 2x2 box filter, down to 1x1.
+ *  Odd sized levels repeat their last row or column.
+ ***********************************************************/
+void TextureCache::BuildMipChain(const unsigned char* pixels, int width, int height,
+	int colorChannels, std::vector<std::vector<unsigned char> >& levelPixels)
+{
+	int levelWidth = width;
+	int levelHeight = height;
+
+	levelPixels.clear();
+	while ((levelWidth > 1) || (levelHeight > 1))
+	{
+		int nextWidth = (levelWidth > 1) ? levelWidth / 2 : 1;
+		int nextHeight = (levelHeight > 1) ? levelHeight / 2 : 1;
+		const unsigned char* source = levelPixels.empty() ? pixels : &levelPixels.back()[0];
+		std::vector<unsigned char> next((size_t)nextWidth * nextHeight * colorChannels);
+
+		for (int y = 0; y < nextHeight; y++)
+		{
+			int y0 = y * 2;
+			int y1 = (y0 + 1 < levelHeight) ? y0 + 1 : y0;
+			for (int x = 0; x < nextWidth; x++)
+			{
+				int x0 = x * 2;
+				int x1 = (x0 + 1 < levelWidth) ? x0 + 1 : x0;
+				for (int c = 0; c < colorChannels; c++)
+				{
+					int sum = source[((size_t)y0 * levelWidth + x0) * colorChannels + c] +
+						source[((size_t)y0 * levelWidth + x1) * colorChannels + c] +
+						source[((size_t)y1 * levelWidth + x0) * colorChannels + c] +
+						source[((size_t)y1 * levelWidth + x1) * colorChannels + c];
+					next[((size_t)y * nextWidth + x) * colorChannels + c] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+
+		levelPixels.push_back(next);
+		levelWidth = nextWidth;
+		levelHeight = nextHeight;
+	}
+}
+
+/***********************************************************
+ *  WriteEntry()
+ *
+ *  This method is used for writing a mip chain, together
+ *  with the stamp of its source image, to an entry file.
+ *  The file is written under a temporary name first so a
+ *  reader never maps a half written entry.
+ ***********************************************************/
+bool TextureCache::WriteEntry(const std::string& entryFilename, const std::string& filename,
+	int width, int height, int colorChannels, TextureCompressor::BLOCK_FORMAT blockFormat,
+	float psnr, const std::vector<TextureDecodePool::MIP_LEVEL>& mipLevels)
+{
+	uint64_t modifiedTime = 0;
+	uint64_t fileSize = 0;
+
+	if ((mipLevels.empty() == true) || (GetSourceStamp(filename, modifiedTime, fileSize) == false))
+	{
+		return(false);
+	}
+
+	// lay out the file and assign each level its offset
+	CACHE_HEADER header;
+	memset(&header, 0, sizeof(header));
+	header.magic = g_CacheMagic;
+	header.version = g_CacheVersion;
+	header.sourceModifiedTime = modifiedTime;
+	header.sourceSize = fileSize;
+	header.width = (uint32_t)width;
+	header.height = (uint32_t)height;
+	header.colorChannels = (uint32_t)colorChannels;
+	header.levelCount = (uint32_t)mipLevels.size();
+	header.pathLength = (uint32_t)filename.size();
+	header.blockFormat = (uint32_t)blockFormat;
+	header.psnr = psnr;
+
+	std::vector<CACHE_LEVEL> levels(mipLevels.size());
+	uint64_t offset = sizeof(CACHE_HEADER) + levels.size() * sizeof(CACHE_LEVEL) + filename.size();
+	for (size_t i = 0; i < levels.size(); i++)
+	{
+		offset = AlignOffset(offset);
+		levels[i].width = (uint32_t)mipLevels[i].width;
+		levels[i].height = (uint32_t)mipLevels[i].height;
+		levels[i].offset = offset;
+		levels[i].size = (uint64_t)mipLevels[i].size;
+		offset += levels[i].size;
+	}
+
+	char suffix[32];
+	snprintf(suffix, sizeof(suffix), ".%u.tmp", g_TempFileCounter++);
+	std::string tempFilename = entryFilename + suffix;
+
+	std::ofstream file(tempFilename.c_str(), std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		return(false);
+	}
+
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)&levels[0], levels.size() * sizeof(CACHE_LEVEL));
+	file.write(filename.c_str(), filename.size());
+
+	uint64_t written = sizeof(CACHE_HEADER) + levels.size() * sizeof(CACHE_LEVEL) + filename.size();
+	const char padding[g_LevelAlignment] = { 0 };
+	for (size_t i = 0; i < levels.size(); i++)
+	{
+		file.write(padding, (std::streamsize)(levels[i].offset - written));
+		file.write((const char*)mipLevels[i].pixels, (std::streamsize)levels[i].size);
+		written = levels[i].offset + levels[i].size;
+	}
+
+	file.close();
+	if (!file)
+	{
+		std::remove(tempFilename.c_str());
+		return(false);
+	}
+
+	// rename does not replace an existing file on Windows
+	std::remove(entryFilename.c_str());
+	if (std::rename(tempFilename.c_str(), entryFilename.c_str()) != 0)
+	{
+		std::remove(tempFilename.c_str());
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  MapEntry()
+ *
+ *  This method is used for mapping an entry file.  The entry
+ *  is only used when the source path, modification time and
+ *  size all match, and it holds the expected block format.
+ *  On success the mip chain of the image points into the
+ *  mapped file.
+ ***********************************************************/
+bool TextureCache::MapEntry(const std::string& entryFilename, const std::string& filename,
+	TextureCompressor::BLOCK_FORMAT blockFormat, TextureDecodePool::DECODED_IMAGE& image)
+{
+	uint64_t modifiedTime = 0;
+	uint64_t fileSize = 0;
+
+	if (GetSourceStamp(filename, modifiedTime, fileSize) == false)
+	{
+		return(false);
+	}
+
+	MappedFile* pMappedFile = new MappedFile();
+	if (pMappedFile->Open(entryFilename) == false)
+	{
+		delete pMappedFile;
+		return(false);
+	}
+
+	const unsigned char* pData = pMappedFile->GetData();
+	size_t dataSize = pMappedFile->GetSize();
+	bool bValid = false;
+	CACHE_HEADER header;
+
+	// check the header against the current state of the source image
+	if (dataSize >= sizeof(CACHE_HEADER))
+	{
+		memcpy(&header, pData, sizeof(CACHE_HEADER));
+		uint64_t tableEnd = sizeof(CACHE_HEADER) + (uint64_t)header.levelCount * sizeof(CACHE_LEVEL);
+
+		bValid = (header.magic == g_CacheMagic) &&
+			(header.version == g_CacheVersion) &&
+			(header.sourceModifiedTime == modifiedTime) &&
+			(header.sourceSize == fileSize) &&
+			(header.blockFormat == (uint32_t)blockFormat) &&
+			(header.levelCount > 0) &&
+			(tableEnd + header.pathLength <= dataSize) &&
+			(header.pathLength == filename.size()) &&
+			(memcmp(pData + tableEnd, filename.c_str(), header.pathLength) == 0);
+	}
+
+	// point the mip chain at the pixels inside the mapped file
+	std::vector<TextureDecodePool::MIP_LEVEL> mipLevels;
+	for (uint32_t i = 0; (bValid == true) && (i < header.levelCount); i++)
+	{
+		CACHE_LEVEL level;
+		memcpy(&level, pData + sizeof(CACHE_HEADER) + i * sizeof(CACHE_LEVEL), sizeof(CACHE_LEVEL));
+
+		if ((level.offset + level.size > dataSize) ||
+			(level.size != GetLevelSize(header.blockFormat, level.width, level.height, header.colorChannels)))
+		{
+			bValid = false;
+		}
+		else
+		{
+			TextureDecodePool::MIP_LEVEL mipLevel;
+			mipLevel.width = (int)level.width;
+			mipLevel.height = (int)level.height;
+			mipLevel.size = (size_t)level.size;
+			mipLevel.pixels = pData + level.offset;
+			mipLevels.push_back(mipLevel);
+		}
+	}
+
+	if (bValid == false)
+	{
+		delete pMappedFile;
+		return(false);
+	}
+
+	image.width = (int)header.width;
+	image.height = (int)header.height;
+	image.colorChannels = (int)header.colorChannels;
+	image.blockFormat = (int)header.blockFormat;
+	image.compressionPSNR = header.psnr;
+	image.mipLevels = mipLevels;
+	image.pMappedFile = pMappedFile;
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetCacheFilename()
+ *
+ *  This method is used for getting the path of the cache
+ *  file for a source image.  The name is a 64-bit FNV-1a
+ *  hash of the source path, and the full path is stored in
+ *  the file to catch hash collisions.
+ ***********************************************************/
+std::string TextureCache::GetCacheFilename(const std::string& filename) const
+{
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < filename.size(); i++)
+	{
+		hash ^= (unsigned char)filename[i];
+		hash *= 1099511628211ULL;
+	}
+
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.texc", (unsigned long long)hash);
+
+	return(m_cacheDirectory + "/" + name);
+}
+
+/***********************************************************
+ *  GetCompressedFilename()
+ *
+ *  This method is used for getting the path of the block
+ *  compressed file kept next to a source image.
+ ***********************************************************/
+std::string TextureCache::GetCompressedFilename(const std::string& filename,
+	TextureCompressor::BLOCK_FORMAT blockFormat)
+{
+	return(filename + "." + TextureCompressor::GetFormatName(blockFormat));
+}
+
+/***********************************************************
+ *  GetSourceStamp()
+ *
+ *  This method is used for getting the modification time
+ *  and size of a source image, which together with the path
+ *  form the key of its cache entry.
+ ***********************************************************/
+bool TextureCache::GetSourceStamp(const std::string& filename, uint64_t& modifiedTime, uint64_t& fileSize)
+{
+#ifdef _WIN32
+	struct _stat64 fileInfo;
+	if (_stat64(filename.c_str(), &fileInfo) != 0)
+	{
+		return(false);
+	}
+#else
+	struct stat fileInfo;
+	if (stat(filename.c_str(), &fileInfo) != 0)
+	{
+		return(false);
+	}
+#endif
+
+	modifiedTime = (uint64_t)fileInfo.st_mtime;
+	fileSize = (uint64_t)fileInfo.st_size;
+
+	return(true);
+}
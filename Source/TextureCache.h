@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecache.h
+// ============
+// persistent on-disk cache of decoded texture images and mipmaps
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TextureCompressor.h"
+#include "TextureDecodePool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  TextureCache
+ *
+ *  This class keeps decoded, vertically flipped texture
+ *  pixels and their whole mip chain in binary files on disk.
+ *  Entries are keyed by the source image path, modification
+ *  time and size, and are memory mapped when loaded so the
+ *  levels can be uploaded straight from the mapped file.
+ *  Block compressed mip chains use the same layout, but are
+ *  kept next to their source image.
+ ***********************************************************/
+class TextureCache
+{
+public:
+	// constructor
+	TextureCache(const std::string& cacheDirectory);
+	// destructor
+	~TextureCache();
+
+	// map the cached mip chain for a source image, if it is current
+	bool Load(const std::string& filename, TextureDecodePool::DECODED_IMAGE& image);
+	// map the cached mip chain again for a texture already loaded, without counting it
+	bool Reload(const std::string& filename, TextureDecodePool::DECODED_IMAGE& image);
+	// build the mip chain for a decoded image and write it to the cache
+	bool Store(const std::string& filename, TextureDecodePool::DECODED_IMAGE& image);
+
+	// map the block compressed mip chain stored next to a source image
+	bool LoadCompressed(const std::string& filename,
+		TextureCompressor::BLOCK_FORMAT blockFormat, TextureDecodePool::DECODED_IMAGE& image);
+	// compress the mip chain of an image and store it next to the source image
+	bool StoreCompressed(const std::string& filename,
+		const TextureCompressor& compressor, TextureDecodePool::DECODED_IMAGE& image);
+	// check whether a source image can be loaded without decoding it
+	bool IsCurrent(const std::string& filename, TextureCompressor::BLOCK_FORMAT blockFormat);
+
+	// generate the levels below the passed in pixels with a box filter
+	static void BuildMipChain(const unsigned char* pixels, int width, int height,
+		int colorChannels, std::vector<std::vector<unsigned char> >& levelPixels);
+
+	// number of cache hits and misses since construction
+	int GetHitCount() const;
+	int GetMissCount() const;
+
+private:
+	// folder holding the cache files
+	std::string m_cacheDirectory;
+	// counters for the load timing report, shared by the decode workers
+	std::atomic<int> m_hitCount;
+	std::atomic<int> m_missCount;
+
+	// write a mip chain and the source stamp to an entry file
+	bool WriteEntry(const std::string& entryFilename, const std::string& filename,
+		int width, int height, int colorChannels, TextureCompressor::BLOCK_FORMAT blockFormat,
+		float psnr, const std::vector<TextureDecodePool::MIP_LEVEL>& mipLevels);
+	// map a current entry file without touching the counters
+	bool MapEntry(const std::string& entryFilename, const std::string& filename,
+		TextureCompressor::BLOCK_FORMAT blockFormat, TextureDecodePool::DECODED_IMAGE& image);
+	// get the cache file path used for a source image
+	std::string GetCacheFilename(const std::string& filename) const;
+	// get the compressed file path kept next to a source image
+	static std::string GetCompressedFilename(const std::string& filename,
+		TextureCompressor::BLOCK_FORMAT blockFormat);
+	// get the modification time and size of a source image
+	static bool GetSourceStamp(const std::string& filename, uint64_t& modifiedTime, uint64_t& fileSize);
+};
@@ -0,0 +1,883 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecompressor.cpp
+// ============
+// encode texture images into BC1, BC3 or BC7 compressed blocks
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureCompressor.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define TEXTURE_COMPRESSOR_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+// declaration of the block encoding helpers
+namespace
+{
+	// interpolation weights of the 4-bit BC7 indices
+	const int g_BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	/***********************************************************
+	 *  LoadBlock()
+	 *
+	 *  Gather the 4x4 block of pixels at the passed in block
+	 *  position as floats, repeating the edge pixels for blocks
+	 *  that hang over the edge of the image.
+	 ***********************************************************/
+	void LoadBlock(const unsigned char* pixels, int width, int height, int colorChannels,
+		int blockX, int blockY, float block[16][4])
+	{
+		for (int y = 0; y < 4; y++)
+		{
+			int row = blockY * 4 + y;
+			if (row >= height)
+				row = height - 1;
+			for (int x = 0; x < 4; x++)
+			{
+				int column = blockX * 4 + x;
+				if (column >= width)
+					column = width - 1;
+				const unsigned char* source = pixels + ((size_t)row * width + column) * colorChannels;
+				block[y * 4 + x][0] = source[0];
+				block[y * 4 + x][1] = source[1];
+				block[y * 4 + x][2] = source[2];
+				block[y * 4 + x][3] = (colorChannels == 4) ? source[3] : 255.0f;
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  FindEndpoints()
+	 *
+	 *  Fit a line through the block colors along their
+	 *  principal axis, found by power iteration on the
+	 *  covariance matrix, and return the extreme points of the
+	 *  block projected onto that line.
+	 ***********************************************************/
+	void FindEndpoints(const float block[16][4], int components, float low[4], float high[4])
+	{
+		float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float minimum[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+		float maximum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+		for (int i = 0; i < 16; i++)
+		{
+			for (int c = 0; c < components; c++)
+			{
+				mean[c] += block[i][c];
+				if (block[i][c] < minimum[c])
+					minimum[c] = block[i][c];
+				if (block[i][c] > maximum[c])
+					maximum[c] = block[i][c];
+			}
+		}
+
+		float covariance[4][4];
+		memset(covariance, 0, sizeof(covariance));
+		for (int c = 0; c < components; c++)
+		{
+			mean[c] /= 16.0f;
+		}
+		for (int i = 0; i < 16; i++)
+		{
+			for (int r = 0; r < components; r++)
+			{
+				for (int c = 0; c < components; c++)
+				{
+					covariance[r][c] += (block[i][r] - mean[r]) * (block[i][c] - mean[c]);
+				}
+			}
+		}
+
+		// start from the bounding box diagonal
+		float axis[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (int c = 0; c < components; c++)
+		{
+			axis[c] = maximum[c] - minimum[c];
+		}
+		for (int iteration = 0; iteration < 8; iteration++)
+		{
+			float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			float length = 0.0f;
+			for (int r = 0; r < components; r++)
+			{
+				for (int c = 0; c < components; c++)
+				{
+					next[r] += covariance[r][c] * axis[c];
+				}
+				length += next[r] * next[r];
+			}
+			if (length < 1e-12f)
+				break;
+			length = 1.0f / std::sqrt(length);
+			for (int c = 0; c < components; c++)
+			{
+				axis[c] = next[c] * length;
+			}
+		}
+
+		float lowest = 0.0f;
+		float highest = 0.0f;
+		float axisLength = 0.0f;
+		for (int c = 0; c < components; c++)
+		{
+			axisLength += axis[c] * axis[c];
+		}
+		if (axisLength > 1e-12f)
+		{
+			lowest = FLT_MAX;
+			highest = -FLT_MAX;
+			for (int i = 0; i < 16; i++)
+			{
+				float projection = 0.0f;
+				for (int c = 0; c < components; c++)
+				{
+					projection += (block[i][c] - mean[c]) * axis[c];
+				}
+				projection /= axisLength;
+				if (projection < lowest)
+					lowest = projection;
+				if (projection > highest)
+					highest = projection;
+			}
+		}
+
+		for (int c = 0; c < 4; c++)
+		{
+			if (c < components)
+			{
+				low[c] = mean[c] + lowest * axis[c];
+				high[c] = mean[c] + highest * axis[c];
+			}
+			else
+			{
+				low[c] = 255.0f;
+				high[c] = 255.0f;
+			}
+			low[c] = (low[c] < 0.0f) ? 0.0f : ((low[c] > 255.0f) ? 255.0f : low[c]);
+			high[c] = (high[c] < 0.0f) ? 0.0f : ((high[c] > 255.0f) ? 255.0f : high[c]);
+		}
+	}
+
+	/***********************************************************
+	 *  SelectIndices()
+	 *
+	 *  Pick the palette entry closest to each block pixel.  The
+	 *  palette is passed as separate channel arrays padded to a
+	 *  multiple of four entries, so four entries are compared at
+	 *  a time with SSE2.
+	 ***********************************************************/
+	void SelectIndices(const float block[16][4], const float* paletteR, const float* paletteG,
+		const float* paletteB, const float* paletteA, int paletteSize, unsigned char indices[16])
+	{
+#ifdef TEXTURE_COMPRESSOR_SSE2
+		const __m128i four = _mm_set1_epi32(4);
+		for (int i = 0; i < 16; i++)
+		{
+			__m128 red = _mm_set1_ps(block[i][0]);
+			__m128 green = _mm_set1_ps(block[i][1]);
+			__m128 blue = _mm_set1_ps(block[i][2]);
+			__m128 alpha = _mm_set1_ps(block[i][3]);
+			__m128 bestError = _mm_set1_ps(FLT_MAX);
+			__m128i bestIndex = _mm_setzero_si128();
+			__m128i index = _mm_setr_epi32(0, 1, 2, 3);
+
+			for (int entry = 0; entry < paletteSize; entry += 4)
+			{
+				__m128 dr = _mm_sub_ps(_mm_loadu_ps(paletteR + entry), red);
+				__m128 dg = _mm_sub_ps(_mm_loadu_ps(paletteG + entry), green);
+				__m128 db = _mm_sub_ps(_mm_loadu_ps(paletteB + entry), blue);
+				__m128 da = _mm_sub_ps(_mm_loadu_ps(paletteA + entry), alpha);
+				__m128 error = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)),
+					_mm_add_ps(_mm_mul_ps(db, db), _mm_mul_ps(da, da)));
+
+				__m128i closer = _mm_castps_si128(_mm_cmplt_ps(error, bestError));
+				bestError = _mm_min_ps(error, bestError);
+				bestIndex = _mm_or_si128(_mm_and_si128(closer, index), _mm_andnot_si128(closer, bestIndex));
+				index = _mm_add_epi32(index, four);
+			}
+
+			float laneError[4];
+			int laneIndex[4];
+			_mm_storeu_ps(laneError, bestError);
+			_mm_storeu_si128((__m128i*)laneIndex, bestIndex);
+
+			int best = 0;
+			for (int lane = 1; lane < 4; lane++)
+			{
+				if ((laneError[lane] < laneError[best]) ||
+					((laneError[lane] == laneError[best]) && (laneIndex[lane] < laneIndex[best])))
+				{
+					best = lane;
+				}
+			}
+			indices[i] = (unsigned char)laneIndex[best];
+		}
+#else
+		for (int i = 0; i < 16; i++)
+		{
+			float bestError = FLT_MAX;
+			int bestIndex = 0;
+			for (int entry = 0; entry < paletteSize; entry++)
+			{
+				float dr = paletteR[entry] - block[i][0];
+				float dg = paletteG[entry] - block[i][1];
+				float db = paletteB[entry] - block[i][2];
+				float da = paletteA[entry] - block[i][3];
+				float error = dr * dr + dg * dg + db * db + da * da;
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = entry;
+				}
+			}
+			indices[i] = (unsigned char)bestIndex;
+		}
+#endif
+	}
+
+	unsigned short Pack565(const float color[4])
+	{
+		int red = (int)(color[0] * 31.0f / 255.0f + 0.5f);
+		int green = (int)(color[1] * 63.0f / 255.0f + 0.5f);
+		int blue = (int)(color[2] * 31.0f / 255.0f + 0.5f);
+		return((unsigned short)((red << 11) | (green << 5) | blue));
+	}
+
+	void Unpack565(unsigned short packed, int color[3])
+	{
+		int red = (packed >> 11) & 31;
+		int green = (packed >> 5) & 63;
+		int blue = packed & 31;
+		color[0] = (red << 3) | (red >> 2);
+		color[1] = (green << 2) | (green >> 4);
+		color[2] = (blue << 3) | (blue >> 2);
+	}
+
+	/***********************************************************
+	 *  EncodeColorBlock()
+	 *
+	 *  Encode the colors of a block as a BC1 color block in
+	 *  four color mode - two 5:6:5 endpoints and a 2-bit index
+	 *  per pixel.
+	 ***********************************************************/
+	void EncodeColorBlock(const float block[16][4], unsigned char* output)
+	{
+		float low[4];
+		float high[4];
+		FindEndpoints(block, 3, low, high);
+
+		unsigned short color0 = Pack565(high);
+		unsigned short color1 = Pack565(low);
+		if (color0 < color1)
+		{
+			unsigned short swap = color0;
+			color0 = color1;
+			color1 = swap;
+		}
+
+		unsigned int indexBits = 0;
+		if (color0 != color1)
+		{
+			int endpoint0[3];
+			int endpoint1[3];
+			Unpack565(color0, endpoint0);
+			Unpack565(color1, endpoint1);
+
+			float paletteR[4];
+			float paletteG[4];
+			float paletteB[4];
+			float paletteA[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			paletteR[0] = (float)endpoint0[0];
+			paletteG[0] = (float)endpoint0[1];
+			paletteB[0] = (float)endpoint0[2];
+			paletteR[1] = (float)endpoint1[0];
+			paletteG[1] = (float)endpoint1[1];
+			paletteB[1] = (float)endpoint1[2];
+			paletteR[2] = (float)((2 * endpoint0[0] + endpoint1[0]) / 3);
+			paletteG[2] = (float)((2 * endpoint0[1] + endpoint1[1]) / 3);
+			paletteB[2] = (float)((2 * endpoint0[2] + endpoint1[2]) / 3);
+			paletteR[3] = (float)((endpoint0[0] + 2 * endpoint1[0]) / 3);
+			paletteG[3] = (float)((endpoint0[1] + 2 * endpoint1[1]) / 3);
+			paletteB[3] = (float)((endpoint0[2] + 2 * endpoint1[2]) / 3);
+
+			// alpha is not stored, so it is left out of the error
+			float colors[16][4];
+			memcpy(colors, block, sizeof(colors));
+			for (int i = 0; i < 16; i++)
+			{
+				colors[i][3] = 0.0f;
+			}
+
+			unsigned char indices[16];
+			SelectIndices(colors, paletteR, paletteG, paletteB, paletteA, 4, indices);
+			for (int i = 0; i < 16; i++)
+			{
+				indexBits |= (unsigned int)indices[i] << (i * 2);
+			}
+		}
+
+		output[0] = (unsigned char)(color0 & 0xFF);
+		output[1] = (unsigned char)(color0 >> 8);
+		output[2] = (unsigned char)(color1 & 0xFF);
+		output[3] = (unsigned char)(color1 >> 8);
+		output[4] = (unsigned char)(indexBits & 0xFF);
+		output[5] = (unsigned char)((indexBits >> 8) & 0xFF);
+		output[6] = (unsigned char)((indexBits >> 16) & 0xFF);
+		output[7] = (unsigned char)(indexBits >> 24);
+	}
+
+	/***********************************************************
+	 *  EncodeAlphaBlock()
+	 *
+	 *  Encode the alpha of a block as a BC3 alpha block in
+	 *  eight value mode - two 8-bit endpoints and a 3-bit index
+	 *  per pixel.
+	 ***********************************************************/
+	void EncodeAlphaBlock(const float block[16][4], unsigned char* output)
+	{
+		float minimum = 255.0f;
+		float maximum = 0.0f;
+		for (int i = 0; i < 16; i++)
+		{
+			if (block[i][3] < minimum)
+				minimum = block[i][3];
+			if (block[i][3] > maximum)
+				maximum = block[i][3];
+		}
+
+		int alpha0 = (int)(maximum + 0.5f);
+		int alpha1 = (int)(minimum + 0.5f);
+		unsigned long long indexBits = 0;
+
+		if (alpha0 > alpha1)
+		{
+			for (int i = 0; i < 16; i++)
+			{
+				// 0 is alpha0, 7 is alpha1, and 1 to 6 are the steps between
+				int step = (int)((alpha0 - block[i][3]) * 7.0f / (alpha0 - alpha1) + 0.5f);
+				step = (step < 0) ? 0 : ((step > 7) ? 7 : step);
+				unsigned long long code = (step == 0) ? 0 : ((step == 7) ? 1 : (unsigned long long)(step + 1));
+				indexBits |= code << (i * 3);
+			}
+		}
+
+		output[0] = (unsigned char)alpha0;
+		output[1] = (unsigned char)alpha1;
+		for (int i = 0; i < 6; i++)
+		{
+			output[2 + i] = (unsigned char)((indexBits >> (i * 8)) & 0xFF);
+		}
+	}
+
+	void PutBits(unsigned char* output, int& bitPosition, unsigned int value, int bitCount)
+	{
+		for (int i = 0; i < bitCount; i++)
+		{
+			if ((value >> i) & 1)
+			{
+				output[(bitPosition + i) >> 3] |= (unsigned char)(1 << ((bitPosition + i) & 7));
+			}
+		}
+		bitPosition += bitCount;
+	}
+
+	unsigned int GetBits(const unsigned char* input, int& bitPosition, int bitCount)
+	{
+		unsigned int value = 0;
+		for (int i = 0; i < bitCount; i++)
+		{
+			if ((input[(bitPosition + i) >> 3] >> ((bitPosition + i) & 7)) & 1)
+			{
+				value |= 1u << i;
+			}
+		}
+		bitPosition += bitCount;
+		return(value);
+	}
+
+	/***********************************************************
+	 *  QuantizeBC7Endpoint()
+	 *
+	 *  Quantize an endpoint to 7 bits per channel plus a shared
+	 *  low bit, picking the low bit with the smaller error.
+	 ***********************************************************/
+	void QuantizeBC7Endpoint(const float endpoint[4], int quantized[4], int& pBit)
+	{
+		float bestError = FLT_MAX;
+		for (int candidate = 0; candidate < 2; candidate++)
+		{
+			int values[4];
+			float error = 0.0f;
+			for (int c = 0; c < 4; c++)
+			{
+				int value = (int)std::floor((endpoint[c] - candidate) / 2.0f + 0.5f);
+				value = (value < 0) ? 0 : ((value > 127) ? 127 : value);
+				values[c] = value;
+				float difference = (float)(value * 2 + candidate) - endpoint[c];
+				error += difference * difference;
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				pBit = candidate;
+				memcpy(quantized, values, sizeof(values));
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  EncodeBC7Block()
+	 *
+	 *  Encode a block in BC7 mode 6 - one subset with RGBA
+	 *  endpoints of 7 bits plus a low bit each, and a 4-bit
+	 *  index per pixel.
+	 ***********************************************************/
+	void EncodeBC7Block(const float block[16][4], unsigned char* output)
+	{
+		float low[4];
+		float high[4];
+		FindEndpoints(block, 4, low, high);
+
+		int endpoints[2][4];
+		int pBits[2];
+		QuantizeBC7Endpoint(low, endpoints[0], pBits[0]);
+		QuantizeBC7Endpoint(high, endpoints[1], pBits[1]);
+
+		float paletteR[16];
+		float paletteG[16];
+		float paletteB[16];
+		float paletteA[16];
+		for (int entry = 0; entry < 16; entry++)
+		{
+			float* palette[4] = { paletteR, paletteG, paletteB, paletteA };
+			for (int c = 0; c < 4; c++)
+			{
+				int value0 = endpoints[0][c] * 2 + pBits[0];
+				int value1 = endpoints[1][c] * 2 + pBits[1];
+				palette[c][entry] = (float)(((64 - g_BC7Weights[entry]) * value0 + g_BC7Weights[entry] * value1 + 32) >> 6);
+			}
+		}
+
+		unsigned char indices[16];
+		SelectIndices(block, paletteR, paletteG, paletteB, paletteA, 16, indices);
+
+		// the first index is stored without its top bit, so it must be below 8
+		if (indices[0] >= 8)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				int swap = endpoints[0][c];
+				endpoints[0][c] = endpoints[1][c];
+				endpoints[1][c] = swap;
+			}
+			int swap = pBits[0];
+			pBits[0] = pBits[1];
+			pBits[1] = swap;
+			for (int i = 0; i < 16; i++)
+			{
+				indices[i] = (unsigned char)(15 - indices[i]);
+			}
+		}
+
+		memset(output, 0, 16);
+		int bitPosition = 0;
+		PutBits(output, bitPosition, 1 << 6, 7);
+		for (int c = 0; c < 4; c++)
+		{
+			PutBits(output, bitPosition, (unsigned int)endpoints[0][c], 7);
+			PutBits(output, bitPosition, (unsigned int)endpoints[1][c], 7);
+		}
+		PutBits(output, bitPosition, (unsigned int)pBits[0], 1);
+		PutBits(output, bitPosition, (unsigned int)pBits[1], 1);
+		PutBits(output, bitPosition, indices[0], 3);
+		for (int i = 1; i < 16; i++)
+		{
+			PutBits(output, bitPosition, indices[i], 4);
+		}
+	}
+
+	void DecodeColorBlock(const unsigned char* input, bool bAlwaysFourColors, unsigned char pixels[16][4])
+	{
+		unsigned short color0 = (unsigned short)(input[0] | (input[1] << 8));
+		unsigned short color1 = (unsigned short)(input[2] | (input[3] << 8));
+		unsigned int indexBits = (unsigned int)input[4] | ((unsigned int)input[5] << 8) |
+			((unsigned int)input[6] << 16) | ((unsigned int)input[7] << 24);
+
+		int palette[4][4];
+		Unpack565(color0, palette[0]);
+		Unpack565(color1, palette[1]);
+		palette[0][3] = 255;
+		palette[1][3] = 255;
+		for (int c = 0; c < 3; c++)
+		{
+			if ((color0 > color1) || (bAlwaysFourColors == true))
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+			else
+			{
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+		}
+		palette[2][3] = 255;
+		palette[3][3] = ((color0 > color1) || (bAlwaysFourColors == true)) ? 255 : 0;
+
+		for (int i = 0; i < 16; i++)
+		{
+			int index = (indexBits >> (i * 2)) & 3;
+			for (int c = 0; c < 4; c++)
+			{
+				pixels[i][c] = (unsigned char)palette[index][c];
+			}
+		}
+	}
+
+	void DecodeAlphaBlock(const unsigned char* input, unsigned char pixels[16][4])
+	{
+		int alpha[8];
+		alpha[0] = input[0];
+		alpha[1] = input[1];
+		if (alpha[0] > alpha[1])
+		{
+			for (int i = 2; i < 8; i++)
+			{
+				alpha[i] = ((8 - i) * alpha[0] + (i - 1) * alpha[1]) / 7;
+			}
+		}
+		else
+		{
+			for (int i = 2; i < 6; i++)
+			{
+				alpha[i] = ((6 - i) * alpha[0] + (i - 1) * alpha[1]) / 5;
+			}
+			alpha[6] = 0;
+			alpha[7] = 255;
+		}
+
+		unsigned long long indexBits = 0;
+		for (int i = 0; i < 6; i++)
+		{
+			indexBits |= (unsigned long long)input[2 + i] << (i * 8);
+		}
+		for (int i = 0; i < 16; i++)
+		{
+			pixels[i][3] = (unsigned char)alpha[(indexBits >> (i * 3)) & 7];
+		}
+	}
+
+	void DecodeBC7Block(const unsigned char* input, unsigned char pixels[16][4])
+	{
+		int bitPosition = 0;
+
+		// only mode 6, the one written by the encoder, is decoded
+		if (GetBits(input, bitPosition, 7) != (1u << 6))
+		{
+			memset(pixels, 0, 16 * 4);
+			return;
+		}
+
+		int endpoints[2][4];
+		for (int c = 0; c < 4; c++)
+		{
+			endpoints[0][c] = (int)GetBits(input, bitPosition, 7);
+			endpoints[1][c] = (int)GetBits(input, bitPosition, 7);
+		}
+		int pBit0 = (int)GetBits(input, bitPosition, 1);
+		int pBit1 = (int)GetBits(input, bitPosition, 1);
+
+		for (int i = 0; i < 16; i++)
+		{
+			int index = (int)GetBits(input, bitPosition, (i == 0) ? 3 : 4);
+			for (int c = 0; c < 4; c++)
+			{
+				int value0 = endpoints[0][c] * 2 + pBit0;
+				int value1 = endpoints[1][c] * 2 + pBit1;
+				pixels[i][c] = (unsigned char)(((64 - g_BC7Weights[index]) * value0 + g_BC7Weights[index] * value1 + 32) >> 6);
+			}
+		}
+	}
+
+	size_t GetBlockBytes(TextureCompressor::BLOCK_FORMAT blockFormat)
+	{
+		return((blockFormat == TextureCompressor::BLOCK_FORMAT_BC1) ? 8 : 16);
+	}
+}
+
+/***********************************************************
+ *  TextureCompressor()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureCompressor::TextureCompressor(BLOCK_FORMAT blockFormat, unsigned int threadCount)
+{
+	m_blockFormat = blockFormat;
+	m_threadCount = threadCount;
+	if (m_threadCount == 0)
+	{
+		m_threadCount = std::thread::hardware_concurrency();
+		if (m_threadCount == 0)
+			m_threadCount = 1;
+	}
+}
+
+/***********************************************************
+ *  ~TextureCompressor()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureCompressor::~TextureCompressor()
+{
+}
+
+/***********************************************************
+ *  CompressLevel()
+ *
+ *  This method is used for encoding one mip level of RGB or
+ *  RGBA pixels into compressed blocks.  The rows of blocks
+ *  are split evenly across the worker threads.
+ ***********************************************************/
+void TextureCompressor::CompressLevel(const unsigned char* pixels, int width, int height,
+	int colorChannels, std::vector<unsigned char>& blocks) const
+{
+	int blockRows = (height + 3) / 4;
+	blocks.assign(GetCompressedSize(m_blockFormat, width, height), 0);
+
+	unsigned int threadCount = m_threadCount;
+	if (threadCount > (unsigned int)blockRows)
+		threadCount = (unsigned int)blockRows;
+
+	if (threadCount <= 1)
+	{
+		CompressBlockRows(pixels, width, height, colorChannels, 0, blockRows, &blocks[0]);
+		return;
+	}
+
+	std::vector<std::thread> workers;
+	for (unsigned int i = 0; i < threadCount; i++)
+	{
+		int firstRow = (int)((long long)blockRows * i / threadCount);
+		int lastRow = (int)((long long)blockRows * (i + 1) / threadCount);
+		workers.push_back(std::thread(&TextureCompressor::CompressBlockRows, this,
+			pixels, width, height, colorChannels, firstRow, lastRow, &blocks[0]));
+	}
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+}
+
+/***********************************************************
+ *  CompressBlockRows()
+ *
+ *  This method is used for encoding the rows of blocks from
+ *  firstRow up to, but not including, lastRow.
+ ***********************************************************/
+void TextureCompressor::CompressBlockRows(const unsigned char* pixels, int width, int height,
+	int colorChannels, int firstRow, int lastRow, unsigned char* blocks) const
+{
+	int blockColumns = (width + 3) / 4;
+	size_t blockBytes = GetBlockBytes(m_blockFormat);
+	float block[16][4];
+
+	for (int blockY = firstRow; blockY < lastRow; blockY++)
+	{
+		for (int blockX = 0; blockX < blockColumns; blockX++)
+		{
+			unsigned char* output = blocks + ((size_t)blockY * blockColumns + blockX) * blockBytes;
+			LoadBlock(pixels, width, height, colorChannels, blockX, blockY, block);
+
+			if (m_blockFormat == BLOCK_FORMAT_BC1)
+			{
+				EncodeColorBlock(block, output);
+			}
+			else if (m_blockFormat == BLOCK_FORMAT_BC3)
+			{
+				EncodeAlphaBlock(block, output);
+				EncodeColorBlock(block, output + 8);
+			}
+			else
+			{
+				EncodeBC7Block(block, output);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  DecompressLevel()
+ *
+ *  This method is used for decoding compressed blocks back
+ *  into RGBA pixels, which is how the quality of the encoder
+ *  is measured.  Only BC7 mode 6 blocks are decoded.
+ ***********************************************************/
+void TextureCompressor::DecompressLevel(BLOCK_FORMAT blockFormat, const unsigned char* blocks,
+	int width, int height, std::vector<unsigned char>& pixels)
+{
+	int blockColumns = (width + 3) / 4;
+	int blockRows = (height + 3) / 4;
+	size_t blockBytes = GetBlockBytes(blockFormat);
+	unsigned char block[16][4];
+
+	pixels.assign((size_t)width * height * 4, 0);
+	for (int blockY = 0; blockY < blockRows; blockY++)
+	{
+		for (int blockX = 0; blockX < blockColumns; blockX++)
+		{
+			const unsigned char* input = blocks + ((size_t)blockY * blockColumns + blockX) * blockBytes;
+
+			if (blockFormat == BLOCK_FORMAT_BC1)
+			{
+				DecodeColorBlock(input, false, block);
+			}
+			else if (blockFormat == BLOCK_FORMAT_BC3)
+			{
+				DecodeColorBlock(input + 8, true, block);
+				DecodeAlphaBlock(input, block);
+			}
+			else
+			{
+				DecodeBC7Block(input, block);
+			}
+
+			for (int y = 0; y < 4; y++)
+			{
+				int row = blockY * 4 + y;
+				for (int x = 0; x < 4; x++)
+				{
+					int column = blockX * 4 + x;
+					if ((row < height) && (column < width))
+					{
+						memcpy(&pixels[((size_t)row * width + column) * 4], block[y * 4 + x], 4);
+					}
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  ComputePSNR()
+ *
+ *  This method is used for measuring the peak signal to
+ *  noise ratio, in decibels, of compressed blocks against
+ *  the source pixels.  Alpha is only measured for formats
+ *  that store it.  Identical images report 99 dB.
+ ***********************************************************/
+double TextureCompressor::ComputePSNR(BLOCK_FORMAT blockFormat, const unsigned char* pixels,
+	int width, int height, int colorChannels, const unsigned char* blocks)
+{
+	std::vector<unsigned char> decoded;
+	DecompressLevel(blockFormat, blocks, width, height, decoded);
+
+	int measuredChannels = ((blockFormat == BLOCK_FORMAT_BC1) || (colorChannels == 3)) ? 3 : 4;
+	double squaredError = 0.0;
+	size_t pixelCount = (size_t)width * height;
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		for (int c = 0; c < measuredChannels; c++)
+		{
+			double difference = (double)pixels[i * colorChannels + c] - (double)decoded[i * 4 + c];
+			squaredError += difference * difference;
+		}
+	}
+
+	double meanSquaredError = squaredError / ((double)pixelCount * measuredChannels);
+	if (meanSquaredError <= 0.0)
+	{
+		return(99.0);
+	}
+
+	return(10.0 * std::log10(255.0 * 255.0 / meanSquaredError));
+}
+
+/***********************************************************
+ *  GetCompressedSize()
+ *
+ *  This method is used for getting the size in bytes of a
+ *  compressed mip level.  Partial blocks at the edges of the
+ *  image take up whole blocks.
+ ***********************************************************/
+size_t TextureCompressor::GetCompressedSize(BLOCK_FORMAT blockFormat, int width, int height)
+{
+	return((size_t)((width + 3) / 4) * ((height + 3) / 4) * GetBlockBytes(blockFormat));
+}
+
+/***********************************************************
+ *  GetGLFormat()
+ *
+ *  This method is used for getting the OpenGL internal
+ *  format used to upload the compressed blocks.
+ ***********************************************************/
+GLenum TextureCompressor::GetGLFormat(BLOCK_FORMAT blockFormat)
+{
+	if (blockFormat == BLOCK_FORMAT_BC1)
+		return(GL_COMPRESSED_RGB_S3TC_DXT1_EXT);
+	if (blockFormat == BLOCK_FORMAT_BC3)
+		return(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
+	return(GL_COMPRESSED_RGBA_BPTC_UNORM);
+}
+
+/***********************************************************
+ *  GetFormatName()
+ *
+ *  This method is used for getting the short name of a
+ *  block format, which is also the extension of the files
+ *  written next to the source images.
+ ***********************************************************/
+const char* TextureCompressor::GetFormatName(BLOCK_FORMAT blockFormat)
+{
+	if (blockFormat == BLOCK_FORMAT_BC1)
+		return("bc1");
+	if (blockFormat == BLOCK_FORMAT_BC3)
+		return("bc3");
+	if (blockFormat == BLOCK_FORMAT_BC7)
+		return("bc7");
+	return("none");
+}
+
+/***********************************************************
+ *  ParseFormatName()
+ *
+ *  This method is used for turning a block format name, as
+ *  passed on the command line, into a block format.
+ ***********************************************************/
+TextureCompressor::BLOCK_FORMAT TextureCompressor::ParseFormatName(const char* name)
+{
+	if (strcmp(name, "bc1") == 0)
+		return(BLOCK_FORMAT_BC1);
+	if (strcmp(name, "bc3") == 0)
+		return(BLOCK_FORMAT_BC3);
+	if (strcmp(name, "bc7") == 0)
+		return(BLOCK_FORMAT_BC7);
+	return(BLOCK_FORMAT_NONE);
+}
+
+/***********************************************************
+ *  GetBlockFormat()
+ *
+ *  This method is used for getting the block format the
+ *  compressor encodes into.
+ ***********************************************************/
+TextureCompressor::BLOCK_FORMAT TextureCompressor::GetBlockFormat() const
+{
+	return(m_blockFormat);
+}
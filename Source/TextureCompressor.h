@@ -0,0 +1,73 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecompressor.h
+// ============
+// encode texture images into BC1, BC3 or BC7 compressed blocks
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <vector>
+
+/***********************************************************
+ *  TextureCompressor
+ *
+ *  This class encodes RGB and RGBA pixels into 4x4 block
+ *  compressed formats that can be uploaded directly with
+ *  glCompressedTexImage2D().  The block encoding is spread
+ *  across worker threads, and the palette index search uses
+ *  SSE2 when the compiler targets it.
+ ***********************************************************/
+class TextureCompressor
+{
+public:
+	enum BLOCK_FORMAT
+	{
+		BLOCK_FORMAT_NONE = 0,
+		// RGB, 8 bytes per block
+		BLOCK_FORMAT_BC1 = 1,
+		// RGBA with interpolated alpha, 16 bytes per block
+		BLOCK_FORMAT_BC3 = 2,
+		// RGBA in BC7 mode 6, 16 bytes per block
+		BLOCK_FORMAT_BC7 = 3
+	};
+
+	// constructor - zero threads picks a count from the hardware
+	TextureCompressor(BLOCK_FORMAT blockFormat, unsigned int threadCount = 0);
+	// destructor
+	~TextureCompressor();
+
+	// encode one mip level into compressed blocks
+	void CompressLevel(const unsigned char* pixels, int width, int height,
+		int colorChannels, std::vector<unsigned char>& blocks) const;
+	// decode compressed blocks back into RGBA pixels
+	static void DecompressLevel(BLOCK_FORMAT blockFormat, const unsigned char* blocks,
+		int width, int height, std::vector<unsigned char>& pixels);
+	// peak signal to noise ratio of the compressed blocks against the source
+	static double ComputePSNR(BLOCK_FORMAT blockFormat, const unsigned char* pixels,
+		int width, int height, int colorChannels, const unsigned char* blocks);
+
+	// size in bytes of one compressed mip level
+	static size_t GetCompressedSize(BLOCK_FORMAT blockFormat, int width, int height);
+	// OpenGL internal format of the compressed blocks
+	static GLenum GetGLFormat(BLOCK_FORMAT blockFormat);
+	// short name of the block format, such as "bc7"
+	static const char* GetFormatName(BLOCK_FORMAT blockFormat);
+	// parse a block format name, returning BLOCK_FORMAT_NONE when unknown
+	static BLOCK_FORMAT ParseFormatName(const char* name);
+
+	BLOCK_FORMAT GetBlockFormat() const;
+
+private:
+	BLOCK_FORMAT m_blockFormat;
+	unsigned int m_threadCount;
+
+	// encode the rows of blocks in [firstRow, lastRow)
+	void CompressBlockRows(const unsigned char* pixels, int width, int height,
+		int colorChannels, int firstRow, int lastRow, unsigned char* blocks) const;
+};
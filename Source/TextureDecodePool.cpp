@@ -0,0 +1,341 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturedecodepool.cpp
+// ============
+// decode texture image files on a pool of worker threads
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureDecodePool.h"
+#include "AssetReader.h"
+#include "TextureCache.h"
+#include "TextureCompressor.h"
+
+#include "stb_image.h"
+
+#include <chrono>
+
+/***********************************************************
+ *  TextureDecodePool()
+ *
+ *  The constructor for the class.  The worker threads are
+ *  started here and wait for images to be queued.  When a
+ *  texture cache is passed in, the workers read from and
+ *  fill the cache instead of always decoding.
+ ***********************************************************/
+TextureDecodePool::TextureDecodePool(TextureCache* pTextureCache, unsigned int threadCount)
+{
+	m_pTextureCache = pTextureCache;
+	m_pTextureCompressor = NULL;
+	m_pAssetReader = NULL;
+	m_bStopping = false;
+
+	if (threadCount == 0)
+	{
+		// leave one core for the thread that uploads to OpenGL
+		threadCount = std::thread::hardware_concurrency();
+		if (threadCount > 1)
+			threadCount--;
+		if (threadCount == 0)
+			threadCount = 1;
+	}
+
+	for (unsigned int i = 0; i < threadCount; i++)
+	{
+		m_workers.push_back(std::thread(&TextureDecodePool::WorkerLoop, this));
+	}
+}
+
+/***********************************************************
+ *  ~TextureDecodePool()
+ *
+ *  The destructor for the class.  Any images that were never
+ *  collected with WaitForImage() are freed here.
+ ***********************************************************/
+TextureDecodePool::~TextureDecodePool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopping = true;
+	}
+	m_workAvailable.notify_all();
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+
+	for (size_t i = 0; i < m_images.size(); i++)
+	{
+		FreeImage(m_images[i]);
+	}
+}
+
+/***********************************************************
+ *  QueueDecode()
+ *
+ *  This method is used for adding an image file to the queue
+ *  of files to decode.  The returned ticket is passed to
+ *  WaitForImage() to collect the decoded pixels.
+ ***********************************************************/
+int TextureDecodePool::QueueDecode(const std::string& filename, const std::string& tag)
+{
+	DECODED_IMAGE image;
+	ResetImage(image);
+	image.filename = filename;
+	image.tag = tag;
+
+	int ticket = -1;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		ticket = (int)m_images.size();
+		m_images.push_back(image);
+		m_imageReady.push_back(false);
+		m_pendingTickets.push_back(ticket);
+	}
+	m_workAvailable.notify_one();
+
+	return(ticket);
+}
+
+/***********************************************************
+ *  WaitForImage()
+ *
+ *  This method is used for blocking until the image for the
+ *  passed in ticket has been decoded.  Ownership of the pixel
+ *  data, or of the cache file holding the mip chain, passes
+ *  to the caller, who frees it with FreeImage().
+ ***********************************************************/
+bool TextureDecodePool::WaitForImage(int ticket, DECODED_IMAGE& image)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if ((ticket < 0) || (ticket >= (int)m_images.size()))
+	{
+		return(false);
+	}
+
+	while (m_imageReady[ticket] == false)
+	{
+		m_imageDecoded.wait(lock);
+	}
+
+	image = m_images[ticket];
+	m_images[ticket].pixels = NULL;
+	m_images[ticket].pMappedFile = NULL;
+	m_images[ticket].mipLevels.clear();
+
+	return((image.pixels != NULL) || (image.mipLevels.empty() == false));
+}
+
+/***********************************************************
+ *  IsImageReady()
+ *
+ *  This method is used for checking, without blocking,
+ *  whether the image for the passed in ticket has been
+ *  decoded, so WaitForImage() will return at once.
+ ***********************************************************/
+bool TextureDecodePool::IsImageReady(int ticket)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if ((ticket < 0) || (ticket >= (int)m_images.size()))
+	{
+		return(false);
+	}
+
+	return(m_imageReady[ticket]);
+}
+
+/***********************************************************
+ *  FreeImage()
+ *
+ *  This method is used for freeing the pixel data of an
+ *  image that was decoded by the pool, and for unmapping the
+ *  cache file when the image came from the texture cache.
+ ***********************************************************/
+void TextureDecodePool::FreeImage(DECODED_IMAGE& image)
+{
+	if (NULL != image.pixels)
+	{
+		stbi_image_free(image.pixels);
+		image.pixels = NULL;
+	}
+	if (NULL != image.pMappedFile)
+	{
+		delete image.pMappedFile;
+		image.pMappedFile = NULL;
+	}
+	image.mipLevels.clear();
+}
+
+/***********************************************************
+ *  ResetImage()
+ *
+ *  This method is used for setting every field of an image
+ *  to empty before it is filled, so a field added to the
+ *  image is never left unset.  It frees nothing, so it is
+ *  only called on images that hold no data, or after
+ *  FreeImage().
+ ***********************************************************/
+void TextureDecodePool::ResetImage(DECODED_IMAGE& image)
+{
+	image.filename.clear();
+	image.tag.clear();
+	image.pixels = NULL;
+	image.width = 0;
+	image.height = 0;
+	image.colorChannels = 0;
+	image.decodeMilliseconds = 0.0;
+	image.mipLevels.clear();
+	image.pMappedFile = NULL;
+	image.blockFormat = 0;
+	image.compressionPSNR = 0.0f;
+}
+
+/***********************************************************
+ *  SetTextureCompressor()
+ *
+ *  This method is used for setting the block compressor the
+ *  workers run over each image before handing it back.  The
+ *  compressed mip chain is kept next to the source image by
+ *  the texture cache, so compression needs a texture cache.
+ *  Images with other than 3 or 4 channels stay uncompressed.
+ ***********************************************************/
+void TextureDecodePool::SetTextureCompressor(const TextureCompressor* pTextureCompressor)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_pTextureCompressor = pTextureCompressor;
+}
+
+/***********************************************************
+ *  SetAssetReader()
+ *
+ *  This method is used for setting the asset reader that
+ *  the image files of the queued images were handed to.
+ *  Workers that have to decode an image take its bytes from
+ *  the reader and decode them from memory, so reading the
+ *  remaining files overlaps the decoding.  Files the reader
+ *  does not hold are read by the worker as before.  The
+ *  reader must outlive the pool.
+ ***********************************************************/
+void TextureDecodePool::SetAssetReader(AssetReader* pAssetReader)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_pAssetReader = pAssetReader;
+}
+
+/***********************************************************
+ *  GetThreadCount()
+ *
+ *  This method is used for getting the number of worker
+ *  threads that decode images.
+ ***********************************************************/
+unsigned int TextureDecodePool::GetThreadCount() const
+{
+	return((unsigned int)m_workers.size());
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  This method is run by every worker thread.  It takes the
+ *  next queued ticket, decodes the image file outside of the
+ *  lock, and then publishes the result.  With a texture cache
+ *  a current cache entry is mapped instead of decoding, and a
+ *  freshly decoded image is written to the cache and mapped
+ *  back so its mip chain is ready for upload.  With a block
+ *  compressor a current compressed file is mapped first, and
+ *  otherwise the mip chain is compressed and stored.  Image
+ *  files held by an asset reader are decoded from memory.  The
+ *  vertical flip setting of stb_image is global, so it must
+ *  be set before any images are queued.
+ ***********************************************************/
+void TextureDecodePool::WorkerLoop()
+{
+	while (true)
+	{
+		int ticket = -1;
+		std::string filename;
+		const TextureCompressor* pTextureCompressor = NULL;
+		AssetReader* pAssetReader = NULL;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while ((m_bStopping == false) && (m_pendingTickets.empty() == true))
+			{
+				m_workAvailable.wait(lock);
+			}
+			if (m_pendingTickets.empty() == true)
+			{
+				return;
+			}
+			ticket = m_pendingTickets.front();
+			m_pendingTickets.pop_front();
+			filename = m_images[ticket].filename;
+			pTextureCompressor = (NULL != m_pTextureCache) ? m_pTextureCompressor : NULL;
+			pAssetReader = m_pAssetReader;
+		}
+
+		DECODED_IMAGE decoded;
+		ResetImage(decoded);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		if ((NULL != pTextureCompressor) && (m_pTextureCache->LoadCompressed(
+			filename, pTextureCompressor->GetBlockFormat(), decoded) == true))
+		{
+			// the compressed mip chain is already current
+		}
+		else if ((NULL == m_pTextureCache) || (m_pTextureCache->Load(filename, decoded) == false))
+		{
+			AssetReader::ASSET_BUFFER buffer;
+			if ((NULL != pAssetReader) && (pAssetReader->TakeFile(filename, buffer) == true))
+			{
+				decoded.pixels = stbi_load_from_memory(
+					buffer.data,
+					(int)buffer.size,
+					&decoded.width,
+					&decoded.height,
+					&decoded.colorChannels,
+					0);
+				AssetReader::FreeBuffer(buffer);
+			}
+			else
+			{
+				decoded.pixels = stbi_load(
+					filename.c_str(),
+					&decoded.width,
+					&decoded.height,
+					&decoded.colorChannels,
+					0);
+			}
+
+			// a stored entry is mapped back so the upload skips mip generation
+			if ((NULL != m_pTextureCache) && (NULL != decoded.pixels))
+			{
+				m_pTextureCache->Store(filename, decoded);
+			}
+		}
+
+		if ((NULL != pTextureCompressor) && (decoded.blockFormat == 0) &&
+			((decoded.colorChannels == 3) || (decoded.colorChannels == 4)) &&
+			((NULL != decoded.pixels) || (decoded.mipLevels.empty() == false)))
+		{
+			// keeps the uncompressed image when compressing fails
+			m_pTextureCache->StoreCompressed(filename, *pTextureCompressor, decoded);
+		}
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			// the decoded image takes the place of the queued one,
+			// keeping only the names it was queued with
+			decoded.filename = m_images[ticket].filename;
+			decoded.tag = m_images[ticket].tag;
+			decoded.decodeMilliseconds = elapsed.count();
+			m_images[ticket] = decoded;
+			m_imageReady[ticket] = true;
+		}
+		m_imageDecoded.notify_all();
+	}
+}
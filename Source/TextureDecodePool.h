@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturedecodepool.h
+// ============
+// decode texture image files on a pool of worker threads
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MappedFile.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class AssetReader;
+class TextureCache;
+class TextureCompressor;
+
+/***********************************************************
+ *  TextureDecodePool
+ *
+ *  This class spreads the decoding of texture image files
+ *  across a pool of worker threads.  No OpenGL calls are
+ *  made here - the decoded pixels are handed back to the
+ *  thread that owns the OpenGL context for uploading.
+ ***********************************************************/
+class TextureDecodePool
+{
+public:
+	// constructor - zero threads picks a count from the hardware
+	TextureDecodePool(TextureCache* pTextureCache = NULL, unsigned int threadCount = 0);
+	// destructor
+	~TextureDecodePool();
+
+	struct MIP_LEVEL
+	{
+		int width;
+		int height;
+		size_t size;
+		const unsigned char* pixels;
+	};
+
+	struct DECODED_IMAGE
+	{
+		std::string filename;
+		std::string tag;
+		unsigned char* pixels;
+		int width;
+		int height;
+		int colorChannels;
+		double decodeMilliseconds;
+		// the whole mip chain, when it was read from the texture cache
+		std::vector<MIP_LEVEL> mipLevels;
+		// cache file backing the mip chain pixels
+		MappedFile* pMappedFile;
+		// TextureCompressor::BLOCK_FORMAT of the mip chain, 0 for raw pixels
+		int blockFormat;
+		// quality of the compressed top level in decibels
+		float compressionPSNR;
+	};
+
+	// queue an image file for decoding and get back its ticket
+	int QueueDecode(const std::string& filename, const std::string& tag);
+	// block until the image for the ticket has been decoded
+	bool WaitForImage(int ticket, DECODED_IMAGE& image);
+	// check without blocking whether the image for the ticket is decoded
+	bool IsImageReady(int ticket);
+	// free the pixel data of a decoded image
+	static void FreeImage(DECODED_IMAGE& image);
+	// set every field of an image that holds nothing to empty
+	static void ResetImage(DECODED_IMAGE& image);
+
+	// block compress the images queued after this call
+	void SetTextureCompressor(const TextureCompressor* pTextureCompressor);
+	// take the image files read ahead by an asset reader instead of reading them
+	void SetAssetReader(AssetReader* pAssetReader);
+
+	// number of worker threads in the pool
+	unsigned int GetThreadCount() const;
+
+private:
+	// optional cache of decoded images shared by the workers
+	TextureCache* m_pTextureCache;
+	// optional block compressor used before images are handed back
+	const TextureCompressor* m_pTextureCompressor;
+	// optional reader holding the image files read in one batch
+	AssetReader* m_pAssetReader;
+	// worker threads that decode the queued images
+	std::vector<std::thread> m_workers;
+	// tickets waiting for a worker to pick them up
+	std::deque<int> m_pendingTickets;
+	// decode results indexed by ticket
+	std::vector<DECODED_IMAGE> m_images;
+	std::vector<bool> m_imageReady;
+	// set when the pool is shutting down
+	bool m_bStopping;
+
+	std::mutex m_mutex;
+	std::condition_variable m_workAvailable;
+	std::condition_variable m_imageDecoded;
+
+	// loop run by each of the worker threads
+	void WorkerLoop();
+};
@@ -0,0 +1,476 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureresidency.cpp
+// ============
+// keep texture mip levels resident within a GPU memory budget
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureResidency.h"
+#include "TextureCompressor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+/***********************************************************
+ *  TextureResidency()
+ *
+ *  The constructor for the class.  The focal length starts
+ *  out for an 800 pixel high view with a 45 degree field of
+ *  view.
+ ***********************************************************/
+TextureResidency::TextureResidency(GLResourceTracker* pResourceTracker, TextureCache* pTextureCache, size_t budgetBytes)
+{
+	m_pResourceTracker = pResourceTracker;
+	m_pTextureCache = pTextureCache;
+	m_budgetBytes = budgetBytes;
+	m_residentBytes = 0;
+	m_focalPixels = 965.7f;
+	m_frame = 0;
+	m_droppedLevels = 0;
+	m_restoredLevels = 0;
+	m_maxRestoresPerFrame = 2;
+}
+
+/***********************************************************
+ *  ~TextureResidency()
+ *
+ *  The destructor for the class.  The managed textures are
+ *  owned by the scene, so they are not deleted here.
+ ***********************************************************/
+TextureResidency::~TextureResidency()
+{
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for managing a texture that was
+ *  uploaded with its whole mip chain.  The chain must be in
+ *  the texture cache, raw or block compressed, so dropped
+ *  levels can be brought back.
+ ***********************************************************/
+void TextureResidency::AddTexture(int handle, GLuint textureID, const std::string& filename, int blockFormat)
+{
+	if ((handle < 0) || (textureID == 0))
+	{
+		return;
+	}
+
+	MANAGED_TEXTURE texture;
+	texture.handle = handle;
+	texture.textureID = textureID;
+	texture.filename = filename;
+	texture.blockFormat = blockFormat;
+	texture.residentTop = 0;
+	texture.wantedTop = 0;
+	texture.frameWantedTop = -1;
+	texture.lastUsedFrame = m_frame;
+
+	// read the level sizes back from the texture itself
+	GLint previousTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	for (GLint level = 0; level < 32; level++)
+	{
+		GLint width = 0;
+		GLint height = 0;
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH, &width);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT, &height);
+		if ((width == 0) || (height == 0))
+		{
+			break;
+		}
+
+		texture.levelWidths.push_back(width);
+		texture.levelHeights.push_back(height);
+		if (blockFormat != 0)
+		{
+			texture.levelSizes.push_back(TextureCompressor::GetCompressedSize(
+				(TextureCompressor::BLOCK_FORMAT)blockFormat, width, height));
+		}
+		else
+		{
+			// matches the RGB8 padding counted by GLResourceTracker
+			texture.levelSizes.push_back((size_t)width * height * 4);
+		}
+	}
+	glBindTexture(GL_TEXTURE_2D, (GLuint)previousTexture);
+
+	if (texture.levelSizes.size() < 2)
+	{
+		return;
+	}
+
+	if (handle >= (int)m_handleIndices.size())
+	{
+		m_handleIndices.resize(handle + 1, -1);
+	}
+	m_handleIndices[handle] = (int)m_textures.size();
+	m_residentBytes += GetResidentSize(texture, 0);
+	m_textures.push_back(texture);
+}
+
+/***********************************************************
+ *  MarkUsed()
+ *
+ *  This method is used for recording that an object at the
+ *  passed in distance from the camera samples a texture.
+ *  The top level the object needs is the one with about one
+ *  texel per pixel of the object on screen.
+ ***********************************************************/
+void TextureResidency::MarkUsed(int handle, float distance, float objectSize)
+{
+	if ((handle < 0) || (handle >= (int)m_handleIndices.size()) || (m_handleIndices[handle] < 0))
+	{
+		return;
+	}
+
+	MANAGED_TEXTURE& texture = m_textures[m_handleIndices[handle]];
+	int lastLevel = (int)texture.levelSizes.size() - 1;
+
+	// pixels covered on screen by the object, and the texels across it
+	float screenPixels = objectSize * m_focalPixels / std::max(distance, 0.01f);
+	float texelsPerPixel = (float)std::max(texture.levelWidths[0], texture.levelHeights[0]) / std::max(screenPixels, 1.0f);
+	int wantedTop = (texelsPerPixel > 1.0f) ? (int)std::floor(std::log2(texelsPerPixel)) : 0;
+	wantedTop = std::min(wantedTop, lastLevel);
+
+	if ((texture.frameWantedTop < 0) || (wantedTop < texture.frameWantedTop))
+	{
+		texture.frameWantedTop = wantedTop;
+	}
+	texture.lastUsedFrame = m_frame;
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for planning and applying the level
+ *  changes of the frame.  Textures used this frame that want
+ *  more levels get them back first, most needed first, with
+ *  unused textures dropping levels to make room.  When still
+ *  over budget, the least recently used textures drop their
+ *  top levels one at a time.  Only a few textures gain
+ *  levels per frame, since each one is reloaded.
+ ***********************************************************/
+void TextureResidency::Update(std::vector<REPLACED_TEXTURE>& replaced)
+{
+	replaced.clear();
+
+	std::vector<int> plannedTops(m_textures.size());
+	size_t plannedBytes = m_residentBytes;
+	std::vector<int> restoreOrder;
+
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		MANAGED_TEXTURE& texture = m_textures[i];
+		if (texture.frameWantedTop >= 0)
+		{
+			texture.wantedTop = texture.frameWantedTop;
+			texture.frameWantedTop = -1;
+		}
+		plannedTops[i] = texture.residentTop;
+		if ((texture.lastUsedFrame == m_frame) && (texture.wantedTop < texture.residentTop))
+		{
+			restoreOrder.push_back((int)i);
+		}
+	}
+
+	// bring back levels, largest missing amount first
+	struct RESTORE_ORDER
+	{
+		const std::vector<MANAGED_TEXTURE>* pTextures;
+		bool operator()(int a, int b) const
+		{
+			const MANAGED_TEXTURE& textureA = (*pTextures)[a];
+			const MANAGED_TEXTURE& textureB = (*pTextures)[b];
+			return((textureA.residentTop - textureA.wantedTop) > (textureB.residentTop - textureB.wantedTop));
+		}
+	};
+	RESTORE_ORDER restoreCompare = { &m_textures };
+	std::sort(restoreOrder.begin(), restoreOrder.end(), restoreCompare);
+
+	int restoreCount = 0;
+	for (size_t i = 0; (i < restoreOrder.size()) && (restoreCount < m_maxRestoresPerFrame); i++)
+	{
+		int index = restoreOrder[i];
+		const MANAGED_TEXTURE& texture = m_textures[index];
+		size_t extraBytes = GetResidentSize(texture, texture.wantedTop) - GetResidentSize(texture, plannedTops[index]);
+
+		if (m_budgetBytes > 0)
+		{
+			FreeUnusedLevels(plannedTops, plannedBytes, extraBytes);
+			if (plannedBytes + extraBytes > m_budgetBytes)
+			{
+				continue;
+			}
+		}
+
+		plannedBytes += extraBytes;
+		plannedTops[index] = texture.wantedTop;
+		restoreCount++;
+	}
+
+	// the budget is a hard limit, so drop levels even from textures in use
+	while ((m_budgetBytes > 0) && (plannedBytes > m_budgetBytes))
+	{
+		int index = FindEvictionCandidate(plannedTops, false);
+		if (index < 0)
+		{
+			break;
+		}
+		plannedBytes -= GetResidentSize(m_textures[index], plannedTops[index]) -
+			GetResidentSize(m_textures[index], plannedTops[index] + 1);
+		plannedTops[index]++;
+	}
+
+	// rebuild every texture whose resident levels changed
+	int droppedLevels = 0;
+	int restoredLevels = 0;
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		MANAGED_TEXTURE& texture = m_textures[i];
+		int levelChange = plannedTops[i] - texture.residentTop;
+		if (levelChange == 0)
+		{
+			continue;
+		}
+
+		size_t oldBytes = GetResidentSize(texture, texture.residentTop);
+		if (RebuildTexture(texture, plannedTops[i]) == true)
+		{
+			m_residentBytes = m_residentBytes - oldBytes + GetResidentSize(texture, texture.residentTop);
+			if (levelChange > 0)
+			{
+				droppedLevels += levelChange;
+			}
+			else
+			{
+				restoredLevels -= levelChange;
+			}
+
+			REPLACED_TEXTURE replacedTexture;
+			replacedTexture.handle = texture.handle;
+			replacedTexture.textureID = texture.textureID;
+			replaced.push_back(replacedTexture);
+		}
+	}
+
+	if (replaced.empty() == false)
+	{
+		m_droppedLevels += droppedLevels;
+		m_restoredLevels += restoredLevels;
+		std::cout << "INFO: Texture residency " << m_residentBytes / 1024 << " KB of "
+			<< m_budgetBytes / 1024 << " KB budget (dropped " << droppedLevels
+			<< " levels, restored " << restoredLevels << ")" << std::endl;
+	}
+
+	m_frame++;
+}
+
+/***********************************************************
+ *  SetBudgetBytes()
+ *
+ *  This method is used for changing the memory budget of the
+ *  managed textures.  A budget of 0 turns the limit off.
+ ***********************************************************/
+void TextureResidency::SetBudgetBytes(size_t budgetBytes)
+{
+	m_budgetBytes = budgetBytes;
+}
+
+/***********************************************************
+ *  SetFocalLength()
+ *
+ *  This method is used for setting how many pixels high an
+ *  object one unit tall is at one unit from the camera,
+ *  which turns object distances into wanted levels.
+ ***********************************************************/
+void TextureResidency::SetFocalLength(float focalPixels)
+{
+	m_focalPixels = focalPixels;
+}
+
+/***********************************************************
+ *  GetResidentBytes()
+ *
+ *  This method is used for getting the bytes of the levels
+ *  of the managed textures currently on the GPU.
+ ***********************************************************/
+size_t TextureResidency::GetResidentBytes() const
+{
+	return(m_residentBytes);
+}
+
+/***********************************************************
+ *  GetStats()
+ *
+ *  This method is used for getting the current residency
+ *  statistics of the managed textures.
+ ***********************************************************/
+void TextureResidency::GetStats(RESIDENCY_STATS& stats) const
+{
+	stats.residentBytes = m_residentBytes;
+	stats.fullBytes = 0;
+	stats.budgetBytes = m_budgetBytes;
+	stats.textureCount = (int)m_textures.size();
+	stats.reducedCount = 0;
+	stats.droppedLevels = m_droppedLevels;
+	stats.restoredLevels = m_restoredLevels;
+
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		stats.fullBytes += GetResidentSize(m_textures[i], 0);
+		if (m_textures[i].residentTop > 0)
+		{
+			stats.reducedCount++;
+		}
+	}
+}
+
+/***********************************************************
+ *  GetResidentSize()
+ *
+ *  This method is used for adding up the bytes of the levels
+ *  of a texture from the passed in top level down.
+ ***********************************************************/
+size_t TextureResidency::GetResidentSize(const MANAGED_TEXTURE& texture, int topLevel)
+{
+	size_t byteSize = 0;
+
+	for (size_t level = (size_t)topLevel; level < texture.levelSizes.size(); level++)
+	{
+		byteSize += texture.levelSizes[level];
+	}
+
+	return(byteSize);
+}
+
+/***********************************************************
+ *  FreeUnusedLevels()
+ *
+ *  This method is used for planning the drop of top levels
+ *  from textures not used this frame, least recently used
+ *  first, until the extra bytes fit in the budget.
+ ***********************************************************/
+void TextureResidency::FreeUnusedLevels(std::vector<int>& plannedTops, size_t& plannedBytes, size_t extraBytes) const
+{
+	while (plannedBytes + extraBytes > m_budgetBytes)
+	{
+		int index = FindEvictionCandidate(plannedTops, true);
+		if (index < 0)
+		{
+			return;
+		}
+		plannedBytes -= GetResidentSize(m_textures[index], plannedTops[index]) -
+			GetResidentSize(m_textures[index], plannedTops[index] + 1);
+		plannedTops[index]++;
+	}
+}
+
+/***********************************************************
+ *  FindEvictionCandidate()
+ *
+ *  This method is used for finding the least recently used
+ *  texture that still has a level above its smallest one,
+ *  preferring the larger texture between equally old ones.
+ ***********************************************************/
+int TextureResidency::FindEvictionCandidate(const std::vector<int>& plannedTops, bool bUnusedOnly) const
+{
+	int candidate = -1;
+
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		const MANAGED_TEXTURE& texture = m_textures[i];
+		if ((plannedTops[i] >= (int)texture.levelSizes.size() - 1) ||
+			((bUnusedOnly == true) && (texture.lastUsedFrame == m_frame)))
+		{
+			continue;
+		}
+
+		if (candidate < 0)
+		{
+			candidate = (int)i;
+			continue;
+		}
+
+		const MANAGED_TEXTURE& best = m_textures[candidate];
+		if ((texture.lastUsedFrame < best.lastUsedFrame) ||
+			((texture.lastUsedFrame == best.lastUsedFrame) &&
+			(GetResidentSize(texture, plannedTops[i]) > GetResidentSize(best, plannedTops[candidate]))))
+		{
+			candidate = (int)i;
+		}
+	}
+
+	return(candidate);
+}
+
+/***********************************************************
+ *  RebuildTexture()
+ *
+ *  This method is used for replacing a texture with a new
+ *  one holding only the levels from topLevel down.  The
+ *  levels are uploaded from the mip chain mapped from the
+ *  texture cache, so growing and shrinking work the same
+ *  way.  The old texture is deleted.
+ ***********************************************************/
+bool TextureResidency::RebuildTexture(MANAGED_TEXTURE& texture, int topLevel)
+{
+	TextureDecodePool::DECODED_IMAGE image;
+	TextureDecodePool::ResetImage(image);
+	image.filename = texture.filename;
+
+	bool bLoaded = (texture.blockFormat != 0) ?
+		m_pTextureCache->LoadCompressed(texture.filename, (TextureCompressor::BLOCK_FORMAT)texture.blockFormat, image) :
+		m_pTextureCache->Reload(texture.filename, image);
+	if ((bLoaded == false) || (image.mipLevels.size() != texture.levelSizes.size()))
+	{
+		TextureDecodePool::FreeImage(image);
+		return(false);
+	}
+
+	GLuint textureID = 0;
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	for (size_t level = (size_t)topLevel; level < image.mipLevels.size(); level++)
+	{
+		const TextureDecodePool::MIP_LEVEL& mipLevel = image.mipLevels[level];
+		GLint targetLevel = (GLint)(level - topLevel);
+		if (texture.blockFormat != 0)
+		{
+			glCompressedTexImage2D(GL_TEXTURE_2D, targetLevel,
+				TextureCompressor::GetGLFormat((TextureCompressor::BLOCK_FORMAT)texture.blockFormat),
+				mipLevel.width, mipLevel.height, 0, (GLsizei)mipLevel.size, mipLevel.pixels);
+		}
+		else
+		{
+			glTexImage2D(GL_TEXTURE_2D, targetLevel, (image.colorChannels == 4) ? GL_RGBA8 : GL_RGB8,
+				mipLevel.width, mipLevel.height, 0, (image.colorChannels == 4) ? GL_RGBA : GL_RGB,
+				GL_UNSIGNED_BYTE, mipLevel.pixels);
+		}
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)(image.mipLevels.size() - topLevel - 1));
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	TextureDecodePool::FreeImage(image);
+
+	m_pResourceTracker->Track(GLResourceTracker::RESOURCE_TEXTURE, textureID,
+		GLResourceTracker::MeasureTexture(GL_TEXTURE_2D, textureID), "textures");
+	m_pResourceTracker->Delete(GLResourceTracker::RESOURCE_TEXTURE, texture.textureID);
+
+	texture.textureID = textureID;
+	texture.residentTop = topLevel;
+
+	return(true);
+}
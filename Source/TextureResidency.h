@@ -0,0 +1,121 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureresidency.h
+// ============
+// keep texture mip levels resident within a GPU memory budget
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLResourceTracker.h"
+#include "TextureCache.h"
+
+#include <GL/glew.h>
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  TextureResidency
+ *
+ *  This class keeps the textures of the scene within a GPU
+ *  memory budget.  When over budget, the top mip levels of
+ *  the least recently sampled textures are dropped by
+ *  rebuilding each texture without them, and the levels are
+ *  brought back from the texture cache once an object using
+ *  the texture gets close enough to the camera to need them.
+ *  It must only be used on the thread that owns the OpenGL
+ *  context.
+ ***********************************************************/
+class TextureResidency
+{
+public:
+	// constructor - a budget of 0 never drops any levels
+	TextureResidency(GLResourceTracker* pResourceTracker, TextureCache* pTextureCache, size_t budgetBytes = 0);
+	// destructor
+	~TextureResidency();
+
+	struct RESIDENCY_STATS
+	{
+		// bytes of the levels currently on the GPU
+		size_t residentBytes;
+		// bytes with every level of every texture on the GPU
+		size_t fullBytes;
+		size_t budgetBytes;
+		int textureCount;
+		// textures with at least one top level dropped
+		int reducedCount;
+		// levels dropped and brought back since the start
+		int droppedLevels;
+		int restoredLevels;
+	};
+
+	struct REPLACED_TEXTURE
+	{
+		int handle;
+		GLuint textureID;
+	};
+
+	// manage a texture whose mip chain is kept in the texture cache
+	void AddTexture(int handle, GLuint textureID, const std::string& filename, int blockFormat);
+	// record that a texture is sampled by an object this frame
+	void MarkUsed(int handle, float distance, float objectSize);
+	// drop or restore levels, once per frame, collecting rebuilt textures
+	void Update(std::vector<REPLACED_TEXTURE>& replaced);
+
+	// change the budget, 0 for no budget
+	void SetBudgetBytes(size_t budgetBytes);
+	// set the height in pixels of one unit at a distance of one unit
+	void SetFocalLength(float focalPixels);
+
+	// current resident bytes
+	size_t GetResidentBytes() const;
+	// current residency statistics
+	void GetStats(RESIDENCY_STATS& stats) const;
+
+private:
+	struct MANAGED_TEXTURE
+	{
+		int handle;
+		GLuint textureID;
+		std::string filename;
+		int blockFormat;
+		// size of every level of the full mip chain
+		std::vector<int> levelWidths;
+		std::vector<int> levelHeights;
+		std::vector<size_t> levelSizes;
+		// top level currently on the GPU
+		int residentTop;
+		// top level asked for by the objects of the last frame it was used
+		int wantedTop;
+		// top level asked for so far this frame, -1 when not used yet
+		int frameWantedTop;
+		// last frame the texture was sampled
+		int lastUsedFrame;
+	};
+
+	GLResourceTracker* m_pResourceTracker;
+	TextureCache* m_pTextureCache;
+	std::vector<MANAGED_TEXTURE> m_textures;
+	// index into m_textures of each handle, -1 when not managed
+	std::vector<int> m_handleIndices;
+	size_t m_budgetBytes;
+	size_t m_residentBytes;
+	float m_focalPixels;
+	int m_frame;
+	int m_droppedLevels;
+	int m_restoredLevels;
+	// textures rebuilt with more levels at most per frame
+	int m_maxRestoresPerFrame;
+
+	// bytes of the levels from topLevel down of a texture
+	static size_t GetResidentSize(const MANAGED_TEXTURE& texture, int topLevel);
+	// drop levels of textures not used this frame until extraBytes fit
+	void FreeUnusedLevels(std::vector<int>& plannedTops, size_t& plannedBytes, size_t extraBytes) const;
+	// index of the least recently used texture that can drop a level
+	int FindEvictionCandidate(const std::vector<int>& plannedTops, bool bUnusedOnly) const;
+	// recreate a texture with only the levels from topLevel down
+	bool RebuildTexture(MANAGED_TEXTURE& texture, int topLevel);
+};
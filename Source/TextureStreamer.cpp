@@ -0,0 +1,391 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturestreamer.cpp
+// ============
+// stream decoded textures to the GPU through pixel buffer objects
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureStreamer.h"
+#include "TextureCompressor.h"
+
+#include <cstring>
+
+/***********************************************************
+ *  TextureStreamer()
+ *
+ *  The constructor for the class.  The pixel buffer ring is
+ *  created and, with GL_ARB_buffer_storage, mapped once for
+ *  the life of the streamer.  Without it each band maps its
+ *  slot unsynchronized, relying on the slot fence instead.
+ ***********************************************************/
+TextureStreamer::TextureStreamer(GLResourceTracker* pResourceTracker, int slotCount, size_t slotSize)
+{
+	m_pResourceTracker = pResourceTracker;
+	m_bufferID = 0;
+	m_pMappedRing = NULL;
+	m_slotCount = (slotCount > 0) ? slotCount : 1;
+	m_slotSize = slotSize;
+	m_nextSlot = 0;
+	m_slotFences.assign(m_slotCount, (GLsync)0);
+	m_uploadedBytes = 0;
+
+	GLsizeiptr ringSize = (GLsizeiptr)(m_slotSize * m_slotCount);
+
+	glGenBuffers(1, &m_bufferID);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_bufferID);
+	if (GLEW_ARB_buffer_storage)
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_PIXEL_UNPACK_BUFFER, ringSize, NULL, flags);
+		m_pMappedRing = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, ringSize, flags);
+	}
+	else
+	{
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, ringSize, NULL, GL_STREAM_DRAW);
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	m_pResourceTracker->Track(GLResourceTracker::RESOURCE_BUFFER, m_bufferID, (size_t)ringSize, "streaming");
+}
+
+/***********************************************************
+ *  ~TextureStreamer()
+ *
+ *  The destructor for the class.  Textures that were still
+ *  being uploaded are deleted along with their images, while
+ *  finished textures belong to the caller.
+ ***********************************************************/
+TextureStreamer::~TextureStreamer()
+{
+	for (size_t i = 0; i < m_jobs.size(); i++)
+	{
+		m_pResourceTracker->Delete(GLResourceTracker::RESOURCE_TEXTURE, m_jobs[i].textureID);
+		TextureDecodePool::FreeImage(m_jobs[i].image);
+	}
+	m_jobs.clear();
+
+	for (int i = 0; i < m_slotCount; i++)
+	{
+		if (m_slotFences[i] != 0)
+		{
+			glDeleteSync(m_slotFences[i]);
+		}
+	}
+
+	if (NULL != m_pMappedRing)
+	{
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_bufferID);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		m_pMappedRing = NULL;
+	}
+	m_pResourceTracker->Delete(GLResourceTracker::RESOURCE_BUFFER, m_bufferID);
+	m_bufferID = 0;
+}
+
+/***********************************************************
+ *  QueueUpload()
+ *
+ *  This method is used for adding a decoded image to the end
+ *  of the upload queue.  The streamer frees the image once
+ *  it has been uploaded.  Only RGB and RGBA images, raw or
+ *  block compressed, whose rows fit in a slot are accepted,
+ *  and the caller keeps any image that is turned down.
+ ***********************************************************/
+bool TextureStreamer::QueueUpload(int handle, const TextureDecodePool::DECODED_IMAGE& image)
+{
+	if (((image.colorChannels != 3) && (image.colorChannels != 4)) ||
+		((NULL == image.pixels) && (image.mipLevels.empty() == true)))
+	{
+		return(false);
+	}
+
+	// the top level has the widest rows
+	size_t rowSize = (image.blockFormat != 0) ?
+		TextureCompressor::GetCompressedSize((TextureCompressor::BLOCK_FORMAT)image.blockFormat, image.width, 4) :
+		(size_t)image.width * image.colorChannels;
+	if (rowSize > m_slotSize)
+	{
+		return(false);
+	}
+
+	UPLOAD_JOB job;
+	job.handle = handle;
+	job.image = image;
+	job.textureID = 0;
+	job.level = 0;
+	job.row = 0;
+
+	m_jobs.push_back(job);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for uploading the next bands of the
+ *  queued images, once per frame.  Every slot of the ring is
+ *  used at most once per call, and filling stops at the
+ *  first slot the GPU is still reading, so the work done in
+ *  a frame is bounded by the size of the ring rather than by
+ *  the size of the textures.  Textures whose last band was
+ *  uploaded are handed back in completed.
+ ***********************************************************/
+void TextureStreamer::Update(std::vector<STREAMED_TEXTURE>& completed)
+{
+	completed.clear();
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	for (int slotsUsed = 0; (slotsUsed < m_slotCount) && (m_jobs.empty() == false); slotsUsed++)
+	{
+		int slot = m_nextSlot;
+
+		// wait for next frame when the GPU has not read the slot yet
+		if (m_slotFences[slot] != 0)
+		{
+			GLenum waitResult = glClientWaitSync(m_slotFences[slot], 0, 0);
+			if ((waitResult != GL_ALREADY_SIGNALED) && (waitResult != GL_CONDITION_SATISFIED))
+			{
+				break;
+			}
+			glDeleteSync(m_slotFences[slot]);
+			m_slotFences[slot] = 0;
+		}
+
+		UPLOAD_JOB& job = m_jobs.front();
+		if (job.textureID == 0)
+		{
+			BeginJob(job);
+		}
+
+		UploadBand(job, slot);
+		m_slotFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		m_nextSlot = (m_nextSlot + 1) % m_slotCount;
+
+		if (job.level >= GetLevelCount(job.image))
+		{
+			glBindTexture(GL_TEXTURE_2D, job.textureID);
+			if (job.image.mipLevels.empty() == true)
+			{
+				// decoded without the texture cache, so no mip chain came with it
+				glGenerateMipmap(GL_TEXTURE_2D);
+			}
+			glBindTexture(GL_TEXTURE_2D, 0);
+			m_pResourceTracker->Resize(GLResourceTracker::RESOURCE_TEXTURE, job.textureID,
+				GLResourceTracker::MeasureTexture(GL_TEXTURE_2D, job.textureID));
+
+			STREAMED_TEXTURE streamed;
+			streamed.handle = job.handle;
+			streamed.textureID = job.textureID;
+			streamed.filename = job.image.filename;
+			streamed.blockFormat = job.image.blockFormat;
+			streamed.bCachedMipChain = (job.image.mipLevels.empty() == false);
+			completed.push_back(streamed);
+
+			TextureDecodePool::FreeImage(job.image);
+			m_jobs.pop_front();
+		}
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+/***********************************************************
+ *  IsIdle()
+ *
+ *  This method is used for checking whether every queued
+ *  image has been uploaded.
+ ***********************************************************/
+bool TextureStreamer::IsIdle() const
+{
+	return(m_jobs.empty());
+}
+
+/***********************************************************
+ *  IsPersistent()
+ *
+ *  This method is used for checking whether the pixel buffer
+ *  ring is persistently mapped.
+ ***********************************************************/
+bool TextureStreamer::IsPersistent() const
+{
+	return(NULL != m_pMappedRing);
+}
+
+/***********************************************************
+ *  GetUploadedBytes()
+ *
+ *  This method is used for getting the total number of bytes
+ *  copied through the pixel buffer ring.
+ ***********************************************************/
+size_t TextureStreamer::GetUploadedBytes() const
+{
+	return(m_uploadedBytes);
+}
+
+/***********************************************************
+ *  BeginJob()
+ *
+ *  This method is used for creating the texture of a job and
+ *  allocating all of its levels up front, so each band only
+ *  has to fill in its rows.  No pixel buffer is bound here,
+ *  so the levels are allocated without any data.
+ ***********************************************************/
+void TextureStreamer::BeginJob(UPLOAD_JOB& job)
+{
+	const TextureDecodePool::DECODED_IMAGE& image = job.image;
+	int levelCount = GetLevelCount(image);
+
+	glGenTextures(1, &job.textureID);
+	glBindTexture(GL_TEXTURE_2D, job.textureID);
+
+	// match the texture parameters of SceneManager::UploadGLTexture()
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	for (int level = 0; level < levelCount; level++)
+	{
+		TextureDecodePool::MIP_LEVEL mipLevel = GetLevel(image, level);
+		if (image.blockFormat != 0)
+		{
+			glCompressedTexImage2D(GL_TEXTURE_2D, level,
+				TextureCompressor::GetGLFormat((TextureCompressor::BLOCK_FORMAT)image.blockFormat),
+				mipLevel.width, mipLevel.height, 0, (GLsizei)mipLevel.size, NULL);
+		}
+		else
+		{
+			glTexImage2D(GL_TEXTURE_2D, level, (image.colorChannels == 4) ? GL_RGBA8 : GL_RGB8,
+				mipLevel.width, mipLevel.height, 0,
+				(image.colorChannels == 4) ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, NULL);
+		}
+	}
+
+	if (image.mipLevels.empty() == false)
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	m_pResourceTracker->Track(GLResourceTracker::RESOURCE_TEXTURE, job.textureID,
+		GLResourceTracker::MeasureTexture(GL_TEXTURE_2D, job.textureID), "textures");
+}
+
+/***********************************************************
+ *  UploadBand()
+ *
+ *  This method is used for copying as many rows of the
+ *  current level of a job as fit into a slot of the ring,
+ *  and uploading them to the texture from the pixel buffer.
+ *  Block compressed levels are split on rows of blocks.  The
+ *  job moves on to the next level when a level is done.
+ ***********************************************************/
+void TextureStreamer::UploadBand(UPLOAD_JOB& job, int slot)
+{
+	const TextureDecodePool::DECODED_IMAGE& image = job.image;
+	TextureDecodePool::MIP_LEVEL mipLevel = GetLevel(image, job.level);
+	TextureCompressor::BLOCK_FORMAT blockFormat = (TextureCompressor::BLOCK_FORMAT)image.blockFormat;
+
+	// a row is a row of 4x4 blocks for compressed levels
+	int rowHeight = (image.blockFormat != 0) ? 4 : 1;
+	int rowCount = (mipLevel.height + rowHeight - 1) / rowHeight;
+	size_t rowSize = (image.blockFormat != 0) ?
+		TextureCompressor::GetCompressedSize(blockFormat, mipLevel.width, 4) :
+		(size_t)mipLevel.width * image.colorChannels;
+
+	// QueueUpload() made sure a slot takes at least one row
+	int bandRows = (int)(m_slotSize / rowSize);
+	if (bandRows > rowCount - job.row)
+	{
+		bandRows = rowCount - job.row;
+	}
+	size_t bandSize = (size_t)bandRows * rowSize;
+	const unsigned char* source = mipLevel.pixels + (size_t)job.row * rowSize;
+	GLintptr slotOffset = (GLintptr)(m_slotSize * slot);
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_bufferID);
+	if (NULL != m_pMappedRing)
+	{
+		memcpy(m_pMappedRing + slotOffset, source, bandSize);
+	}
+	else
+	{
+		void* pSlot = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, slotOffset, (GLsizeiptr)bandSize,
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		if (NULL != pSlot)
+		{
+			memcpy(pSlot, source, bandSize);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		}
+	}
+
+	int y = job.row * rowHeight;
+	int height = bandRows * rowHeight;
+	if (y + height > mipLevel.height)
+	{
+		height = mipLevel.height - y;
+	}
+
+	glBindTexture(GL_TEXTURE_2D, job.textureID);
+	if (image.blockFormat != 0)
+	{
+		glCompressedTexSubImage2D(GL_TEXTURE_2D, job.level, 0, y, mipLevel.width, height,
+			TextureCompressor::GetGLFormat(blockFormat), (GLsizei)bandSize, (const void*)slotOffset);
+	}
+	else
+	{
+		glTexSubImage2D(GL_TEXTURE_2D, job.level, 0, y, mipLevel.width, height,
+			(image.colorChannels == 4) ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, (const void*)slotOffset);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	m_uploadedBytes += bandSize;
+
+	job.row += bandRows;
+	if (job.row >= rowCount)
+	{
+		job.level++;
+		job.row = 0;
+	}
+}
+
+/***********************************************************
+ *  GetLevelCount()
+ *
+ *  This method is used for getting the number of levels
+ *  streamed for an image - the whole cached mip chain, or
+ *  just the decoded pixels.
+ ***********************************************************/
+int TextureStreamer::GetLevelCount(const TextureDecodePool::DECODED_IMAGE& image)
+{
+	return(image.mipLevels.empty() ? 1 : (int)image.mipLevels.size());
+}
+
+/***********************************************************
+ *  GetLevel()
+ *
+ *  This method is used for getting the size and pixels of
+ *  one level of an image, whether it came with a mip chain
+ *  or only with decoded pixels.
+ ***********************************************************/
+TextureDecodePool::MIP_LEVEL TextureStreamer::GetLevel(const TextureDecodePool::DECODED_IMAGE& image, int level)
+{
+	if (image.mipLevels.empty() == false)
+	{
+		return(image.mipLevels[level]);
+	}
+
+	TextureDecodePool::MIP_LEVEL mipLevel;
+	mipLevel.width = image.width;
+	mipLevel.height = image.height;
+	mipLevel.size = (size_t)image.width * image.height * image.colorChannels;
+	mipLevel.pixels = image.pixels;
+
+	return(mipLevel);
+}
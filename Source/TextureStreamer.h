@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturestreamer.h
+// ============
+// stream decoded textures to the GPU through pixel buffer objects
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLResourceTracker.h"
+#include "TextureDecodePool.h"
+
+#include <GL/glew.h>
+
+#include <deque>
+#include <vector>
+
+/***********************************************************
+ *  TextureStreamer
+ *
+ *  This class uploads decoded images to new textures a band
+ *  of rows at a time, spread over several frames.  The rows
+ *  are copied into a ring of slots in a pixel buffer object,
+ *  which is mapped persistently when the driver supports it,
+ *  and each slot is guarded by a fence so it is only reused
+ *  once the GPU has read it.  All of its methods must be
+ *  called on the thread that owns the OpenGL context.
+ ***********************************************************/
+class TextureStreamer
+{
+public:
+	// constructor - creates the pixel buffer ring
+	TextureStreamer(GLResourceTracker* pResourceTracker, int slotCount = 4, size_t slotSize = 4 * 1024 * 1024);
+	// destructor
+	~TextureStreamer();
+
+	struct STREAMED_TEXTURE
+	{
+		// handle passed in with the image
+		int handle;
+		// texture holding the whole uploaded mip chain
+		GLuint textureID;
+		// image file and TextureCompressor::BLOCK_FORMAT of the texture
+		std::string filename;
+		int blockFormat;
+		// true when the mip chain was read from the texture cache
+		bool bCachedMipChain;
+	};
+
+	// queue a decoded image for upload, taking ownership of it
+	bool QueueUpload(int handle, const TextureDecodePool::DECODED_IMAGE& image);
+	// upload the next bands and collect the finished textures
+	void Update(std::vector<STREAMED_TEXTURE>& completed);
+
+	// true when every queued image has been uploaded
+	bool IsIdle() const;
+	// true when the pixel buffer is persistently mapped
+	bool IsPersistent() const;
+	// total bytes copied through the pixel buffer
+	size_t GetUploadedBytes() const;
+
+private:
+	struct UPLOAD_JOB
+	{
+		int handle;
+		TextureDecodePool::DECODED_IMAGE image;
+		GLuint textureID;
+		// next level and row of blocks or pixels to upload
+		int level;
+		int row;
+	};
+
+	// records the ring and the streamed textures
+	GLResourceTracker* m_pResourceTracker;
+	// pixel buffer holding every slot of the ring
+	GLuint m_bufferID;
+	// start of the persistently mapped ring, or NULL
+	unsigned char* m_pMappedRing;
+	int m_slotCount;
+	size_t m_slotSize;
+	// next slot of the ring to fill
+	int m_nextSlot;
+	// fence set after the last upload from each slot
+	std::vector<GLsync> m_slotFences;
+	// images waiting for or being uploaded, oldest first
+	std::deque<UPLOAD_JOB> m_jobs;
+	size_t m_uploadedBytes;
+
+	// create the texture and allocate every level of a job
+	void BeginJob(UPLOAD_JOB& job);
+	// upload the next band of a job from the passed in slot
+	void UploadBand(UPLOAD_JOB& job, int slot);
+	// number of levels uploaded for an image
+	static int GetLevelCount(const TextureDecodePool::DECODED_IMAGE& image);
+	// size and pixels of one level of an image
+	static TextureDecodePool::MIP_LEVEL GetLevel(const TextureDecodePool::DECODED_IMAGE& image, int level);
+
+	// the ring owns OpenGL objects, so it is not copied
+	TextureStreamer(const TextureStreamer&);
+	TextureStreamer& operator=(const TextureStreamer&);
+};
@@ -0,0 +1,472 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbatch.cpp
+// ============
+// compose the model matrices of many objects from their scale, rotation
+// and position
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TransformBatch.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cmath>
+
+#if defined(__AVX__)
+#define TRANSFORM_BATCH_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define TRANSFORM_BATCH_SSE2
+#include <emmintrin.h>
+#endif
+
+// declaration of the batch composing helpers
+namespace
+{
+	const float g_DegreesToRadians = 3.14159265358979f / 180.0f;
+
+#if defined(TRANSFORM_BATCH_AVX) || defined(TRANSFORM_BATCH_SSE2)
+#define TRANSFORM_BATCH_SIMD
+
+	// the kernel is written once against these wrappers, which
+	// hold eight objects with AVX and four with SSE2
+#ifdef TRANSFORM_BATCH_AVX
+	typedef __m256 FLOATS;
+	const int g_Lanes = 8;
+
+	inline FLOATS Load(const float* values) { return(_mm256_loadu_ps(values)); }
+	inline FLOATS Splat(float value) { return(_mm256_set1_ps(value)); }
+	inline FLOATS Add(FLOATS a, FLOATS b) { return(_mm256_add_ps(a, b)); }
+	inline FLOATS Sub(FLOATS a, FLOATS b) { return(_mm256_sub_ps(a, b)); }
+	inline FLOATS Mul(FLOATS a, FLOATS b) { return(_mm256_mul_ps(a, b)); }
+	inline FLOATS And(FLOATS a, FLOATS b) { return(_mm256_and_ps(a, b)); }
+	inline FLOATS Or(FLOATS a, FLOATS b) { return(_mm256_or_ps(a, b)); }
+	inline FLOATS Xor(FLOATS a, FLOATS b) { return(_mm256_xor_ps(a, b)); }
+	inline FLOATS Equal(FLOATS a, FLOATS b) { return(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)); }
+	inline FLOATS GreaterEqual(FLOATS a, FLOATS b) { return(_mm256_cmp_ps(a, b, _CMP_GE_OQ)); }
+	inline FLOATS Select(FLOATS mask, FLOATS a, FLOATS b) { return(_mm256_blendv_ps(b, a, mask)); }
+#else
+	typedef __m128 FLOATS;
+	const int g_Lanes = 4;
+
+	inline FLOATS Load(const float* values) { return(_mm_loadu_ps(values)); }
+	inline FLOATS Splat(float value) { return(_mm_set1_ps(value)); }
+	inline FLOATS Add(FLOATS a, FLOATS b) { return(_mm_add_ps(a, b)); }
+	inline FLOATS Sub(FLOATS a, FLOATS b) { return(_mm_sub_ps(a, b)); }
+	inline FLOATS Mul(FLOATS a, FLOATS b) { return(_mm_mul_ps(a, b)); }
+	inline FLOATS And(FLOATS a, FLOATS b) { return(_mm_and_ps(a, b)); }
+	inline FLOATS Or(FLOATS a, FLOATS b) { return(_mm_or_ps(a, b)); }
+	inline FLOATS Xor(FLOATS a, FLOATS b) { return(_mm_xor_ps(a, b)); }
+	inline FLOATS Equal(FLOATS a, FLOATS b) { return(_mm_cmpeq_ps(a, b)); }
+	inline FLOATS GreaterEqual(FLOATS a, FLOATS b) { return(_mm_cmpge_ps(a, b)); }
+	inline FLOATS Select(FLOATS mask, FLOATS a, FLOATS b) { return(_mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b))); }
+#endif
+
+	/***********************************************************
+	 *  RoundToInteger()
+	 *
+	 *  Round to the nearest whole number by adding and taking
+	 *  away 1.5 * 2^23, which pushes the fraction bits out of
+	 *  the mantissa.  Good for values under 2^22, which covers
+	 *  any angle in degrees divided by 90.
+	 ***********************************************************/
+	inline FLOATS RoundToInteger(FLOATS values)
+	{
+		const FLOATS magic = Splat(12582912.0f);
+		return(Sub(Add(values, magic), magic));
+	}
+
+	/***********************************************************
+	 *  SinCosDegrees()
+	 *
+	 *  Work out the sine and cosine of angles in degrees.  The
+	 *  nearest multiple of 90 degrees is taken away first,
+	 *  which is exact for the whole degree angles the scene
+	 *  uses, and the remainder of at most 45 degrees goes
+	 *  through the minimax polynomials from the Cephes library.
+	 *  The quarter turn the angle fell in then swaps the sine
+	 *  and cosine and flips their signs.
+	 ***********************************************************/
+	inline void SinCosDegrees(FLOATS degrees, FLOATS& sines, FLOATS& cosines)
+	{
+		const FLOATS one = Splat(1.0f);
+		const FLOATS two = Splat(2.0f);
+		const FLOATS three = Splat(3.0f);
+		const FLOATS signBit = Splat(-0.0f);
+
+		// quarter turns, and which of the four the angle ends in
+		FLOATS turns = RoundToInteger(Mul(degrees, Splat(1.0f / 90.0f)));
+		FLOATS wholeTurns = RoundToInteger(Sub(Mul(turns, Splat(0.25f)), Splat(0.375f)));
+		FLOATS quadrant = Sub(turns, Mul(wholeTurns, Splat(4.0f)));
+
+		FLOATS x = Mul(Sub(degrees, Mul(turns, Splat(90.0f))), Splat(g_DegreesToRadians));
+		FLOATS z = Mul(x, x);
+
+		FLOATS sinX = Add(Mul(Sub(Mul(Add(Mul(Splat(-1.9515295891e-4f), z), Splat(8.3321608736e-3f)), z),
+			Splat(1.6666654611e-1f)), Mul(z, x)), x);
+		FLOATS cosX = Add(Sub(Mul(Mul(Add(Mul(Sub(Mul(Splat(2.443315711809948e-5f), z), Splat(1.388731625493765e-3f)), z),
+			Splat(4.166664568298827e-2f)), z), z), Mul(Splat(0.5f), z)), one);
+
+		FLOATS oddQuadrant = Or(Equal(quadrant, one), Equal(quadrant, three));
+		FLOATS negateSine = GreaterEqual(quadrant, two);
+		FLOATS negateCosine = And(GreaterEqual(quadrant, one), GreaterEqual(two, quadrant));
+
+		sines = Xor(Select(oddQuadrant, cosX, sinX), And(negateSine, signBit));
+		cosines = Xor(Select(oddQuadrant, sinX, cosX), And(negateCosine, signBit));
+	}
+
+	/***********************************************************
+	 *  StoreColumn()
+	 *
+	 *  Write one column of the model matrices of a batch of
+	 *  objects.  The column rows arrive with one object per
+	 *  lane, so each group of four objects is transposed into
+	 *  four matrix columns.
+	 ***********************************************************/
+	inline void StoreColumn(float* matrices, int column, FLOATS row0, FLOATS row1, FLOATS row2, FLOATS row3)
+	{
+#ifdef TRANSFORM_BATCH_AVX
+		for (int half = 0; half < 2; half++)
+		{
+			__m128 x = (half == 0) ? _mm256_castps256_ps128(row0) : _mm256_extractf128_ps(row0, 1);
+			__m128 y = (half == 0) ? _mm256_castps256_ps128(row1) : _mm256_extractf128_ps(row1, 1);
+			__m128 z = (half == 0) ? _mm256_castps256_ps128(row2) : _mm256_extractf128_ps(row2, 1);
+			__m128 w = (half == 0) ? _mm256_castps256_ps128(row3) : _mm256_extractf128_ps(row3, 1);
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+
+			float* objects = matrices + half * 64 + column * 4;
+			_mm_storeu_ps(objects, x);
+			_mm_storeu_ps(objects + 16, y);
+			_mm_storeu_ps(objects + 32, z);
+			_mm_storeu_ps(objects + 48, w);
+		}
+#else
+		_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+		float* objects = matrices + column * 4;
+		_mm_storeu_ps(objects, row0);
+		_mm_storeu_ps(objects + 16, row1);
+		_mm_storeu_ps(objects + 32, row2);
+		_mm_storeu_ps(objects + 48, row3);
+#endif
+	}
+#endif
+}
+
+/***********************************************************
+ *  TransformBatch()
+ *
+ *  The constructor for the class.
+ ***********************************************************/
+TransformBatch::TransformBatch()
+{
+}
+
+/***********************************************************
+ *  ~TransformBatch()
+ *
+ *  The destructor for the class.
+ ***********************************************************/
+TransformBatch::~TransformBatch()
+{
+}
+
+/***********************************************************
+ *  AddTransform()
+ *
+ *  This method is used for adding the transform of another
+ *  object to the batch.  Its model matrix is filled in by
+ *  the next Compose() call that covers the returned index.
+ ***********************************************************/
+int TransformBatch::AddTransform(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	int index = GetCount();
+	Resize(index + 1);
+	SetTransform(index, scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+
+	return(index);
+}
+
+/***********************************************************
+ *  SetTransform()
+ *
+ *  This method is used for changing the transform of an
+ *  object in the batch.  False is returned when the object
+ *  already had exactly this transform, so its model matrix
+ *  does not need composing again.
+ ***********************************************************/
+bool TransformBatch::SetTransform(
+	int index,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	if ((index < 0) || (index >= GetCount()))
+	{
+		return(false);
+	}
+
+	if ((m_scaleX[index] == scaleXYZ.x) && (m_scaleY[index] == scaleXYZ.y) && (m_scaleZ[index] == scaleXYZ.z) &&
+		(m_rotationX[index] == XrotationDegrees) && (m_rotationY[index] == YrotationDegrees) &&
+		(m_rotationZ[index] == ZrotationDegrees) && (m_positionX[index] == positionXYZ.x) &&
+		(m_positionY[index] == positionXYZ.y) && (m_positionZ[index] == positionXYZ.z))
+	{
+		return(false);
+	}
+
+	m_scaleX[index] = scaleXYZ.x;
+	m_scaleY[index] = scaleXYZ.y;
+	m_scaleZ[index] = scaleXYZ.z;
+	m_rotationX[index] = XrotationDegrees;
+	m_rotationY[index] = YrotationDegrees;
+	m_rotationZ[index] = ZrotationDegrees;
+	m_positionX[index] = positionXYZ.x;
+	m_positionY[index] = positionXYZ.y;
+	m_positionZ[index] = positionXYZ.z;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Resize()
+ *
+ *  This method is used for setting the number of objects in
+ *  the batch.  Added objects get the identity transform.
+ ***********************************************************/
+void TransformBatch::Resize(int count)
+{
+	if (count < 0)
+	{
+		count = 0;
+	}
+
+	m_scaleX.resize(count, 1.0f);
+	m_scaleY.resize(count, 1.0f);
+	m_scaleZ.resize(count, 1.0f);
+	m_rotationX.resize(count, 0.0f);
+	m_rotationY.resize(count, 0.0f);
+	m_rotationZ.resize(count, 0.0f);
+	m_positionX.resize(count, 0.0f);
+	m_positionY.resize(count, 0.0f);
+	m_positionZ.resize(count, 0.0f);
+	m_modelMatrices.resize(count, glm::mat4(1.0f));
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing every object from the
+ *  batch.  The arrays keep their capacity for refilling.
+ ***********************************************************/
+void TransformBatch::Clear()
+{
+	Resize(0);
+}
+
+/***********************************************************
+ *  Compose()
+ *
+ *  This method is used for composing the model matrices of
+ *  the objects in [first, last).  Whole groups of objects
+ *  go through the vector kernel and the rest are composed
+ *  one at a time.  The matrix is written out directly as
+ *
+ *    translation * rotationX * rotationY * rotationZ * scale
+ *
+ *  where the rotation part, with s and c for the sines and
+ *  cosines of the angles, is
+ *
+ *    | cy*cz             -cy*sz              sy     |
+ *    | sx*sy*cz + cx*sz   cx*cz - sx*sy*sz  -sx*cy  |
+ *    | sx*sz - cx*sy*cz   cx*sy*sz + sx*cz   cx*cy  |
+ *
+ *  and each column is multiplied by the scale on its axis.
+ ***********************************************************/
+void TransformBatch::Compose(int first, int last)
+{
+	if (first < 0)
+	{
+		first = 0;
+	}
+	if (last > GetCount())
+	{
+		last = GetCount();
+	}
+
+	int index = first;
+#ifdef TRANSFORM_BATCH_SIMD
+	const FLOATS zero = Splat(0.0f);
+	const FLOATS one = Splat(1.0f);
+
+	for (; index + g_Lanes <= last; index += g_Lanes)
+	{
+		FLOATS sinX, cosX, sinY, cosY, sinZ, cosZ;
+		SinCosDegrees(Load(&m_rotationX[index]), sinX, cosX);
+		SinCosDegrees(Load(&m_rotationY[index]), sinY, cosY);
+		SinCosDegrees(Load(&m_rotationZ[index]), sinZ, cosZ);
+
+		FLOATS scaleX = Load(&m_scaleX[index]);
+		FLOATS scaleY = Load(&m_scaleY[index]);
+		FLOATS scaleZ = Load(&m_scaleZ[index]);
+		FLOATS sinXsinY = Mul(sinX, sinY);
+		FLOATS cosXsinY = Mul(cosX, sinY);
+
+		float* matrices = glm::value_ptr(m_modelMatrices[index]);
+		StoreColumn(matrices, 0,
+			Mul(Mul(cosY, cosZ), scaleX),
+			Mul(Add(Mul(sinXsinY, cosZ), Mul(cosX, sinZ)), scaleX),
+			Mul(Sub(Mul(sinX, sinZ), Mul(cosXsinY, cosZ)), scaleX),
+			zero);
+		StoreColumn(matrices, 1,
+			Mul(Xor(Mul(cosY, sinZ), Splat(-0.0f)), scaleY),
+			Mul(Sub(Mul(cosX, cosZ), Mul(sinXsinY, sinZ)), scaleY),
+			Mul(Add(Mul(cosXsinY, sinZ), Mul(sinX, cosZ)), scaleY),
+			zero);
+		StoreColumn(matrices, 2,
+			Mul(sinY, scaleZ),
+			Mul(Xor(Mul(sinX, cosY), Splat(-0.0f)), scaleZ),
+			Mul(Mul(cosX, cosY), scaleZ),
+			zero);
+		StoreColumn(matrices, 3,
+			Load(&m_positionX[index]),
+			Load(&m_positionY[index]),
+			Load(&m_positionZ[index]),
+			one);
+	}
+#endif
+
+	ComposeScalar(index, last);
+}
+
+/***********************************************************
+ *  ComposeAll()
+ *
+ *  This method is used for composing the model matrices of
+ *  every object in the batch.
+ ***********************************************************/
+void TransformBatch::ComposeAll()
+{
+	Compose(0, GetCount());
+}
+
+/***********************************************************
+ *  ComposeScalar()
+ *
+ *  This method is used for composing the model matrices of
+ *  the objects in [first, last) one at a time, for the
+ *  objects left over after the vector kernel.
+ ***********************************************************/
+void TransformBatch::ComposeScalar(int first, int last)
+{
+	for (int index = first; index < last; index++)
+	{
+		m_modelMatrices[index] = ComposeModelMatrix(
+			glm::vec3(m_scaleX[index], m_scaleY[index], m_scaleZ[index]),
+			m_rotationX[index],
+			m_rotationY[index],
+			m_rotationZ[index],
+			glm::vec3(m_positionX[index], m_positionY[index], m_positionZ[index]));
+	}
+}
+
+/***********************************************************
+ *  GetModelMatrix()
+ *
+ *  This method is used for getting the model matrix of an
+ *  object as of the last Compose() call that covered it.
+ ***********************************************************/
+const glm::mat4& TransformBatch::GetModelMatrix(int index) const
+{
+	return(m_modelMatrices[index]);
+}
+
+/***********************************************************
+ *  GetModelMatrices()
+ *
+ *  This method is used for getting the model matrices of
+ *  every object, in index order, ready for uploading into a
+ *  buffer.
+ ***********************************************************/
+const glm::mat4* TransformBatch::GetModelMatrices() const
+{
+	return((m_modelMatrices.empty() == true) ? NULL : &m_modelMatrices[0]);
+}
+
+/***********************************************************
+ *  GetCount()
+ *
+ *  This method is used for getting the number of objects in
+ *  the batch.
+ ***********************************************************/
+int TransformBatch::GetCount() const
+{
+	return((int)m_modelMatrices.size());
+}
+
+/***********************************************************
+ *  ComposeModelMatrix()
+ *
+ *  This method is used for composing a single model matrix
+ *  the same way as Compose(), for objects that are drawn
+ *  straight away instead of being batched.
+ ***********************************************************/
+glm::mat4 TransformBatch::ComposeModelMatrix(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	float sinX = std::sin(XrotationDegrees * g_DegreesToRadians);
+	float cosX = std::cos(XrotationDegrees * g_DegreesToRadians);
+	float sinY = std::sin(YrotationDegrees * g_DegreesToRadians);
+	float cosY = std::cos(YrotationDegrees * g_DegreesToRadians);
+	float sinZ = std::sin(ZrotationDegrees * g_DegreesToRadians);
+	float cosZ = std::cos(ZrotationDegrees * g_DegreesToRadians);
+
+	glm::mat4 modelMatrix;
+	modelMatrix[0] = glm::vec4(
+		cosY * cosZ,
+		sinX * sinY * cosZ + cosX * sinZ,
+		sinX * sinZ - cosX * sinY * cosZ,
+		0.0f) * scaleXYZ.x;
+	modelMatrix[1] = glm::vec4(
+		-cosY * sinZ,
+		cosX * cosZ - sinX * sinY * sinZ,
+		cosX * sinY * sinZ + sinX * cosZ,
+		0.0f) * scaleXYZ.y;
+	modelMatrix[2] = glm::vec4(
+		sinY,
+		-sinX * cosY,
+		cosX * cosY,
+		0.0f) * scaleXYZ.z;
+	modelMatrix[3] = glm::vec4(positionXYZ, 1.0f);
+
+	return(modelMatrix);
+}
+
+/***********************************************************
+ *  GetKernelName()
+ *
+ *  This method is used for getting the name of the
+ *  instruction set the batches are composed with.
+ ***********************************************************/
+const char* TransformBatch::GetKernelName()
+{
+#if defined(TRANSFORM_BATCH_AVX)
+	return("AVX");
+#elif defined(TRANSFORM_BATCH_SSE2)
+	return("SSE2");
+#else
+	return("scalar");
+#endif
+}
@@ -0,0 +1,98 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbatch.h
+// ============
+// compose the model matrices of many objects from their scale, rotation
+// and position
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  TransformBatch
+ *
+ *  This class keeps the scale, Euler rotation and position
+ *  of every object in separate arrays, one per component,
+ *  and composes the model matrices of a range of objects in
+ *  one pass.  The matrices are built straight from the
+ *  sines and cosines of the angles, in the same order as
+ *  translation * rotationX * rotationY * rotationZ * scale,
+ *  and several objects are composed at once with AVX or SSE2
+ *  when the compiler targets them.
+ ***********************************************************/
+class TransformBatch
+{
+public:
+	// constructor
+	TransformBatch();
+	// destructor
+	~TransformBatch();
+
+	// add the transform of an object and get back its index
+	int AddTransform(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+	// change the transform of an object, true when it differs from before
+	bool SetTransform(
+		int index,
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+	// set the number of objects, new objects get the identity transform
+	void Resize(int count);
+	// remove every object
+	void Clear();
+
+	// compose the model matrices of the objects in [first, last)
+	void Compose(int first, int last);
+	// compose the model matrices of every object
+	void ComposeAll();
+
+	// model matrix of an object as of the last Compose() call
+	const glm::mat4& GetModelMatrix(int index) const;
+	// model matrices of every object, in index order
+	const glm::mat4* GetModelMatrices() const;
+	int GetCount() const;
+
+	// compose one model matrix without a batch
+	static glm::mat4 ComposeModelMatrix(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+	// name of the instruction set the batches are composed with
+	static const char* GetKernelName();
+
+private:
+	// transform components, indexed by object
+	std::vector<float> m_scaleX;
+	std::vector<float> m_scaleY;
+	std::vector<float> m_scaleZ;
+	std::vector<float> m_rotationX;
+	std::vector<float> m_rotationY;
+	std::vector<float> m_rotationZ;
+	std::vector<float> m_positionX;
+	std::vector<float> m_positionY;
+	std::vector<float> m_positionZ;
+	// composed model matrices, indexed by object
+	std::vector<glm::mat4> m_modelMatrices;
+
+	// compose the objects in [first, last) one at a time
+	void ComposeScalar(int first, int last);
+
+	// batches hold the transforms of the whole scene, so they are not copied
+	TransformBatch(const TransformBatch&);
+	TransformBatch& operator=(const TransformBatch&);
+};
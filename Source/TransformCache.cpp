@@ -0,0 +1,178 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformcache.cpp
+// ============
+// keep the model and normal matrices of the drawn objects between frames
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TransformCache.h"
+
+/***********************************************************
+ *  TransformCache()
+ *
+ *  The constructor for the class.
+ ***********************************************************/
+TransformCache::TransformCache()
+{
+	m_nextSlot = 0;
+	m_frameRecomputes = 0;
+	m_totalRecomputes = 0;
+}
+
+/***********************************************************
+ *  ~TransformCache()
+ *
+ *  The destructor for the class.
+ ***********************************************************/
+TransformCache::~TransformCache()
+{
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting a frame.  Objects are
+ *  matched to their cached matrices by the order they are
+ *  drawn in, so the first transform set after this call is
+ *  for the first object again.
+ ***********************************************************/
+void TransformCache::BeginFrame()
+{
+	m_nextSlot = 0;
+	m_frameRecomputes = 0;
+}
+
+/***********************************************************
+ *  SetNextTransform()
+ *
+ *  This method is used for setting the transform of the
+ *  next object drawn this frame.  Its matrices are only
+ *  composed when the transform differs from the one set for
+ *  the same slot last frame, or when the slot is new.  The
+ *  normal matrix comes from the model matrix columns, which
+ *  are the rotation axes times the scale, so dividing each
+ *  column by its squared length undoes the scale and leaves
+ *  the inverse transpose without any trig or inversion.
+ ***********************************************************/
+int TransformCache::SetNextTransform(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	int slot = m_nextSlot++;
+	bool bChanged = false;
+
+	if (slot >= m_transformBatch.GetCount())
+	{
+		m_transformBatch.AddTransform(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+		m_normalMatrices.push_back(glm::mat4(1.0f));
+		m_dirty.push_back(true);
+	}
+	else
+	{
+		bChanged = m_transformBatch.SetTransform(
+			slot, scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+	}
+
+	if ((bChanged == true) || (m_dirty[slot] == true))
+	{
+		m_transformBatch.Compose(slot, slot + 1);
+
+		const glm::mat4& modelMatrix = m_transformBatch.GetModelMatrix(slot);
+		glm::mat4 normalMatrix(1.0f);
+		for (int column = 0; column < 3; column++)
+		{
+			glm::vec3 axis(modelMatrix[column].x, modelMatrix[column].y, modelMatrix[column].z);
+			float lengthSquared = glm::dot(axis, axis);
+			if (lengthSquared > 0.0f)
+			{
+				normalMatrix[column] = glm::vec4(axis / lengthSquared, 0.0f);
+			}
+			else
+			{
+				normalMatrix[column] = glm::vec4(0.0f);
+			}
+		}
+		m_normalMatrices[slot] = normalMatrix;
+
+		m_dirty[slot] = false;
+		m_frameRecomputes++;
+		m_totalRecomputes++;
+	}
+
+	return(slot);
+}
+
+/***********************************************************
+ *  GetModelMatrix()
+ *
+ *  This method is used for getting the model matrix of the
+ *  object in the passed in slot.
+ ***********************************************************/
+const glm::mat4& TransformCache::GetModelMatrix(int slot) const
+{
+	return(m_transformBatch.GetModelMatrix(slot));
+}
+
+/***********************************************************
+ *  GetNormalMatrix()
+ *
+ *  This method is used for getting the matrix that carries
+ *  the normals of the object in the passed in slot into
+ *  world space.  Only its upper 3x3 part is used.
+ ***********************************************************/
+const glm::mat4& TransformCache::GetNormalMatrix(int slot) const
+{
+	return(m_normalMatrices[slot]);
+}
+
+/***********************************************************
+ *  Invalidate()
+ *
+ *  This method is used for composing the matrices of every
+ *  slot again the next time its transform is set.
+ ***********************************************************/
+void TransformCache::Invalidate()
+{
+	for (size_t i = 0; i < m_dirty.size(); i++)
+	{
+		m_dirty[i] = true;
+	}
+}
+
+/***********************************************************
+ *  GetFrameRecomputeCount()
+ *
+ *  This method is used for getting the number of objects
+ *  whose matrices were composed since BeginFrame().
+ ***********************************************************/
+int TransformCache::GetFrameRecomputeCount() const
+{
+	return(m_frameRecomputes);
+}
+
+/***********************************************************
+ *  GetTotalRecomputeCount()
+ *
+ *  This method is used for getting the number of objects
+ *  whose matrices were composed since the cache was made.
+ ***********************************************************/
+int TransformCache::GetTotalRecomputeCount() const
+{
+	return(m_totalRecomputes);
+}
+
+/***********************************************************
+ *  GetCount()
+ *
+ *  This method is used for getting the number of slots,
+ *  which is the most objects drawn in one frame so far.
+ ***********************************************************/
+int TransformCache::GetCount() const
+{
+	return(m_transformBatch.GetCount());
+}
@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformcache.h
+// ============
+// keep the model and normal matrices of the drawn objects between frames
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TransformBatch.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  TransformCache
+ *
+ *  This class keeps the model matrix and normal matrix of
+ *  every object drawn in a frame, in draw order, so the
+ *  next frame only composes the matrices of objects whose
+ *  scale, rotation or position changed.  A scene that does
+ *  not move does no matrix math at all after its first
+ *  frame.
+ ***********************************************************/
+class TransformCache
+{
+public:
+	// constructor
+	TransformCache();
+	// destructor
+	~TransformCache();
+
+	// start a frame, the next transform set is for the first object again
+	void BeginFrame();
+	// set the transform of the next object drawn and get back its slot
+	int SetNextTransform(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
+	// model matrix of the object in a slot
+	const glm::mat4& GetModelMatrix(int slot) const;
+	// inverse transpose of the model matrix, for transforming normals
+	const glm::mat4& GetNormalMatrix(int slot) const;
+
+	// compose every matrix again on the next frame
+	void Invalidate();
+
+	// matrices composed since BeginFrame()
+	int GetFrameRecomputeCount() const;
+	// matrices composed since the cache was created
+	int GetTotalRecomputeCount() const;
+	// number of objects drawn in a frame
+	int GetCount() const;
+
+private:
+	// transforms and model matrices, one slot per object drawn
+	TransformBatch m_transformBatch;
+	// normal matrices, indexed by slot
+	std::vector<glm::mat4> m_normalMatrices;
+	// set for slots that must be composed whatever their transform
+	std::vector<bool> m_dirty;
+	// slot of the next object drawn this frame
+	int m_nextSlot;
+	int m_frameRecomputes;
+	int m_totalRecomputes;
+
+	// caches hold the matrices of the whole scene, so they are not copied
+	TransformCache(const TransformCache&);
+	TransformCache& operator=(const TransformCache&);
+};
@@ -0,0 +1,396 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformcache.cpp
+// ============
+// resolve the uniform locations of a shader program once
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "UniformCache.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// GLSL types each kind of handle can resolve to - ints
+	// also cover samplers, which are set with their unit
+	const GLenum g_BoolTypes[] = { GL_BOOL, GL_INT };
+	const GLenum g_IntTypes[] = { GL_INT, GL_BOOL, GL_SAMPLER_2D, GL_SAMPLER_2D_ARRAY };
+	const GLenum g_FloatTypes[] = { GL_FLOAT };
+	const GLenum g_Vec2Types[] = { GL_FLOAT_VEC2 };
+	const GLenum g_Vec3Types[] = { GL_FLOAT_VEC3 };
+	const GLenum g_Vec4Types[] = { GL_FLOAT_VEC4 };
+	const GLenum g_Mat4Types[] = { GL_FLOAT_MAT4 };
+}
+
+/***********************************************************
+ *  UniformCache()
+ *
+ *  The constructor for the class.
+ ***********************************************************/
+UniformCache::UniformCache()
+{
+	m_programID = 0;
+	m_issuedCount = 0;
+	m_elidedCount = 0;
+}
+
+/***********************************************************
+ *  ~UniformCache()
+ *
+ *  The destructor for the class.
+ ***********************************************************/
+UniformCache::~UniformCache()
+{
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for reading the location and type
+ *  of every active uniform of a linked program.  Members of
+ *  structs and arrays of structs are listed by the driver
+ *  one by one, such as "lights[1].position", while an
+ *  array of a plain type is listed once, so each of its
+ *  elements is looked up by name, along with the array name
+ *  on its own for the first element.
+ ***********************************************************/
+bool UniformCache::Load(GLuint programID)
+{
+	m_uniforms.clear();
+	m_shadows.clear();
+	m_programID = programID;
+	if (programID == 0)
+	{
+		return(false);
+	}
+
+	GLint uniformCount = 0;
+	GLint maxNameLength = 0;
+	glGetProgramiv(programID, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+	std::string nameBuffer((size_t)maxNameLength + 1, '\0');
+
+	for (GLint i = 0; i < uniformCount; i++)
+	{
+		GLsizei nameLength = 0;
+		GLint arraySize = 0;
+		UNIFORM_INFO info;
+		glGetActiveUniform(programID, (GLuint)i, (GLsizei)nameBuffer.size(), &nameLength, &arraySize,
+			&info.type, &nameBuffer[0]);
+		std::string name(nameBuffer.c_str(), (size_t)nameLength);
+
+		// uniforms in blocks have no location of their own
+		info.location = glGetUniformLocation(programID, name.c_str());
+		if (info.location < 0)
+		{
+			continue;
+		}
+		info.slot = AddShadow();
+		m_uniforms[name] = info;
+
+		if ((name.size() > 3) && (name.compare(name.size() - 3, 3, "[0]") == 0))
+		{
+			// the array name is the first element, and shares its shadow
+			std::string arrayName = name.substr(0, name.size() - 3);
+			m_uniforms[arrayName] = info;
+			for (GLint element = 1; element < arraySize; element++)
+			{
+				std::string elementName = arrayName + "[" + std::to_string(element) + "]";
+				info.location = glGetUniformLocation(programID, elementName.c_str());
+				info.slot = AddShadow();
+				m_uniforms[elementName] = info;
+			}
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetProgram()
+ *
+ *  This method is used for getting the program the uniforms
+ *  were read from, to tell when it has been replaced.
+ ***********************************************************/
+GLuint UniformCache::GetProgram() const
+{
+	return(m_programID);
+}
+
+/***********************************************************
+ *  GetUniformCount()
+ *
+ *  This method is used for getting the number of uniforms
+ *  read, counting every array element.
+ ***********************************************************/
+int UniformCache::GetUniformCount() const
+{
+	return((int)m_uniforms.size());
+}
+
+/***********************************************************
+ *  GetLocation()
+ *
+ *  This method is used for finding the location of a
+ *  uniform by name without asking the driver.
+ ***********************************************************/
+GLint UniformCache::GetLocation(const std::string& name) const
+{
+	std::unordered_map<std::string, UNIFORM_INFO>::const_iterator found = m_uniforms.find(name);
+	if (found == m_uniforms.end())
+	{
+		return(-1);
+	}
+
+	return(found->second.location);
+}
+
+/***********************************************************
+ *  Resolve()
+ *
+ *  These methods are used for resolving the handle of a
+ *  uniform of the type of the handle.  A missing uniform,
+ *  such as one the compiler removed as unused, leaves the
+ *  handle at -1 so setting it does nothing, as setting the
+ *  uniform by name would.
+ ***********************************************************/
+bool UniformCache::Resolve(const std::string& name, UNIFORM_HANDLE<bool>& handle) const
+{
+	handle.location = FindLocation(name, g_BoolTypes, sizeof(g_BoolTypes) / sizeof(g_BoolTypes[0]), handle.slot);
+	return(handle.location >= 0);
+}
+
+bool UniformCache::Resolve(const std::string& name, UNIFORM_HANDLE<int>& handle) const
+{
+	handle.location = FindLocation(name, g_IntTypes, sizeof(g_IntTypes) / sizeof(g_IntTypes[0]), handle.slot);
+	return(handle.location >= 0);
+}
+
+bool UniformCache::Resolve(const std::string& name, UNIFORM_HANDLE<float>& handle) const
+{
+	handle.location = FindLocation(name, g_FloatTypes, sizeof(g_FloatTypes) / sizeof(g_FloatTypes[0]), handle.slot);
+	return(handle.location >= 0);
+}
+
+bool UniformCache::Resolve(const std::string& name, UNIFORM_HANDLE<glm::vec2>& handle) const
+{
+	handle.location = FindLocation(name, g_Vec2Types, sizeof(g_Vec2Types) / sizeof(g_Vec2Types[0]), handle.slot);
+	return(handle.location >= 0);
+}
+
+bool UniformCache::Resolve(const std::string& name, UNIFORM_HANDLE<glm::vec3>& handle) const
+{
+	handle.location = FindLocation(name, g_Vec3Types, sizeof(g_Vec3Types) / sizeof(g_Vec3Types[0]), handle.slot);
+	return(handle.location >= 0);
+}
+
+bool UniformCache::Resolve(const std::string& name, UNIFORM_HANDLE<glm::vec4>& handle) const
+{
+	handle.location = FindLocation(name, g_Vec4Types, sizeof(g_Vec4Types) / sizeof(g_Vec4Types[0]), handle.slot);
+	return(handle.location >= 0);
+}
+
+bool UniformCache::Resolve(const std::string& name, UNIFORM_HANDLE<glm::mat4>& handle) const
+{
+	handle.location = FindLocation(name, g_Mat4Types, sizeof(g_Mat4Types) / sizeof(g_Mat4Types[0]), handle.slot);
+	return(handle.location >= 0);
+}
+
+/***********************************************************
+ *  Set()
+ *
+ *  These methods are used for setting a value through a
+ *  handle into the program in use.  The write is dropped
+ *  when the shadow copy shows the uniform already holds
+ *  the value, and a handle of -1 sets nothing.
+ ***********************************************************/
+void UniformCache::Set(UNIFORM_HANDLE<bool> handle, bool value)
+{
+	int intValue = (value == true) ? 1 : 0;
+	if (UpdateShadow(handle.slot, &intValue, sizeof(intValue)) == true)
+	{
+		glUniform1i(handle.location, intValue);
+	}
+}
+
+void UniformCache::Set(UNIFORM_HANDLE<int> handle, int value)
+{
+	if (UpdateShadow(handle.slot, &value, sizeof(value)) == true)
+	{
+		glUniform1i(handle.location, value);
+	}
+}
+
+void UniformCache::Set(UNIFORM_HANDLE<float> handle, float value)
+{
+	if (UpdateShadow(handle.slot, &value, sizeof(value)) == true)
+	{
+		glUniform1f(handle.location, value);
+	}
+}
+
+void UniformCache::Set(UNIFORM_HANDLE<glm::vec2> handle, const glm::vec2& value)
+{
+	if (UpdateShadow(handle.slot, glm::value_ptr(value), sizeof(value)) == true)
+	{
+		glUniform2fv(handle.location, 1, glm::value_ptr(value));
+	}
+}
+
+void UniformCache::Set(UNIFORM_HANDLE<glm::vec3> handle, const glm::vec3& value)
+{
+	if (UpdateShadow(handle.slot, glm::value_ptr(value), sizeof(value)) == true)
+	{
+		glUniform3fv(handle.location, 1, glm::value_ptr(value));
+	}
+}
+
+void UniformCache::Set(UNIFORM_HANDLE<glm::vec4> handle, const glm::vec4& value)
+{
+	if (UpdateShadow(handle.slot, glm::value_ptr(value), sizeof(value)) == true)
+	{
+		glUniform4fv(handle.location, 1, glm::value_ptr(value));
+	}
+}
+
+void UniformCache::Set(UNIFORM_HANDLE<glm::mat4> handle, const glm::mat4& value)
+{
+	if (UpdateShadow(handle.slot, glm::value_ptr(value), sizeof(value)) == true)
+	{
+		glUniformMatrix4fv(handle.location, 1, GL_FALSE, glm::value_ptr(value));
+	}
+}
+
+/***********************************************************
+ *  FindLocation()
+ *
+ *  This method is used for finding the location and the
+ *  shadow slot of a uniform whose type is one of the
+ *  passed in types.  A
+ *  uniform of another type is reported, since setting it
+ *  through the handle would fail.
+ ***********************************************************/
+GLint UniformCache::FindLocation(const std::string& name, const GLenum* types, int typeCount, int& slot) const
+{
+	std::unordered_map<std::string, UNIFORM_INFO>::const_iterator found = m_uniforms.find(name);
+	slot = -1;
+	if (found == m_uniforms.end())
+	{
+		return(-1);
+	}
+
+	for (int i = 0; i < typeCount; i++)
+	{
+		if (found->second.type == types[i])
+		{
+			slot = found->second.slot;
+			return(found->second.location);
+		}
+	}
+
+	std::cout << "Could not resolve the uniform handle, it has another type:" << name << std::endl;
+	return(-1);
+}
+
+/***********************************************************
+ *  Invalidate()
+ *
+ *  This method is used for forgetting every shadow value,
+ *  so the next write of each uniform reaches the driver.
+ *  It must be called after uniforms of the program were
+ *  set without going through the cache.
+ ***********************************************************/
+void UniformCache::Invalidate()
+{
+	for (size_t i = 0; i < m_shadows.size(); i++)
+	{
+		m_shadows[i].bValid = false;
+	}
+}
+
+/***********************************************************
+ *  GetIssuedCount()
+ *
+ *  This method is used for getting the number of writes
+ *  passed to the driver since the counts were reset.
+ ***********************************************************/
+int UniformCache::GetIssuedCount() const
+{
+	return(m_issuedCount);
+}
+
+/***********************************************************
+ *  GetElidedCount()
+ *
+ *  This method is used for getting the number of writes
+ *  dropped since the counts were reset, because the
+ *  uniform already held the value.
+ ***********************************************************/
+int UniformCache::GetElidedCount() const
+{
+	return(m_elidedCount);
+}
+
+/***********************************************************
+ *  ResetCounts()
+ *
+ *  This method is used for starting the issued and elided
+ *  counts again, such as once per frame.
+ ***********************************************************/
+void UniformCache::ResetCounts()
+{
+	m_issuedCount = 0;
+	m_elidedCount = 0;
+}
+
+/***********************************************************
+ *  AddShadow()
+ *
+ *  This method is used for adding an empty shadow value
+ *  and getting back its slot.
+ ***********************************************************/
+int UniformCache::AddShadow()
+{
+	SHADOW_VALUE shadow;
+	memset(&shadow, 0, sizeof(shadow));
+	m_shadows.push_back(shadow);
+
+	return((int)m_shadows.size() - 1);
+}
+
+/***********************************************************
+ *  UpdateShadow()
+ *
+ *  This method is used for comparing a value about to be
+ *  written with the shadow copy of its uniform.  A changed
+ *  value is recorded and counted as issued, and true is
+ *  returned so the caller passes it on.  An unchanged one
+ *  is counted as elided.  A handle that never resolved has
+ *  no slot and nothing to write.
+ ***********************************************************/
+bool UniformCache::UpdateShadow(int slot, const void* value, size_t valueSize)
+{
+	if ((slot < 0) || (slot >= (int)m_shadows.size()))
+	{
+		return(false);
+	}
+
+	SHADOW_VALUE& shadow = m_shadows[slot];
+	if ((shadow.bValid == true) && (memcmp(shadow.bytes, value, valueSize) == 0))
+	{
+		m_elidedCount++;
+		return(false);
+	}
+
+	memcpy(shadow.bytes, value, valueSize);
+	shadow.bValid = true;
+	m_issuedCount++;
+
+	return(true);
+}
@@ -0,0 +1,121 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformcache.h
+// ============
+// resolve the uniform locations of a shader program once
+//
+//  AUTHOR: Christian Tran
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// location of a uniform holding a value of type T, -1 when
+// the program has no such uniform, which sets nothing
+template <typename T>
+struct UNIFORM_HANDLE
+{
+	GLint location;
+	// shadow copy of the value last set
+	int slot;
+};
+
+/***********************************************************
+ *  UniformCache
+ *
+ *  This class reads the location and type of every active
+ *  uniform of a linked program in one pass, so uniforms are
+ *  found by name without asking the driver.  The hot paths
+ *  resolve typed handles once and set values through them
+ *  with no lookup at all, and a handle only resolves when
+ *  the uniform has the type of the handle.  Values are set
+ *  in the program in use.  A shadow copy of each value set
+ *  through a handle is kept, and a write of the value the
+ *  uniform already holds is dropped before the driver sees
+ *  it.  Uniforms set some other way, such as by name
+ *  through the shader manager, must be followed by a call
+ *  to Invalidate().
+ ***********************************************************/
+class UniformCache
+{
+public:
+	// constructor
+	UniformCache();
+	// destructor
+	~UniformCache();
+
+	// read the uniforms of a linked program, replacing any read before
+	bool Load(GLuint programID);
+	// program the uniforms were read from, 0 before Load()
+	GLuint GetProgram() const;
+	int GetUniformCount() const;
+	// location of a uniform by name, -1 when the program has none
+	GLint GetLocation(const std::string& name) const;
+
+	// resolve the handle of a uniform, false when missing or of another type
+	bool Resolve(const std::string& name, UNIFORM_HANDLE<bool>& handle) const;
+	bool Resolve(const std::string& name, UNIFORM_HANDLE<int>& handle) const;
+	bool Resolve(const std::string& name, UNIFORM_HANDLE<float>& handle) const;
+	bool Resolve(const std::string& name, UNIFORM_HANDLE<glm::vec2>& handle) const;
+	bool Resolve(const std::string& name, UNIFORM_HANDLE<glm::vec3>& handle) const;
+	bool Resolve(const std::string& name, UNIFORM_HANDLE<glm::vec4>& handle) const;
+	bool Resolve(const std::string& name, UNIFORM_HANDLE<glm::mat4>& handle) const;
+
+	// set a value through a handle into the program in use, unless it holds it already
+	void Set(UNIFORM_HANDLE<bool> handle, bool value);
+	void Set(UNIFORM_HANDLE<int> handle, int value);
+	void Set(UNIFORM_HANDLE<float> handle, float value);
+	void Set(UNIFORM_HANDLE<glm::vec2> handle, const glm::vec2& value);
+	void Set(UNIFORM_HANDLE<glm::vec3> handle, const glm::vec3& value);
+	void Set(UNIFORM_HANDLE<glm::vec4> handle, const glm::vec4& value);
+	void Set(UNIFORM_HANDLE<glm::mat4> handle, const glm::mat4& value);
+
+	// forget the shadow values after uniforms were set some other way
+	void Invalidate();
+	// writes passed to the driver and dropped as unchanged since ResetCounts()
+	int GetIssuedCount() const;
+	int GetElidedCount() const;
+	void ResetCounts();
+
+private:
+	struct UNIFORM_INFO
+	{
+		GLint location;
+		// GLSL type, such as GL_FLOAT_VEC3
+		GLenum type;
+		int slot;
+	};
+
+	// the value a uniform was last set to, large enough for a mat4
+	struct SHADOW_VALUE
+	{
+		unsigned char bytes[sizeof(glm::mat4)];
+		bool bValid;
+	};
+
+	GLuint m_programID;
+	// every active uniform by name, with each array element by its own name
+	std::unordered_map<std::string, UNIFORM_INFO> m_uniforms;
+	// shadow values by slot
+	std::vector<SHADOW_VALUE> m_shadows;
+	int m_issuedCount;
+	int m_elidedCount;
+
+	// add an empty shadow value and get back its slot
+	int AddShadow();
+	// record a value in its shadow slot, false when it holds it already
+	bool UpdateShadow(int slot, const void* value, size_t valueSize);
+
+	// location and shadow slot of a uniform of one of the passed in types, or -1
+	GLint FindLocation(const std::string& name, const GLenum* types, int typeCount, int& slot) const;
+
+	// caches match one program, so they are not copied
+	UniformCache(const UniformCache&);
+	UniformCache& operator=(const UniformCache&);
+};
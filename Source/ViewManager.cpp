@@ -28,8 +28,6 @@ namespace
 	// Variables for window width and height
 	const int WINDOW_WIDTH = 1000;
 	const int WINDOW_HEIGHT = 800;
-	const char* g_ViewName = "view";
-	const char* g_ProjectionName = "projection";
 
 	// camera object used for viewing and interacting with
 	// the 3D scene
@@ -63,6 +61,11 @@ ViewManager::ViewManager(
 	// initialize the member variables
 	m_pShaderManager = pShaderManager;
 	m_pWindow = NULL;
+	// the buffer needs an OpenGL context and a resource tracker,
+	// so it waits for the first frame
+	m_pFrameUniforms = NULL;
+	m_boundProgramID = 0;
+	m_pResourceTracker = NULL;
 	g_pCamera = new Camera();
 	// default camera view parameters
 	g_pCamera->Position = glm::vec3(0.0f, 5.0f, 12.0f);
@@ -81,6 +84,11 @@ ViewManager::~ViewManager()
 	// free up allocated memory
 	m_pShaderManager = NULL;
 	m_pWindow = NULL;
+	if (NULL != m_pFrameUniforms)
+	{
+		delete m_pFrameUniforms;
+		m_pFrameUniforms = NULL;
+	}
 	if (NULL != g_pCamera)
 	{
 		delete g_pCamera;
@@ -283,15 +291,107 @@ void ViewManager::PrepareSceneView()
 			0.1f, 100.0f);
 	}
 
-	// if the shader manager object is valid
-	if (NULL != m_pShaderManager)
+	// the frame values are only shared once they can be tracked
+	if (NULL == m_pResourceTracker)
+	{
+		return;
+	}
+	if (NULL == m_pFrameUniforms)
+	{
+		m_pFrameUniforms = new FrameUniformBuffer(m_pResourceTracker);
+	}
+
+	// a program only has to be pointed at the frame values once,
+	// so a new program of the shader manager is bound when seen
+	if ((NULL != m_pShaderManager) && (m_boundProgramID != m_pShaderManager->m_programID))
+	{
+		m_boundProgramID = m_pShaderManager->m_programID;
+		if (FrameUniformBuffer::BindProgram(m_boundProgramID) == false)
+		{
+			std::cout << "Could not find the FrameData block of the shader program" << std::endl;
+		}
+	}
+
+	// write the view and projection matrices and the camera
+	// position once for every program that renders the frame
+	m_pFrameUniforms->Update(view, projection, g_pCamera->Position);
+}
+
+/***********************************************************
+ *  SetResourceTracker()
+ *
+ *  This method is used for setting the tracker the frame
+ *  values buffer is recorded in, which is owned by the
+ *  scene manager.  The buffer made with an earlier tracker
+ *  is freed through it, so passing NULL before the tracker
+ *  goes away leaves nothing behind at the leak check, and
+ *  a new buffer is made on the next frame.
+ ***********************************************************/
+void ViewManager::SetResourceTracker(GLResourceTracker* pResourceTracker)
+{
+	if (pResourceTracker == m_pResourceTracker)
+	{
+		return;
+	}
+
+	if (NULL != m_pFrameUniforms)
+	{
+		delete m_pFrameUniforms;
+		m_pFrameUniforms = NULL;
+	}
+	m_pResourceTracker = pResourceTracker;
+}
+
+/***********************************************************
+ *  GetFrameUniforms()
+ *
+ *  This method is used for getting the camera values of the
+ *  last prepared frame, such as to find the view frustum.
+ ***********************************************************/
+const FrameUniformBuffer* ViewManager::GetFrameUniforms() const
+{
+	return(m_pFrameUniforms);
+}
+
+/***********************************************************
+ *  GetCameraPosition()
+ *
+ *  This method is used for getting the current position of
+ *  the camera in the 3D scene.
+ ***********************************************************/
+glm::vec3 ViewManager::GetCameraPosition() const
+{
+	return(g_pCamera->Position);
+}
+
+/***********************************************************
+ *  GetFocalLengthPixels()
+ *
+ *  This method is used for getting how many pixels high an
+ *  object one unit tall appears at one unit from the camera
+ *  with the current perspective projection.
+ ***********************************************************/
+float ViewManager::GetFocalLengthPixels() const
+{
+	return((float)WINDOW_HEIGHT / (2.0f * tanf(glm::radians(g_pCamera->Zoom) * 0.5f)));
+}
+
+/***********************************************************
+ *  GetViewportSize()
+ *
+ *  This method is used for getting the size in pixels of
+ *  the framebuffer of the window, which is what the
+ *  fragment shaders see in gl_FragCoord and can be larger
+ *  than the window on high density displays.
+ ***********************************************************/
+glm::ivec2 ViewManager::GetViewportSize() const
+{
+	glm::ivec2 viewportSize(WINDOW_WIDTH, WINDOW_HEIGHT);
+	if (NULL != m_pWindow)
 	{
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ViewName, view);
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
-		// set the view position of the camera into the shader for proper rendering
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
+		glfwGetFramebufferSize(m_pWindow, &viewportSize.x, &viewportSize.y);
 	}
+
+	return(viewportSize);
 }
 
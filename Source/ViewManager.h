@@ -10,8 +10,11 @@
 #pragma once
 
 #include "ShaderManager.h"
+#include "FrameUniformBuffer.h"
 #include "camera.h"
 
+class GLResourceTracker;
+
 // GLFW library
 #include "GLFW/glfw3.h" 
 
@@ -36,6 +39,12 @@ private:
 	ShaderManager* m_pShaderManager;
 	// active OpenGL display window
 	GLFWwindow* m_pWindow;
+	// camera values of the frame, shared by every program
+	FrameUniformBuffer* m_pFrameUniforms;
+	// shader manager program last pointed at the frame values
+	GLuint m_boundProgramID;
+	// records the frame values buffer, not owned
+	GLResourceTracker* m_pResourceTracker;
 
 	// process keyboard events for interaction with the 3D scene
 	void ProcessKeyboardEvents();
@@ -46,4 +55,15 @@ public:
 	
 	// prepare the conversion from 3D object display to 2D scene display
 	void PrepareSceneView();
+
+	// track the frame values through the scene's resources, NULL to free them
+	void SetResourceTracker(GLResourceTracker* pResourceTracker);
+	// camera values of the last prepared frame, NULL before the first
+	const FrameUniformBuffer* GetFrameUniforms() const;
+	// current position of the camera
+	glm::vec3 GetCameraPosition() const;
+	// height in pixels of one unit at a distance of one unit
+	float GetFocalLengthPixels() const;
+	// size in pixels of the framebuffer the scene is drawn into
+	glm::ivec2 GetViewportSize() const;
 };
\ No newline at end of file